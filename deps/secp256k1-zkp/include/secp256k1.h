@@ -607,6 +607,25 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_mul(
     const unsigned char *tweak
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Tweak many public keys by multiplying each of them by the same tweak value.
+ *  Each multiplication is constant time with respect to the tweak, and the
+ *  results are converted to affine coordinates together, with a single field
+ *  inversion for the whole call.
+ * Returns: 0 if the tweak was out of range or equal to zero, or if any of the
+ *          public keys couldn't be loaded. 1 otherwise.
+ * Args:    ctx:       pointer to a context object (cannot be NULL).
+ * In/Out:  pubkeys:   pointer to an array of n_pubkeys public key objects.
+ *                     All of them are zeroed if 0 is returned.
+ * In:      n_pubkeys: the number of public keys.
+ *          tweak:     pointer to a 32-byte tweak.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_mul_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkeys,
+    size_t n_pubkeys,
+    const unsigned char *tweak
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4);
+
 /** Updates the context randomization to protect against side-channel leakage.
  *  Returns: 1: randomization successfully updated
  *           0: error
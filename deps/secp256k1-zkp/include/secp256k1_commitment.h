@@ -244,6 +244,83 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_commitment_to_
   const secp256k1_pedersen_commitment* commit
 );
 
+/** Opaque structure holding precomputed multiplication tables for the fixed generators of
+ *  Pedersen commitments and switch commitments.
+ */
+typedef struct secp256k1_pedersen_tables secp256k1_pedersen_tables;
+
+/** Precomputes multiplication tables for the value generator 'h', the blinding factor generator 'g'
+ *  and the switch commitment public key 'j', for use with secp256k1_pedersen_commit_batch and
+ *  secp256k1_blind_switch_batch. The tables take about 150KB, and only need to be built once.
+ *
+ *  Returns a pointer to the tables, or NULL if the switch pubkey couldn't be loaded.
+ *  Args:         ctx: pointer to a context object (cannot be NULL)
+ *  In:     value_gen: value generator 'h'
+ *          blind_gen: blinding factor generator 'g'
+ *      switch_pubkey: pointer to public key 'j'
+ */
+SECP256K1_API secp256k1_pedersen_tables *secp256k1_pedersen_tables_create(
+  const secp256k1_context* ctx,
+  const secp256k1_generator *value_gen,
+  const secp256k1_generator *blind_gen,
+  const secp256k1_pubkey *switch_pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Destroys tables created by secp256k1_pedersen_tables_create.
+ *  Args:    ctx: pointer to a context object (cannot be NULL)
+ *        tables: pointer to the tables to destroy (may be NULL)
+ */
+SECP256K1_API void secp256k1_pedersen_tables_destroy(
+  const secp256k1_context* ctx,
+  secp256k1_pedersen_tables *tables
+) SECP256K1_ARG_NONNULL(1);
+
+/** Generate many Pedersen commitments, commits[i] = blinds[i] * G + values[i] * H, using the precomputed
+ *  tables instead of variable-base multiplication. The table lookups are constant time, and all of the
+ *  commitments are converted to affine coordinates with a single field inversion.
+ *
+ *  Returns 1: All commitments successfully created.
+ *          0: Error. A blinding factor is larger than the group order, or a commitment is the point
+ *             at infinity. All of the commitments are zeroed.
+ *  Args:   ctx:        pointer to a context object (cannot be NULL)
+ *  Out:    commits:    array of n_commits commitments (cannot be NULL unless n_commits is 0)
+ *  In:     tables:     tables created by secp256k1_pedersen_tables_create (cannot be NULL)
+ *          blinds:     array of n_commits pointers to 32-byte blinding factors
+ *          values:     array of n_commits unsigned 64-bit integer values to commit to
+ *          n_commits:  the number of commitments to generate
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pedersen_commit_batch(
+  const secp256k1_context* ctx,
+  secp256k1_pedersen_commitment *commits,
+  const secp256k1_pedersen_tables *tables,
+  const unsigned char * const *blinds,
+  const uint64_t *values,
+  size_t n_commits
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** Calculates many switch commitment blinding factors x' = x + SHA256(xG+vH | xJ), like
+ *  secp256k1_blind_switch, using the precomputed tables. The table lookups are constant time,
+ *  and all of the points are converted to affine coordinates with a single field inversion.
+ *
+ *  Returns 1: All blinding factors successfully computed.
+ *          0: Error. A blinding factor is zero or larger than the group order, or a hash overflowed.
+ *             Retry with different values.
+ *  Args:           ctx: pointer to a context object (cannot be NULL)
+ *  Out:  blind_switches: array of n pointers to 32-byte blinding factors for the switch commitments
+ *  In:          tables: tables created by secp256k1_pedersen_tables_create (cannot be NULL)
+ *               blinds: array of n pointers to 32-byte blinding factors
+ *               values: array of n unsigned 64-bit integer values to commit to
+ *                    n: the number of blinding factors to compute
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_blind_switch_batch(
+  const secp256k1_context* ctx,
+  unsigned char * const *blind_switches,
+  const secp256k1_pedersen_tables *tables,
+  const unsigned char * const *blinds,
+  const uint64_t *values,
+  size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
 # ifdef __cplusplus
 }
 # endif
@@ -354,4 +354,305 @@ int secp256k1_blind_switch(const secp256k1_context* ctx, unsigned char* blind_sw
     return 1;
 }
 
+/* Fixed-base tables, laid out like secp256k1_ecmult_gen_context: for each 4-bit window j of the
+ * multiplicand and each value i of that window, prec[j][i] = i * 16^j * P + U_j. The offsets U_j are
+ * multiples of a point with no known discrete log and sum to zero, so the sum of one entry per window
+ * is the product, and no entry is the point at infinity (which secp256k1_gej_add_ge can't take as its
+ * second argument). Values are 64 bits, so their table only needs 16 windows. */
+struct secp256k1_pedersen_tables {
+    secp256k1_ge_storage value[16][16];
+    secp256k1_ge_storage blind[64][16];
+    secp256k1_ge_storage switch_key[64][16];
+};
+
+static void secp256k1_pedersen_table_build(secp256k1_ge_storage (*prec)[16], size_t n_windows, const secp256k1_ge *base, const secp256k1_callback *cb) {
+    secp256k1_gej *precj;
+    secp256k1_ge *precg;
+    secp256k1_gej basej;
+    secp256k1_gej nums_gej;
+    secp256k1_gej numsbase;
+    size_t i, j;
+
+    precj = (secp256k1_gej *)checked_malloc(cb, sizeof(secp256k1_gej) * n_windows * 16);
+    precg = (secp256k1_ge *)checked_malloc(cb, sizeof(secp256k1_ge) * n_windows * 16);
+
+    /* Construct a group element with no known corresponding scalar (nothing up my sleeve), as in secp256k1_ecmult_gen_context_build. */
+    {
+        static const unsigned char nums_b32[33] = "The scalar for this x is unknown";
+        secp256k1_fe nums_x;
+        secp256k1_ge nums_ge;
+        int r;
+        r = secp256k1_fe_set_b32(&nums_x, nums_b32);
+        (void)r;
+        VERIFY_CHECK(r);
+        r = secp256k1_ge_set_xo_var(&nums_ge, &nums_x, 0);
+        (void)r;
+        VERIFY_CHECK(r);
+        secp256k1_gej_set_ge(&nums_gej, &nums_ge);
+        secp256k1_gej_add_ge_var(&nums_gej, &nums_gej, base, NULL);
+    }
+
+    secp256k1_gej_set_ge(&basej, base); /* 16^j * P */
+    numsbase = nums_gej; /* 2^j * nums */
+    for (j = 0; j < n_windows; j++) {
+        precj[j * 16] = numsbase;
+        for (i = 1; i < 16; i++) {
+            secp256k1_gej_add_var(&precj[j * 16 + i], &precj[j * 16 + i - 1], &basej, NULL);
+        }
+        for (i = 0; i < 4; i++) {
+            secp256k1_gej_double_var(&basej, &basej, NULL);
+        }
+        secp256k1_gej_double_var(&numsbase, &numsbase, NULL);
+        if (j == n_windows - 2) {
+            /* In the last window, numsbase is (1 - 2^j) * nums instead, so the offsets sum to zero. */
+            secp256k1_gej_neg(&numsbase, &numsbase);
+            secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
+        }
+    }
+
+    secp256k1_ge_set_all_gej_var(precg, precj, n_windows * 16, cb);
+    for (j = 0; j < n_windows; j++) {
+        for (i = 0; i < 16; i++) {
+            secp256k1_ge_to_storage(&prec[j][i], &precg[j * 16 + i]);
+        }
+    }
+
+    free(precg);
+    free(precj);
+}
+
+/* r += n * P, for the low 4 * n_windows bits of n. The entries are selected with conditional moves,
+ * so no secret data is used as an array index. */
+static void secp256k1_pedersen_table_ecmult(secp256k1_gej *r, const secp256k1_ge_storage (*prec)[16], size_t n_windows, const secp256k1_scalar *n) {
+    secp256k1_ge add;
+    secp256k1_ge_storage adds;
+    unsigned int bits;
+    size_t i, j;
+
+    memset(&adds, 0, sizeof(adds));
+    add.infinity = 0;
+    for (j = 0; j < n_windows; j++) {
+        bits = secp256k1_scalar_get_bits(n, j * 4, 4);
+        for (i = 0; i < 16; i++) {
+            secp256k1_ge_storage_cmov(&adds, &prec[j][i], i == bits);
+        }
+        secp256k1_ge_from_storage(&add, &adds);
+        secp256k1_gej_add_ge(r, r, &add);
+    }
+    bits = 0;
+    secp256k1_ge_clear(&add);
+}
+
+/* Converts the points to affine coordinates with a single (constant time) field inversion.
+ * Returns 0 if any of them is the point at infinity. */
+static int secp256k1_pedersen_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len, const secp256k1_callback *cb) {
+    secp256k1_fe *prod;
+    secp256k1_fe zi;
+    secp256k1_fe tmp;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (a[i].infinity) {
+            return 0;
+        }
+    }
+    if (len == 0) {
+        return 1;
+    }
+
+    /* prod[i] is the product of the first i + 1 z coordinates (Montgomery's trick). */
+    prod = (secp256k1_fe *)checked_malloc(cb, sizeof(secp256k1_fe) * len);
+    prod[0] = a[0].z;
+    for (i = 1; i < len; i++) {
+        secp256k1_fe_mul(&prod[i], &prod[i - 1], &a[i].z);
+    }
+
+    secp256k1_fe_inv(&zi, &prod[len - 1]);
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_fe_mul(&tmp, &zi, &prod[i - 1]);
+        secp256k1_ge_set_gej_zinv(&r[i], &a[i], &tmp);
+        secp256k1_fe_mul(&zi, &zi, &a[i].z);
+    }
+    secp256k1_ge_set_gej_zinv(&r[0], &a[0], &zi);
+
+    free(prod);
+    return 1;
+}
+
+/* r = blind * G + value * H */
+static void secp256k1_pedersen_table_commit(secp256k1_gej *r, const secp256k1_pedersen_tables *tables, const secp256k1_scalar *sec, uint64_t value) {
+    secp256k1_scalar vs;
+    secp256k1_scalar_set_u64(&vs, value);
+    secp256k1_gej_set_infinity(r);
+    secp256k1_pedersen_table_ecmult(r, tables->value, 16, &vs);
+    secp256k1_pedersen_table_ecmult(r, tables->blind, 64, sec);
+    secp256k1_scalar_clear(&vs);
+}
+
+secp256k1_pedersen_tables *secp256k1_pedersen_tables_create(const secp256k1_context* ctx, const secp256k1_generator *value_gen, const secp256k1_generator *blind_gen, const secp256k1_pubkey *switch_pubkey) {
+    secp256k1_pedersen_tables *ret;
+    secp256k1_ge value_genp;
+    secp256k1_ge blind_genp;
+    secp256k1_ge switchp;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(value_gen != NULL);
+    ARG_CHECK(blind_gen != NULL);
+    ARG_CHECK(switch_pubkey != NULL);
+
+    secp256k1_generator_load(&value_genp, value_gen);
+    secp256k1_generator_load(&blind_genp, blind_gen);
+    if (!secp256k1_pubkey_load(ctx, &switchp, switch_pubkey)) {
+        return NULL;
+    }
+
+    ret = (secp256k1_pedersen_tables *)checked_malloc(&ctx->error_callback, sizeof(*ret));
+    if (ret == NULL) {
+        return NULL;
+    }
+
+    secp256k1_pedersen_table_build(ret->value, 16, &value_genp, &ctx->error_callback);
+    secp256k1_pedersen_table_build(ret->blind, 64, &blind_genp, &ctx->error_callback);
+    secp256k1_pedersen_table_build(ret->switch_key, 64, &switchp, &ctx->error_callback);
+    return ret;
+}
+
+void secp256k1_pedersen_tables_destroy(const secp256k1_context* ctx, secp256k1_pedersen_tables *tables) {
+    (void) ctx;
+    free(tables);
+}
+
+int secp256k1_pedersen_commit_batch(const secp256k1_context* ctx, secp256k1_pedersen_commitment *commits, const secp256k1_pedersen_tables *tables, const unsigned char * const *blinds, const uint64_t *values, size_t n_commits) {
+    secp256k1_gej *rj;
+    secp256k1_ge *r;
+    secp256k1_scalar sec;
+    int overflow;
+    int ret = 1;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(tables != NULL);
+    if (n_commits == 0) {
+        return 1;
+    }
+    ARG_CHECK(commits != NULL);
+    ARG_CHECK(blinds != NULL);
+    ARG_CHECK(values != NULL);
+
+    rj = (secp256k1_gej *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_gej) * n_commits);
+    r = (secp256k1_ge *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * n_commits);
+
+    for (i = 0; i < n_commits; i++) {
+        secp256k1_scalar_set_b32(&sec, blinds[i], &overflow);
+        if (overflow) {
+            ret = 0;
+            break;
+        }
+        secp256k1_pedersen_table_commit(&rj[i], tables, &sec, values[i]);
+    }
+    secp256k1_scalar_clear(&sec);
+
+    if (ret) {
+        ret = secp256k1_pedersen_ge_set_all_gej(r, rj, n_commits, &ctx->error_callback);
+    }
+
+    if (ret) {
+        for (i = 0; i < n_commits; i++) {
+            secp256k1_pedersen_commitment_save(&commits[i], &r[i]);
+        }
+    } else {
+        memset(commits, 0, sizeof(*commits) * n_commits);
+    }
+
+    memset(rj, 0, sizeof(secp256k1_gej) * n_commits);
+    memset(r, 0, sizeof(secp256k1_ge) * n_commits);
+    free(r);
+    free(rj);
+    return ret;
+}
+
+int secp256k1_blind_switch_batch(const secp256k1_context* ctx, unsigned char * const *blind_switches, const secp256k1_pedersen_tables *tables, const unsigned char * const *blinds, const uint64_t *values, size_t n) {
+    secp256k1_sha256 hasher;
+    secp256k1_gej *rj;
+    secp256k1_ge *r;
+    secp256k1_scalar sec;
+    secp256k1_scalar blind_switch_scalar;
+    unsigned char buf[33];
+    size_t buflen;
+    unsigned char hashed[32];
+    int overflow;
+    int ret = 1;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(tables != NULL);
+    if (n == 0) {
+        return 1;
+    }
+    ARG_CHECK(blind_switches != NULL);
+    ARG_CHECK(blinds != NULL);
+    ARG_CHECK(values != NULL);
+
+    /* rj[2i] = xG + vH, rj[2i + 1] = xJ */
+    rj = (secp256k1_gej *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_gej) * n * 2);
+    r = (secp256k1_ge *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * n * 2);
+
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar_set_b32(&sec, blinds[i], &overflow);
+        if (overflow || secp256k1_scalar_is_zero(&sec)) {
+            ret = 0;
+            break;
+        }
+        secp256k1_pedersen_table_commit(&rj[2 * i], tables, &sec, values[i]);
+        secp256k1_gej_set_infinity(&rj[2 * i + 1]);
+        secp256k1_pedersen_table_ecmult(&rj[2 * i + 1], tables->switch_key, 64, &sec);
+    }
+
+    if (ret) {
+        ret = secp256k1_pedersen_ge_set_all_gej(r, rj, n * 2, &ctx->error_callback);
+    }
+
+    for (i = 0; ret && i < n; i++) {
+        secp256k1_sha256_initialize(&hasher);
+
+        /* xG + vH, serialized as in secp256k1_pedersen_commitment_serialize */
+        secp256k1_fe_normalize_var(&r[2 * i].x);
+        secp256k1_fe_normalize_var(&r[2 * i].y);
+        buf[0] = 9 ^ secp256k1_fe_is_quad_var(&r[2 * i].y);
+        secp256k1_fe_get_b32(&buf[1], &r[2 * i].x);
+        secp256k1_sha256_write(&hasher, buf, sizeof(buf));
+
+        /* xJ */
+        buflen = sizeof(buf);
+        if (!secp256k1_eckey_pubkey_serialize(&r[2 * i + 1], buf, &buflen, 1)) {
+            ret = 0;
+            break;
+        }
+        secp256k1_sha256_write(&hasher, buf, buflen);
+        secp256k1_sha256_finalize(&hasher, hashed);
+
+        secp256k1_scalar_set_b32(&blind_switch_scalar, hashed, &overflow); /* hash(xG+vH||xJ) */
+        if (overflow) {
+            ret = 0;
+            break;
+        }
+        secp256k1_scalar_set_b32(&sec, blinds[i], &overflow);
+        secp256k1_scalar_add(&blind_switch_scalar, &blind_switch_scalar, &sec); /* x + hash(xG+vH||xJ) */
+        secp256k1_scalar_get_b32(blind_switches[i], &blind_switch_scalar);
+    }
+
+    if (!ret) {
+        for (i = 0; i < n; i++) {
+            memset(blind_switches[i], 0, 32);
+        }
+    }
+
+    secp256k1_scalar_clear(&blind_switch_scalar);
+    secp256k1_scalar_clear(&sec);
+    memset(buf, 0, sizeof(buf));
+    memset(rj, 0, sizeof(secp256k1_gej) * n * 2);
+    memset(r, 0, sizeof(secp256k1_ge) * n * 2);
+    free(r);
+    free(rj);
+    return ret;
+}
+
 #endif
@@ -600,6 +600,66 @@ int secp256k1_ec_pubkey_tweak_mul(const secp256k1_context* ctx, secp256k1_pubkey
     return ret;
 }
 
+int secp256k1_ec_pubkey_tweak_mul_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, size_t n_pubkeys, const unsigned char *tweak) {
+    secp256k1_scalar factor;
+    secp256k1_gej *rj;
+    secp256k1_ge *r;
+    int overflow = 0;
+    int ret = 1;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkeys != NULL);
+    ARG_CHECK(tweak != NULL);
+
+    secp256k1_scalar_set_b32(&factor, tweak, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&factor)) {
+        memset(pubkeys, 0, sizeof(*pubkeys) * n_pubkeys);
+        secp256k1_scalar_clear(&factor);
+        return 0;
+    }
+    if (n_pubkeys == 0) {
+        secp256k1_scalar_clear(&factor);
+        return 1;
+    }
+
+    rj = (secp256k1_gej*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_gej) * n_pubkeys);
+    r = (secp256k1_ge*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * n_pubkeys);
+
+    /* The tweak is secret (e.g. a scan key), so each key is multiplied in constant time, as in ECDH. */
+    for (i = 0; i < n_pubkeys; i++) {
+        secp256k1_ge p;
+        if (!secp256k1_pubkey_load(ctx, &p, &pubkeys[i])) {
+            ret = 0;
+            break;
+        }
+        secp256k1_ecmult_const(&rj[i], &p, &factor, 256);
+    }
+
+    if (ret) {
+        /* Only the conversion of the results to affine coordinates is batched, with a single inversion. */
+        secp256k1_ge_set_all_gej_var(r, rj, n_pubkeys, &ctx->error_callback);
+        for (i = 0; i < n_pubkeys; i++) {
+            if (secp256k1_ge_is_infinity(&r[i])) {
+                ret = 0;
+                break;
+            }
+        }
+    }
+
+    if (ret) {
+        for (i = 0; i < n_pubkeys; i++) {
+            secp256k1_pubkey_save(&pubkeys[i], &r[i]);
+        }
+    } else {
+        memset(pubkeys, 0, sizeof(*pubkeys) * n_pubkeys);
+    }
+
+    secp256k1_scalar_clear(&factor);
+    free(r);
+    free(rj);
+    return ret;
+}
+
 int secp256k1_context_randomize(secp256k1_context* ctx, const unsigned char *seed32) {
     VERIFY_CHECK(ctx != NULL);
     ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
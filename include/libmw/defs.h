@@ -75,6 +75,11 @@ static constexpr size_t MAX_BLOCK_WEIGHT = 21'000;
 static constexpr size_t KERNEL_WEIGHT = 2;
 static constexpr size_t OWNER_SIG_WEIGHT = 1;
 static constexpr size_t OUTPUT_WEIGHT = 18;
+
+// An output proven by another output's aggregated range proof carries no proof of its own,
+// and each extra commitment an aggregated proof is over adds to the weight of the output carrying it.
+static constexpr size_t UNPROVEN_OUTPUT_WEIGHT = 5;
+static constexpr size_t AGGREGATED_COMMIT_WEIGHT = 1;
 static constexpr uint16_t PEGIN_MATURITY = 20;
 static constexpr uint8_t MAX_KERNEL_EXTRADATA_SIZE = 33;
 
@@ -88,6 +93,12 @@ static constexpr uint32_t CHANGE_INDEX{ 0 };
 /// </summary>
 static constexpr uint32_t PEGIN_INDEX{ 1 };
 
+/// <summary>
+/// Spent outputs are compacted out of the output PMMR and the leaf database once they are buried this many blocks deep.
+/// This is not a consensus parameter, so it can be overridden using ChainParams::pruneHorizon.
+/// </summary>
+static constexpr uint32_t DEFAULT_PRUNE_HORIZON{ 2880 };
+
 struct PegIn
 {
     uint64_t amount;
@@ -194,6 +205,9 @@ struct ChainParams
 {
     boost::filesystem::path dataDirectory;
     std::string hrp;
+
+    // Number of blocks to keep spent outputs for. 0 disables compaction.
+    uint32_t pruneHorizon{ DEFAULT_PRUNE_HORIZON };
 };
 
 struct BlockBuilderRef
@@ -10,8 +10,9 @@ MINER_NAMESPACE
 /// </summary>
 /// <param name="height">The height of the block being built.</param>
 /// <param name="view">The CoinsView representing the latest state of the active chain. Must not be null.</param>
+/// <param name="cut_through">Allows transactions to spend outputs created earlier in the block, cutting them through. Ignored below the cut-through height.</param>
 /// <returns>A non-null BlockBuilderRef</returns>
-MWIMPORT libmw::BlockBuilderRef NewBuilder(const uint64_t height, const libmw::CoinsViewRef& view);
+MWIMPORT libmw::BlockBuilderRef NewBuilder(const uint64_t height, const libmw::CoinsViewRef& view, const bool cut_through = false);
 
 MWIMPORT bool AddTransaction(
     const libmw::BlockBuilderRef& builder,
@@ -19,6 +20,28 @@ MWIMPORT bool AddTransaction(
     const std::vector<libmw::PegIn>& pegins
 );
 
+/// <summary>
+/// Adds a transaction to the pool of candidates the block is filled from.
+/// Candidates are included in order of fee per unit of weight, and may be replaced by later candidates with higher fee rates.
+/// </summary>
+/// <param name="builder">The BlockBuilder to add the candidate to. Must not be null.</param>
+/// <param name="transaction">The candidate transaction. Must not be null.</param>
+/// <param name="pegins">The peg-ins of the transaction.</param>
+/// <returns>False if the transaction can't be included in the block (e.g. it spends an immature peg-in or an output that isn't on chain).</returns>
+MWIMPORT bool AddCandidate(
+    const libmw::BlockBuilderRef& builder,
+    const libmw::TxRef& transaction,
+    const std::vector<libmw::PegIn>& pegins
+);
+
+/// <summary>
+/// Removes a transaction or candidate from the block being built, e.g. when it's evicted from the mempool.
+/// </summary>
+/// <param name="builder">The BlockBuilder the transaction was added to. Must not be null.</param>
+/// <param name="transaction">The transaction to remove. Must not be null.</param>
+/// <returns>True if the transaction was found and removed.</returns>
+MWIMPORT bool RemoveTransaction(const libmw::BlockBuilderRef& builder, const libmw::TxRef& transaction);
+
 MWIMPORT libmw::BlockRef BuildBlock(const libmw::BlockBuilderRef& builder);
 
 END_NAMESPACE // miner
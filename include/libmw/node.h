@@ -3,6 +3,8 @@
 #include "defs.h"
 #include <libmw/interfaces/chain_interface.h>
 #include <libmw/interfaces/db_interface.h>
+#include <functional>
+#include <future>
 
 LIBMW_NAMESPACE
 NODE_NAMESPACE
@@ -43,6 +45,22 @@ MWIMPORT libmw::CoinsViewRef ApplyState(
     const libmw::StateRef& state
 );
 
+/// <summary>
+/// Validates the chainstate in a snapshot file written by WriteStateSnapshot, and replaces the existing state if valid.
+/// Unlike ApplyState, the snapshot is read and applied one chunk at a time, so memory use stays bounded.
+/// </summary>
+/// <param name="pChain">Provides access to MWEB headers and blocks. Must not be null.</param>
+/// <param name="pCoinsDB">A wrapper around the node database. Must not be null.</param>
+/// <param name="stateHeader">The MWEB header at the chain tip. Must match the snapshot.</param>
+/// <param name="snapshot_path">The path of the snapshot file.</param>
+/// <returns>The CoinsViewDB which represents the state of the flushed chain.</returns>
+MWIMPORT libmw::CoinsViewRef ApplyStateSnapshot(
+    const libmw::IChain::Ptr& pChain,
+    const libmw::IDBWrapper::Ptr& pCoinsDB,
+    const libmw::HeaderRef& stateHeader,
+    const boost::filesystem::path& snapshot_path
+);
+
 /// <summary>
 /// Context-free validation of the MW ext block.
 /// This performs all consensus checks that don't require knowledge of the state.
@@ -93,9 +111,18 @@ MWIMPORT void FlushCache(
 /// <returns>A non-null snapshot of the chainstate.</returns>
 MWIMPORT libmw::StateRef SnapshotState(const libmw::CoinsViewRef& view);
 
+/// <summary>
+/// Writes a chunked snapshot of the chainstate in the given CoinsView to a file, without loading the whole state into memory.
+/// The file starts with a manifest (header hash, leafset, and the offset and hash of each chunk), followed by the kernel and UTXO chunks.
+/// </summary>
+/// <param name="view">The CoinsView containing the chainstate to snapshot. Must not be null.</param>
+/// <param name="snapshot_path">The path of the snapshot file to write. Any existing file is replaced.</param>
+MWIMPORT void WriteStateSnapshot(const libmw::CoinsViewRef& view, const boost::filesystem::path& snapshot_path);
+
 /// <summary>
 /// Context-free validation of the MWEB transaction.
 /// This validates that the transaction is valid without checking for double-spends.
+/// Signatures and range proofs are checked right away, without waiting to be batched with others like SubmitTransaction.
 /// </summary>
 /// <param name="transaction">The MWEB transaction to validate. Must not be null.</param>
 /// <returns>True if transaction is valid.</returns>
@@ -111,6 +138,44 @@ MWIMPORT bool CheckTransaction(const libmw::TxRef& transaction);
 /// <returns>True if the inputs are unspent.</returns>
 MWIMPORT bool CheckTxInputs(const libmw::CoinsViewRef& view, const libmw::TxRef& transaction, uint64_t nSpendHeight);
 
+/// <summary>
+/// Called once a transaction submitted with SubmitTransaction is validated.
+/// The bool is true if the transaction passed both CheckTransaction and CheckTxInputs.
+/// This is called from a libmw worker thread, so it should be quick, and must not throw.
+/// </summary>
+using TxCallback = std::function<void(const libmw::TxRef&, bool)>;
+
+/// <summary>
+/// Queues the MWEB transaction to be validated in the background, with the checks of CheckTransaction and CheckTxInputs.
+/// Transactions submitted close together are validated together, and their signatures and range proofs are batch verified.
+/// The inputs are looked up in the view before this returns, but it never waits on the queue, so it's safe to call from the P2P thread.
+/// </summary>
+/// <param name="view">The CoinsView to validate the inputs against. Must not be null, and must be guarded (e.g. by cs_main) during the call.</param>
+/// <param name="transaction">The MWEB transaction to validate. Must not be null.</param>
+/// <param name="nSpendHeight">The height at which the transaction is included.</param>
+/// <param name="callback">Called with the result once the transaction is validated.</param>
+/// <returns>False, without calling the callback, if too many transactions are already queued. Otherwise, true.</returns>
+MWIMPORT bool SubmitTransaction(
+    const libmw::CoinsViewRef& view,
+    const libmw::TxRef& transaction,
+    uint64_t nSpendHeight,
+    const TxCallback& callback
+);
+
+/// <summary>
+/// Same as the callback version of SubmitTransaction, but returns a future for the result instead.
+/// Blocks while too many transactions are queued.
+/// </summary>
+/// <param name="view">The CoinsView to validate the inputs against. Must not be null, and must be guarded (e.g. by cs_main) during the call.</param>
+/// <param name="transaction">The MWEB transaction to validate. Must not be null.</param>
+/// <param name="nSpendHeight">The height at which the transaction is included.</param>
+/// <returns>A future that's true if the transaction passed both CheckTransaction and CheckTxInputs.</returns>
+MWIMPORT std::future<bool> SubmitTransaction(
+    const libmw::CoinsViewRef& view,
+    const libmw::TxRef& transaction,
+    uint64_t nSpendHeight
+);
+
 /// <summary>
 /// Checks if there's a unspent coin in the view with a matching commitment.
 /// </summary>
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "defs.h"
+#include <libmw/interfaces/chain_interface.h>
+#include <libmw/interfaces/db_interface.h>
 #include <boost/variant.hpp>
 
 LIBMW_NAMESPACE
@@ -39,6 +41,12 @@ struct KeychainRef
     /// <param name="index">The index of the address keypair to use.</param>
     /// <returns>The generated stealth address.</returns>
     MWIMPORT MWEBAddress GetAddress(const uint32_t index);
+
+    /// <summary>
+    /// Serializes the spend pubkeys the keychain has derived so far.
+    /// </summary>
+    /// <returns>The serialized spend pubkeys, to be passed to LoadKeychain when the wallet is next loaded.</returns>
+    MWIMPORT std::vector<uint8_t> SerializeSpendPubKeys() const;
 };
 
 WALLET_NAMESPACE
@@ -49,18 +57,45 @@ WALLET_NAMESPACE
 /// <param name="scan_key">Scan private key generated with path m/1/0/100'</param>
 /// <param name="spend_key">Spend private key generated with path m/1/0/101'</param>
 /// <param name="address_index_counter">The highest index known to be used by the wallet.</param>
+/// <param name="spend_pubkeys">Spend pubkeys from KeychainRef::SerializeSpendPubKeys, if any were saved. Ignored if they don't belong to the keychain.</param>
 /// <returns>The loaded keychain</returns>
 MWIMPORT KeychainRef LoadKeychain(
     const libmw::PrivateKey& scan_key,
     const libmw::PrivateKey& spend_key,
-    const uint32_t address_index_counter
+    const uint32_t address_index_counter,
+    const std::vector<uint8_t>& spend_pubkeys = {}
 );
 
+/// <summary>
+/// Creates a transaction that spends the input coins and pegs in pegin_amount, paying the recipients and the fee.
+/// </summary>
+/// <param name="aggregate_proofs">Share range proofs between the outputs, making the transaction smaller and cheaper to verify.</param>
 MWIMPORT libmw::TxRef CreateTx(
     const std::vector<libmw::Coin>& input_coins,
     const std::vector<libmw::Recipient>& recipients,
     const boost::optional<uint64_t>& pegin_amount,
-    const uint64_t fee
+    const uint64_t fee,
+    const bool aggregate_proofs = false
+);
+
+/// <summary>
+/// Creates a transaction paying the recipients, picking which of the available coins to spend
+/// and adding a change output to the keychain's change address when needed.
+/// </summary>
+/// <param name="keychain">The wallet's keychain.</param>
+/// <param name="available_coins">The coins that may be spent. Watch-only coins are skipped.</param>
+/// <param name="recipients">The MWEB and pegout recipients.</param>
+/// <param name="fee_rate">The fee to pay per unit of transaction weight.</param>
+/// <param name="spent_coins_out">The coins the transaction spends.</param>
+/// <param name="aggregate_proofs">Share range proofs between the outputs, making the transaction smaller and cheaper to verify.</param>
+/// <returns>The transaction. Throws an InsufficientFundsException if the available coins can't cover the recipients and fee.</returns>
+MWIMPORT libmw::TxRef Send(
+    const libmw::KeychainRef& keychain,
+    const std::vector<libmw::Coin>& available_coins,
+    const std::vector<libmw::Recipient>& recipients,
+    const uint64_t fee_rate,
+    std::vector<libmw::Coin>& spent_coins_out,
+    const bool aggregate_proofs = false
 );
 
 MWIMPORT bool RewindBlockOutput(
@@ -77,5 +112,56 @@ MWIMPORT bool RewindTxOutput(
     libmw::Coin& coin_out
 );
 
+/// <summary>
+/// Finds all of the block's outputs that belong to the wallet.
+/// Each output is checked once, and only outputs whose view tags match are fully rewound.
+/// </summary>
+/// <param name="keychain">The wallet's keychain.</param>
+/// <param name="block">The block to scan.</param>
+/// <returns>The wallet's coins, in the order their outputs appear in the block.</returns>
+MWIMPORT std::vector<libmw::Coin> ScanBlock(
+    const libmw::KeychainRef& keychain,
+    const libmw::BlockRef& block
+);
+
+/// <summary>
+/// Scans the blocks after the wallet's scan cursor for coins that belong to the wallet.
+/// The coins and the cursor are saved to the wallet database, so only new blocks are scanned next time.
+/// If the block at the cursor is no longer in the chain, the whole chain is scanned again.
+/// </summary>
+/// <param name="keychain">The wallet's keychain.</param>
+/// <param name="pChain">Provides access to MWEB blocks. Must not be null.</param>
+/// <param name="pWalletDB">A wrapper around the wallet database. Must not be null.</param>
+/// <returns>The coins found in the newly scanned blocks.</returns>
+MWIMPORT std::vector<libmw::Coin> ScanChain(
+    const libmw::KeychainRef& keychain,
+    const libmw::IChain::Ptr& pChain,
+    const libmw::IDBWrapper::Ptr& pWalletDB
+);
+
+/// <summary>
+/// Moves the wallet's scan cursor back from a block being disconnected from the chain,
+/// removing the coins the block added and restoring the coins it spent.
+/// </summary>
+/// <param name="keychain">The wallet's keychain.</param>
+/// <param name="undo">The undo data of the block at the scan cursor. Must not be null.</param>
+/// <param name="pWalletDB">A wrapper around the wallet database. Must not be null.</param>
+MWIMPORT void DisconnectBlock(
+    const libmw::KeychainRef& keychain,
+    const libmw::BlockUndoRef& undo,
+    const libmw::IDBWrapper::Ptr& pWalletDB
+);
+
+/// <summary>
+/// Lists the wallet's unspent coins found by ScanChain.
+/// </summary>
+/// <param name="keychain">The wallet's keychain.</param>
+/// <param name="pWalletDB">A wrapper around the wallet database. Must not be null.</param>
+/// <returns>The unspent coins, ordered by commitment.</returns>
+MWIMPORT std::vector<libmw::Coin> GetCoins(
+    const libmw::KeychainRef& keychain,
+    const libmw::IDBWrapper::Ptr& pWalletDB
+);
+
 END_NAMESPACE // wallet
 END_NAMESPACE // libmw
\ No newline at end of file
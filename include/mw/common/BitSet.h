@@ -3,6 +3,8 @@
 #include <mw/traits/Serializable.h>
 #include <mw/serialization/Serializer.h>
 #include <boost/dynamic_bitset.hpp>
+#include <bitset>
+#include <iterator>
 #include <vector>
 
 struct BitSet : public Traits::ISerializable
@@ -94,4 +96,52 @@ struct BitSet : public Traits::ISerializable
         uint64_t num_bytes = deserializer.Read<uint64_t>();
         return BitSet::From(deserializer.ReadVector(num_bytes));
     }
+};
+
+/// <summary>
+/// A snapshot of a BitSet with precomputed per-block prefix counts, allowing rank() in constant time.
+/// Changes made to the BitSet after construction are not reflected.
+/// </summary>
+class BitSetRank
+{
+    using block_type = boost::dynamic_bitset<>::block_type;
+    static constexpr size_t BITS_PER_BLOCK = boost::dynamic_bitset<>::bits_per_block;
+
+public:
+    BitSetRank(const BitSet& bitset)
+        : m_size(bitset.size())
+    {
+        m_blocks.reserve(bitset.bitset.num_blocks());
+        boost::to_block_range(bitset.bitset, std::back_inserter(m_blocks));
+
+        m_counts.reserve(m_blocks.size());
+        uint64_t count = 0;
+        for (const block_type block : m_blocks) {
+            m_counts.push_back(count);
+            count += std::bitset<BITS_PER_BLOCK>(block).count();
+        }
+    }
+
+    /// <summary>
+    /// Calculates the number of set bits that are smaller than idx.
+    /// Matches BitSet::rank(idx).
+    /// </summary>
+    /// <param name="idx">The index to calculate the rank for.</param>
+    /// <returns>The calculated rank.</returns>
+    uint64_t rank(uint64_t idx) const noexcept
+    {
+        if (idx >= m_size) {
+            return m_blocks.empty() ? 0 : m_counts.back() + std::bitset<BITS_PER_BLOCK>(m_blocks.back()).count();
+        }
+
+        const size_t block_idx = idx / BITS_PER_BLOCK;
+        const size_t bit_idx = idx % BITS_PER_BLOCK;
+        const block_type mask = (block_type(1) << bit_idx) - 1;
+        return m_counts[block_idx] + std::bitset<BITS_PER_BLOCK>(m_blocks[block_idx] & mask).count();
+    }
+
+private:
+    uint64_t m_size;
+    std::vector<block_type> m_blocks;
+    std::vector<uint64_t> m_counts;
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// A fixed-size pool of worker threads.
+// Use ThreadPool::Get() for the process-wide pool shared by the node, wallet, and crypto code.
+//
+class ThreadPool
+{
+public:
+    explicit ThreadPool(const size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //
+    // Returns the shared pool, which has one worker per hardware thread.
+    //
+    static ThreadPool& Get();
+
+    size_t GetNumThreads() const noexcept { return m_workers.size(); }
+
+    //
+    // Queues the task and returns a future for its result.
+    // Blocking on the future from inside a worker can deadlock the pool. Use ParallelFor for nested work.
+    //
+    template<typename F>
+    auto Enqueue(F&& task) -> std::future<decltype(task())>
+    {
+        using R = decltype(task());
+        auto pTask = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = pTask->get_future();
+        Push([pTask]() { (*pTask)(); });
+        return result;
+    }
+
+    //
+    // Splits [begin, end) into chunks of at least min_chunk items, and calls fn(chunk_begin, chunk_end) for each.
+    // The calling thread processes chunks too, so it is safe to call this from a worker thread.
+    // Returns once every chunk has been processed. The first exception thrown by fn is rethrown.
+    //
+    void ParallelFor(
+        const uint64_t begin,
+        const uint64_t end,
+        const uint64_t min_chunk,
+        const std::function<void(const uint64_t, const uint64_t)>& fn
+    );
+
+private:
+    void Push(std::function<void()>&& task);
+    void Run();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <mw/exceptions/ValidationException.h>
 #include <mw/models/tx/Transaction.h>
+#include <algorithm>
 #include <cassert>
 
 class Aggregation
@@ -9,70 +11,183 @@ public:
     //
     // Aggregates multiple transactions into 1.
     //
-    static mw::Transaction::CPtr Aggregate(const std::vector<mw::Transaction::CPtr>& transactions)
+    // Each transaction's inputs, outputs, kernels and owner sigs are already sorted,
+    // so they're merged straight into pre-sized vectors instead of being concatenated and re-sorted.
+    // Throws a ValidationException if the same input, output or kernel appears in more than one transaction.
+    //
+    // With cut_through, outputs spent by another of the transactions are removed along with the inputs spending them.
+    // Cut-throughs aren't relayed with transactions, so the result is only meant for a block past the cut-through height.
+    //
+    static mw::Transaction::CPtr Aggregate(const std::vector<mw::Transaction::CPtr>& transactions, const bool cut_through = false)
     {
         if (transactions.empty()) {
             return std::make_shared<mw::Transaction>();
         }
 
-        if (transactions.size() == 1) {
+        if (transactions.size() == 1 && !cut_through) {
             return transactions.front();
         }
 
-        std::vector<Input> inputs;
-        std::vector<Output> outputs;
-        std::vector<Kernel> kernels;
+        std::vector<const std::vector<Input>*> inputs;
+        std::vector<const std::vector<Output>*> outputs;
+        std::vector<const std::vector<Kernel>*> kernels;
+        std::vector<const std::vector<SignedMessage>*> owner_sigs;
+        std::vector<const std::vector<CutThrough>*> cut_throughs;
         std::vector<BlindingFactor> kernel_offsets;
         std::vector<BlindingFactor> owner_offsets;
-        std::vector<SignedMessage> owner_sigs;
 
-        // collect all the inputs, outputs, kernels, and owner sigs from the txs
         for (const mw::Transaction::CPtr& pTransaction : transactions) {
-            inputs.insert(
-                inputs.end(),
-                pTransaction->GetInputs().begin(),
-                pTransaction->GetInputs().end()
-            );
-
-            outputs.insert(
-                outputs.end(),
-                pTransaction->GetOutputs().begin(),
-                pTransaction->GetOutputs().end()
-            );
-
-            kernels.insert(
-                kernels.end(),
-                pTransaction->GetKernels().begin(),
-                pTransaction->GetKernels().end()
-            );
-
-            owner_sigs.insert(
-                owner_sigs.end(),
-                pTransaction->GetOwnerSigs().begin(),
-                pTransaction->GetOwnerSigs().end()
-            );
-
+            inputs.push_back(&pTransaction->GetInputs());
+            outputs.push_back(&pTransaction->GetOutputs());
+            kernels.push_back(&pTransaction->GetKernels());
+            owner_sigs.push_back(&pTransaction->GetOwnerSigs());
+            cut_throughs.push_back(&pTransaction->GetBody().GetCutThroughs());
             kernel_offsets.push_back(pTransaction->GetKernelOffset());
             owner_offsets.push_back(pTransaction->GetOwnerOffset());
         }
 
-        // TODO: Do we need to prevent duplicate inputs, outputs, and kernels here?
-        // In theory, that should already be done in the mempool.
-        // Belt and suspenders checks wouldn't be bad, but it will result in a lot of
-        // memory duplication and hashtable lookups slowing down mining.
-
         // Sum the offsets up to give us an aggregate offsets for the transaction.
         BlindingFactor kernel_offset = Crypto::AddBlindingFactors(kernel_offsets);
         BlindingFactor owner_offset = Crypto::AddBlindingFactors(owner_offsets);
 
+        std::vector<Input> merged_inputs = Merge(inputs, SortByCommitment, true);
+        std::vector<Output> merged_outputs = Merge(outputs, SortByCommitment, true);
+        std::vector<CutThrough> merged_cut_throughs = Merge(cut_throughs, SortByHash, true);
+        if (cut_through) {
+            merged_cut_throughs = ApplyCutThrough(merged_inputs, merged_outputs, std::move(merged_cut_throughs));
+        }
+
         // Build a new aggregate tx
-        return mw::Transaction::Create(
+        return std::make_shared<mw::Transaction>(
             std::move(kernel_offset),
             std::move(owner_offset),
-            std::move(inputs),
-            std::move(outputs),
-            std::move(kernels),
-            std::move(owner_sigs)
+            TxBody{
+                std::move(merged_inputs),
+                std::move(merged_outputs),
+                Merge(kernels, KernelSort, true),
+                Merge(owner_sigs, SortByHash, false),
+                std::move(merged_cut_throughs)
+            }
         );
     }
-};
\ No newline at end of file
+
+    //
+    // Removes every output that's spent by one of the inputs, along with that input,
+    // and returns the given cut-throughs plus one for each removed pair, sorted by hash.
+    // Inputs and outputs must be sorted by commitment, so matching pairs are found in a single pass.
+    //
+    // Peg-in outputs can't be spent until they mature, so they're never cut through.
+    // Neither are outputs carrying an aggregated range proof, since other outputs in the body depend on it.
+    //
+    static std::vector<CutThrough> ApplyCutThrough(
+        std::vector<Input>& inputs,
+        std::vector<Output>& outputs,
+        std::vector<CutThrough>&& cut_throughs)
+    {
+        const size_t num_existing = cut_throughs.size();
+
+        std::vector<bool> input_spent(inputs.size(), false);
+        std::vector<bool> output_spent(outputs.size(), false);
+        size_t input_idx = 0;
+        size_t output_idx = 0;
+        while (input_idx < inputs.size() && output_idx < outputs.size()) {
+            const Commitment& input_commit = inputs[input_idx].GetCommitment();
+            const Commitment& output_commit = outputs[output_idx].GetCommitment();
+            if (input_commit < output_commit) {
+                input_idx++;
+            } else if (output_commit < input_commit) {
+                output_idx++;
+            } else {
+                const Output& output = outputs[output_idx];
+                if (!output.IsPeggedIn() && !(output.HasAggregatedProof() && output.HasRangeProof())) {
+                    cut_throughs.push_back(CutThrough::From(inputs[input_idx], outputs[output_idx]));
+                    input_spent[input_idx] = true;
+                    output_spent[output_idx] = true;
+                }
+
+                input_idx++;
+                output_idx++;
+            }
+        }
+
+        if (cut_throughs.size() == num_existing) {
+            return std::move(cut_throughs);
+        }
+
+        EraseFlagged(inputs, input_spent);
+        EraseFlagged(outputs, output_spent);
+
+        std::sort(cut_throughs.begin() + num_existing, cut_throughs.end(), SortByHash);
+        std::inplace_merge(cut_throughs.begin(), cut_throughs.begin() + num_existing, cut_throughs.end(), SortByHash);
+        return std::move(cut_throughs);
+    }
+
+private:
+    template<typename T>
+    static void EraseFlagged(std::vector<T>& items, const std::vector<bool>& flagged)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < items.size(); i++) {
+            if (!flagged[i]) {
+                if (kept != i) {
+                    items[kept] = std::move(items[i]);
+                }
+
+                kept++;
+            }
+        }
+
+        items.erase(items.begin() + kept, items.end());
+    }
+
+    //
+    // K-way merge of sorted lists, using a heap holding the next unmerged element of each list.
+    // Duplicates end up next to each other, so they're caught as they're merged.
+    //
+    template<typename T, typename Less>
+    static std::vector<T> Merge(const std::vector<const std::vector<T>*>& lists, const Less& less, const bool reject_duplicates)
+    {
+        using Cursor = std::pair<typename std::vector<T>::const_iterator, typename std::vector<T>::const_iterator>;
+
+        size_t total = 0;
+        std::vector<Cursor> heap;
+        heap.reserve(lists.size());
+        for (const std::vector<T>* pList : lists) {
+            total += pList->size();
+            if (!pList->empty()) {
+                heap.push_back({ pList->cbegin(), pList->cend() });
+            }
+        }
+
+        // std heaps keep the largest element on top, so the order is reversed to pop the smallest.
+        auto greater = [&less](const Cursor& lhs, const Cursor& rhs) { return less(*rhs.first, *lhs.first); };
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        std::vector<T> merged;
+        merged.reserve(total);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            Cursor& cursor = heap.back();
+
+            if (!merged.empty() && !less(merged.back(), *cursor.first)) {
+                if (less(*cursor.first, merged.back())) {
+                    ThrowValidation(EConsensusError::NOT_SORTED);
+                }
+
+                if (reject_duplicates) {
+                    ThrowValidation(EConsensusError::DUPLICATE_COMMITS);
+                }
+            }
+
+            merged.push_back(*cursor.first);
+
+            if (++cursor.first == cursor.second) {
+                heap.pop_back();
+            } else {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+
+        return merged;
+    }
+};
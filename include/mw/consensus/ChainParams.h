@@ -1,6 +1,8 @@
 #pragma once
 
 #include <mw/common/Macros.h>
+#include <cstdint>
+#include <limits>
 #include <string>
 
 MW_NAMESPACE
@@ -8,18 +10,30 @@ MW_NAMESPACE
 class ChainParams
 {
 public:
-    static void Initialize(const std::string& hrp, const uint64_t pegin_maturity)
+    // Cut-through is never activated unless a height is given.
+    static constexpr uint64_t NO_CUT_THROUGH = std::numeric_limits<uint64_t>::max();
+
+    static void Initialize(const std::string& hrp, const uint64_t pegin_maturity, const uint64_t cut_through_height = NO_CUT_THROUGH)
     {
         s_hrp = hrp;
         s_pegin_maturity = pegin_maturity;
+        s_cut_through_height = cut_through_height;
     }
 
     static const std::string& GetHRP() noexcept { return s_hrp; }
     static uint64_t GetPegInMaturity() noexcept { return s_pegin_maturity; }
 
+    //
+    // Blocks at or above this height have an explicit cut-through field.
+    // Their headers commit to the hash of the block's cut-throughs, which are serialized after the block's TxBody.
+    //
+    static uint64_t GetCutThroughHeight() noexcept { return s_cut_through_height; }
+    static bool IsCutThroughActive(const uint64_t height) noexcept { return height >= s_cut_through_height; }
+
 private:
     inline static std::string s_hrp = "tmwltc";
     inline static uint64_t s_pegin_maturity = 20;
+    inline static uint64_t s_cut_through_height = NO_CUT_THROUGH;
 };
 
 END_NAMESPACE
\ No newline at end of file
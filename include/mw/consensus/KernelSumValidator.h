@@ -1,7 +1,9 @@
 #pragma once
 
 #include <mw/exceptions/ValidationException.h>
+#include <mw/crypto/CommitmentSum.h>
 #include <mw/crypto/Crypto.h>
+#include <mw/models/block/StateSums.h>
 #include <mw/models/tx/TxBody.h>
 #include <mw/models/tx/Transaction.h>
 #include <mw/models/tx/UTXO.h>
@@ -33,15 +35,33 @@ public:
             }
         }
 
+        // The state can have millions of commitments, so they're summed in parallel.
         ValidateSums(
             {},
-            utxo_commitments,
-            Commitments::From(kernels),
+            { CommitmentSum::Sum(utxo_commitments) },
+            { CommitmentSum::Sum(Commitments::From(kernels)) },
             total_offset,
             total_mw_supply
         );
     }
 
+    // Same as above, for callers that total the commitments and supply themselves
+    // (e.g. with CommitmentSum::AddPartial, or as blocks are connected).
+    static void ValidateState(const mw::StateSums& sums, const BlindingFactor& total_offset)
+    {
+        if (sums.total_mw_supply < 0) {
+            ThrowValidation(EConsensusError::BLOCK_SUMS);
+        }
+
+        ValidateSums(
+            {},
+            { sums.utxo_sum },
+            { sums.kernel_sum },
+            total_offset,
+            sums.total_mw_supply
+        );
+    }
+
     static void ValidateForBlock(
         const TxBody& body,
         const BlindingFactor& total_offset,
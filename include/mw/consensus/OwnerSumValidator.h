@@ -17,6 +17,13 @@ public:
             [](const Output& output) { return output.GetSenderPubKey(); }
         );
 
+        // Outputs that were cut through still count towards the sums, along with the inputs that spent them.
+        std::transform(
+            body.GetCutThroughs().cbegin(), body.GetCutThroughs().cend(),
+            std::back_inserter(output_pubkeys),
+            [](const CutThrough& cut_through) { return cut_through.GetSenderPubKey(); }
+        );
+
         std::vector<PublicKey> input_pubkeys;
         std::transform(
             body.GetInputs().cbegin(), body.GetInputs().cend(),
@@ -24,6 +31,12 @@ public:
             [](const Input& input) { return input.GetPubKey(); }
         );
 
+        std::transform(
+            body.GetCutThroughs().cbegin(), body.GetCutThroughs().cend(),
+            std::back_inserter(input_pubkeys),
+            [](const CutThrough& cut_through) { return cut_through.GetInputPubKey(); }
+        );
+
         std::transform(
             body.GetOwnerSigs().cbegin(), body.GetOwnerSigs().cend(),
             std::back_inserter(input_pubkeys),
@@ -25,15 +25,53 @@ public:
             + (num_outputs * libmw::OUTPUT_WEIGHT);
     }
 
+    // Each cut-through carries 2 signatures, so it weighs the same as 2 owner sigs.
     static size_t Calculate(const TxBody& tx_body)
     {
-        return Calculate(
+        size_t output_weight = 0;
+        for (const Output& output : tx_body.GetOutputs()) {
+            output_weight += Calculate(output);
+        }
+
+        return output_weight + Calculate(
             tx_body.GetKernels().size(),
-            tx_body.GetOwnerSigs().size(),
-            tx_body.GetOutputs().size()
+            tx_body.GetOwnerSigs().size() + (2 * tx_body.GetCutThroughs().size()),
+            0
         );
     }
 
+    static size_t Calculate(const Output& output)
+    {
+        if (!output.HasRangeProof()) {
+            return libmw::UNPROVEN_OUTPUT_WEIGHT;
+        }
+
+        return libmw::OUTPUT_WEIGHT + (output.GetAggregatedCommits().size() * libmw::AGGREGATED_COMMIT_WEIGHT);
+    }
+
+    //
+    // The weight of num_outputs new outputs, the same as Calculate(const Output&) summed over them.
+    // With aggregate_proofs, they're split into groups that share a proof the way Transact splits them:
+    // the largest power of 2, up to RangeProof::MAX_COMMITS, that fits in the outputs that are left.
+    //
+    static size_t CalculateOutputs(const size_t num_outputs, const bool aggregate_proofs)
+    {
+        size_t weight = 0;
+        for (size_t next = 0; next < num_outputs;) {
+            size_t group_size = aggregate_proofs ? RangeProof::MAX_COMMITS : 1;
+            while (group_size > num_outputs - next) {
+                group_size /= 2;
+            }
+
+            weight += libmw::OUTPUT_WEIGHT
+                + ((group_size - 1) * libmw::AGGREGATED_COMMIT_WEIGHT)
+                + ((group_size - 1) * libmw::UNPROVEN_OUTPUT_WEIGHT);
+            next += group_size;
+        }
+
+        return weight;
+    }
+
     static bool ExceedsMaximum(const TxBody& tx_body)
     {
         return Calculate(tx_body) > libmw::MAX_BLOCK_WEIGHT;
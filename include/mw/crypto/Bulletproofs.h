@@ -25,6 +25,19 @@ public:
         const std::vector<uint8_t>& extraData
     );
 
+    //
+    // Proves all of the amounts are in range with a single proof, which grows logarithmically with the number of amounts.
+    // The keys are the blinding factors of the amounts' commitments, in the same order.
+    // Aggregated proofs can't be rewound, so they carry no proof message.
+    //
+    static RangeProof::CPtr GenerateAggregated(
+        const std::vector<uint64_t>& amounts,
+        const std::vector<SecretKey>& keys,
+        const SecretKey& privateNonce,
+        const SecretKey& rewindNonce,
+        const std::vector<uint8_t>& extraData
+    );
+
     static std::unique_ptr<RewoundProof> Rewind(
         const Commitment& commitment,
         const RangeProof& rangeProof,
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mw/models/crypto/Commitment.h>
+
+//
+// Sums large numbers of pedersen commitments.
+// Commitments are split into partitions that are parsed and summed in parallel on the ThreadPool,
+// and the partial sums are combined the same way until only one is left.
+//
+// Sums can also be built up one batch at a time with AddPartial,
+// so callers never need to hold every commitment in memory at once.
+//
+class CommitmentSum
+{
+public:
+    //
+    // Commitments are summed in partitions of at least this many.
+    //
+    static constexpr size_t PARTITION_SIZE = 1024;
+
+    CommitmentSum() = default;
+
+    //
+    // Adds the positive commitments to the running total, and subtracts the negative ones.
+    //
+    CommitmentSum& AddPartial(
+        const std::vector<Commitment>& positive,
+        const std::vector<Commitment>& negative = { }
+    );
+
+    //
+    // Returns the sum of everything added so far.
+    // A zero commitment is returned if nothing was added.
+    //
+    const Commitment& Total() const noexcept { return m_total; }
+
+    //
+    // Returns the sum of the positive commitments minus the sum of the negative ones.
+    // Gives the same result as Crypto::AddCommitments.
+    //
+    static Commitment Sum(
+        const std::vector<Commitment>& positive,
+        const std::vector<Commitment>& negative = { }
+    );
+
+private:
+    Commitment m_total;
+};
@@ -15,6 +15,7 @@
 #include <mw/models/crypto/PublicKey.h>
 #include <mw/models/crypto/SecretKey.h>
 #include <support/allocators/secure.h>
+#include <boost/optional.hpp>
 
 #define CRYPTO_API
 
@@ -37,6 +38,15 @@ public:
         const BlindingFactor& blindingFactor
     );
 
+    //
+    // Creates a pedersen commitment for each value with the blinding factor at the same index.
+    // The commitments are created in batches on the thread pool, and each batch shares its field inversion.
+    //
+    static std::vector<Commitment> CommitBlinded(
+        const std::vector<uint64_t>& values,
+        const std::vector<BlindingFactor>& blindingFactors
+    );
+
     //
     // Adds the homomorphic pedersen commitments together.
     //
@@ -77,6 +87,14 @@ public:
         const uint64_t amount
     );
 
+    //
+    // Calculates the switch blinding factor of each secret key with the amount at the same index, in batches like CommitBlinded.
+    //
+    static std::vector<BlindingFactor> BlindSwitch(
+        const std::vector<BlindingFactor>& secretKeys,
+        const std::vector<uint64_t>& amounts
+    );
+
     //
     // Adds 2 private keys together.
     //
@@ -86,4 +104,12 @@ public:
     );
 
     static PublicKey MultiplyKey(const PublicKey& public_key, const SecretKey& mul);
+
+    //
+    // Multiplies each of the public keys by the same scalar, e.g. to calculate the shared secrets of many outputs.
+    // The keys are multiplied in batches on the thread pool, in constant time, and each batch shares its field inversion.
+    // Returns the products in the same order as the public keys, with boost::none for keys that aren't valid points.
+    // Throws a CryptoException only if mul isn't a valid scalar.
+    //
+    static std::vector<boost::optional<PublicKey>> MultiplyKeys(const std::vector<PublicKey>& public_keys, const SecretKey& mul);
 };
\ No newline at end of file
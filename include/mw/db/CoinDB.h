@@ -4,9 +4,17 @@
 #include <mw/models/tx/UTXO.h>
 #include <libmw/interfaces/db_interface.h>
 #include <unordered_map>
+#include <unordered_set>
 
 // Forward Declarations
 class Database;
+class ProofRecord;
+
+//
+// Stores the UTXOs by commitment.
+// UTXOs covered by another output's aggregated proof share one copy of that output,
+// which is kept until the last of them is removed.
+//
 
 class CoinDB
 {
@@ -43,5 +51,11 @@ public:
 	void RemoveAllUTXOs();
 
 private:
+	std::shared_ptr<const ProofRecord> GetProof(const Commitment& commitment) const;
+	void SaveProof(const Commitment& commitment, const ProofRecord& proof);
+
 	std::unique_ptr<Database> m_pDatabase;
+
+	// Proof outputs removed in this batch.
+	std::unordered_set<Commitment> m_removedProofs;
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <mw/mmr/LeafPruneState.h>
+#include <libmw/interfaces/db_interface.h>
+#include <memory>
+
+// Forward Declarations
+class Database;
+
+//
+// Stores the LeafPruner's progress in its own table,
+// so clearing the LeafDB (e.g. when a snapshot is applied) doesn't wipe it.
+//
+class LeafPruneDB
+{
+public:
+    LeafPruneDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch = nullptr);
+    ~LeafPruneDB();
+
+    //
+    // Retrieves the saved state. nullptr if none was saved.
+    //
+    std::unique_ptr<LeafPruneState> Get() const;
+
+    //
+    // Replaces the saved state.
+    //
+    void Save(const LeafPruneState& state);
+
+private:
+    std::unique_ptr<Database> m_pDatabase;
+};
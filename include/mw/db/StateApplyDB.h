@@ -0,0 +1,36 @@
+#pragma once
+
+#include <mw/node/StateChunk.h>
+#include <libmw/interfaces/db_interface.h>
+#include <memory>
+
+// Forward Declarations
+class Database;
+
+//
+// Stores the progress of the state that's being applied, if there is one.
+//
+class StateApplyDB
+{
+public:
+    StateApplyDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch = nullptr);
+    ~StateApplyDB();
+
+    //
+    // Retrieves the saved progress. nullptr if no state is being applied.
+    //
+    std::unique_ptr<mw::StateApplyProgress> Get() const;
+
+    //
+    // Replaces the saved progress.
+    //
+    void Save(const mw::StateApplyProgress& progress);
+
+    //
+    // Removes the saved progress, once the state is either saved or removed.
+    //
+    void Remove();
+
+private:
+    std::unique_ptr<Database> m_pDatabase;
+};
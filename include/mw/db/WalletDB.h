@@ -0,0 +1,67 @@
+#pragma once
+
+#include <mw/models/crypto/Commitment.h>
+#include <mw/models/wallet/ScanState.h>
+#include <libmw/interfaces/db_interface.h>
+
+// Forward Declarations
+class Database;
+
+class WalletDB
+{
+public:
+    WalletDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch = nullptr);
+    ~WalletDB();
+
+    /// <summary>
+    /// Retrieves the last block the wallet scanned.
+    /// </summary>
+    /// <returns>The scan cursor. nullptr if nothing has been scanned yet.</returns>
+    std::unique_ptr<mw::ScanCursor> GetCursor() const;
+
+    /// <summary>
+    /// Saves the last block the wallet scanned.
+    /// </summary>
+    /// <param name="cursor">The scan cursor to save.</param>
+    void SaveCursor(const mw::ScanCursor& cursor);
+
+    /// <summary>
+    /// Removes the scan cursor, if there is one.
+    /// </summary>
+    void RemoveCursor();
+
+    /// <summary>
+    /// Retrieves the wallet's unspent coin with the given commitment.
+    /// </summary>
+    /// <param name="commitment">The commitment of the coin to retrieve.</param>
+    /// <returns>The coin. nullptr if not found.</returns>
+    std::unique_ptr<mw::WalletCoin> GetCoin(const Commitment& commitment) const;
+
+    /// <summary>
+    /// Retrieves all of the wallet's unspent coins.
+    /// Coins added or removed in a batch that hasn't been committed yet aren't included.
+    /// </summary>
+    /// <returns>The coins, ordered by commitment.</returns>
+    std::vector<mw::WalletCoin> GetCoins() const;
+
+    /// <summary>
+    /// Adds the coins, replacing any with the same commitments.
+    /// </summary>
+    /// <param name="coins">The coins to add.</param>
+    void AddCoins(const std::vector<mw::WalletCoin>& coins);
+
+    /// <summary>
+    /// Removes the coin with the given commitment, if the wallet has one.
+    /// </summary>
+    /// <param name="commitment">The commitment of the coin to remove.</param>
+    /// <returns>True if a coin was removed.</returns>
+    bool RemoveCoin(const Commitment& commitment);
+
+    /// <summary>
+    /// Removes all of the wallet's coins. This is useful when rescanning the chain.
+    /// </summary>
+    void RemoveAllCoins();
+
+private:
+    std::unique_ptr<Database> m_pDatabase;
+};
\ No newline at end of file
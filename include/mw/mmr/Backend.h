@@ -5,12 +5,12 @@
 // file LICENSE or http://www.opensource.org/licenses/mit-license.php.
 
 #include <mw/common/Macros.h>
+#include <mw/common/BitSet.h>
 #include <mw/models/crypto/Hash.h>
 #include <mw/mmr/Index.h>
 #include <mw/mmr/LeafIndex.h>
 #include <mw/mmr/Leaf.h>
 #include <libmw/interfaces/db_interface.h>
-#include <boost/dynamic_bitset.hpp>
 #include <memory>
 
 MMR_NAMESPACE
@@ -28,14 +28,17 @@ public:
     virtual void Rewind(const LeafIndex& nextLeafIndex) = 0;
 
     /// <summary>
-    /// Takes in a bitset of all positions we want to keep.
-    /// All other positions in the leafset will be removed,
+    /// Takes in a bitset of all positions that can be removed from the MMR hash file,
     /// leaving just enough parents to rebuild & verify the MMR root.
-    /// The resulting MMR will be immediately flushed to disk. No need to call Commit().
+    /// This must be a superset of the positions already compacted.
+    /// The compacted hash file is only staged. The next Commit() writes it as that commit's hash file
+    /// and saves the new PruneList, so the files of the last committed index are never modified.
+    /// Until then, the MMR reads as if it wasn't compacted, and can't be rewound past the removed positions.
     /// </summary>
-    /// <param name="file_index">The file number to save the compacted MMR hash file.</param>
-    /// <param name="hashes_to_remove">The positions to remove.</param>
-    virtual void Compact(const uint32_t file_index, const boost::dynamic_bitset<uint64_t>& hashes_to_remove) = 0;
+    /// <param name="compact_index">The file number to save the new PruneList bitset.</param>
+    /// <param name="compacted">The positions to remove. Usually built using MMRUtil::BuildCompactBitSet.</param>
+    /// <returns>The number of hashes that will be removed from the hash file.</returns>
+    virtual uint64_t Compact(const uint32_t compact_index, const BitSet& compacted) = 0;
 
     virtual uint64_t GetNumLeaves() const noexcept = 0;
     virtual mw::Hash GetHash(const Index& idx) const = 0;
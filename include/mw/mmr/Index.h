@@ -19,6 +19,12 @@ public:
         : m_position(position), m_height(height) { }
     static Index At(const uint64_t position) noexcept;
 
+    //
+    // Gets the index of the nth node (zero-based, from the left) at the given height.
+    // eg. Using the diagram below, AtHeight(1, 1) is position 5.
+    //
+    static Index AtHeight(const uint64_t height, const uint64_t n) noexcept;
+
     bool operator==(const Index& rhs) const noexcept { return m_position == rhs.m_position && m_height == rhs.m_height; }
     bool operator!=(const Index& rhs) const noexcept { return m_position != rhs.m_position || m_height != rhs.m_height; }
     bool operator<(const Index& rhs) const noexcept { return m_position < rhs.m_position; }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mw/serialization/Deserializer.h>
+#include <mw/serialization/Serializer.h>
+#include <mw/traits/Serializable.h>
+#include <cstdint>
+
+/// <summary>
+/// Tracks how far the removal of spent leaves from the LeafDB has gotten.
+/// Each pass removes the leaves that were spent in the target leafset, but not in the base leafset.
+/// </summary>
+struct LeafPruneState : public Traits::ISerializable
+{
+    LeafPruneState()
+        : version(0), base_index(0), target_index(0), next_leaf(0) { }
+    LeafPruneState(uint8_t version_in, uint32_t base_index_in, uint32_t target_index_in, uint64_t next_leaf_in)
+        : version(version_in), base_index(base_index_in), target_index(target_index_in), next_leaf(next_leaf_in) { }
+
+    // Version byte that allows for future modifications to the LeafPruneState schema.
+    uint8_t version;
+
+    // File number of the leafset the last completed pass pruned up to.
+    // 0 if no pass has completed, since a flush never writes leafset 0.
+    uint32_t base_index;
+
+    // File number of the leafset the current pass is pruning up to.
+    // 0 if no pass is in progress.
+    uint32_t target_index;
+
+    // The watermark. Leaves below this were already handled by the current pass.
+    uint64_t next_leaf;
+
+    bool IsPassInProgress() const noexcept { return target_index != 0; }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint8_t>(version)
+            .Append<uint32_t>(base_index)
+            .Append<uint32_t>(target_index)
+            .Append<uint64_t>(next_leaf);
+    }
+
+    static LeafPruneState Deserialize(Deserializer& deserializer)
+    {
+        uint8_t version = deserializer.Read<uint8_t>();
+        uint32_t base_index = deserializer.Read<uint32_t>();
+        uint32_t target_index = deserializer.Read<uint32_t>();
+        uint64_t next_leaf = deserializer.Read<uint64_t>();
+
+        return LeafPruneState{ version, base_index, target_index, next_leaf };
+    }
+};
@@ -122,6 +122,15 @@ public:
         const std::unique_ptr<libmw::IDBBatch>& pBatch
     ) final;
 
+    /// <summary>
+    /// Stages the removal of the given positions from the MMR hash file. See IBackend::Compact.
+    /// </summary>
+    /// <returns>The number of hashes that will be removed from the hash file.</returns>
+    uint64_t Compact(const uint32_t compact_index, const BitSet& compacted)
+    {
+        return m_pBackend->Compact(compact_index, compacted);
+    }
+
 private:
     IBackend::Ptr m_pBackend;
 };
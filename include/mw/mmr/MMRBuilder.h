@@ -0,0 +1,67 @@
+#pragma once
+
+#include <mw/common/BitSet.h>
+#include <mw/common/Macros.h>
+#include <mw/file/File.h>
+#include <mw/mmr/Leaf.h>
+#include <mw/mmr/LeafIndex.h>
+#include <mw/models/crypto/Hash.h>
+#include <boost/optional.hpp>
+
+MMR_NAMESPACE
+
+/// <summary>
+/// Writes the hash file of an MMR whose leaves are supplied in order, a range at a time.
+/// Only the hashes of the current peaks are kept in memory, so memory use doesn't grow with the number of leaves.
+/// Each range is hashed one height at a time, with the nodes of a height split across the ThreadPool.
+/// </summary>
+class MMRBuilder
+{
+public:
+    /// <summary>
+    /// Creates a builder that writes to the given hash file, replacing it if it already exists.
+    /// </summary>
+    /// <param name="hash_file_path">The path of the hash file to write.</param>
+    /// <param name="unspent_leaf_indices">The leafset of the finished MMR. Its size is the total number of leaves.</param>
+    MMRBuilder(const FilePath& hash_file_path, const BitSet& unspent_leaf_indices);
+
+    /// <summary>
+    /// Calculates the hashes of every position before next_leaf_idx's position.
+    /// </summary>
+    /// <param name="next_leaf_idx">The first leaf that's not part of this range.</param>
+    /// <param name="unspent_leaves">The range's unspent leaves, in order.</param>
+    /// <param name="pruned_parent_hashes">The hashes of the range's pruned parents, in order.</param>
+    /// <throws>ValidationException if the leaves or hashes don't match the leafset.</throws>
+    void Add(
+        const LeafIndex& next_leaf_idx,
+        const std::vector<Leaf>& unspent_leaves,
+        const std::vector<mw::Hash>& pruned_parent_hashes
+    );
+
+    /// <summary>
+    /// Bags the peaks of the MMR built so far.
+    /// </summary>
+    /// <returns>The root, or ZERO_HASH if no leaves have been added.</returns>
+    /// <throws>ValidationException if a peak was pruned without its hash being supplied.</throws>
+    mw::Hash Root() const;
+
+    const LeafIndex& GetNextLeafIdx() const noexcept { return m_nextLeafIdx; }
+
+    /// <summary>
+    /// Appends any buffered hashes to the hash file.
+    /// </summary>
+    void Flush();
+
+private:
+    File m_hashFile;
+    BitSet m_leafset;
+    BitSet m_prunedParents;
+    LeafIndex m_nextLeafIdx;
+
+    // The hash of each subtree not yet joined to its sibling, from left to right.
+    // A subtree that's been fully compacted has no hash.
+    std::vector<boost::optional<mw::Hash>> m_peaks;
+    std::vector<uint8_t> m_buffer;
+};
+
+END_NAMESPACE
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mw/models/block/StateSums.h>
 #include <mw/models/crypto/Hash.h>
 #include <boost/optional.hpp>
 
@@ -8,10 +9,31 @@
 /// </summary>
 struct MMRInfo : public Traits::ISerializable
 {
+    // Version 1 adds the state sums.
+    static constexpr uint8_t SUMS_VERSION = 1;
+
+    // Version 2 adds the heights, so the compaction checkpoints can be restored from the saved MMRInfos.
+    static constexpr uint8_t HEIGHT_VERSION = 2;
+
     MMRInfo()
-        : version(0), index(0), pruned(mw::Hash()), compact_index(0), compacted(boost::none) { }
-    MMRInfo(uint8_t version, uint32_t index_in, mw::Hash pruned_in, uint32_t compact_index_in, boost::optional<mw::Hash> compacted_in)
-        : version(version), index(index_in), pruned(std::move(pruned_in)), compact_index(compact_index_in), compacted(std::move(compacted_in)) { }
+        : version(HEIGHT_VERSION), index(0), pruned(mw::Hash()), compact_index(0), compacted(boost::none), sums(boost::none), height(boost::none), compacted_height(boost::none) { }
+    MMRInfo(
+        uint8_t version,
+        uint32_t index_in,
+        mw::Hash pruned_in,
+        uint32_t compact_index_in,
+        boost::optional<mw::Hash> compacted_in,
+        boost::optional<mw::StateSums> sums_in = boost::none,
+        boost::optional<uint64_t> height_in = boost::none,
+        boost::optional<uint64_t> compacted_height_in = boost::none)
+        : version(version),
+        index(index_in),
+        pruned(std::move(pruned_in)),
+        compact_index(compact_index_in),
+        compacted(std::move(compacted_in)),
+        sums(std::move(sums_in)),
+        height(std::move(height_in)),
+        compacted_height(std::move(compacted_height_in)) { }
 
     // Version byte that allows for future modifications to the MMRInfo schema.
     uint8_t version;
@@ -29,14 +51,39 @@ struct MMRInfo : public Traits::ISerializable
     // You cannot rewind beyond this point.
     boost::optional<mw::Hash> compacted;
 
+    // Sums of the UTXOs and kernels in the MMRs.
+    // Missing for MMRs written before version 1, until they're summed again.
+    boost::optional<mw::StateSums> sums;
+
+    // Height of the header this MMR represents (pruned).
+    // Missing for MMRs written before version 2.
+    boost::optional<uint64_t> height;
+
+    // Height of the header this MMR was compacted for (compacted).
+    boost::optional<uint64_t> compacted_height;
+
     Serializer& Serialize(Serializer& serializer) const noexcept final
     {
-        return serializer
+        serializer
             .Append<uint8_t>(version)
             .Append<uint32_t>(index)
             .Append(pruned)
             .Append<uint32_t>(compact_index)
             .Append(compacted.value_or(mw::Hash()));
+
+        if (version >= SUMS_VERSION) {
+            serializer.Append(sums);
+        }
+
+        if (version >= HEIGHT_VERSION) {
+            serializer
+                .Append<bool>(height.has_value())
+                .Append<uint64_t>(height.value_or(0))
+                .Append<bool>(compacted_height.has_value())
+                .Append<uint64_t>(compacted_height.value_or(0));
+        }
+
+        return serializer;
     }
 
     static MMRInfo Deserialize(Deserializer& deserializer)
@@ -47,12 +94,35 @@ struct MMRInfo : public Traits::ISerializable
         uint32_t compact_index = deserializer.Read<uint32_t>();
         mw::Hash compacted = deserializer.Read<mw::Hash>();
 
+        boost::optional<mw::StateSums> sums = boost::none;
+        if (version >= SUMS_VERSION) {
+            sums = deserializer.ReadOpt<mw::StateSums>();
+        }
+
+        boost::optional<uint64_t> height = boost::none;
+        boost::optional<uint64_t> compacted_height = boost::none;
+        if (version >= HEIGHT_VERSION) {
+            height = ReadOptHeight(deserializer);
+            compacted_height = ReadOptHeight(deserializer);
+        }
+
         return MMRInfo{
             version,
             index,
             pruned,
             compact_index,
-            compacted == mw::Hash() ? boost::none : boost::make_optional<mw::Hash>(std::move(compacted))
+            compacted == mw::Hash() ? boost::none : boost::make_optional<mw::Hash>(std::move(compacted)),
+            std::move(sums),
+            height,
+            compacted_height
         };
     }
+
+private:
+    static boost::optional<uint64_t> ReadOptHeight(Deserializer& deserializer)
+    {
+        const bool has_height = deserializer.Read<bool>();
+        const uint64_t height = deserializer.Read<uint64_t>();
+        return has_height ? boost::make_optional(height) : boost::none;
+    }
 };
\ No newline at end of file
@@ -5,7 +5,8 @@
 #include <mw/mmr/LeafIndex.h>
 #include <mw/util/BitUtil.h>
 #include <boost/dynamic_bitset.hpp>
-#include <cmath>
+#include <iterator>
+#include <vector>
 
 MMR_NAMESPACE
 
@@ -13,7 +14,7 @@ struct SiblingIter
 {
 public:
     SiblingIter(const uint64_t height, const mmr::Index& last_node)
-        : m_height(height), m_lastNode(last_node), m_baseInc((uint64_t)std::pow(2, height + 1) - 1), m_siblingNum(0), m_next()
+        : m_height(height), m_lastNode(last_node), m_baseInc((2ULL << height) - 1), m_siblingNum(0), m_next()
     {
 
     }
@@ -46,43 +47,28 @@ private:
 class MMRUtil
 {
 public:
+    /// <summary>
+    /// Calculates the positions that can be removed from the MMR hash file.
+    /// Those are the children of every parent whose leaves have all been spent.
+    /// </summary>
+    /// <param name="num_leaves">The total number of (spent and unspent) leaves in the MMR.</param>
+    /// <param name="unspent_leaf_indices">The unspent leaf indices.</param>
+    /// <returns>The compactable positions.</returns>
     static BitSet BuildCompactBitSet(const uint64_t num_leaves, const BitSet& unspent_leaf_indices)
     {
-        BitSet compactable_node_indices(num_leaves * 2);
+        std::vector<uint64_t> compactable_node_indices(NumWords(num_leaves * 2), 0);
 
-        boost::dynamic_bitset<> prunable_nodes(num_leaves * 2);
+        // Leaves beyond the end of the leafset are not considered spent.
+        std::vector<uint64_t> prunable = CalcSpentLeaves(std::min(num_leaves, unspent_leaf_indices.size()), unspent_leaf_indices);
+        prunable.resize(NumWords(num_leaves), 0);
 
-        mmr::LeafIndex leaf_idx = mmr::LeafIndex::At(0);
-        while (leaf_idx.GetLeafIndex() < num_leaves) {
-            if (unspent_leaf_indices.size() > leaf_idx.GetLeafIndex() && !unspent_leaf_indices.test(leaf_idx.GetLeafIndex())) {
-                prunable_nodes.set(leaf_idx.GetPosition());
-            }
-
-            leaf_idx = leaf_idx.Next();
+        for (uint64_t height = 0; (num_leaves >> (height + 1)) > 0; height++) {
+            std::vector<uint64_t> parents = CalcParentLayer(prunable, num_leaves >> (height + 1));
+            SetPositions(compactable_node_indices, height, SpreadBits(parents, num_leaves >> height));
+            prunable = std::move(parents);
         }
 
-        mmr::LeafIndex next_leaf = mmr::LeafIndex::At(num_leaves);
-        mmr::Index last_node = mmr::Index::At(next_leaf.GetPosition() - 1);
-
-        uint64_t height = 1;
-        while ((std::pow(2, height + 1) - 2) <= next_leaf.GetPosition()) {
-            SiblingIter iter(height, last_node);
-            while (iter.Next()) {
-                mmr::Index right_child = iter.Get().GetRightChild();
-                if (prunable_nodes.test(right_child.GetPosition())) {
-                    mmr::Index left_child = iter.Get().GetLeftChild();
-                    if (prunable_nodes.test(left_child.GetPosition())) {
-                        compactable_node_indices.set(right_child.GetPosition());
-                        compactable_node_indices.set(left_child.GetPosition());
-                        prunable_nodes.set(iter.Get().GetPosition());
-                    }
-                }
-            }
-
-            ++height;
-        }
-
-        return compactable_node_indices;
+        return ToBitSet(compactable_node_indices, num_leaves * 2);
     }
 
     static BitSet DiffCompactBitSet(const BitSet& prev_compact, const BitSet& new_compact)
@@ -109,39 +95,154 @@ public:
     /// <returns>The pruned parent positions.</returns>
     static BitSet CalcPrunedParents(const BitSet& unspent_leaf_indices)
     {
-        BitSet ret(unspent_leaf_indices.size() * 2);
-
-        mmr::LeafIndex leaf_idx = mmr::LeafIndex::At(0);
-        while (leaf_idx.GetLeafIndex() < unspent_leaf_indices.size()) {
-            if (!unspent_leaf_indices.test(leaf_idx.GetLeafIndex())) {
-                ret.set(leaf_idx.GetPosition());
+        const uint64_t num_leaves = unspent_leaf_indices.size();
+        std::vector<uint64_t> ret(NumWords(num_leaves * 2), 0);
+
+        // A fully-spent node is a pruned parent unless its own parent is fully spent too.
+        std::vector<uint64_t> spent = CalcSpentLeaves(num_leaves, unspent_leaf_indices);
+        for (uint64_t height = 0; (num_leaves >> height) > 0; height++) {
+            const uint64_t num_nodes = num_leaves >> height;
+            std::vector<uint64_t> parents = CalcParentLayer(spent, num_leaves >> (height + 1));
+            std::vector<uint64_t> spent_parents = SpreadBits(parents, num_nodes);
+            for (size_t i = 0; i < spent.size(); i++) {
+                spent[i] &= ~spent_parents[i];
             }
 
-            leaf_idx = leaf_idx.Next();
+            SetPositions(ret, height, spent);
+            spent = std::move(parents);
+        }
+
+        return ToBitSet(ret, num_leaves * 2);
+    }
+
+private:
+    static size_t NumWords(const uint64_t num_bits) noexcept { return (size_t)((num_bits + 63) / 64); }
+
+    //
+    // Builds the leaf layer, with a bit set for each leaf index below num_leaves that's not in unspent_leaf_indices.
+    //
+    static std::vector<uint64_t> CalcSpentLeaves(const uint64_t num_leaves, const BitSet& unspent_leaf_indices)
+    {
+        using block_type = boost::dynamic_bitset<>::block_type;
+        const size_t bits_per_block = boost::dynamic_bitset<>::bits_per_block;
+
+        std::vector<block_type> blocks;
+        blocks.reserve(unspent_leaf_indices.bitset.num_blocks());
+        boost::to_block_range(unspent_leaf_indices.bitset, std::back_inserter(blocks));
+
+        std::vector<uint64_t> spent(NumWords(num_leaves), 0);
+        for (size_t i = 0; i < blocks.size() && (i * bits_per_block) < (spent.size() * 64); i++) {
+            const size_t bit_idx = i * bits_per_block;
+            spent[bit_idx / 64] |= ((uint64_t)blocks[i]) << (bit_idx % 64);
+        }
+
+        for (uint64_t& word : spent) {
+            word = ~word;
+        }
+
+        if (num_leaves % 64 != 0) {
+            spent.back() &= (1ULL << (num_leaves % 64)) - 1;
+        }
+
+        return spent;
+    }
+
+    //
+    // Calculates the layer above, where bit k is set when both bits 2k and 2k+1 of the given layer are set.
+    //
+    static std::vector<uint64_t> CalcParentLayer(const std::vector<uint64_t>& layer, const uint64_t num_parents)
+    {
+        std::vector<uint64_t> parents(NumWords(num_parents), 0);
+        for (size_t i = 0; i < parents.size(); i++) {
+            const uint64_t lo = (2 * i) < layer.size() ? layer[2 * i] : 0;
+            const uint64_t hi = (2 * i + 1) < layer.size() ? layer[2 * i + 1] : 0;
+            parents[i] = CompressEvenBits(lo & (lo >> 1)) | (CompressEvenBits(hi & (hi >> 1)) << 32);
         }
 
-        mmr::Index last_node = mmr::LeafIndex::At(unspent_leaf_indices.size()).GetNodeIndex();
-
-        uint64_t height = 1;
-        while ((std::pow(2, height + 1) - 2) <= last_node.GetPosition()) {
-            SiblingIter iter(height, last_node);
-            while (iter.Next()) {
-                mmr::Index right_child = iter.Get().GetRightChild();
-                if (ret.test(right_child.GetPosition())) {
-                    mmr::Index left_child = iter.Get().GetLeftChild();
-                    if (ret.test(left_child.GetPosition())) {
-                        ret.set(right_child.GetPosition(), false);
-                        ret.set(left_child.GetPosition(), false);
-                        ret.set(iter.Get().GetPosition());
-                    }
-                }
+        if (num_parents % 64 != 0 && !parents.empty()) {
+            parents.back() &= (1ULL << (num_parents % 64)) - 1;
+        }
+
+        return parents;
+    }
+
+    //
+    // Calculates the layer below, where bits 2k and 2k+1 are set when bit k of the given layer is set.
+    //
+    static std::vector<uint64_t> SpreadBits(const std::vector<uint64_t>& layer, const uint64_t num_children)
+    {
+        std::vector<uint64_t> children(NumWords(num_children), 0);
+        for (size_t i = 0; i < children.size(); i++) {
+            const uint64_t word = (i / 2) < layer.size() ? layer[i / 2] : 0;
+            const uint64_t even = ExpandToEvenBits((i % 2 == 0) ? (word & 0xFFFFFFFFULL) : (word >> 32));
+            children[i] = even | (even << 1);
+        }
+
+        return children;
+    }
+
+    // Moves bits 0, 2, 4, ... 62 into bits 0-31.
+    static uint64_t CompressEvenBits(uint64_t x) noexcept
+    {
+        x &= 0x5555555555555555ULL;
+        x = (x | (x >> 1)) & 0x3333333333333333ULL;
+        x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+        x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+        return x;
+    }
+
+    // Moves bits 0-31 into bits 0, 2, 4, ... 62.
+    static uint64_t ExpandToEvenBits(uint64_t x) noexcept
+    {
+        x &= 0x00000000FFFFFFFFULL;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+        x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x << 2)) & 0x3333333333333333ULL;
+        x = (x | (x << 1)) & 0x5555555555555555ULL;
+        return x;
+    }
+
+    //
+    // For each bit k set in the layer, sets the position of the kth node at the given height.
+    //
+    static void SetPositions(std::vector<uint64_t>& positions, const uint64_t height, const std::vector<uint64_t>& layer)
+    {
+        for (size_t i = 0; i < layer.size(); i++) {
+            uint64_t word = layer[i];
+            if (word == 0) {
+                continue;
             }
 
-            ++height;
+            // Since i * 64 has no bits in common with j < 64, AtHeight(height, (i * 64) + j)
+            // is the position of the first node in the word plus (j << (height + 1)) - CountBitsSet(j).
+            const uint64_t first_pos = Index::AtHeight(height, i * 64).GetPosition();
+            while (word != 0) {
+                const uint64_t j = BitUtil::CountRightmostZeros(word);
+                const uint64_t pos = first_pos + (j << (height + 1)) - BitUtil::CountBitsSet(j);
+                positions[pos / 64] |= (1ULL << (pos % 64));
+                word &= (word - 1);
+            }
         }
+    }
 
+    static BitSet ToBitSet(const std::vector<uint64_t>& words, const uint64_t num_bits)
+    {
+        using block_type = boost::dynamic_bitset<>::block_type;
+        const size_t bits_per_block = boost::dynamic_bitset<>::bits_per_block;
+
+        BitSet bitset;
+        bitset.bitset.reserve(words.size() * 64);
+        for (const uint64_t word : words) {
+            for (size_t shift = 0; shift < 64; shift += bits_per_block) {
+                bitset.bitset.append((block_type)(word >> shift));
+            }
+        }
 
-        return ret;
+        bitset.bitset.resize(num_bits);
+        return bitset;
     }
 };
 
@@ -20,15 +20,17 @@ public:
     uint64_t GetShift(const mmr::Index& index) const noexcept;
     uint64_t GetShift(const mmr::LeafIndex& index) const noexcept;
     uint64_t GetTotalShift() const noexcept { return m_totalShift; }
+    const BitSet& GetCompacted() const noexcept { return m_compacted; }
 
     void Commit(const uint32_t file_index, const BitSet& compacted);
 
 private:
     PruneList(const FilePath& dir, BitSet&& compacted, uint64_t total_shift)
-        : m_dir(dir), m_compacted(std::move(compacted)), m_totalShift(total_shift) { }
+        : m_dir(dir), m_compacted(std::move(compacted)), m_shifts(m_compacted), m_totalShift(total_shift) { }
 
     FilePath m_dir;
     BitSet m_compacted;
+    BitSetRank m_shifts;
     uint64_t m_totalShift;
 };
 
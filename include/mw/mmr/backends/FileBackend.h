@@ -22,7 +22,7 @@ public:
         const FilePath& mmr_dir,
         const uint32_t file_index,
         const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-        const mmr::PruneList::CPtr& pPruneList
+        const mmr::PruneList::Ptr& pPruneList
     );
 
     FileBackend(
@@ -30,7 +30,7 @@ public:
         const FilePath& mmr_dir,
         const AppendOnlyFile::Ptr& pHashFile,
         const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-        const mmr::PruneList::CPtr& pPruneList
+        const mmr::PruneList::Ptr& pPruneList
     );
 
     static FilePath GetPath(const FilePath& dir, const char prefix, const uint32_t file_index);
@@ -39,7 +39,7 @@ public:
     void AddHash(const mw::Hash& hash) final;
     void Rewind(const LeafIndex& nextLeafIndex) final;
 
-    void Compact(const uint32_t file_index, const boost::dynamic_bitset<uint64_t>& hashes_to_remove) final;
+    uint64_t Compact(const uint32_t compact_index, const BitSet& compacted) final;
 
     uint64_t GetNumLeaves() const noexcept final;
     mw::Hash GetHash(const Index& idx) const final;
@@ -48,13 +48,34 @@ public:
     void Commit(const uint32_t file_index, const std::unique_ptr<libmw::IDBBatch>& pBatch) final;
 
 private:
+    //
+    // A compaction written to a temp file by Compact(), waiting for the next Commit().
+    //
+    struct StagedCompaction
+    {
+        FilePath temp_path;
+        uint32_t compact_index;
+        BitSet compacted;
+        uint64_t num_removed;
+
+        // Offset in the live hash file of the last hash removed.
+        uint64_t last_removed;
+
+        // The size of the live hash file's prefix that the temp file still matches.
+        // Lowered by rewinds, which can't go past last_removed.
+        uint64_t num_kept;
+    };
+
+    void ApplyStaged(const FilePath& path);
+
     char m_dbPrefix;
     FilePath m_dir;
     AppendOnlyFile::Ptr m_pHashFile;
     std::vector<Leaf> m_leaves;
     std::map<mmr::LeafIndex, size_t> m_leafMap;
     std::shared_ptr<libmw::IDBWrapper> m_pDatabase;
-    PruneList::CPtr m_pPruneList;
+    PruneList::Ptr m_pPruneList;
+    std::unique_ptr<StagedCompaction> m_pStaged;
 };
 
 END_NAMESPACE
\ No newline at end of file
@@ -42,7 +42,7 @@ public:
         m_nodes.resize(nextLeafIndex.GetPosition());
     }
 
-    void Compact(const uint32_t, const boost::dynamic_bitset<uint64_t>&) final { }
+    uint64_t Compact(const uint32_t, const BitSet&) final { return 0; }
 
     uint64_t GetNumLeaves() const noexcept final { return m_leaves.size(); }
 
@@ -65,13 +65,20 @@ public:
     Serializer& Serialize(Serializer& serializer) const noexcept final
     {
         assert(m_pHeader != nullptr);
-        return serializer.Append(m_pHeader).Append(m_body);
+        serializer.Append(m_pHeader);
+
+        // Blocks past the cut-through height have a cut-through field, which their header commits to.
+        if (m_pHeader->GetCutThroughHash()) {
+            return m_body.SerializeCutThroughs(serializer);
+        }
+
+        return serializer.Append(m_body);
     }
 
     static Block Deserialize(Deserializer& deserializer)
     {
         mw::Header::CPtr pHeader = std::make_shared<mw::Header>(mw::Header::Deserialize(deserializer));
-        TxBody body = TxBody::Deserialize(deserializer);
+        TxBody body = pHeader->GetCutThroughHash() ? TxBody::DeserializeWithCutThroughs(deserializer) : TxBody::Deserialize(deserializer);
         return Block{ pHeader, std::move(body) };
     }
 
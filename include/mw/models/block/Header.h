@@ -5,6 +5,7 @@
 // file LICENSE or http://www.opensource.org/licenses/mit-license.php.
 
 #include <mw/common/Macros.h>
+#include <mw/consensus/ChainParams.h>
 #include <mw/models/crypto/BlindingFactor.h>
 #include <mw/models/crypto/Hash.h>
 #include <mw/traits/Hashable.h>
@@ -39,7 +40,8 @@ public:
         BlindingFactor&& kernelOffset,
         BlindingFactor&& ownerOffset,
         const uint64_t outputMMRSize,
-        const uint64_t kernelMMRSize
+        const uint64_t kernelMMRSize,
+        boost::optional<mw::Hash> cutThroughHash = boost::none
     )
         : m_height(height),
         m_outputRoot(std::move(outputRoot)),
@@ -48,7 +50,8 @@ public:
         m_kernelOffset(std::move(kernelOffset)),
         m_ownerOffset(std::move(ownerOffset)),
         m_outputMMRSize(outputMMRSize),
-        m_kernelMMRSize(kernelMMRSize) { }
+        m_kernelMMRSize(kernelMMRSize),
+        m_cutThroughHash(std::move(cutThroughHash)) { }
 
     //
     // Operators
@@ -67,6 +70,9 @@ public:
     uint64_t GetNumTXOs() const noexcept { return m_outputMMRSize; }
     uint64_t GetNumKernels() const noexcept { return m_kernelMMRSize; }
 
+    // The block's TxBody::GetCutThroughHash(). Only present, and required, once ChainParams::IsCutThroughActive(height).
+    const boost::optional<mw::Hash>& GetCutThroughHash() const noexcept { return m_cutThroughHash; }
+
     //
     // Traits
     //
@@ -84,10 +90,11 @@ public:
 
     //
     // Serialization/Deserialization
+    // The cut-through hash follows the kernel MMR size in headers of blocks past the cut-through height.
     //
     Serializer& Serialize(Serializer& serializer) const noexcept final
     {
-        return serializer
+        serializer
             .Append<uint64_t>(m_height)
             .Append(m_outputRoot)
             .Append(m_kernelRoot)
@@ -96,6 +103,12 @@ public:
             .Append(m_ownerOffset)
             .Append<uint64_t>(m_outputMMRSize)
             .Append<uint64_t>(m_kernelMMRSize);
+
+        if (m_cutThroughHash) {
+            serializer.Append(*m_cutThroughHash);
+        }
+
+        return serializer;
     }
 
     static Header Deserialize(Deserializer& deserializer)
@@ -109,6 +122,11 @@ public:
         uint64_t outputMMRSize = deserializer.Read<uint64_t>();
         uint64_t kernelMMRSize = deserializer.Read<uint64_t>();
 
+        boost::optional<mw::Hash> cutThroughHash = boost::none;
+        if (ChainParams::IsCutThroughActive(height)) {
+            cutThroughHash = mw::Hash::Deserialize(deserializer);
+        }
+
         return Header{
             height,
             std::move(outputRoot),
@@ -117,7 +135,8 @@ public:
             std::move(kernelOffset),
             std::move(ownerOffset),
             outputMMRSize,
-            kernelMMRSize
+            kernelMMRSize,
+            std::move(cutThroughHash)
         };
     }
 
@@ -131,6 +150,7 @@ private:
     BlindingFactor m_ownerOffset;
     uint64_t m_outputMMRSize;
     uint64_t m_kernelMMRSize;
+    boost::optional<mw::Hash> m_cutThroughHash;
 };
 
 END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mw/common/Macros.h>
+#include <mw/models/crypto/Commitment.h>
+#include <mw/traits/Serializable.h>
+#include <mw/serialization/Serializer.h>
+
+#include <cstdint>
+
+MW_NAMESPACE
+
+//
+// Running totals of the unspent outputs and kernels in the state.
+// These are updated as blocks are connected and disconnected,
+// so the state can be checked against a header without reading every output and kernel.
+//
+struct StateSums : public Traits::ISerializable
+{
+    StateSums()
+        : utxo_sum(), kernel_sum(), total_mw_supply(0) { }
+    StateSums(Commitment utxo_sum_in, Commitment kernel_sum_in, const int64_t total_mw_supply_in)
+        : utxo_sum(std::move(utxo_sum_in)), kernel_sum(std::move(kernel_sum_in)), total_mw_supply(total_mw_supply_in) { }
+
+    // Sum of every unspent output commitment. Zero when there are no unspent outputs.
+    Commitment utxo_sum;
+
+    // Sum of every kernel excess. Zero when there are no kernels.
+    Commitment kernel_sum;
+
+    // Total coins pegged in, minus total coins pegged out.
+    int64_t total_mw_supply;
+
+    //
+    // Returns the sums after adding and removing the given outputs and kernels.
+    //
+    StateSums Update(
+        const std::vector<Commitment>& utxos_added,
+        const std::vector<Commitment>& utxos_removed,
+        const std::vector<Commitment>& kernels_added,
+        const std::vector<Commitment>& kernels_removed,
+        const int64_t supply_change
+    ) const;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append(utxo_sum)
+            .Append(kernel_sum)
+            .Append<int64_t>(total_mw_supply);
+    }
+
+    static StateSums Deserialize(Deserializer& deserializer)
+    {
+        Commitment utxo_sum = deserializer.Read<Commitment>();
+        Commitment kernel_sum = deserializer.Read<Commitment>();
+        int64_t total_mw_supply = deserializer.Read<int64_t>();
+        return StateSums(std::move(utxo_sum), std::move(kernel_sum), total_mw_supply);
+    }
+};
+
+END_NAMESPACE
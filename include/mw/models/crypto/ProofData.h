@@ -10,12 +10,16 @@ struct ProofData
     RangeProof::CPtr pRangeProof;
     std::vector<uint8_t> extraData;
 
+    // The other commitments an aggregated proof is over, in the order they were proven. Empty for single proofs.
+    std::vector<Commitment> aggregated_commits;
+
     inline bool operator==(const ProofData& rhs) const noexcept
     {
         assert(rhs.pRangeProof != nullptr);
 
         return commitment == rhs.commitment
             && *pRangeProof == *rhs.pRangeProof
-            && extraData == rhs.extraData;
+            && extraData == rhs.extraData
+            && aggregated_commits == rhs.aggregated_commits;
     }
 };
\ No newline at end of file
@@ -19,7 +19,23 @@ class RangeProof :
 {
 public:
     using CPtr = std::shared_ptr<const RangeProof>;
-    static constexpr size_t const& MAX_SIZE = 675;
+    // The most commitments a single (aggregated) proof can be over.
+    // Proofs must be over a power of 2 commitments.
+    static constexpr size_t MAX_COMMITS = 8;
+
+    // Size of a proof over MAX_COMMITS commitments.
+    static constexpr size_t MAX_SIZE = 867;
+
+    static constexpr bool IsValidNumCommits(const size_t num_commits)
+    {
+        return num_commits > 0 && num_commits <= MAX_COMMITS && (num_commits & (num_commits - 1)) == 0;
+    }
+
+    // Size of a 64-bit proof over num_commits commitments. Each doubling of the commitments adds 64 bytes.
+    static constexpr size_t SizeFor(const size_t num_commits)
+    {
+        return num_commits <= 1 ? 675 : SizeFor(num_commits / 2) + 64;
+    }
 
     //
     // Constructors
@@ -77,6 +93,6 @@ public:
     std::string Format() const final { return HexUtil::ToHex(m_bytes); }
 
 private:
-    // The proof itself, at most 675 bytes long.
+    // The proof itself, at most MAX_SIZE bytes long.
     std::vector<uint8_t> m_bytes;
 };
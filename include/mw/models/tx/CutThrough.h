@@ -0,0 +1,93 @@
+#pragma once
+
+#include <mw/models/crypto/SignedMessage.h>
+#include <mw/models/tx/Input.h>
+#include <mw/models/tx/Output.h>
+#include <mw/crypto/Hasher.h>
+#include <mw/traits/Hashable.h>
+#include <mw/traits/Serializable.h>
+
+////////////////////////////////////////
+// CUT THROUGH - What's left of an output that's spent in the same transaction or block that creates it.
+//
+// The commitments of the output and input cancel out, so both are removed along with the range proof.
+// The input's pubkey and the output's sender pubkey are part of the owner sum though,
+// so the signatures proving knowledge of their keys are kept.
+////////////////////////////////////////
+class CutThrough :
+    public Traits::IHashable,
+    public Traits::ISerializable
+{
+public:
+    //
+    // Constructors
+    //
+    CutThrough(PublicKey&& input_pubkey, Signature&& input_signature, SignedMessage&& output_sig)
+        : m_inputPubKey(std::move(input_pubkey)), m_inputSignature(std::move(input_signature)), m_outputSig(std::move(output_sig))
+    {
+        m_hash = Hashed(Serialized());
+    }
+    CutThrough(const CutThrough& cut_through) = default;
+    CutThrough(CutThrough&& cut_through) noexcept = default;
+    CutThrough() = default;
+
+    static CutThrough From(const Input& input, const Output& output)
+    {
+        return CutThrough(PublicKey(input.GetPubKey()), Signature(input.GetSignature()), output.BuildSignedMsg());
+    }
+
+    //
+    // Destructor
+    //
+    virtual ~CutThrough() = default;
+
+    //
+    // Operators
+    //
+    CutThrough& operator=(const CutThrough& cut_through) = default;
+    CutThrough& operator=(CutThrough&& cut_through) noexcept = default;
+    bool operator==(const CutThrough& cut_through) const noexcept { return m_hash == cut_through.m_hash; }
+
+    //
+    // Getters
+    //
+    const PublicKey& GetInputPubKey() const noexcept { return m_inputPubKey; }
+    const PublicKey& GetSenderPubKey() const noexcept { return m_outputSig.GetPublicKey(); }
+
+    SignedMessage GetInputSig() const noexcept { return SignedMessage{ InputMessage(), m_inputPubKey, m_inputSignature }; }
+    const SignedMessage& GetOutputSig() const noexcept { return m_outputSig; }
+
+    //
+    // Serialization/Deserialization
+    //
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append(m_inputPubKey)
+            .Append(m_inputSignature)
+            .Append(m_outputSig);
+    }
+
+    static CutThrough Deserialize(Deserializer& deserializer)
+    {
+        PublicKey input_pubkey = PublicKey::Deserialize(deserializer);
+        Signature input_signature = Signature::Deserialize(deserializer);
+        SignedMessage output_sig = SignedMessage::Deserialize(deserializer);
+        return CutThrough(std::move(input_pubkey), std::move(input_signature), std::move(output_sig));
+    }
+
+    //
+    // Traits
+    //
+    mw::Hash GetHash() const noexcept final { return m_hash; }
+
+private:
+    // The input's pubkey and its signature of InputMessage().
+    PublicKey m_inputPubKey;
+    Signature m_inputSignature;
+
+    // The output's sender pubkey and its signature of the output data.
+    SignedMessage m_outputSig;
+
+    mw::Hash m_hash;
+};
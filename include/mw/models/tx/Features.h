@@ -16,7 +16,12 @@ enum EOutputFeatures : uint8_t
     DEFAULT_OUTPUT = 0,
 
     // Output is a pegged-in output, must not be spent until maturity
-    PEGGED_IN = 1
+    PEGGED_IN = 1,
+
+    // Output's range proof is aggregated with those of other outputs in the same transaction.
+    // The first output of the group carries the proof and the other commitments it's over,
+    // while the rest carry an empty proof.
+    AGGREGATED_PROOF = 2
 };
 
 class Features
@@ -46,6 +51,8 @@ namespace OutputFeatures
                 return "Plain";
             case PEGGED_IN:
                 return "PeggedIn";
+            case AGGREGATED_PROOF:
+                return "AggregatedProof";
         }
 
         return "";
@@ -61,6 +68,10 @@ namespace OutputFeatures
         {
             return EOutputFeatures::PEGGED_IN;
         }
+        else if (string == "AggregatedProof")
+        {
+            return EOutputFeatures::AGGREGATED_PROOF;
+        }
 
         ThrowDeserialization_F("Failed to deserialize output feature: {}", string);
     }
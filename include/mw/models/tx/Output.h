@@ -39,7 +39,8 @@ public:
         BigInt<16>&& masked_nonce,
         PublicKey&& sender_pubkey,
         Signature&& signature,
-        const RangeProof::CPtr& pProof
+        const RangeProof::CPtr& pProof,
+        std::vector<Commitment>&& aggregated_commits = {}
     );
     Output(const Output& Output) = default;
     Output(Output&& Output) noexcept = default;
@@ -56,6 +57,18 @@ public:
         const uint64_t value
     );
 
+    //
+    // Creates one output per recipient, with a single range proof over all of them carried by the first output.
+    // The number of recipients must be a power of 2, no more than RangeProof::MAX_COMMITS.
+    // blinds_out and sender_privkeys are in recipient order.
+    //
+    static std::vector<Output> CreateAggregated(
+        std::vector<BlindingFactor>& blinds_out,
+        const Features& features,
+        const std::vector<SecretKey>& sender_privkeys,
+        const std::vector<std::pair<uint64_t, StealthAddress>>& recipients
+    );
+
     //
     // Destructor
     //
@@ -74,6 +87,7 @@ public:
     //
     const Commitment& GetCommitment() const noexcept final { return m_commitment; }
     const RangeProof::CPtr& GetRangeProof() const noexcept { return m_pProof; }
+    const std::vector<Commitment>& GetAggregatedCommits() const noexcept { return m_aggregatedCommits; }
 
     Features GetFeatures() const noexcept { return m_features; }
     const PublicKey& GetReceiverPubKey() const noexcept { return m_receiverPubKey; }
@@ -91,6 +105,10 @@ public:
     ProofData BuildProofData() const noexcept;
 
     bool IsPeggedIn() const noexcept { return GetFeatures().IsSet(EOutputFeatures::PEGGED_IN); }
+    bool HasAggregatedProof() const noexcept { return GetFeatures().IsSet(EOutputFeatures::AGGREGATED_PROOF); }
+
+    // False for outputs whose range is proven by the aggregated proof of another output.
+    bool HasRangeProof() const noexcept { return !HasAggregatedProof() || !m_aggregatedCommits.empty(); }
 
     OutputId ToOutputId() const noexcept {
         return OutputId(
@@ -112,6 +130,18 @@ public:
     static Output Deserialize(Deserializer& deserializer);
 
 private:
+    // Builds everything but the range proof, which commits to the rest of the output.
+    static Output CreateUnproven(
+        BlindingFactor& blind_out,
+        const Features& features,
+        const SecretKey& sender_privkey,
+        const StealthAddress& receiver_addr,
+        const uint64_t value
+    );
+
+    Output WithProof(const RangeProof::CPtr& pProof, std::vector<Commitment>&& aggregated_commits) const;
+    std::vector<uint8_t> BuildProofMessage() const;
+
     // The homomorphic commitment representing the output amount
     Commitment m_commitment;
 
@@ -127,5 +157,8 @@ private:
     // A proof that the commitment is in the right range
     RangeProof::CPtr m_pProof;
 
+    // With an aggregated proof, the other commitments m_pProof is over, in the order they were proven.
+    std::vector<Commitment> m_aggregatedCommits;
+
     mw::Hash m_hash;
 };
\ No newline at end of file
@@ -134,6 +134,13 @@ public:
     mw::Hash GetHash() const noexcept final { return m_hash; }
 
     void Validate() const;
+
+    //
+    // Runs the checks in Validate() other than the signatures and range proofs,
+    // for callers that verify those in batches with other transactions.
+    //
+    void ValidateStructureAndSums() const;
+
     std::string Print() const noexcept;
 
 private:
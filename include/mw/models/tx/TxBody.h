@@ -8,6 +8,7 @@
 #include <mw/traits/Serializable.h>
 #include <mw/models/crypto/BigInteger.h>
 #include <mw/models/crypto/SignedMessage.h>
+#include <mw/models/tx/CutThrough.h>
 #include <mw/models/tx/Input.h>
 #include <mw/models/tx/Output.h>
 #include <mw/models/tx/Kernel.h>
@@ -30,10 +31,24 @@ public:
     //
     // Constructors
     //
-    TxBody(std::vector<Input>&& inputs, std::vector<Output>&& outputs, std::vector<Kernel>&& kernels, std::vector<SignedMessage>&& ownerSigs)
-        : m_inputs(std::move(inputs)), m_outputs(std::move(outputs)), m_kernels(std::move(kernels)), m_ownerSigs(std::move(ownerSigs)) { }
-    TxBody(const std::vector<Input>& inputs, const std::vector<Output>& outputs, const std::vector<Kernel>& kernels, const std::vector<SignedMessage>& ownerSigs)
-        : m_inputs(inputs), m_outputs(outputs), m_kernels(kernels), m_ownerSigs(ownerSigs) { }
+    TxBody(
+        std::vector<Input>&& inputs,
+        std::vector<Output>&& outputs,
+        std::vector<Kernel>&& kernels,
+        std::vector<SignedMessage>&& ownerSigs,
+        std::vector<CutThrough>&& cutThroughs = {})
+        : m_inputs(std::move(inputs)),
+        m_outputs(std::move(outputs)),
+        m_kernels(std::move(kernels)),
+        m_ownerSigs(std::move(ownerSigs)),
+        m_cutThroughs(std::move(cutThroughs)) { }
+    TxBody(
+        const std::vector<Input>& inputs,
+        const std::vector<Output>& outputs,
+        const std::vector<Kernel>& kernels,
+        const std::vector<SignedMessage>& ownerSigs,
+        const std::vector<CutThrough>& cutThroughs = {})
+        : m_inputs(inputs), m_outputs(outputs), m_kernels(kernels), m_ownerSigs(ownerSigs), m_cutThroughs(cutThroughs) { }
     TxBody(const TxBody& other) = default;
     TxBody(TxBody&& other) noexcept = default;
     TxBody() = default;
@@ -55,7 +70,8 @@ public:
             m_inputs == rhs.m_inputs &&
             m_outputs == rhs.m_outputs &&
             m_kernels == rhs.m_kernels &&
-            m_ownerSigs == rhs.m_ownerSigs;
+            m_ownerSigs == rhs.m_ownerSigs &&
+            m_cutThroughs == rhs.m_cutThroughs;
     }
 
     //
@@ -65,6 +81,7 @@ public:
     const std::vector<Output>& GetOutputs() const noexcept { return m_outputs; }
     const std::vector<Kernel>& GetKernels() const noexcept { return m_kernels; }
     const std::vector<SignedMessage>& GetOwnerSigs() const noexcept { return m_ownerSigs; }
+    const std::vector<CutThrough>& GetCutThroughs() const noexcept { return m_cutThroughs; }
 
     std::vector<Commitment> GetKernelCommits() const noexcept { return Commitments::From(m_kernels); }
     std::vector<Commitment> GetInputCommits() const noexcept { return Commitments::From(m_inputs); }
@@ -78,15 +95,48 @@ public:
     int64_t GetSupplyChange() const noexcept;
     uint64_t GetLockHeight() const noexcept;
 
+    //
+    // The hash of the cut-throughs, which a block's header commits to.
+    //
+    mw::Hash GetCutThroughHash() const noexcept;
+
     //
     // Serialization/Deserialization
+    // The cut-throughs aren't part of this, so transactions are relayed without them.
+    // Blocks past the cut-through height serialize them after the body, as an explicit field their header commits to.
     //
     Serializer& Serialize(Serializer& serializer) const noexcept final;
     static TxBody Deserialize(Deserializer& deserializer);
 
+    Serializer& SerializeCutThroughs(Serializer& serializer) const noexcept;
+    static TxBody DeserializeWithCutThroughs(Deserializer& deserializer);
+
+    //
+    // Runs every check below, in order.
+    //
     void Validate() const;
 
+    //
+    // Checks the weight, extra data sizes, sorting, duplicates, that each output without a range proof
+    // is covered by another output's aggregated proof, and that each owner sig has a kernel.
+    // These are cheap compared to the signatures and range proofs, so they're run first.
+    //
+    void ValidateStructure() const;
+
+    //
+    // Returns every kernel, input, output, owner and cut-through signature in the body, for batch verification.
+    //
+    std::vector<SignedMessage> BuildSignedMessages() const;
+
+    //
+    // Returns the range proof data for every output that carries a proof, for batch verification.
+    // Aggregated proofs cover the outputs that don't carry one.
+    //
+    std::vector<ProofData> BuildProofData() const;
+
 private:
+    void ValidateAggregatedProofs() const;
+
     // List of inputs spent by the transaction.
     std::vector<Input> m_inputs;
 
@@ -98,4 +148,7 @@ private:
 
     // The owner offset can be split into a raw private key diff & a pubkey/sig version.
     std::vector<SignedMessage> m_ownerSigs;
+
+    // Signatures of outputs that were spent in the same body, and of the inputs that spent them.
+    std::vector<CutThrough> m_cutThroughs;
 };
\ No newline at end of file
@@ -1,38 +1,62 @@
 #pragma once
 
 #include <mw/common/Macros.h>
+#include <mw/exceptions/DeserializationException.h>
 #include <mw/models/tx/Output.h>
 #include <mw/mmr/LeafIndex.h>
 #include <mw/traits/Serializable.h>
 #include <mw/serialization/Serializer.h>
 
+#include <cassert>
+#include <memory>
+
 class UTXO : public Traits::ISerializable
 {
 public:
     using CPtr = std::shared_ptr<const UTXO>;
 
     UTXO() : m_blockHeight(0), m_leafIdx(), m_output() { }
-    UTXO(const uint64_t blockHeight, mmr::LeafIndex&& leafIdx, Output&& output)
-        : m_blockHeight(blockHeight), m_leafIdx(std::move(leafIdx)), m_output(std::move(output)) { }
-    UTXO(const uint64_t blockHeight, mmr::LeafIndex&& leafIdx, const Output& output)
-        : m_blockHeight(blockHeight), m_leafIdx(std::move(leafIdx)), m_output(output) { }
+    UTXO(const uint64_t blockHeight, mmr::LeafIndex&& leafIdx, Output&& output, std::shared_ptr<const Output> pProofOutput = nullptr)
+        : m_blockHeight(blockHeight), m_leafIdx(std::move(leafIdx)), m_output(std::move(output)), m_pProofOutput(std::move(pProofOutput))
+    {
+        assert(m_output.HasRangeProof() == (m_pProofOutput == nullptr));
+    }
+    UTXO(const uint64_t blockHeight, mmr::LeafIndex&& leafIdx, const Output& output, std::shared_ptr<const Output> pProofOutput = nullptr)
+        : m_blockHeight(blockHeight), m_leafIdx(std::move(leafIdx)), m_output(output), m_pProofOutput(std::move(pProofOutput))
+    {
+        assert(m_output.HasRangeProof() == (m_pProofOutput == nullptr));
+    }
 
     uint64_t GetBlockHeight() const noexcept { return m_blockHeight; }
     const mmr::LeafIndex GetLeafIndex() const noexcept { return m_leafIdx; }
     const Output& GetOutput() const noexcept { return m_output; }
     OutputId ToOutputId() const noexcept { return m_output.ToOutputId(); }
 
+    //
+    // The output carrying the aggregated proof that covers this one, kept with it so the proof outlives the output being spent.
+    // nullptr unless the output has no range proof of its own.
+    //
+    const std::shared_ptr<const Output>& GetProofOutput() const noexcept { return m_pProofOutput; }
+
     const Commitment& GetCommitment() const noexcept { return m_output.GetCommitment(); }
     RangeProof::CPtr GetRangeProof() const noexcept { return m_output.GetRangeProof(); }
-    ProofData BuildProofData() const noexcept { return m_output.BuildProofData(); }
     bool IsPeggedIn() const noexcept { return m_output.IsPeggedIn(); }
 
+    // The data of the proof that covers the output, which is another output's aggregated proof if it has none of its own.
+    ProofData BuildProofData() const noexcept { return m_pProofOutput != nullptr ? m_pProofOutput->BuildProofData() : m_output.BuildProofData(); }
+
     Serializer& Serialize(Serializer& serializer) const noexcept
     {
-        return serializer
+        serializer
             .Append<uint64_t>(m_blockHeight)
             .Append<uint64_t>(m_leafIdx.GetLeafIndex())
             .Append(m_output);
+
+        if (m_pProofOutput != nullptr) {
+            serializer.Append(*m_pProofOutput);
+        }
+
+        return serializer;
     }
 
     static UTXO Deserialize(Deserializer& deserializer)
@@ -40,11 +64,21 @@ public:
         const uint64_t blockHeight = deserializer.Read<uint64_t>();
         const uint64_t leafIdx = deserializer.Read<uint64_t>();
         Output output = Output::Deserialize(deserializer);
-        return UTXO(blockHeight, mmr::LeafIndex::At(leafIdx), std::move(output));
+
+        std::shared_ptr<const Output> pProofOutput = nullptr;
+        if (!output.HasRangeProof()) {
+            pProofOutput = std::make_shared<const Output>(Output::Deserialize(deserializer));
+            if (!pProofOutput->HasAggregatedProof() || !pProofOutput->HasRangeProof()) {
+                ThrowDeserialization("UTXO's proof output doesn't carry an aggregated proof");
+            }
+        }
+
+        return UTXO(blockHeight, mmr::LeafIndex::At(leafIdx), std::move(output), std::move(pProofOutput));
     }
 
 private:
     uint64_t m_blockHeight;
     mmr::LeafIndex m_leafIdx;
     Output m_output;
+    std::shared_ptr<const Output> m_pProofOutput;
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <mw/common/Macros.h>
+#include <mw/models/crypto/Hash.h>
+#include <mw/traits/Serializable.h>
+#include <mw/serialization/Serializer.h>
+#include <libmw/defs.h>
+
+#include <cstdint>
+
+MW_NAMESPACE
+
+//
+// The last block the wallet scanned.
+//
+struct ScanCursor : public Traits::ISerializable
+{
+    ScanCursor() : height(0), block_hash() { }
+    ScanCursor(const uint64_t height_in, mw::Hash block_hash_in)
+        : height(height_in), block_hash(std::move(block_hash_in)) { }
+
+    uint64_t height;
+    mw::Hash block_hash;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint64_t>(height)
+            .Append(block_hash);
+    }
+
+    static ScanCursor Deserialize(Deserializer& deserializer)
+    {
+        uint64_t height = deserializer.Read<uint64_t>();
+        mw::Hash block_hash = deserializer.Read<mw::Hash>();
+        return ScanCursor(height, std::move(block_hash));
+    }
+};
+
+//
+// An unspent coin that belongs to the wallet, along with the height of the block it was found in.
+//
+struct WalletCoin : public Traits::ISerializable
+{
+    WalletCoin() : coin(), height(0) { }
+    WalletCoin(libmw::Coin coin_in, const uint64_t height_in)
+        : coin(std::move(coin_in)), height(height_in) { }
+
+    libmw::Coin coin;
+    uint64_t height;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        serializer
+            .Append<uint8_t>(coin.features)
+            .Append<uint32_t>(coin.address_index)
+            .Append<bool>(!!coin.key);
+        if (coin.key) {
+            serializer.Append(*coin.key);
+        }
+
+        serializer.Append<bool>(!!coin.blind);
+        if (coin.blind) {
+            serializer.Append(*coin.blind);
+        }
+
+        return serializer
+            .Append<uint64_t>(coin.amount)
+            .Append(coin.commitment)
+            .Append<uint64_t>(height);
+    }
+
+    static WalletCoin Deserialize(Deserializer& deserializer)
+    {
+        libmw::Coin coin;
+        coin.features = deserializer.Read<uint8_t>();
+        coin.address_index = deserializer.Read<uint32_t>();
+        if (deserializer.Read<bool>()) {
+            coin.key = deserializer.ReadArray<32>();
+        }
+
+        if (deserializer.Read<bool>()) {
+            coin.blind = deserializer.ReadArray<32>();
+        }
+
+        coin.amount = deserializer.Read<uint64_t>();
+        coin.commitment = deserializer.ReadArray<33>();
+        uint64_t height = deserializer.Read<uint64_t>();
+        return WalletCoin(std::move(coin), height);
+    }
+};
+
+END_NAMESPACE
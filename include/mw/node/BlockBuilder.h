@@ -4,27 +4,121 @@
 #include <mw/models/tx/Transaction.h>
 #include <mw/models/tx/PegInCoin.h>
 #include <mw/node/CoinsView.h>
+#include <libmw/defs.h>
 #include <memory>
+#include <set>
+#include <unordered_map>
 
 MW_NAMESPACE
 
+//
+// Assembles a block template one transaction at a time.
+// The inputs, outputs, kernels and owner sigs of every added transaction are merged into
+// sorted vectors as they're added, and the offsets are summed as they go,
+// so adding, removing and building don't need to re-aggregate the whole block.
+//
+// Transactions can either be added directly, in the order the caller chooses,
+// or offered as candidates, which are included in order of fee per unit of weight.
+//
+// With cut-through enabled, transactions can spend outputs of transactions already in the block,
+// and those outputs are cut through when the block is built. It's only enabled once ChainParams activates
+// cut-through at the block's height, since older blocks have no cut-through field.
+//
 class BlockBuilder
 {
 public:
     using Ptr = std::shared_ptr<BlockBuilder>;
 
-    BlockBuilder(const uint64_t height, const mw::ICoinsView::Ptr& pCoinsView)
-        : m_height(height), m_weight(0), m_pCoinsView(std::make_shared<mw::CoinsViewCache>(pCoinsView)), m_pAggregated(nullptr){ }
+    BlockBuilder(
+        const uint64_t height,
+        const mw::ICoinsView::Ptr& pCoinsView,
+        const uint64_t max_weight = libmw::MAX_BLOCK_WEIGHT,
+        const bool cut_through = false
+    );
 
     bool AddTransaction(const Transaction::CPtr& pTransaction, const std::vector<PegInCoin>& pegins);
 
+    //
+    // Adds a transaction to the pool of candidates that the block is filled from.
+    // The candidates with the highest fee per unit of weight are included as long as they fit.
+    // When the block is full, a new candidate replaces included candidates with a lower fee rate
+    // if that increases the total fees of the block.
+    //
+    // Returns false if the candidate can't be included in this block, i.e. it spends an immature peg-in,
+    // or an output that isn't on chain. Without cut-through, a block can't spend its own outputs,
+    // so that includes outputs of other candidates. With cut-through, outputs of transactions already in the block can be spent.
+    //
+    bool AddCandidate(const Transaction::CPtr& pTransaction, const std::vector<PegInCoin>& pegins);
+
+    //
+    // Removes a previously added transaction or candidate (e.g. one that was evicted from the mempool),
+    // along with any transactions in the block that spend its outputs,
+    // and fills the freed weight with the best remaining candidates.
+    // Returns false if the transaction isn't in the block or the candidate pool.
+    //
+    bool RemoveTransaction(const mw::Hash& tx_hash);
+
+    uint64_t GetWeight() const noexcept { return m_weight; }
+    const std::vector<Transaction::CPtr>& GetTransactions() const noexcept { return m_transactions; }
+
     mw::Block::Ptr BuildBlock() const;
 
 private:
+    struct Candidate
+    {
+        Transaction::CPtr pTransaction;
+        std::vector<PegInCoin> pegins;
+        uint64_t fee;
+        uint64_t weight;
+    };
+
+    // Orders candidates by fee per unit of weight, highest first.
+    struct FeeRateOrder
+    {
+        bool operator()(const Candidate* pLhs, const Candidate* pRhs) const noexcept;
+    };
+
+    using CandidateQueue = std::set<const Candidate*, FeeRateOrder>;
+
+    // Returns false if the output isn't on chain (or in the block, with cut-through),
+    // or is a peg-in that can't be spent until a later block.
+    bool IsSpendable(const Commitment& commitment) const;
+
+    // Returns true if another transaction in the block spends one of the transaction's outputs.
+    bool HasDependents(const Transaction& transaction) const;
+
+    std::vector<Transaction::CPtr>::iterator FindTransaction(const mw::Hash& tx_hash);
+    void RemoveFromBlock(const mw::Hash& tx_hash);
+
+    //
+    // Walks the queued candidates from highest to lowest fee rate, adding each one that fits,
+    // or that fits after removing selected candidates whose fees add up to less than its own.
+    //
+    void SelectCandidates();
+
     uint64_t m_height;
+    uint64_t m_maxWeight;
+    bool m_cutThrough;
     uint64_t m_weight;
-    mw::CoinsViewCache::Ptr m_pCoinsView;
-    Transaction::CPtr m_pAggregated;
+    mw::ICoinsView::Ptr m_pCoinsView;
+
+    // Candidates are kept in one of two indexed priority queues: the ones waiting for room in the block,
+    // and the ones that are in the block (so the lowest fee rates can be evicted first).
+    std::unordered_map<mw::Hash, Candidate> m_candidates;
+    CandidateQueue m_queued;
+    CandidateQueue m_selected;
+
+    // The added transactions, in the order they were added.
+    std::vector<Transaction::CPtr> m_transactions;
+
+    // The contents of every added transaction, in the order they'll appear in the block.
+    std::vector<Input> m_inputs;
+    std::vector<Output> m_outputs;
+    std::vector<Kernel> m_kernels;
+    std::vector<SignedMessage> m_ownerSigs;
+    std::vector<CutThrough> m_cutThroughs;
+    BlindingFactor m_kernelOffset;
+    BlindingFactor m_ownerOffset;
 };
 
-END_NAMESPACE // mw
\ No newline at end of file
+END_NAMESPACE // mw
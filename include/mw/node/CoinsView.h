@@ -4,12 +4,17 @@
 #include <mw/models/block/Header.h>
 #include <mw/models/block/Block.h>
 #include <mw/models/block/BlockUndo.h>
+#include <mw/models/block/StateSums.h>
 #include <mw/models/tx/Transaction.h>
 #include <mw/models/tx/UTXO.h>
 #include <mw/mmr/MMR.h>
 #include <mw/mmr/LeafSet.h>
+#include <mw/mmr/MMRInfo.h>
+#include <mw/node/CompactionScheduler.h>
+#include <mw/node/LeafPruner.h>
 #include <libmw/interfaces/db_interface.h>
 #include <memory>
+#include <unordered_map>
 
 // Forward Declarations
 class CoinDB;
@@ -92,12 +97,22 @@ public:
     void SetBestHeader(const mw::Header::CPtr& pHeader) noexcept { m_pHeader = pHeader; }
     mw::Header::CPtr GetBestHeader() const noexcept { return m_pHeader; }
 
+    // Sums of the UTXOs and kernels as of the best header, or none if they haven't been calculated.
+    void SetStateSums(const boost::optional<mw::StateSums>& sums) noexcept { m_sums = sums; }
+    const boost::optional<mw::StateSums>& GetStateSums() const noexcept { return m_sums; }
+
     const std::shared_ptr<libmw::IDBWrapper>& GetDatabase() const noexcept { return m_pDatabase; }
 
     virtual bool IsCache() const noexcept = 0;
 
     // Virtual functions
     virtual std::vector<UTXO::CPtr> GetUTXOs(const Commitment& commitment) const = 0;
+
+    // GetUTXOs for many commitments, e.g. every input of a transaction.
+    // Commitments without any UTXOs are left out of the result.
+    // The DB view still reads each commitment on its own, since IDBWrapper has no multi-key read.
+    virtual std::unordered_map<Commitment, std::vector<UTXO::CPtr>> LookupUTXOs(const std::vector<Commitment>& commitments) const = 0;
+
     virtual void WriteBatch(
         const libmw::IDBBatch::UPtr& pBatch,
         const CoinsViewUpdates& updates,
@@ -107,12 +122,17 @@ public:
     virtual mmr::ILeafSet::Ptr GetLeafSet() const noexcept = 0;
     virtual mmr::IMMR::Ptr GetKernelMMR() const noexcept = 0;
     virtual mmr::IMMR::Ptr GetOutputPMMR() const noexcept = 0;
+
+    // Called once a flush has written the MMR files with index mmr_info.index, before mmr_info is saved.
+    // Views backed by the database use this to compact the output PMMR and prune spent leaves.
+    virtual void OnFlushed(MMRInfo& mmr_info, const libmw::IDBBatch::UPtr& pBatch) { }
     
 protected:
     void ValidateMMRs(const mw::Header::CPtr& pHeader) const;
 
 private:
     mw::Header::CPtr m_pHeader;
+    boost::optional<mw::StateSums> m_sums;
     std::shared_ptr<libmw::IDBWrapper> m_pDatabase;
 };
 
@@ -128,11 +148,15 @@ public:
         m_pLeafSet(std::make_unique<mmr::LeafSetCache>(pBase->GetLeafSet())),
         m_pKernelMMR(std::make_unique<mmr::MMRCache>(pBase->GetKernelMMR())),
         m_pOutputPMMR(std::make_unique<mmr::MMRCache>(pBase->GetOutputPMMR())),
-        m_pUpdates(std::make_shared<CoinsViewUpdates>()) { }
+        m_pUpdates(std::make_shared<CoinsViewUpdates>())
+    {
+        SetStateSums(pBase->GetStateSums());
+    }
 
     bool IsCache() const noexcept final { return true; }
 
     std::vector<UTXO::CPtr> GetUTXOs(const Commitment& commitment) const noexcept final;
+    std::unordered_map<Commitment, std::vector<UTXO::CPtr>> LookupUTXOs(const std::vector<Commitment>& commitments) const final;
     mw::BlockUndo::CPtr ApplyBlock(const mw::Block::Ptr& pBlock);
     void UndoBlock(const mw::BlockUndo::CPtr& pUndo);
     void WriteBatch(
@@ -143,6 +167,9 @@ public:
     void Flush(const libmw::IDBBatch::UPtr& pBatch = nullptr);
     mw::Block::Ptr BuildNextBlock(const uint64_t height, const std::vector<mw::Transaction::CPtr>& transactions);
 
+    //
+    // Reads and sums every UTXO and kernel, and checks them against the best header.
+    //
     void ValidateState() const;
 
     bool HasCoinInCache(const Commitment& commitment) const noexcept;
@@ -152,7 +179,8 @@ public:
     mmr::IMMR::Ptr GetOutputPMMR() const noexcept final { return m_pOutputPMMR; }
 
 private:
-    void AddUTXO(const uint64_t header_height, const Output& output);
+    void ApplyUpdates(const Commitment& commitment, std::vector<UTXO::CPtr>& utxos) const;
+    void AddUTXOs(const uint64_t header_height, const std::vector<Output>& outputs);
     UTXO SpendUTXO(const Commitment& commitment);
 
     ICoinsView::Ptr m_pBase;
@@ -172,15 +200,20 @@ public:
         const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
         const mmr::LeafSet::Ptr& pLeafSet,
         const mmr::MMR::Ptr& pKernelMMR,
-        const mmr::MMR::Ptr& pOutputPMMR
+        const mmr::MMR::Ptr& pOutputPMMR,
+        const CompactionScheduler::Ptr& pCompactionScheduler = nullptr,
+        const LeafPruner::Ptr& pLeafPruner = nullptr
     ) : ICoinsView(pBestHeader, pDBWrapper),
         m_pLeafSet(pLeafSet),
         m_pKernelMMR(pKernelMMR),
-        m_pOutputPMMR(pOutputPMMR) { }
+        m_pOutputPMMR(pOutputPMMR),
+        m_pCompactionScheduler(pCompactionScheduler),
+        m_pLeafPruner(pLeafPruner) { }
 
     bool IsCache() const noexcept final { return false; }
 
     std::vector<UTXO::CPtr> GetUTXOs(const Commitment& commitment) const final;
+    std::unordered_map<Commitment, std::vector<UTXO::CPtr>> LookupUTXOs(const std::vector<Commitment>& commitments) const final;
     void WriteBatch(
         const libmw::IDBBatch::UPtr& pBatch,
         const CoinsViewUpdates& updates,
@@ -191,6 +224,10 @@ public:
     mmr::IMMR::Ptr GetKernelMMR() const noexcept final { return m_pKernelMMR; }
     mmr::IMMR::Ptr GetOutputPMMR() const noexcept final { return m_pOutputPMMR; }
 
+    void OnFlushed(MMRInfo& mmr_info, const libmw::IDBBatch::UPtr& pBatch) final;
+
+    const CompactionScheduler::Ptr& GetCompactionScheduler() const noexcept { return m_pCompactionScheduler; }
+
 private:
     void AddUTXO(CoinDB& coinDB, const Output& output);
     void AddUTXO(CoinDB& coinDB, const UTXO::CPtr& pUTXO);
@@ -200,6 +237,8 @@ private:
     mmr::LeafSet::Ptr m_pLeafSet;
     mmr::MMR::Ptr m_pKernelMMR;
     mmr::MMR::Ptr m_pOutputPMMR;
+    CompactionScheduler::Ptr m_pCompactionScheduler;
+    LeafPruner::Ptr m_pLeafPruner;
 };
 
 END_NAMESPACE
\ No newline at end of file
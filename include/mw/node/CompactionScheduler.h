@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mw/common/Macros.h>
+#include <mw/common/BitSet.h>
+#include <mw/file/FilePath.h>
+#include <mw/models/block/Header.h>
+#include <mw/mmr/MMR.h>
+#include <mw/mmr/MMRInfo.h>
+#include <libmw/interfaces/db_interface.h>
+#include <boost/optional.hpp>
+#include <deque>
+#include <future>
+#include <memory>
+
+MW_NAMESPACE
+
+//
+// Compacts spent outputs out of the output PMMR once they are buried deeper than the horizon.
+//
+// Every flush to the database is recorded along with the index of the leafset file it wrote.
+// Once a recorded flush falls behind the horizon, its compact bitset is calculated on the
+// shared ThreadPool from that (immutable) leafset file. The next flush stages the compaction,
+// streaming the surviving hashes into a temp file, and the flush after that commits it as its
+// own hash file and PruneList. Only files that no committed MMRInfo refers to yet are written,
+// so a batch that never commits leaves the last committed MMR intact.
+//
+// The recorded flushes are the saved MMRInfos, so they're restored by Load() after a restart.
+//
+class CompactionScheduler
+{
+public:
+    using Ptr = std::shared_ptr<CompactionScheduler>;
+
+    //
+    // Don't compact more often than this, since every compaction rewrites the whole hash file.
+    //
+    static constexpr uint32_t DEFAULT_INTERVAL = 100;
+
+    CompactionScheduler(const FilePath& datadir, const uint32_t horizon, const uint32_t interval = DEFAULT_INTERVAL)
+        : m_datadir(datadir), m_horizon(horizon), m_interval(interval) { }
+
+    //
+    // Restores the recorded flushes from the MMRInfos saved in the database.
+    //
+    void Load(libmw::IDBWrapper* pDBWrapper);
+
+    //
+    // Called after the MMR files with index mmr_info.index have been written for pHeader.
+    // Updates mmr_info if those files include the compaction staged by the previous flush,
+    // then stages the calculated compaction, if one is ready.
+    // Returns the number of bytes removed from the output PMMR's hash file by this flush.
+    //
+    uint64_t OnFlush(const mw::Header::CPtr& pHeader, mmr::MMR& output_pmmr, MMRInfo& mmr_info);
+
+    //
+    // Blocks until the compaction currently being calculated (if any) is ready to be applied.
+    //
+    void Wait() const;
+
+    //
+    // The index of the MMR files written by the most recent flush that's beyond the horizon.
+    //
+    boost::optional<uint32_t> GetHorizonIndex() const noexcept
+    {
+        return m_horizonCheckpoint ? boost::make_optional(m_horizonCheckpoint->file_index) : boost::none;
+    }
+
+private:
+    struct Checkpoint
+    {
+        uint64_t height;
+        mw::Hash header_hash;
+        uint32_t file_index;
+    };
+
+    struct Pending
+    {
+        Checkpoint checkpoint;
+        std::shared_future<BitSet> compacted;
+    };
+
+    struct Staged
+    {
+        Checkpoint checkpoint;
+        uint32_t compact_index;
+        uint64_t num_removed;
+    };
+
+    void UpdateHorizon(const uint64_t tip_height);
+    uint64_t ApplyStaged(MMRInfo& mmr_info);
+    void StagePending(mmr::MMR& output_pmmr, const MMRInfo& mmr_info);
+    void SchedulePending();
+
+    FilePath m_datadir;
+    uint32_t m_horizon;
+    uint32_t m_interval;
+
+    std::deque<Checkpoint> m_checkpoints;
+    boost::optional<Pending> m_pending;
+    boost::optional<Staged> m_staged;
+    boost::optional<Checkpoint> m_horizonCheckpoint;
+    boost::optional<uint64_t> m_lastScheduledHeight;
+    boost::optional<uint64_t> m_lastCompactedHeight;
+};
+
+END_NAMESPACE
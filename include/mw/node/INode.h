@@ -3,6 +3,7 @@
 #include <mw/common/Macros.h>
 #include <mw/common/BitSet.h>
 #include <mw/node/CoinsView.h>
+#include <mw/node/StateChunk.h>
 #include <mw/models/block/Header.h>
 #include <mw/models/block/Block.h>
 #include <mw/models/block/BlockUndo.h>
@@ -13,6 +14,7 @@
 #include <libmw/interfaces/chain_interface.h>
 #include <libmw/interfaces/db_interface.h>
 #include <functional>
+#include <future>
 #include <vector>
 
 MW_NAMESPACE
@@ -36,6 +38,17 @@ public:
         const std::vector<PegOutCoin>& pegOutCoins
     ) const = 0;
 
+    //
+    // Same as ValidateBlock, but runs in the background so the caller can connect the previous block meanwhile.
+    // The returned future rethrows any ValidationException.
+    //
+    virtual std::future<void> ValidateBlockAsync(
+        const mw::Block::Ptr& pBlock,
+        const mw::Hash& mweb_hash,
+        const std::vector<PegInCoin>& pegInCoins,
+        const std::vector<PegOutCoin>& pegOutCoins
+    ) const = 0;
+
     //
     // Contextual validation of the block and application of the block to the supplied ICoinsView.
     // Consumer is required to call ValidateBlock first.
@@ -47,26 +60,31 @@ public:
         const ICoinsView::Ptr& pView
     ) = 0;
 
+    //
+    // Validates the state and replaces the existing state with it.
+    // Chunks are read, validated, and written one at a time, so the whole state is never held in memory.
+    //
     virtual mw::ICoinsView::Ptr ApplyState(
         const libmw::IDBWrapper::Ptr& pDBWrapper,
         const libmw::IChain::Ptr& pChain,
         const mw::Header::CPtr& pStateHeader,
-        const std::vector<UTXO::CPtr>& utxos,
-        const std::vector<Kernel>& kernels,
         const BitSet& leafset,
-        const std::vector<mw::Hash>& pruned_parent_hashes
+        const mw::StateChunkReader& read_chunk
     ) = 0;
 };
 
 //
 // Creates an instance of the node.
 // This will fail if an instance is already running.
+// Spent outputs buried deeper than prune_horizon blocks get compacted out of the output PMMR,
+// and their leaves are removed from the database.
 //
 INode::Ptr InitializeNode(
     const FilePath& datadir,
     const std::string& hrp,
     const mw::Header::CPtr& pBestHeader,
-    const libmw::IDBWrapper::Ptr& pDBWrapper
+    const libmw::IDBWrapper::Ptr& pDBWrapper,
+    const uint32_t prune_horizon = libmw::DEFAULT_PRUNE_HORIZON
 );
 
 END_NAMESPACE
\ No newline at end of file
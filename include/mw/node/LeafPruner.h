@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mw/common/Macros.h>
+#include <mw/common/BitSet.h>
+#include <mw/file/FilePath.h>
+#include <libmw/interfaces/db_interface.h>
+#include <boost/optional.hpp>
+#include <map>
+#include <memory>
+
+MW_NAMESPACE
+
+//
+// Removes the LeafDB entries of outputs that were spent beyond the horizon,
+// so the database grows with the UTXO set rather than with every output ever created.
+//
+// Each pass compares the leafset of a flush beyond the horizon against the leafset the previous pass
+// pruned up to, and removes the leaves spent in between. A pass is spread across flushes, scanning at most
+// max_leaves_scanned_per_flush leaves and removing at most max_leaves_per_flush of them in each flush's batch.
+// The watermark is saved in the same batch, in its own table (see LeafPruneDB),
+// so after a restart, the pass resumes where the last committed flush stopped.
+//
+class LeafPruner
+{
+public:
+    using Ptr = std::shared_ptr<LeafPruner>;
+
+    static constexpr uint64_t DEFAULT_MAX_LEAVES_PER_FLUSH = 10'000;
+    static constexpr uint64_t DEFAULT_MAX_LEAVES_SCANNED_PER_FLUSH = 1'000'000;
+
+    LeafPruner(
+        const FilePath& datadir,
+        const uint64_t max_leaves_per_flush = DEFAULT_MAX_LEAVES_PER_FLUSH,
+        const uint64_t max_leaves_scanned_per_flush = DEFAULT_MAX_LEAVES_SCANNED_PER_FLUSH
+    ) : m_datadir(datadir),
+        m_maxLeavesPerFlush(max_leaves_per_flush),
+        m_maxLeavesScannedPerFlush(max_leaves_scanned_per_flush) { }
+
+    //
+    // Removes the next group of spent output leaves using pBatch.
+    // horizon_index is the file index of the most recent leafset beyond the horizon, if there is one.
+    // Returns the number of leaves removed.
+    //
+    uint64_t Prune(
+        libmw::IDBWrapper* pDBWrapper,
+        libmw::IDBBatch* pBatch,
+        const boost::optional<uint32_t>& horizon_index
+    );
+
+private:
+    const BitSet& GetLeafSet(const uint32_t file_index);
+
+    FilePath m_datadir;
+    uint64_t m_maxLeavesPerFlush;
+    uint64_t m_maxLeavesScannedPerFlush;
+
+    // The base and target leafsets of the current pass.
+    std::map<uint32_t, BitSet> m_leafsets;
+};
+
+END_NAMESPACE
@@ -1,14 +1,72 @@
 #pragma once
 
+#include <mw/file/File.h>
 #include <mw/node/CoinsView.h>
 #include <mw/node/State.h>
+#include <mw/node/StateChunk.h>
 
 MW_NAMESPACE
 
 class Snapshot
 {
 public:
+    //
+    // Default number of kernel or output leaves in each chunk (the last chunk of each type may have fewer).
+    // leaves_per_chunk can't be more than StateChunk::MAX_LEAVES, or the chunks won't be readable.
+    //
+    static constexpr uint64_t LEAVES_PER_CHUNK = StateChunk::MAX_LEAVES;
+
     static State Build(const mw::ICoinsView::CPtr& pView);
+
+    //
+    // Reads the state of the view one chunk at a time, loading only that chunk's kernels, outputs and hashes.
+    //
+    static StateChunkReader Stream(const mw::ICoinsView::CPtr& pView, const uint64_t leaves_per_chunk = LEAVES_PER_CHUNK);
+
+    //
+    // Splits an in-memory state into chunks.
+    //
+    static StateChunkReader Stream(const std::shared_ptr<const State>& pState, const uint64_t leaves_per_chunk = LEAVES_PER_CHUNK);
+
+    //
+    // Writes the state of the view to a snapshot file, holding at most one chunk in memory at a time.
+    // The file contains the size of the manifest (8 bytes, big-endian), the manifest, and then every chunk.
+    //
+    static StateManifest Write(
+        const mw::ICoinsView::CPtr& pView,
+        const FilePath& path,
+        const uint64_t leaves_per_chunk = LEAVES_PER_CHUNK
+    );
+};
+
+//
+// Reads a snapshot file written by Snapshot::Write.
+//
+class SnapshotFile
+{
+public:
+    static SnapshotFile Open(const FilePath& path);
+
+    const StateManifest& GetManifest() const noexcept { return m_manifest; }
+
+    //
+    // Reads the chunk with the given index.
+    // Throws a DeserializationException if the chunk doesn't match the hash in the manifest.
+    //
+    StateChunk ReadChunk(const size_t chunk_idx) const;
+
+    //
+    // Reads every chunk in order.
+    //
+    StateChunkReader Stream() const;
+
+private:
+    SnapshotFile(const File& file, StateManifest&& manifest, const uint64_t chunks_pos)
+        : m_file(file), m_manifest(std::move(manifest)), m_chunksPos(chunks_pos) { }
+
+    File m_file;
+    StateManifest m_manifest;
+    uint64_t m_chunksPos;
 };
 
-END_NAMESPACE
\ No newline at end of file
+END_NAMESPACE
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <mw/common/BitSet.h>
+#include <mw/crypto/Hasher.h>
+#include <mw/exceptions/DeserializationException.h>
+#include <mw/models/tx/Kernel.h>
+#include <mw/models/tx/UTXO.h>
+#include <mw/traits/Serializable.h>
+#include <functional>
+#include <type_traits>
+
+MW_NAMESPACE
+
+enum class EStateChunkType : uint8_t
+{
+    KERNELS = 0,
+    OUTPUTS = 1
+};
+
+//
+// A contiguous range of leaves from the kernel MMR or the output PMMR.
+// Kernel chunks hold every kernel in the range.
+// Output chunks hold the unspent outputs in the range, plus the hashes of the pruned parents
+// whose positions fall between the positions of the range's first leaf and the leaf after its last.
+//
+struct StateChunk : public Traits::ISerializable
+{
+    //
+    // The most leaves a chunk may cover. Chunks come from untrusted snapshots,
+    // so this bounds what deserializing one can allocate.
+    //
+    static constexpr uint64_t MAX_LEAVES = 4096;
+
+    //
+    // The most bytes a serialized chunk may take: MAX_LEAVES leaves of up to 16KB each,
+    // which is more than any kernel, or any UTXO along with the proof it's verified with.
+    //
+    static constexpr uint64_t MAX_SERIALIZED_SIZE = MAX_LEAVES * 16 * 1024;
+
+    StateChunk()
+        : type(EStateChunkType::KERNELS), first_leaf(0), num_leaves(0) { }
+    StateChunk(
+        EStateChunkType type_in,
+        uint64_t first_leaf_in,
+        uint64_t num_leaves_in,
+        std::vector<Kernel> kernels_in,
+        std::vector<UTXO::CPtr> utxos_in,
+        std::vector<mw::Hash> pruned_parent_hashes_in)
+        : type(type_in),
+        first_leaf(first_leaf_in),
+        num_leaves(num_leaves_in),
+        kernels(std::move(kernels_in)),
+        utxos(std::move(utxos_in)),
+        pruned_parent_hashes(std::move(pruned_parent_hashes_in)) { }
+
+    EStateChunkType type;
+    uint64_t first_leaf;
+    uint64_t num_leaves;
+    std::vector<Kernel> kernels;
+    std::vector<UTXO::CPtr> utxos;
+    std::vector<mw::Hash> pruned_parent_hashes;
+
+    mmr::LeafIndex GetNextLeafIdx() const noexcept { return mmr::LeafIndex::At(first_leaf + num_leaves); }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint8_t>((uint8_t)type)
+            .Append<uint64_t>(first_leaf)
+            .Append<uint64_t>(num_leaves)
+            .AppendVec(kernels)
+            .AppendVec(utxos)
+            .AppendVec(pruned_parent_hashes);
+    }
+
+    static StateChunk Deserialize(Deserializer& deserializer)
+    {
+        const uint8_t type = deserializer.Read<uint8_t>();
+        if (type > (uint8_t)EStateChunkType::OUTPUTS) {
+            ThrowDeserialization_F("Unknown state chunk type {}", type);
+        }
+
+        const uint64_t first_leaf = deserializer.Read<uint64_t>();
+        const uint64_t num_leaves = deserializer.Read<uint64_t>();
+        if (num_leaves > MAX_LEAVES) {
+            ThrowDeserialization_F("State chunk has {} leaves, more than the maximum of {}", num_leaves, MAX_LEAVES);
+        }
+
+        // A chunk has at most one kernel or UTXO per leaf. Pruned parents are fewer than the positions the leaves span,
+        // which is less than twice the number of leaves, plus one parent per height above them.
+        std::vector<Kernel> kernels = ReadBounded<Kernel>(deserializer, num_leaves);
+        std::vector<UTXO::CPtr> utxos = ReadBounded<UTXO::CPtr>(deserializer, num_leaves);
+        std::vector<mw::Hash> pruned_parent_hashes = ReadBounded<mw::Hash>(deserializer, (2 * num_leaves) + 64);
+
+        return StateChunk{
+            (EStateChunkType)type,
+            first_leaf,
+            num_leaves,
+            std::move(kernels),
+            std::move(utxos),
+            std::move(pruned_parent_hashes)
+        };
+    }
+
+private:
+    // Same as Deserializer::ReadVec, but fails before allocating anything if there are more than max_entries.
+    template<typename T>
+    static std::vector<T> ReadBounded(Deserializer& deserializer, const uint64_t max_entries)
+    {
+        const uint32_t num_entries = deserializer.Read<uint32_t>();
+        if (num_entries > max_entries) {
+            ThrowDeserialization_F("State chunk has {} entries, but only {} are allowed", num_entries, max_entries);
+        }
+
+        std::vector<T> entries;
+        entries.reserve(num_entries);
+        for (uint32_t i = 0; i < num_entries; i++) {
+            if constexpr (std::is_same_v<T, UTXO::CPtr>) {
+                entries.push_back(std::make_shared<UTXO>(deserializer.Read<UTXO>()));
+            } else {
+                entries.push_back(deserializer.Read<T>());
+            }
+        }
+
+        return entries;
+    }
+};
+
+//
+// How much of a state that's being applied has been committed to the database.
+// It's saved in the same batch as each chunk's leaves and UTXOs, so it covers everything that may need to be removed
+// if the apply fails or is interrupted. The state itself isn't used until its MMRInfo is saved.
+//
+struct StateApplyProgress : public Traits::ISerializable
+{
+    StateApplyProgress()
+        : version(0), num_kernels(0), num_outputs(0) { }
+    StateApplyProgress(uint8_t version_in, uint64_t num_kernels_in, uint64_t num_outputs_in)
+        : version(version_in), num_kernels(num_kernels_in), num_outputs(num_outputs_in) { }
+
+    // Version byte that allows for future modifications to the StateApplyProgress schema.
+    uint8_t version;
+
+    // Kernel leaves below this were written.
+    uint64_t num_kernels;
+
+    // The unspent output leaves below this, and their UTXOs, were written.
+    uint64_t num_outputs;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint8_t>(version)
+            .Append<uint64_t>(num_kernels)
+            .Append<uint64_t>(num_outputs);
+    }
+
+    static StateApplyProgress Deserialize(Deserializer& deserializer)
+    {
+        uint8_t version = deserializer.Read<uint8_t>();
+        uint64_t num_kernels = deserializer.Read<uint64_t>();
+        uint64_t num_outputs = deserializer.Read<uint64_t>();
+        return StateApplyProgress{ version, num_kernels, num_outputs };
+    }
+};
+
+//
+// Reads the next chunk of a state into the given chunk.
+// Returns false once there are no chunks left.
+// Kernel chunks come first, then output chunks, each in leaf order.
+//
+using StateChunkReader = std::function<bool(StateChunk&)>;
+
+//
+// Describes a chunk of a snapshot file.
+// The offset is relative to the first byte after the manifest.
+//
+struct StateChunkInfo : public Traits::ISerializable
+{
+    StateChunkInfo()
+        : type(EStateChunkType::KERNELS), first_leaf(0), num_leaves(0), offset(0), size(0) { }
+    StateChunkInfo(EStateChunkType type_in, uint64_t first_leaf_in, uint64_t num_leaves_in, uint64_t offset_in, uint64_t size_in, mw::Hash hash_in)
+        : type(type_in), first_leaf(first_leaf_in), num_leaves(num_leaves_in), offset(offset_in), size(size_in), hash(std::move(hash_in)) { }
+
+    EStateChunkType type;
+    uint64_t first_leaf;
+    uint64_t num_leaves;
+    uint64_t offset;
+    uint64_t size;
+    mw::Hash hash;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint8_t>((uint8_t)type)
+            .Append<uint64_t>(first_leaf)
+            .Append<uint64_t>(num_leaves)
+            .Append<uint64_t>(offset)
+            .Append<uint64_t>(size)
+            .Append(hash);
+    }
+
+    static StateChunkInfo Deserialize(Deserializer& deserializer)
+    {
+        const uint8_t type = deserializer.Read<uint8_t>();
+        if (type > (uint8_t)EStateChunkType::OUTPUTS) {
+            ThrowDeserialization_F("Unknown state chunk type {}", type);
+        }
+
+        const uint64_t first_leaf = deserializer.Read<uint64_t>();
+        const uint64_t num_leaves = deserializer.Read<uint64_t>();
+        const uint64_t offset = deserializer.Read<uint64_t>();
+        const uint64_t size = deserializer.Read<uint64_t>();
+        mw::Hash hash = deserializer.Read<mw::Hash>();
+        return StateChunkInfo{ (EStateChunkType)type, first_leaf, num_leaves, offset, size, std::move(hash) };
+    }
+};
+
+//
+// The first thing in a snapshot file.
+// It's everything needed to start applying the state, plus the location and hash of each chunk.
+//
+struct StateManifest : public Traits::ISerializable
+{
+    StateManifest()
+        : version(0) { }
+    StateManifest(uint8_t version_in, mw::Hash header_hash_in, BitSet leafset_in, std::vector<StateChunkInfo> chunks_in)
+        : version(version_in), header_hash(std::move(header_hash_in)), leafset(std::move(leafset_in)), chunks(std::move(chunks_in)) { }
+
+    // Version byte that allows for future modifications to the snapshot format.
+    uint8_t version;
+    mw::Hash header_hash;
+    BitSet leafset;
+    std::vector<StateChunkInfo> chunks;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint8_t>(version)
+            .Append(header_hash)
+            .Append<uint64_t>(leafset.size())
+            .Append(leafset)
+            .AppendVec(chunks);
+    }
+
+    static StateManifest Deserialize(Deserializer& deserializer)
+    {
+        const uint8_t version = deserializer.Read<uint8_t>();
+        mw::Hash header_hash = deserializer.Read<mw::Hash>();
+
+        // BitSet is serialized in whole bytes, so the exact number of leaves is stored separately.
+        const uint64_t num_leaves = deserializer.Read<uint64_t>();
+        BitSet leafset = deserializer.Read<BitSet>();
+        if (leafset.size() < num_leaves) {
+            ThrowDeserialization("Leafset is smaller than expected");
+        }
+
+        leafset.bitset.resize(num_leaves);
+
+        std::vector<StateChunkInfo> chunks = deserializer.ReadVec<StateChunkInfo>();
+        return StateManifest{ version, std::move(header_hash), std::move(leafset), std::move(chunks) };
+    }
+};
+
+END_NAMESPACE
@@ -2,6 +2,13 @@
 
 #include <mw/models/block/Block.h>
 
+#include <future>
+
+//
+// Validates a block without any context (i.e. without the UTXO set).
+// The cheap checks (hash, structure, pegs) run first so invalid blocks fail fast.
+// The signature batches, range proof batches and owner sum then run concurrently on the ThreadPool.
+//
 class BlockValidator
 {
 public:
@@ -14,6 +21,17 @@ public:
         const std::vector<PegOutCoin>& pegOutCoins
     );
 
+    //
+    // Same as Validate, but runs on the ThreadPool, so the caller can connect the previous block in the meantime.
+    // The future rethrows any ValidationException. The block must not be modified until the future is ready.
+    //
+    static std::future<void> ValidateAsync(
+        const mw::Block::Ptr& pBlock,
+        const mw::Hash& mweb_hash,
+        const std::vector<PegInCoin>& pegInCoins,
+        const std::vector<PegOutCoin>& pegOutCoins
+    );
+
 private:
     void ValidatePegInCoins(
         const mw::Block::CPtr& pBlock,
@@ -24,4 +42,6 @@ private:
         const mw::Block::CPtr& pBlock,
         const std::vector<PegOutCoin>& pegOutCoins
     );
+
+    void VerifyInParallel(const mw::Block::CPtr& pBlock);
 };
\ No newline at end of file
@@ -7,5 +7,9 @@ class StateValidator
 public:
     StateValidator() = default;
 
-    void Validate(const mw::ICoinsView& coins_view);
+    //
+    // Sums every UTXO and kernel in the view, and checks the sums against its best header.
+    // Returns the sums, so they can be kept up to date from here on.
+    //
+    mw::StateSums Validate(const mw::ICoinsView& coins_view);
 };
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <mw/models/tx/Transaction.h>
+#include <mw/node/CoinsView.h>
+#include <mw/node/validation/VerificationService.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//
+// Validates transactions submitted from other threads (e.g. relayed by peers) in the background,
+// running the same checks as CheckTransaction and CheckTxInputs.
+//
+// The inputs are looked up in the view when the transaction is submitted, on the submitter's thread.
+// A dispatcher thread then takes every transaction waiting in the queue as a batch, and splits their structure,
+// sum and input checks across the ThreadPool. The signatures and range proofs of the transactions that pass
+// are handed to the VerificationService, and the dispatcher moves on to the next batch without waiting for them.
+//
+// The queue is bounded: Submit blocks while it's full, and TrySubmit returns false instead.
+// When the VerificationService is full, the dispatcher blocks, so the backpressure reaches the submitters.
+//
+class TxAcceptor
+{
+public:
+    //
+    // Called once the transaction is validated, with nullptr if it's valid, or the ValidationException (or other error) otherwise.
+    // Runs on the dispatcher, a ThreadPool worker, or the VerificationService's dispatcher, so it should be quick, and must not throw.
+    // If the inputs can't be looked up, it's called with that error before Submit or TrySubmit returns.
+    //
+    using Callback = std::function<void(const std::exception_ptr&)>;
+
+    struct Options
+    {
+        // Submitters block once this many transactions are waiting.
+        size_t max_queued_txs = 10'000;
+
+        // The most transactions the dispatcher takes from the queue at once.
+        size_t max_batch_txs = 1'000;
+    };
+
+    TxAcceptor();
+    TxAcceptor(const Options& options, VerificationService& verifier);
+    ~TxAcceptor();
+
+    TxAcceptor(const TxAcceptor&) = delete;
+    TxAcceptor& operator=(const TxAcceptor&) = delete;
+
+    //
+    // Returns the process-wide acceptor, with the default options and the process-wide VerificationService.
+    //
+    static TxAcceptor& Get();
+
+    //
+    // Looks up the transaction's inputs in the view, then queues it, blocking while the queue is full.
+    // The view is only read before this returns, so the caller must guard it the same way as for LookupUTXOs.
+    // The future rethrows a ValidationException if the transaction is invalid.
+    //
+    std::future<void> Submit(const mw::ICoinsView::CPtr& pView, const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height);
+    void Submit(const mw::ICoinsView::CPtr& pView, const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height, const Callback& callback);
+
+    //
+    // Queues the transaction without blocking. Returns false, without calling callback, if the queue is full.
+    //
+    bool TrySubmit(const mw::ICoinsView::CPtr& pView, const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height, const Callback& callback);
+
+    //
+    // The number of transactions waiting to be dispatched.
+    //
+    size_t GetNumQueued() const;
+
+    //
+    // Checks that every input of the transaction is in utxos (as returned by ICoinsView::LookupUTXOs),
+    // and that the pegged-in ones are mature at spend_height. Throws a ValidationException if not.
+    //
+    static void CheckInputs(
+        const mw::Transaction& transaction,
+        const std::unordered_map<Commitment, std::vector<UTXO::CPtr>>& utxos,
+        const uint64_t spend_height
+    );
+
+private:
+    struct Pending
+    {
+        mw::Transaction::CPtr pTransaction;
+        std::unordered_map<Commitment, std::vector<UTXO::CPtr>> utxos;
+        uint64_t spend_height;
+        Callback callback;
+    };
+
+    bool Enqueue(
+        const mw::ICoinsView::CPtr& pView,
+        const mw::Transaction::CPtr& pTransaction,
+        const uint64_t spend_height,
+        const Callback& callback,
+        const bool block
+    );
+    void Run();
+    void Process(std::vector<Pending>& batch) const;
+
+    Options m_options;
+    VerificationService& m_verifier;
+
+    std::deque<Pending> m_pending;
+    bool m_stopping;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_pendingAdded;
+    std::condition_variable m_spaceFreed;
+    std::thread m_dispatcher;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mw/models/crypto/ProofData.h>
+#include <mw/models/crypto/SignedMessage.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Verifies the signatures and range proofs of many callers' transactions together.
+//
+// Each job is the signatures and proofs of one transaction. A dispatcher thread collects the jobs that
+// arrive within a short window, then verifies them as shared Schnorr and range proof batches on the ThreadPool,
+// so a stream of small transactions gets the per-item savings of batch verification that a block does.
+// When a batch fails, only the jobs it covered are re-verified on their own, so one invalid transaction
+// doesn't fail the others.
+//
+// The queue is bounded by the number of signatures and proofs waiting in it. Submit blocks while it's full,
+// and TrySubmit returns false instead. Verify is for a single caller that needs the result straight away,
+// so it never waits out the window.
+//
+class VerificationService
+{
+public:
+    //
+    // Called once the job is verified, with nullptr if it's valid, or the ValidationException (or other error) otherwise.
+    // Runs on the dispatcher or a ThreadPool worker, so it should be quick, must not throw, and must not wait on other jobs.
+    //
+    using Callback = std::function<void(const std::exception_ptr&)>;
+
+    struct Options
+    {
+        // Submitters block once this many signatures and proofs are waiting.
+        // A job larger than this is still accepted when the queue is empty.
+        size_t max_queued_items = 100'000;
+
+        // How long the oldest waiting job is held back for others to join its batch.
+        std::chrono::microseconds batch_window = std::chrono::microseconds(500);
+
+        // A batch is dispatched without waiting out the window once it has this many signatures or proofs.
+        size_t max_batch_signatures = 4096;
+        size_t max_batch_proofs = 512;
+    };
+
+    VerificationService();
+    explicit VerificationService(const Options& options);
+    ~VerificationService();
+
+    VerificationService(const VerificationService&) = delete;
+    VerificationService& operator=(const VerificationService&) = delete;
+
+    //
+    // Returns the process-wide service, with the default options.
+    //
+    static VerificationService& Get();
+
+    //
+    // Queues the job, blocking while the queue is full.
+    // The future rethrows a ValidationException (INVALID_SIG or BULLETPROOF) if the job is invalid.
+    //
+    std::future<void> Submit(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs);
+    void Submit(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs, const Callback& callback);
+
+    //
+    // Queues the job without blocking. Returns false, without calling callback, if the queue is full.
+    //
+    bool TrySubmit(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs, const Callback& callback);
+
+    //
+    // Verifies the job and returns once it's done, throwing a ValidationException (INVALID_SIG or BULLETPROOF) if it's invalid.
+    // With nothing queued, it's verified on the calling thread. Otherwise it joins the waiting jobs,
+    // which are then dispatched without waiting out the rest of their window.
+    //
+    void Verify(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs);
+
+    //
+    // The number of signatures and proofs waiting to be dispatched.
+    //
+    size_t GetNumQueued() const;
+
+private:
+    struct Job
+    {
+        std::vector<SignedMessage> signatures;
+        std::vector<ProofData> proofs;
+        Callback callback;
+        std::chrono::steady_clock::time_point queued_at;
+
+        // Dispatched without waiting out the window.
+        bool urgent = false;
+    };
+
+    bool Enqueue(Job&& job, const bool block);
+    void Run();
+    bool IsBatchFull() const noexcept;
+    void VerifyBatch(const std::vector<Job>& jobs) const;
+    static void VerifyJob(const Job& job);
+
+    Options m_options;
+
+    std::deque<Job> m_jobs;
+    size_t m_queuedSignatures;
+    size_t m_queuedProofs;
+    size_t m_queuedUrgent;
+    bool m_stopping;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobAdded;
+    std::condition_variable m_spaceFreed;
+    std::thread m_dispatcher;
+};
@@ -56,7 +56,12 @@ public:
     template <class T, typename SFINAE = typename std::enable_if_t<std::is_base_of_v<Traits::ISerializable, T>>>
     std::vector<T> ReadVec()
     {
+        // Every entry takes at least one byte, so a count that can't fit in what's left is rejected before allocating.
         const uint32_t num_entries = Read<uint32_t>();
+        if (num_entries > GetRemainingSize()) {
+            ThrowDeserialization("Vector is larger than the remaining buffer.");
+        }
+
         std::vector<T> vec(num_entries);
         for (uint32_t i = 0; i < num_entries; i++) {
             vec[i] = T::Deserialize(*this);
@@ -4,6 +4,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file LICENSE or http://www.opensource.org/licenses/mit-license.php.
 
+#include <bitset>
 #include <cstdint>
 
 class BitUtil
@@ -26,28 +27,16 @@ public:
     //
     static uint8_t CountBitsSet(const uint64_t input) noexcept
     {
-        uint64_t n = input;
-        uint8_t count = 0;
-        while (n)
-        {
-            count += (uint8_t)(n & 1);
-            n >>= 1;
-        }
-
-        return count;
+        return (uint8_t)std::bitset<64>(input).count();
     }
 
+    //
+    // Counts the number of trailing zero bits. Returns 64 when input is 0.
+    //
     static uint8_t CountRightmostZeros(const uint64_t input) noexcept
     {
-        uint8_t count = 0;
-
-        uint64_t n = input;
-        while ((n & 1) == 0) {
-            ++count;
-            n >>= 1;
-        }
-
-        return count;
+        // (input - 1) flips the trailing zeros to ones, and clears the lowest set bit.
+        return CountBitsSet(~input & (input - 1));
     }
 
     //
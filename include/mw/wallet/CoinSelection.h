@@ -0,0 +1,70 @@
+#pragma once
+
+#include <libmw/defs.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//
+// Picks which of the wallet's coins a transaction spends, and the fee it pays.
+//
+// Inputs don't add to a transaction's weight, so the fee only depends on the outputs, how their range proofs
+// are created, and the pegouts.
+// Branch-and-bound is tried first, looking for coins that cover the amount and fee closely enough
+// that a change output would cost more than it returns. When there's no such set,
+// a knapsack search picks coins that cover the amount and the fee of a transaction with a change output.
+//
+class CoinSelection
+{
+public:
+    struct Result
+    {
+        std::vector<libmw::Coin> inputs;
+        uint64_t fee;
+
+        // The amount left over for a change output, or 0 when the transaction doesn't need one.
+        uint64_t change;
+    };
+
+    //
+    // Selects coins worth at least amount plus the fee of a transaction with num_outputs outputs and num_pegouts pegouts,
+    // paying fee_rate per unit of weight. Watch-only coins (no key or blind) and empty coins are never selected.
+    // aggregate_proofs must match how the transaction's outputs are created (see Transact::CreateTx).
+    // Throws an InsufficientFundsException if the coins can't cover it.
+    //
+    static Result Select(
+        const std::vector<libmw::Coin>& coins,
+        const uint64_t amount,
+        const size_t num_outputs,
+        const uint64_t fee_rate,
+        const size_t num_pegouts = 0,
+        const bool aggregate_proofs = false
+    );
+
+    //
+    // The fee of a transaction with num_outputs outputs and a single owner sig.
+    // Each pegout is carried by a kernel, and there's always at least one.
+    //
+    static uint64_t CalcFee(
+        const size_t num_outputs,
+        const uint64_t fee_rate,
+        const size_t num_pegouts = 0,
+        const bool aggregate_proofs = false
+    );
+
+private:
+    // A spendable coin's amount and its index in the wallet's coins.
+    using Candidate = std::pair<uint64_t, size_t>;
+
+    static boost::optional<std::vector<size_t>> SelectBnB(
+        const std::vector<Candidate>& sorted,
+        const uint64_t target,
+        const uint64_t max_excess
+    );
+
+    static std::vector<size_t> SelectKnapsack(
+        const std::vector<Candidate>& sorted,
+        const uint64_t target
+    );
+};
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <mw/models/crypto/Hash.h>
 #include <mw/models/crypto/SecretKey.h>
 #include <mw/models/wallet/StealthAddress.h>
-#include <unordered_map>
+#include <array>
+#include <atomic>
 #include <climits>
 #include <memory>
+#include <shared_mutex>
+#include <vector>
 
 MW_NAMESPACE
 
+//
+// Derives the wallet's keys and addresses.
+// Safe to use from multiple threads, so outputs can be scanned in parallel.
+//
 class Keychain
 {
 public:
@@ -20,17 +28,51 @@ public:
 
     StealthAddress GetStealthAddress(const uint32_t index) const;
     SecretKey GetSpendKey(const uint32_t index) const;
+
+    //
+    // Looks up the address index of the spend pubkey.
+    // Spend pubkeys are derived in windows, up to RESTORE_WINDOW past the highest address index used so far.
+    //
     bool IsSpendPubKey(const PublicKey& spend_pubkey, uint32_t& index_out) const;
 
+    //
+    // Serializes the spend pubkeys derived so far, so they can be loaded instead of derived again when the wallet starts.
+    // They're followed by a hash keyed with the keychain's secrets, so they can't be swapped or tampered with.
+    //
+    std::vector<uint8_t> SerializeSpendPubKeys() const;
+
+    //
+    // Loads spend pubkeys written by SerializeSpendPubKeys.
+    // Throws a DeserializationException if they're malformed or belong to a different keychain.
+    //
+    void LoadSpendPubKeys(const std::vector<uint8_t>& serialized);
+
     const SecretKey& GetScanSecret() const noexcept { return m_scanSecret; }
     const SecretKey& GetSpendSecret() const noexcept { return m_spendSecret; }
     
 private:
+    struct SpendPubKey
+    {
+        std::array<uint8_t, 33> pubkey;
+        uint32_t index;
+
+        bool operator<(const SpendPubKey& rhs) const noexcept { return pubkey < rhs.pubkey; }
+    };
+
+    // The hash appended by SerializeSpendPubKeys, which only this keychain's secrets can produce.
+    mw::Hash HashSpendPubKeys(const std::vector<uint8_t>& serialized) const;
+
+    // Derives the spend pubkeys of every index below num_indices. The caller must hold the exclusive lock.
+    void DeriveSpendPubKeys(const size_t num_indices) const;
+
     SecretKey m_scanSecret;
     SecretKey m_spendSecret;
 
-    mutable uint32_t m_addressIndexCounter;
-    mutable std::unordered_map<PublicKey, uint32_t> m_pubkeys;
+    mutable std::atomic<uint32_t> m_addressIndexCounter;
+
+    // The spend pubkeys of address indices [0, m_pubkeys.size()), sorted by pubkey.
+    mutable std::shared_mutex m_mutex;
+    mutable std::vector<SpendPubKey> m_pubkeys;
 };
 
 END_NAMESPACE
\ No newline at end of file
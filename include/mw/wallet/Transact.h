@@ -4,6 +4,8 @@
 #include <mw/models/wallet/StealthAddress.h>
 #include <mw/models/tx/PegInCoin.h>
 #include <mw/models/tx/PegOutCoin.h>
+#include <mw/wallet/CoinSelection.h>
+#include <mw/wallet/Keychain.h>
 #include <libmw/defs.h>
 
 // Forward Declarations
@@ -19,14 +21,36 @@ class Transact
     };
 
 public:
+    //
+    // With aggregate_proofs, the outputs share range proofs in groups of up to RangeProof::MAX_COMMITS,
+    // which makes the transaction smaller and cheaper to verify.
+    //
     static mw::Transaction::CPtr CreateTx(
         const std::vector<libmw::Coin>& input_coins,
         const std::vector<std::pair<uint64_t, StealthAddress>>& recipients,
         const std::vector<PegOutCoin>& pegouts,
         const boost::optional<uint64_t>& pegin_amount,
-        const uint64_t fee
+        const uint64_t fee,
+        const bool aggregate_proofs = false
+    );
+
+    //
+    // Same as above, but the inputs are picked from available_coins by CoinSelection, paying fee_rate per unit of weight.
+    // Any change goes to the keychain's change address. The selected coins, fee and change are returned in selection_out.
+    //
+    static mw::Transaction::CPtr Send(
+        const mw::Keychain::Ptr& pKeychain,
+        const std::vector<libmw::Coin>& available_coins,
+        const std::vector<std::pair<uint64_t, StealthAddress>>& recipients,
+        const std::vector<PegOutCoin>& pegouts,
+        const uint64_t fee_rate,
+        CoinSelection::Result& selection_out,
+        const bool aggregate_proofs = false
     );
 
 private:
-    static Outputs CreateOutputs(const std::vector<std::pair<uint64_t, StealthAddress>>& recipients);
+    static Outputs CreateOutputs(
+        const std::vector<std::pair<uint64_t, StealthAddress>>& recipients,
+        const bool aggregate_proofs
+    );
 };
\ No newline at end of file
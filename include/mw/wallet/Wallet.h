@@ -10,8 +10,20 @@ public:
     Wallet(const mw::Keychain::Ptr& pKeychain)
         : m_pKeychain(pKeychain) { }
 
+    // Returns false if the output doesn't belong to the wallet, including when its keys aren't valid points.
     bool RewindOutput(const Output& output, libmw::Coin& coin) const;
 
+    //
+    // Finds every output that belongs to the wallet, in the order they're given.
+    // The shared secrets of all outputs are calculated together in batches,
+    // and the outputs are then checked in parallel on the thread pool.
+    // Outputs whose keys aren't valid points are skipped, rather than failing the scan.
+    //
+    std::vector<libmw::Coin> ScanOutputs(const std::vector<Output>& outputs) const;
+
 private:
+    // Rewinds the output using the shared secret (Ke*a) that was already calculated for it.
+    bool RewindOutput(const Output& output, const PublicKey& shared_secret, libmw::Coin& coin) const;
+
     mw::Keychain::Ptr m_pKeychain;
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mw/models/block/Block.h>
+#include <mw/models/block/BlockUndo.h>
+#include <mw/models/wallet/ScanState.h>
+#include <mw/wallet/Wallet.h>
+#include <libmw/interfaces/chain_interface.h>
+#include <libmw/interfaces/db_interface.h>
+
+//
+// Scans the chain for the wallet's coins, saving them to the wallet's database
+// along with a cursor that points to the last block scanned.
+// After a restart, only the blocks after the cursor need to be scanned.
+//
+class WalletScanner
+{
+public:
+    WalletScanner(const mw::Keychain::Ptr& pKeychain, const libmw::IDBWrapper::Ptr& pDBWrapper)
+        : m_wallet(pKeychain), m_pDBWrapper(pDBWrapper) { }
+
+    //
+    // Scans every block in the chain after the cursor, and returns the coins found.
+    // If the block at the cursor is no longer in the chain, it was disconnected without DisconnectBlock being called,
+    // so the wallet's coins and cursor are cleared and the whole chain is scanned again.
+    //
+    std::vector<libmw::Coin> ScanChain(const libmw::IChain::Ptr& pChain);
+
+    //
+    // Scans the block after the cursor (or any block, if nothing has been scanned yet), and returns the coins found.
+    // Coins spent by the block are removed, and the cursor is moved to the block.
+    // Throws a DatabaseException if the block isn't at the next height.
+    //
+    std::vector<libmw::Coin> ConnectBlock(const mw::Block::CPtr& pBlock);
+
+    //
+    // Moves the cursor back from the last block scanned, using the block's undo data.
+    // Coins the block added are removed, and coins it spent are restored.
+    // Throws a DatabaseException if the undo data isn't for the block at the cursor.
+    //
+    void DisconnectBlock(const mw::BlockUndo::CPtr& pUndo);
+
+    std::unique_ptr<mw::ScanCursor> GetCursor() const;
+    std::vector<libmw::Coin> GetCoins() const;
+
+private:
+    Wallet m_wallet;
+    libmw::IDBWrapper::Ptr m_pDBWrapper;
+};
\ No newline at end of file
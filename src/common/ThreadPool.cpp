@@ -0,0 +1,127 @@
+#include <mw/common/ThreadPool.h>
+#include <algorithm>
+
+ThreadPool::ThreadPool(const size_t num_threads)
+    : m_stopping(false)
+{
+    m_workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        m_workers.emplace_back([this]() { Run(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_cv.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::Get()
+{
+    static ThreadPool pool(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+    return pool;
+}
+
+void ThreadPool::ParallelFor(
+    const uint64_t begin,
+    const uint64_t end,
+    const uint64_t min_chunk,
+    const std::function<void(const uint64_t, const uint64_t)>& fn)
+{
+    if (end <= begin) {
+        return;
+    }
+
+    const uint64_t num_items = end - begin;
+    const uint64_t max_chunks = (GetNumThreads() + 1) * 4;
+    const uint64_t chunk_size = std::max<uint64_t>(std::max<uint64_t>(min_chunk, 1), (num_items + max_chunks - 1) / max_chunks);
+    const uint64_t num_chunks = (num_items + chunk_size - 1) / chunk_size;
+    if (num_chunks <= 1 || GetNumThreads() == 0) {
+        fn(begin, end);
+        return;
+    }
+
+    // Shared with the helper tasks, which may only get dequeued after this call has returned.
+    struct State
+    {
+        std::atomic<uint64_t> next_chunk{ 0 };
+        uint64_t chunks_done{ 0 };
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto pState = std::make_shared<State>();
+
+    auto process_chunks = [pState, begin, end, chunk_size, num_chunks, fn]() {
+        uint64_t chunk;
+        while ((chunk = pState->next_chunk.fetch_add(1)) < num_chunks) {
+            const uint64_t chunk_begin = begin + (chunk * chunk_size);
+            const uint64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+
+            std::exception_ptr error;
+            try {
+                fn(chunk_begin, chunk_end);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::unique_lock<std::mutex> lock(pState->mutex);
+            if (error && !pState->error) {
+                pState->error = error;
+            }
+
+            if (++pState->chunks_done == num_chunks) {
+                pState->cv.notify_all();
+            }
+        }
+    };
+
+    const uint64_t num_helpers = std::min<uint64_t>(GetNumThreads(), num_chunks - 1);
+    for (uint64_t i = 0; i < num_helpers; i++) {
+        Push(process_chunks);
+    }
+
+    process_chunks();
+
+    std::unique_lock<std::mutex> lock(pState->mutex);
+    pState->cv.wait(lock, [&pState, num_chunks]() { return pState->chunks_done == num_chunks; });
+    if (pState->error) {
+        std::rethrow_exception(pState->error);
+    }
+}
+
+void ThreadPool::Push(std::function<void()>&& task)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_cv.notify_one();
+}
+
+void ThreadPool::Run()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -5,20 +5,44 @@
 
 #include <mw/crypto/Random.h>
 #include <mw/exceptions/CryptoException.h>
-#include <mw/util/VectorUtil.h>
+
+#include <algorithm>
+#include <map>
 
 static constexpr uint64_t MAX_WIDTH = 1 << 20;
 static constexpr size_t SCRATCH_SPACE_SIZE = 256 * MAX_WIDTH;
-static constexpr size_t PROOF_LEN = 675;
 static constexpr size_t NUM_BITS_PROVEN = 64;
 
+// Aggregated proofs use their own, larger generator set,
+// so single proofs stay valid against the 256 generators they've always been made with.
+static constexpr size_t NUM_AGGREGATE_GENERATORS = 2 * NUM_BITS_PROVEN * RangeProof::MAX_COMMITS;
+
 static BulletProofsCache CACHE;
 static Locked<Context> BP_CONTEXT(std::make_shared<Context>());
+static Locked<Context> BP_AGGREGATE_CONTEXT(std::make_shared<Context>(NUM_AGGREGATE_GENERATORS));
 
-bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
+// Proving randomizes and mutates its context, so each thread proves with its own context and generators
+// instead of serializing every proof behind BP_CONTEXT's write lock.
+static Context& GetProvingContext(const size_t num_commits)
 {
+    if (num_commits == 1) {
+        thread_local Context context;
+        return context;
+    }
+
+    thread_local Context aggregate_context(NUM_AGGREGATE_GENERATORS);
+    return aggregate_context;
+}
+
+// Verifies proofs that are all over num_commits commitments in a single batch.
+static bool VerifyBatch(const size_t num_commits, const std::vector<const ProofData*>& proofs)
+{
+    const Locked<Context>& context = num_commits == 1 ? BP_CONTEXT : BP_AGGREGATE_CONTEXT;
+    const size_t proof_len = RangeProof::SizeFor(num_commits);
+
+    // The commitments of each proof are laid out next to each other.
     std::vector<secp256k1_pedersen_commitment> secpCommitments;
-    secpCommitments.reserve(proofs.size());
+    secpCommitments.reserve(proofs.size() * num_commits);
 
     std::vector<const uint8_t*> bulletproofPointers;
     bulletproofPointers.reserve(proofs.size());
@@ -29,49 +53,58 @@ bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
     std::vector<size_t> extraDataLen;
     extraDataLen.reserve(proofs.size());
 
-    for (const auto& proof : proofs)
+    for (const ProofData* pProof : proofs)
     {
-        if (!CACHE.Contains(proof)) {
-            secpCommitments.push_back(ConversionUtil(BP_CONTEXT).ToSecp256k1(proof.commitment));
-            bulletproofPointers.emplace_back(proof.pRangeProof->data());
-
-            if (!proof.extraData.empty()) {
-                extraData.push_back(proof.extraData.data());
-                extraDataLen.push_back(proof.extraData.size());
-            } else {
-                extraData.push_back(nullptr);
-                extraDataLen.push_back(0);
-            }
+        if (pProof->pRangeProof->size() != proof_len) {
+            return false;
         }
-    }
 
-    if (secpCommitments.empty()) {
-        return true;
+        secpCommitments.push_back(ConversionUtil(context).ToSecp256k1(pProof->commitment));
+        for (const Commitment& commitment : pProof->aggregated_commits)
+        {
+            secpCommitments.push_back(ConversionUtil(context).ToSecp256k1(commitment));
+        }
+
+        bulletproofPointers.emplace_back(pProof->pRangeProof->data());
+
+        if (!pProof->extraData.empty()) {
+            extraData.push_back(pProof->extraData.data());
+            extraDataLen.push_back(pProof->extraData.size());
+        } else {
+            extraData.push_back(nullptr);
+            extraDataLen.push_back(0);
+        }
     }
 
     // array of generator multiplied by value in pedersen commitments (cannot be NULL)
     std::vector<secp256k1_generator> valueGenerators;
-    for (size_t i = 0; i < secpCommitments.size(); i++)
+    for (size_t i = 0; i < proofs.size(); i++)
     {
         valueGenerators.push_back(secp256k1_generator_const_h);
     }
 
-    std::vector<secp256k1_pedersen_commitment*> commitmentPointers = VectorUtil::ToPointerVec(secpCommitments);
+    std::vector<const secp256k1_pedersen_commitment*> commitmentPointers;
+    commitmentPointers.reserve(proofs.size());
+    for (size_t i = 0; i < proofs.size(); i++)
+    {
+        commitmentPointers.push_back(&secpCommitments[i * num_commits]);
+    }
 
+    auto contextReader = context.Read();
     secp256k1_scratch_space* pScratchSpace = secp256k1_scratch_space_create(
-        BP_CONTEXT.Read()->Get(),
+        contextReader->Get(),
         SCRATCH_SPACE_SIZE
     );
     const int result = secp256k1_bulletproof_rangeproof_verify_multi(
-        BP_CONTEXT.Read()->Get(),
+        contextReader->Get(),
         pScratchSpace,
-        BP_CONTEXT.Read()->GetGenerators(),
+        contextReader->GetGenerators(),
         bulletproofPointers.data(),
-        secpCommitments.size(),
-        PROOF_LEN,
+        proofs.size(),
+        proof_len,
         NULL,
         commitmentPointers.data(),
-        1,
+        num_commits,
         NUM_BITS_PROVEN,
         valueGenerators.data(),
         extraData.data(),
@@ -79,54 +112,46 @@ bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
     );
     secp256k1_scratch_space_destroy(pScratchSpace);
 
-    if (result == 1) {
-        for (const auto& proof : proofs)
-        {
-            CACHE.Add(proof);
-        }
-    }
-
     return result == 1;
 }
 
-RangeProof::CPtr Bulletproofs::Generate(
-    const uint64_t amount,
-    const SecretKey& key,
+static RangeProof::CPtr Prove(
+    const std::vector<uint64_t>& amounts,
+    const std::vector<const uint8_t*>& blindingFactors,
     const SecretKey& privateNonce,
     const SecretKey& rewindNonce,
-    const ProofMessage& proofMessage,
+    const uint8_t* pProofMessage,
     const std::vector<uint8_t>& extraData)
 {
-    auto contextWriter = BP_CONTEXT.Write();
-    secp256k1_context* pContext = contextWriter->Randomized();
+    Context& context = GetProvingContext(amounts.size());
+    secp256k1_context* pContext = context.Randomized();
 
     std::vector<uint8_t> proofBytes(RangeProof::MAX_SIZE, 0);
     size_t proofLen = RangeProof::MAX_SIZE;
 
     secp256k1_scratch_space* pScratchSpace = secp256k1_scratch_space_create(pContext, SCRATCH_SPACE_SIZE);
 
-    std::vector<const uint8_t*> blindingFactors({ key.data() });
     int result = secp256k1_bulletproof_rangeproof_prove(
         pContext,
         pScratchSpace,
-        contextWriter->GetGenerators(),
+        context.GetGenerators(),
         &proofBytes[0],
         &proofLen,
         NULL,
         NULL,
         NULL,
-        &amount,
+        amounts.data(),
         NULL,
         blindingFactors.data(),
         NULL,
-        1,
+        amounts.size(),
         &secp256k1_generator_const_h,
         NUM_BITS_PROVEN,
         rewindNonce.data(),
         privateNonce.data(),
         extraData.data(),
         extraData.size(),
-        proofMessage.data()
+        pProofMessage
     );
     secp256k1_scratch_space_destroy(pScratchSpace);
 
@@ -138,6 +163,69 @@ RangeProof::CPtr Bulletproofs::Generate(
     return std::make_shared<RangeProof>(std::move(proofBytes));
 }
 
+bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
+{
+    // verify_multi only takes proofs over the same number of commitments,
+    // so single and aggregated proofs are split into a batch per commitment count.
+    std::map<size_t, std::vector<const ProofData*>> batches;
+    for (const auto& proof : proofs)
+    {
+        if (!RangeProof::IsValidNumCommits(1 + proof.aggregated_commits.size())) {
+            return false;
+        }
+
+        if (!CACHE.Contains(proof)) {
+            batches[1 + proof.aggregated_commits.size()].push_back(&proof);
+        }
+    }
+
+    for (const auto& batch : batches)
+    {
+        if (!VerifyBatch(batch.first, batch.second)) {
+            return false;
+        }
+    }
+
+    for (const auto& proof : proofs)
+    {
+        CACHE.Add(proof);
+    }
+
+    return true;
+}
+
+RangeProof::CPtr Bulletproofs::Generate(
+    const uint64_t amount,
+    const SecretKey& key,
+    const SecretKey& privateNonce,
+    const SecretKey& rewindNonce,
+    const ProofMessage& proofMessage,
+    const std::vector<uint8_t>& extraData)
+{
+    return Prove({ amount }, { key.data() }, privateNonce, rewindNonce, proofMessage.data(), extraData);
+}
+
+RangeProof::CPtr Bulletproofs::GenerateAggregated(
+    const std::vector<uint64_t>& amounts,
+    const std::vector<SecretKey>& keys,
+    const SecretKey& privateNonce,
+    const SecretKey& rewindNonce,
+    const std::vector<uint8_t>& extraData)
+{
+    if (!RangeProof::IsValidNumCommits(amounts.size()) || amounts.size() != keys.size()) {
+        ThrowCrypto_F("Can't aggregate a range proof over {} amounts and {} keys", amounts.size(), keys.size());
+    }
+
+    std::vector<const uint8_t*> blindingFactors;
+    std::transform(
+        keys.cbegin(), keys.cend(),
+        std::back_inserter(blindingFactors),
+        [](const SecretKey& key) { return key.data(); }
+    );
+
+    return Prove(amounts, blindingFactors, privateNonce, rewindNonce, nullptr, extraData);
+}
+
 std::unique_ptr<RewoundProof> Bulletproofs::Rewind(
     const Commitment& commitment,
     const RangeProof& rangeProof,
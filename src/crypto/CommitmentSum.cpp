@@ -0,0 +1,38 @@
+#include <mw/crypto/CommitmentSum.h>
+#include <mw/crypto/Crypto.h>
+#include <mw/common/ThreadPool.h>
+
+// Sums the commitments in parallel, then sums the partial sums until there's only one left.
+static Commitment SumPositive(const std::vector<Commitment>& commitments)
+{
+    if (commitments.size() <= CommitmentSum::PARTITION_SIZE) {
+        return Crypto::AddCommitments(commitments);
+    }
+
+    const uint64_t num_partitions = (commitments.size() + CommitmentSum::PARTITION_SIZE - 1) / CommitmentSum::PARTITION_SIZE;
+    std::vector<Commitment> partial_sums(num_partitions);
+    ThreadPool::Get().ParallelFor(0, num_partitions, 1, [&commitments, &partial_sums](const uint64_t begin, const uint64_t end) {
+        for (uint64_t partition = begin; partition < end; partition++) {
+            auto first = commitments.cbegin() + (partition * CommitmentSum::PARTITION_SIZE);
+            auto last = commitments.cbegin() + std::min<uint64_t>((partition + 1) * CommitmentSum::PARTITION_SIZE, commitments.size());
+            partial_sums[partition] = Crypto::AddCommitments(std::vector<Commitment>(first, last));
+        }
+    });
+
+    return SumPositive(partial_sums);
+}
+
+CommitmentSum& CommitmentSum::AddPartial(const std::vector<Commitment>& positive, const std::vector<Commitment>& negative)
+{
+    m_total = Crypto::AddCommitments({ m_total, Sum(positive, negative) });
+    return *this;
+}
+
+Commitment CommitmentSum::Sum(const std::vector<Commitment>& positive, const std::vector<Commitment>& negative)
+{
+    if (positive.size() + negative.size() <= CommitmentSum::PARTITION_SIZE) {
+        return Crypto::AddCommitments(positive, negative);
+    }
+
+    return Crypto::AddCommitments({ SumPositive(positive) }, { SumPositive(negative) });
+}
@@ -7,21 +7,40 @@
 #include <mw/models/crypto/SecretKey.h>
 #include <mw/exceptions/CryptoException.h>
 
+#include <mutex>
+
 class Context
 {
 public:
-    Context()
+    // Bulletproofs split the generators in half, so proofs are only valid against a set of the same size.
+    explicit Context(const size_t num_generators = 256)
+        : m_pPedersenTables(nullptr)
     {
         m_pContext = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
-        m_pGenerators = secp256k1_bulletproof_generators_create(m_pContext, &secp256k1_generator_const_g, 256);
+        if (m_pContext == nullptr) {
+            ThrowCrypto("secp256k1_context_create failed");
+        }
+
+        m_pGenerators = secp256k1_bulletproof_generators_create(m_pContext, &secp256k1_generator_const_g, num_generators);
+        if (m_pGenerators == nullptr) {
+            secp256k1_context_destroy(m_pContext);
+            ThrowCrypto("secp256k1_bulletproof_generators_create failed");
+        }
     }
 
     ~Context()
     {
+        if (m_pPedersenTables != nullptr) {
+            secp256k1_pedersen_tables_destroy(m_pContext, m_pPedersenTables);
+        }
+
         secp256k1_bulletproof_generators_destroy(m_pContext, m_pGenerators);
         secp256k1_context_destroy(m_pContext);
     }
 
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+
     secp256k1_context* Randomized()
     {
         const SecretKey randomSeed = Random::CSPRNG<32>();
@@ -39,7 +58,33 @@ public:
 
     const secp256k1_bulletproof_generators* GetGenerators() const noexcept { return m_pGenerators; }
 
+    //
+    // Precomputed multiples of G, H and J, so commitments and switch blinds don't need variable-base multiplication.
+    // They take up about 147KB, so they're only built the first time a context is used to commit.
+    //
+    const secp256k1_pedersen_tables* GetPedersenTables() const
+    {
+        std::call_once(m_pedersenTablesBuilt, [this]() {
+            secp256k1_pedersen_tables* pTables = secp256k1_pedersen_tables_create(
+                m_pContext,
+                &secp256k1_generator_const_h,
+                &secp256k1_generator_const_g,
+                &GENERATOR_J_PUB
+            );
+            if (pTables == nullptr) {
+                ThrowCrypto("secp256k1_pedersen_tables_create failed");
+            }
+
+            m_pPedersenTables = pTables;
+        });
+
+        return m_pPedersenTables;
+    }
+
 private:
     secp256k1_context* m_pContext;
     secp256k1_bulletproof_generators* m_pGenerators;
+
+    mutable std::once_flag m_pedersenTablesBuilt;
+    mutable secp256k1_pedersen_tables* m_pPedersenTables;
 };
\ No newline at end of file
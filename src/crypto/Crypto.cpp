@@ -1,6 +1,7 @@
 #include <mw/crypto/Crypto.h>
 #include <mw/exceptions/CryptoException.h>
 #include <mw/common/Logger.h>
+#include <mw/common/ThreadPool.h>
 
 #include <cassert>
 
@@ -15,6 +16,23 @@
 #pragma comment(lib, "crypt32")
 #endif
 
+// Public keys are multiplied, and commitments created, in batches of up to this many.
+// Larger batches barely reduce the cost of the shared inversions.
+static const uint64_t MULTIPLY_BATCH_SIZE = 256;
+static const uint64_t COMMIT_BATCH_SIZE = 256;
+
+// Calls fn(begin, end) for consecutive ranges of up to batch_size items, in parallel on the thread pool.
+template<typename F>
+static void ForEachBatch(const uint64_t num_items, const uint64_t batch_size, const F& fn)
+{
+    const uint64_t num_batches = (num_items + batch_size - 1) / batch_size;
+    ThreadPool::Get().ParallelFor(0, num_batches, 1, [num_items, batch_size, &fn](const uint64_t first, const uint64_t last) {
+        for (uint64_t batch = first; batch < last; batch++) {
+            fn(batch * batch_size, std::min<uint64_t>((batch + 1) * batch_size, num_items));
+        }
+    });
+}
+
 Locked<Context> SECP256K1_CONTEXT(std::make_shared<Context>());
 
 Commitment Crypto::CommitTransparent(const uint64_t value)
@@ -29,6 +47,26 @@ Commitment Crypto::CommitBlinded(
     return Pedersen(SECP256K1_CONTEXT).PedersenCommit(value, blindingFactor);
 }
 
+std::vector<Commitment> Crypto::CommitBlinded(
+    const std::vector<uint64_t>& values,
+    const std::vector<BlindingFactor>& blindingFactors)
+{
+    if (values.size() != blindingFactors.size()) {
+        ThrowCrypto("Number of values and blinding factors don't match.");
+    }
+
+    std::vector<Commitment> commitments(values.size());
+    ForEachBatch(values.size(), COMMIT_BATCH_SIZE, [&values, &blindingFactors, &commitments](const uint64_t begin, const uint64_t end) {
+        std::vector<Commitment> batch = Pedersen(SECP256K1_CONTEXT).PedersenCommits(
+            std::vector<uint64_t>(values.cbegin() + begin, values.cbegin() + end),
+            std::vector<BlindingFactor>(blindingFactors.cbegin() + begin, blindingFactors.cbegin() + end)
+        );
+        std::move(batch.begin(), batch.end(), commitments.begin() + begin);
+    });
+
+    return commitments;
+}
+
 Commitment Crypto::AddCommitments(
     const std::vector<Commitment>& positive,
     const std::vector<Commitment>& negative)
@@ -102,6 +140,24 @@ BlindingFactor Crypto::BlindSwitch(const BlindingFactor& secretKey, const uint64
     return Pedersen(SECP256K1_CONTEXT).BlindSwitch(secretKey, amount);
 }
 
+std::vector<BlindingFactor> Crypto::BlindSwitch(const std::vector<BlindingFactor>& secretKeys, const std::vector<uint64_t>& amounts)
+{
+    if (secretKeys.size() != amounts.size()) {
+        ThrowCrypto("Number of blinding factors and amounts don't match.");
+    }
+
+    std::vector<BlindingFactor> blindSwitches(secretKeys.size());
+    ForEachBatch(secretKeys.size(), COMMIT_BATCH_SIZE, [&secretKeys, &amounts, &blindSwitches](const uint64_t begin, const uint64_t end) {
+        std::vector<BlindingFactor> batch = Pedersen(SECP256K1_CONTEXT).BlindSwitches(
+            std::vector<BlindingFactor>(secretKeys.cbegin() + begin, secretKeys.cbegin() + end),
+            std::vector<uint64_t>(amounts.cbegin() + begin, amounts.cbegin() + end)
+        );
+        std::move(batch.begin(), batch.end(), blindSwitches.begin() + begin);
+    });
+
+    return blindSwitches;
+}
+
 SecretKey Crypto::AddPrivateKeys(const SecretKey& secretKey1, const SecretKey& secretKey2)
 {
     SecretKey result(secretKey1.vec());
@@ -147,4 +203,47 @@ PublicKey Crypto::MultiplyKey(const PublicKey& public_key, const SecretKey& mul)
     }
 
     ThrowCrypto("secp256k1_ec_pubkey_tweak_mul failed");
+}
+
+std::vector<boost::optional<PublicKey>> Crypto::MultiplyKeys(const std::vector<PublicKey>& public_keys, const SecretKey& mul)
+{
+    std::vector<boost::optional<PublicKey>> products(public_keys.size());
+    ForEachBatch(public_keys.size(), MULTIPLY_BATCH_SIZE, [&public_keys, &mul, &products](const uint64_t begin, const uint64_t end) {
+        // Keys that aren't valid points are left out of the batch, so they don't fail the others.
+        std::vector<secp256k1_pubkey> pubkeys;
+        std::vector<uint64_t> indices;
+        for (uint64_t i = begin; i < end; i++) {
+            secp256k1_pubkey pubkey;
+            const int parseResult = secp256k1_ec_pubkey_parse(
+                SECP256K1_CONTEXT.Read()->Get(),
+                &pubkey,
+                public_keys[i].data(),
+                public_keys[i].size()
+            );
+            if (parseResult == 1) {
+                pubkeys.push_back(pubkey);
+                indices.push_back(i);
+            }
+        }
+
+        if (pubkeys.empty()) {
+            return;
+        }
+
+        const int tweakResult = secp256k1_ec_pubkey_tweak_mul_batch(
+            SECP256K1_CONTEXT.Read()->Get(),
+            pubkeys.data(),
+            pubkeys.size(),
+            mul.data()
+        );
+        if (tweakResult != 1) {
+            ThrowCrypto("secp256k1_ec_pubkey_tweak_mul_batch failed");
+        }
+
+        for (size_t i = 0; i < pubkeys.size(); i++) {
+            products[indices[i]] = ConversionUtil(SECP256K1_CONTEXT).ToPublicKey(pubkeys[i]);
+        }
+    });
+
+    return products;
 }
\ No newline at end of file
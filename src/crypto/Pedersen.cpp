@@ -7,20 +7,44 @@
 
 Commitment Pedersen::PedersenCommit(const uint64_t value, const BlindingFactor& blindingFactor) const
 {
-    secp256k1_pedersen_commitment commitment;
-    const int result = secp256k1_pedersen_commit(
-        m_context.Read()->Get(),
-        &commitment,
-        blindingFactor.data(),
-        value,
-        &secp256k1_generator_const_h,
-        &secp256k1_generator_const_g
-    );
-    if (result != 1) {
-        ThrowCrypto("Failed to create commitment.");
+    return PedersenCommits({ value }, { blindingFactor }).front();
+}
+
+std::vector<Commitment> Pedersen::PedersenCommits(const std::vector<uint64_t>& values, const std::vector<BlindingFactor>& blindingFactors) const
+{
+    if (values.size() != blindingFactors.size()) {
+        ThrowCrypto("Number of values and blinding factors don't match.");
     }
 
-    return ConversionUtil(m_context).ToCommitment(commitment);
+    std::vector<const unsigned char*> blinds;
+    blinds.reserve(blindingFactors.size());
+    for (const BlindingFactor& blindingFactor : blindingFactors) {
+        blinds.push_back(blindingFactor.data());
+    }
+
+    std::vector<secp256k1_pedersen_commitment> commitments(values.size());
+    {
+        auto pContext = m_context.Read();
+        const int result = secp256k1_pedersen_commit_batch(
+            pContext->Get(),
+            commitments.data(),
+            pContext->GetPedersenTables(),
+            blinds.data(),
+            values.data(),
+            values.size()
+        );
+        if (result != 1) {
+            ThrowCrypto("Failed to create commitment.");
+        }
+    }
+
+    std::vector<Commitment> out;
+    out.reserve(commitments.size());
+    for (const secp256k1_pedersen_commitment& commitment : commitments) {
+        out.push_back(ConversionUtil(m_context).ToCommitment(commitment));
+    }
+
+    return out;
 }
 
 Commitment Pedersen::PedersenCommitSum(const std::vector<Commitment>& positive, const std::vector<Commitment>& negative) const
@@ -78,19 +102,37 @@ BlindingFactor Pedersen::PedersenBlindSum(const std::vector<BlindingFactor>& pos
 
 BlindingFactor Pedersen::BlindSwitch(const BlindingFactor& blindingFactor, const uint64_t amount) const
 {
-    BlindingFactor blindSwitch;
-    const int result = secp256k1_blind_switch(
-        m_context.Read()->Get(),
-        blindSwitch.data(),
-        blindingFactor.data(),
-        amount,
-        &secp256k1_generator_const_h,
-        &secp256k1_generator_const_g,
-        &GENERATOR_J_PUB
+    return BlindSwitches({ blindingFactor }, { amount }).front();
+}
+
+std::vector<BlindingFactor> Pedersen::BlindSwitches(const std::vector<BlindingFactor>& secretKeys, const std::vector<uint64_t>& amounts) const
+{
+    if (secretKeys.size() != amounts.size()) {
+        ThrowCrypto("Number of blinding factors and amounts don't match.");
+    }
+
+    std::vector<BlindingFactor> blindSwitches(secretKeys.size());
+    std::vector<const unsigned char*> blinds;
+    std::vector<unsigned char*> blindSwitchPtrs;
+    blinds.reserve(secretKeys.size());
+    blindSwitchPtrs.reserve(secretKeys.size());
+    for (size_t i = 0; i < secretKeys.size(); i++) {
+        blinds.push_back(secretKeys[i].data());
+        blindSwitchPtrs.push_back(blindSwitches[i].data());
+    }
+
+    auto pContext = m_context.Read();
+    const int result = secp256k1_blind_switch_batch(
+        pContext->Get(),
+        blindSwitchPtrs.data(),
+        pContext->GetPedersenTables(),
+        blinds.data(),
+        amounts.data(),
+        amounts.size()
     );
     if (result != 1) {
         ThrowCrypto("secp256k1_blind_switch failed");
     }
 
-    return blindSwitch;
-}
\ No newline at end of file
+    return blindSwitches;
+}
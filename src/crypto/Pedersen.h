@@ -16,6 +16,12 @@ public:
         const BlindingFactor& blindingFactor
     ) const;
 
+    // Commits to each value with the blinding factor at the same index.
+    std::vector<Commitment> PedersenCommits(
+        const std::vector<uint64_t>& values,
+        const std::vector<BlindingFactor>& blindingFactors
+    ) const;
+
     Commitment PedersenCommitSum(
         const std::vector<Commitment>& positive,
         const std::vector<Commitment>& negative
@@ -31,6 +37,12 @@ public:
         const uint64_t amount
     ) const;
 
+    // Calculates the switch blind of each secret key with the amount at the same index.
+    std::vector<BlindingFactor> BlindSwitches(
+        const std::vector<BlindingFactor>& secretKeys,
+        const std::vector<uint64_t>& amounts
+    ) const;
+
 private:
     Locked<Context> m_context;
 };
\ No newline at end of file
@@ -1,7 +1,129 @@
 #include <mw/db/CoinDB.h>
+#include <mw/exceptions/DatabaseException.h>
 #include "common/Database.h"
 
 static const DBTable UTXO_TABLE = { 'U', DBTable::Options({ false /* allowDuplicates */ }) };
+static const DBTable PROOF_TABLE = { 'R', DBTable::Options({ false /* allowDuplicates */ }) };
+
+//
+// A UTXO's record in UTXO_TABLE.
+// Since version 1, an output covered by another output's aggregated proof refers to that output by its commitment,
+// and the output carrying the proof is stored once in PROOF_TABLE.
+// Records from before version 1 start with the block height, so their first byte is always 0.
+//
+class UTXORecord : public Traits::ISerializable
+{
+public:
+    static constexpr uint8_t VERSION = 1;
+
+    UTXORecord() = default;
+    UTXORecord(const uint8_t version_in, const uint64_t block_height_in, const uint64_t leaf_idx_in, Output&& output_in)
+        : version(version_in), block_height(block_height_in), leaf_idx(leaf_idx_in), output(std::move(output_in)) { }
+
+    uint8_t version;
+    uint64_t block_height;
+    uint64_t leaf_idx;
+    Output output;
+
+    // The commitment of the output carrying the proof. Only set in version 1 records of outputs without a proof.
+    boost::optional<Commitment> proof_commitment;
+
+    // The output carrying the proof, which records from before version 1 stored inline.
+    std::shared_ptr<const Output> pLegacyProofOutput;
+
+    static UTXORecord From(const UTXO& utxo)
+    {
+        UTXORecord record(VERSION, utxo.GetBlockHeight(), utxo.GetLeafIndex().Get(), Output(utxo.GetOutput()));
+        if (utxo.GetProofOutput() != nullptr) {
+            record.proof_commitment = utxo.GetProofOutput()->GetCommitment();
+        }
+
+        return record;
+    }
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        assert(version == VERSION);
+        serializer
+            .Append<uint8_t>(version)
+            .Append<uint64_t>(block_height)
+            .Append<uint64_t>(leaf_idx)
+            .Append(output);
+
+        if (!output.HasRangeProof()) {
+            assert(proof_commitment.has_value());
+            serializer.Append(*proof_commitment);
+        }
+
+        return serializer;
+    }
+
+    static UTXORecord Deserialize(Deserializer& deserializer)
+    {
+        const uint8_t version = deserializer.Read<uint8_t>();
+        if (version == 0) {
+            // The rest of the old record's block height.
+            uint64_t block_height = 0;
+            for (size_t i = 0; i < sizeof(uint64_t) - 1; i++) {
+                block_height = (block_height << 8) | deserializer.Read<uint8_t>();
+            }
+
+            const uint64_t leaf_idx = deserializer.Read<uint64_t>();
+            UTXORecord record(version, block_height, leaf_idx, Output::Deserialize(deserializer));
+            if (!record.output.HasRangeProof()) {
+                record.pLegacyProofOutput = std::make_shared<const Output>(Output::Deserialize(deserializer));
+            }
+
+            return record;
+        }
+
+        if (version != VERSION) {
+            ThrowDeserialization_F("Unsupported UTXO record version {}", version);
+        }
+
+        const uint64_t block_height = deserializer.Read<uint64_t>();
+        const uint64_t leaf_idx = deserializer.Read<uint64_t>();
+        UTXORecord record(version, block_height, leaf_idx, Output::Deserialize(deserializer));
+        if (!record.output.HasRangeProof()) {
+            record.proof_commitment = Commitment::Deserialize(deserializer);
+        }
+
+        return record;
+    }
+};
+
+//
+// An output carrying an aggregated proof, stored once in PROOF_TABLE for all of the UTXOs it covers.
+// It's removed once the last of them is spent.
+//
+class ProofRecord : public Traits::ISerializable
+{
+public:
+    ProofRecord(const uint64_t num_refs_in, const std::shared_ptr<const Output>& pOutput_in)
+        : num_refs(num_refs_in), pOutput(pOutput_in) { }
+
+    // The number of UTXOs in UTXO_TABLE that refer to the output.
+    uint64_t num_refs;
+    std::shared_ptr<const Output> pOutput;
+
+    Serializer& Serialize(Serializer& serializer) const noexcept final
+    {
+        return serializer
+            .Append<uint64_t>(num_refs)
+            .Append(*pOutput);
+    }
+
+    static ProofRecord Deserialize(Deserializer& deserializer)
+    {
+        const uint64_t num_refs = deserializer.Read<uint64_t>();
+        auto pOutput = std::make_shared<const Output>(Output::Deserialize(deserializer));
+        if (!pOutput->HasAggregatedProof() || !pOutput->HasRangeProof()) {
+            ThrowDeserialization("Proof record doesn't carry an aggregated proof");
+        }
+
+        return ProofRecord(num_refs, pOutput);
+    }
+};
 
 CoinDB::CoinDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch)
     : m_pDatabase(std::make_unique<Database>(pDBWrapper, pBatch)) { }
@@ -12,12 +134,36 @@ std::unordered_map<Commitment, UTXO::CPtr> CoinDB::GetUTXOs(const std::vector<Co
 {
     std::unordered_map<Commitment, UTXO::CPtr> utxos;
 
+    // UTXOs covered by the same proof share the output carrying it.
+    std::unordered_map<Commitment, std::shared_ptr<const Output>> proof_outputs;
+
     for (const Commitment& commitment : commitments)
     {
-        auto pUTXO = m_pDatabase->Get<UTXO>(UTXO_TABLE, commitment.ToHex());
-        if (pUTXO != nullptr) {
-            utxos.insert({ commitment, pUTXO->item });
+        auto pRecord = m_pDatabase->Get<UTXORecord>(UTXO_TABLE, commitment.ToHex());
+        if (pRecord == nullptr) {
+            continue;
         }
+
+        const UTXORecord& record = *pRecord->item;
+        std::shared_ptr<const Output> pProofOutput = record.pLegacyProofOutput;
+        if (record.proof_commitment) {
+            auto iter = proof_outputs.find(*record.proof_commitment);
+            if (iter == proof_outputs.end()) {
+                auto pProof = GetProof(*record.proof_commitment);
+                if (pProof == nullptr) {
+                    ThrowDatabase_F("Proof output {} not found for UTXO {}", *record.proof_commitment, commitment);
+                }
+
+                iter = proof_outputs.insert({ *record.proof_commitment, pProof->pOutput }).first;
+            }
+
+            pProofOutput = iter->second;
+        }
+
+        utxos.insert({
+            commitment,
+            std::make_shared<UTXO>(record.block_height, mmr::LeafIndex::At(record.leaf_idx), record.output, std::move(pProofOutput))
+        });
     }
 
     return utxos;
@@ -25,20 +171,47 @@ std::unordered_map<Commitment, UTXO::CPtr> CoinDB::GetUTXOs(const std::vector<Co
 
 void CoinDB::AddUTXOs(const std::vector<UTXO::CPtr>& utxos)
 {
-    std::vector<DBEntry<UTXO>> entries;
-    std::transform(
-        utxos.cbegin(), utxos.cend(),
-        std::back_inserter(entries),
-        [](const UTXO::CPtr& pUTXO) { return DBEntry<UTXO>(pUTXO->GetCommitment().ToHex(), pUTXO); }
-    );
+    std::vector<DBEntry<UTXORecord>> entries;
+    std::unordered_map<Commitment, ProofRecord> added_refs;
+    for (const UTXO::CPtr& pUTXO : utxos)
+    {
+        entries.push_back(DBEntry<UTXORecord>(pUTXO->GetCommitment().ToHex(), UTXORecord::From(*pUTXO)));
+
+        const std::shared_ptr<const Output>& pProofOutput = pUTXO->GetProofOutput();
+        if (pProofOutput != nullptr) {
+            auto iter = added_refs.insert({ pProofOutput->GetCommitment(), ProofRecord(0, pProofOutput) }).first;
+            iter->second.num_refs++;
+        }
+    }
 
     m_pDatabase->Put(UTXO_TABLE, entries);
+
+    for (const auto& added : added_refs)
+    {
+        auto pExisting = GetProof(added.first);
+        const uint64_t num_refs = added.second.num_refs + (pExisting != nullptr ? pExisting->num_refs : 0);
+        SaveProof(added.first, ProofRecord(num_refs, added.second.pOutput));
+    }
 }
 
 void CoinDB::RemoveUTXOs(const std::vector<Commitment>& commitments)
 {
     for (const Commitment& commitment : commitments)
     {
+        auto pRecord = m_pDatabase->Get<UTXORecord>(UTXO_TABLE, commitment.ToHex());
+        if (pRecord != nullptr && pRecord->item->proof_commitment) {
+            const Commitment& proof_commitment = *pRecord->item->proof_commitment;
+            auto pProof = GetProof(proof_commitment);
+            if (pProof != nullptr) {
+                if (pProof->num_refs > 1) {
+                    SaveProof(proof_commitment, ProofRecord(pProof->num_refs - 1, pProof->pOutput));
+                } else {
+                    m_pDatabase->Delete(PROOF_TABLE, proof_commitment.ToHex());
+                    m_removedProofs.insert(proof_commitment);
+                }
+            }
+        }
+
         m_pDatabase->Delete(UTXO_TABLE, commitment.ToHex());
     }
 }
@@ -46,4 +219,22 @@ void CoinDB::RemoveUTXOs(const std::vector<Commitment>& commitments)
 void CoinDB::RemoveAllUTXOs()
 {
     m_pDatabase->DeleteAll(UTXO_TABLE);
-}
\ No newline at end of file
+    m_pDatabase->DeleteAll(PROOF_TABLE);
+}
+
+std::shared_ptr<const ProofRecord> CoinDB::GetProof(const Commitment& commitment) const
+{
+    // A batch only tracks what was written to it, so a record removed in it would still be read from the DB.
+    if (m_removedProofs.find(commitment) != m_removedProofs.end()) {
+        return nullptr;
+    }
+
+    auto pEntry = m_pDatabase->Get<ProofRecord>(PROOF_TABLE, commitment.ToHex());
+    return pEntry != nullptr ? pEntry->item : nullptr;
+}
+
+void CoinDB::SaveProof(const Commitment& commitment, const ProofRecord& proof)
+{
+    m_pDatabase->Put(PROOF_TABLE, std::vector<DBEntry<ProofRecord>>{ DBEntry<ProofRecord>(commitment.ToHex(), proof) });
+    m_removedProofs.erase(commitment);
+}
@@ -44,4 +44,4 @@ void LeafDB::Remove(const std::vector<mmr::LeafIndex>& indices)
 void LeafDB::RemoveAll()
 {
     m_pDatabase->DeleteAll(m_prefix);
-}
\ No newline at end of file
+}
@@ -0,0 +1,24 @@
+#include <mw/db/LeafPruneDB.h>
+#include "common/Database.h"
+
+static const DBTable PRUNE_TABLE = { 'P', DBTable::Options({ false /* allowDuplicates */ }) };
+static const std::string PRUNE_STATE_KEY = "output";
+
+LeafPruneDB::LeafPruneDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch)
+    : m_pDatabase(std::make_unique<Database>(pDBWrapper, pBatch)) { }
+
+LeafPruneDB::~LeafPruneDB() { }
+
+std::unique_ptr<LeafPruneState> LeafPruneDB::Get() const
+{
+    auto pEntry = m_pDatabase->Get<LeafPruneState>(PRUNE_TABLE, PRUNE_STATE_KEY);
+    return pEntry != nullptr ? std::make_unique<LeafPruneState>(*pEntry->item) : nullptr;
+}
+
+void LeafPruneDB::Save(const LeafPruneState& state)
+{
+    std::vector<DBEntry<LeafPruneState>> entries{
+        DBEntry<LeafPruneState>(PRUNE_STATE_KEY, state)
+    };
+    m_pDatabase->Put(PRUNE_TABLE, entries);
+}
@@ -0,0 +1,29 @@
+#include <mw/db/StateApplyDB.h>
+#include "common/Database.h"
+
+static const DBTable APPLY_TABLE = { 'A', DBTable::Options({ false /* allowDuplicates */ }) };
+static const std::string PROGRESS_KEY = "progress";
+
+StateApplyDB::StateApplyDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch)
+    : m_pDatabase(std::make_unique<Database>(pDBWrapper, pBatch)) { }
+
+StateApplyDB::~StateApplyDB() { }
+
+std::unique_ptr<mw::StateApplyProgress> StateApplyDB::Get() const
+{
+    auto pEntry = m_pDatabase->Get<mw::StateApplyProgress>(APPLY_TABLE, PROGRESS_KEY);
+    return pEntry != nullptr ? std::make_unique<mw::StateApplyProgress>(*pEntry->item) : nullptr;
+}
+
+void StateApplyDB::Save(const mw::StateApplyProgress& progress)
+{
+    std::vector<DBEntry<mw::StateApplyProgress>> entries{
+        DBEntry<mw::StateApplyProgress>(PROGRESS_KEY, progress)
+    };
+    m_pDatabase->Put(APPLY_TABLE, entries);
+}
+
+void StateApplyDB::Remove()
+{
+    m_pDatabase->Delete(APPLY_TABLE, PROGRESS_KEY);
+}
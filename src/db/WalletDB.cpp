@@ -0,0 +1,86 @@
+#include <mw/db/WalletDB.h>
+#include "common/Database.h"
+
+static const DBTable SCAN_TABLE = { 'S', DBTable::Options({ false /* allowDuplicates */ }) };
+static const DBTable WALLET_COIN_TABLE = { 'W', DBTable::Options({ false /* allowDuplicates */ }) };
+static const std::string CURSOR_KEY = "cursor";
+
+WalletDB::WalletDB(libmw::IDBWrapper* pDBWrapper, libmw::IDBBatch* pBatch)
+    : m_pDatabase(std::make_unique<Database>(pDBWrapper, pBatch)) { }
+
+WalletDB::~WalletDB() { }
+
+std::unique_ptr<mw::ScanCursor> WalletDB::GetCursor() const
+{
+    auto pEntry = m_pDatabase->Get<mw::ScanCursor>(SCAN_TABLE, CURSOR_KEY);
+    return pEntry != nullptr ? std::make_unique<mw::ScanCursor>(*pEntry->item) : nullptr;
+}
+
+void WalletDB::SaveCursor(const mw::ScanCursor& cursor)
+{
+    m_pDatabase->Put(SCAN_TABLE, std::vector<DBEntry<mw::ScanCursor>>{ DBEntry<mw::ScanCursor>(CURSOR_KEY, cursor) });
+}
+
+void WalletDB::RemoveCursor()
+{
+    if (GetCursor() != nullptr) {
+        m_pDatabase->Delete(SCAN_TABLE, CURSOR_KEY);
+    }
+}
+
+std::unique_ptr<mw::WalletCoin> WalletDB::GetCoin(const Commitment& commitment) const
+{
+    auto pEntry = m_pDatabase->Get<mw::WalletCoin>(WALLET_COIN_TABLE, commitment.ToHex());
+    return pEntry != nullptr ? std::make_unique<mw::WalletCoin>(*pEntry->item) : nullptr;
+}
+
+std::vector<mw::WalletCoin> WalletDB::GetCoins() const
+{
+    std::vector<mw::WalletCoin> coins;
+
+    auto iter = m_pDatabase->m_pDB->NewIterator();
+    iter->Seek(std::string(1, WALLET_COIN_TABLE.GetPrefix()));
+    std::string key;
+    while (iter->Valid() && iter->GetKey(key) && !key.empty() && key.front() == WALLET_COIN_TABLE.GetPrefix()) {
+        std::vector<uint8_t> value;
+        if (m_pDatabase->m_pDB->Read(key, value)) {
+            Deserializer deserializer(std::move(value));
+            coins.push_back(mw::WalletCoin::Deserialize(deserializer));
+        }
+
+        iter->Next();
+    }
+
+    return coins;
+}
+
+void WalletDB::AddCoins(const std::vector<mw::WalletCoin>& coins)
+{
+    if (coins.empty()) {
+        return;
+    }
+
+    std::vector<DBEntry<mw::WalletCoin>> entries;
+    std::transform(
+        coins.cbegin(), coins.cend(),
+        std::back_inserter(entries),
+        [](const mw::WalletCoin& coin) { return DBEntry<mw::WalletCoin>(Commitment(coin.coin.commitment).ToHex(), coin); }
+    );
+
+    m_pDatabase->Put(WALLET_COIN_TABLE, entries);
+}
+
+bool WalletDB::RemoveCoin(const Commitment& commitment)
+{
+    if (GetCoin(commitment) == nullptr) {
+        return false;
+    }
+
+    m_pDatabase->Delete(WALLET_COIN_TABLE, commitment.ToHex());
+    return true;
+}
+
+void WalletDB::RemoveAllCoins()
+{
+    m_pDatabase->DeleteAll(WALLET_COIN_TABLE);
+}
\ No newline at end of file
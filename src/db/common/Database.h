@@ -84,7 +84,7 @@ public:
         auto pBatch = m_pDB->CreateBatch();
 
         auto iter = m_pDB->NewIterator();
-        iter->Seek(std::to_string(table.GetPrefix()));
+        iter->Seek(std::string(1, table.GetPrefix()));
         while (iter->Valid()) {
             std::string key;
             if (iter->GetKey(key) && !key.empty() && key.front() == table.GetPrefix()) {
@@ -8,9 +8,9 @@
 LIBMW_NAMESPACE
 MINER_NAMESPACE
 
-MWEXPORT libmw::BlockBuilderRef NewBuilder(const uint64_t height, const libmw::CoinsViewRef& view)
+MWEXPORT libmw::BlockBuilderRef NewBuilder(const uint64_t height, const libmw::CoinsViewRef& view, const bool cut_through)
 {
-    return libmw::BlockBuilderRef{ std::make_shared<mw::BlockBuilder>(height, view.pCoinsView) };
+    return libmw::BlockBuilderRef{ std::make_shared<mw::BlockBuilder>(height, view.pCoinsView, libmw::MAX_BLOCK_WEIGHT, cut_through) };
 }
 
 MWEXPORT bool AddTransaction(
@@ -30,6 +30,31 @@ MWEXPORT bool AddTransaction(
     return false;
 }
 
+MWEXPORT bool AddCandidate(
+    const libmw::BlockBuilderRef& builder,
+    const libmw::TxRef& transaction,
+    const std::vector<libmw::PegIn>& pegins)
+{
+    assert(builder.pBuilder != nullptr);
+    assert(transaction.pTransaction != nullptr);
+
+    try {
+        return builder.pBuilder->AddCandidate(transaction.pTransaction, TransformPegIns(pegins));
+    } catch (std::exception& e) {
+        LOG_DEBUG_F("Failed to add candidate {}. Error: {}", transaction.pTransaction, e.what());
+    }
+
+    return false;
+}
+
+MWEXPORT bool RemoveTransaction(const libmw::BlockBuilderRef& builder, const libmw::TxRef& transaction)
+{
+    assert(builder.pBuilder != nullptr);
+    assert(transaction.pTransaction != nullptr);
+
+    return builder.pBuilder->RemoveTransaction(transaction.pTransaction->GetHash());
+}
+
 MWEXPORT libmw::BlockRef BuildBlock(const libmw::BlockBuilderRef& builder)
 {
     return libmw::BlockRef{ builder.pBuilder->BuildBlock() };
@@ -3,7 +3,6 @@
 #include "Transformers.h"
 
 #include <mw/common/Logger.h>
-#include <mw/consensus/ChainParams.h>
 #include <mw/exceptions/ValidationException.h>
 #include <mw/models/block/Block.h>
 #include <mw/models/block/BlockUndo.h>
@@ -11,12 +10,30 @@
 #include <mw/models/tx/UTXO.h>
 #include <mw/node/INode.h>
 #include <mw/node/Snapshot.h>
+#include <mw/node/validation/TxAcceptor.h>
+#include <mw/node/validation/VerificationService.h>
 #include <mw/node/State.h>
 #include <mw/wallet/Wallet.h>
 #include <numeric>
 
 static mw::INode::Ptr NODE = nullptr;
 
+// Logs why the transaction is invalid, like CheckTransaction and CheckTxInputs, before passing the result on.
+static TxAcceptor::Callback ToAcceptorCallback(const libmw::TxRef& transaction, const libmw::node::TxCallback& callback)
+{
+    return [transaction, callback](const std::exception_ptr& error) {
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                LOG_ERROR_F("Failed to validate {}. Error: {}", transaction.pTransaction->Print(), e);
+            }
+        }
+
+        callback(transaction, error == nullptr);
+    };
+}
+
 LIBMW_NAMESPACE
 NODE_NAMESPACE
 
@@ -27,7 +44,13 @@ MWEXPORT libmw::CoinsViewRef Initialize(
     const std::function<void(const std::string&)>& log_callback)
 {
     LoggerAPI::Initialize(log_callback);
-    NODE = mw::InitializeNode(FilePath{ chainParams.dataDirectory.native() }, chainParams.hrp, header.pHeader, pDBWrapper);
+    NODE = mw::InitializeNode(
+        FilePath{ chainParams.dataDirectory.native() },
+        chainParams.hrp,
+        header.pHeader,
+        pDBWrapper,
+        chainParams.pruneHorizon
+    );
 
     return libmw::CoinsViewRef{ NODE->GetDBView() };
 }
@@ -47,10 +70,30 @@ MWEXPORT libmw::CoinsViewRef ApplyState(
         pCoinsDB,
         pChain,
         stateHeader.pHeader,
-        state.pState->utxos,
-        state.pState->kernels,
         state.pState->leafset,
-        state.pState->pruned_parent_hashes
+        mw::Snapshot::Stream(state.pState)
+    );
+
+    return libmw::CoinsViewRef{ pCoinsViewDB };
+}
+
+MWEXPORT libmw::CoinsViewRef ApplyStateSnapshot(
+    const libmw::IChain::Ptr& pChain,
+    const libmw::IDBWrapper::Ptr& pCoinsDB,
+    const libmw::HeaderRef& stateHeader,
+    const boost::filesystem::path& snapshot_path)
+{
+    mw::SnapshotFile snapshot = mw::SnapshotFile::Open(FilePath{ snapshot_path.native() });
+    if (snapshot.GetManifest().header_hash != stateHeader.pHeader->GetHash()) {
+        ThrowValidation(EConsensusError::MMR_MISMATCH);
+    }
+
+    auto pCoinsViewDB = NODE->ApplyState(
+        pCoinsDB,
+        pChain,
+        stateHeader.pHeader,
+        snapshot.GetManifest().leafset,
+        snapshot.Stream()
     );
 
     return libmw::CoinsViewRef{ pCoinsViewDB };
@@ -103,12 +146,21 @@ MWEXPORT libmw::StateRef SnapshotState(const libmw::CoinsViewRef& view)
     return { std::make_shared<mw::State>(mw::Snapshot::Build(view.pCoinsView)) };
 }
 
+MWEXPORT void WriteStateSnapshot(const libmw::CoinsViewRef& view, const boost::filesystem::path& snapshot_path)
+{
+    assert(view.pCoinsView != nullptr);
+    mw::Snapshot::Write(view.pCoinsView, FilePath{ snapshot_path.native() });
+}
+
 MWEXPORT bool CheckTransaction(const libmw::TxRef& transaction)
 {
     assert(transaction.pTransaction != nullptr);
 
     try {
-        transaction.pTransaction->Validate();
+        // Verify doesn't wait out the batch window, so a lone caller isn't held back.
+        const mw::Transaction& tx = *transaction.pTransaction;
+        tx.ValidateStructureAndSums();
+        VerificationService::Get().Verify(tx.GetBody().BuildSignedMessages(), tx.GetBody().BuildProofData());
         return true;
     } catch (const std::exception& e) {
         LOG_ERROR_F("Failed to validate {}. Error: {}", transaction.pTransaction->Print(), e);
@@ -123,17 +175,11 @@ MWEXPORT bool CheckTxInputs(const libmw::CoinsViewRef& view, const libmw::TxRef&
     assert(transaction.pTransaction != nullptr);
 
     try {
-        for (const Input& input : transaction.pTransaction->GetInputs()) {
-            auto utxos = view.pCoinsView->GetUTXOs(input.GetCommitment());
-            if (utxos.empty()) {
-                ThrowValidation(EConsensusError::UTXO_MISSING);
-            }
-
-            if (utxos.back()->IsPeggedIn() && nSpendHeight < utxos.back()->GetBlockHeight() + mw::ChainParams::GetPegInMaturity()) {
-                ThrowValidation(EConsensusError::PEGIN_MATURITY);
-            }
-        }
-
+        TxAcceptor::CheckInputs(
+            *transaction.pTransaction,
+            view.pCoinsView->LookupUTXOs(transaction.pTransaction->GetInputCommits()),
+            nSpendHeight
+        );
         return true;
     } catch (const std::exception& e) {
         LOG_ERROR_F("Failed to validate: {}. Error: {}", transaction.pTransaction->Print(), e);
@@ -142,6 +188,43 @@ MWEXPORT bool CheckTxInputs(const libmw::CoinsViewRef& view, const libmw::TxRef&
     return false;
 }
 
+MWEXPORT bool SubmitTransaction(
+    const libmw::CoinsViewRef& view,
+    const libmw::TxRef& transaction,
+    uint64_t nSpendHeight,
+    const TxCallback& callback)
+{
+    assert(view.pCoinsView != nullptr);
+    assert(transaction.pTransaction != nullptr);
+
+    return TxAcceptor::Get().TrySubmit(
+        view.pCoinsView,
+        transaction.pTransaction,
+        nSpendHeight,
+        ToAcceptorCallback(transaction, callback)
+    );
+}
+
+MWEXPORT std::future<bool> SubmitTransaction(
+    const libmw::CoinsViewRef& view,
+    const libmw::TxRef& transaction,
+    uint64_t nSpendHeight)
+{
+    assert(view.pCoinsView != nullptr);
+    assert(transaction.pTransaction != nullptr);
+
+    auto pPromise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = pPromise->get_future();
+    TxAcceptor::Get().Submit(
+        view.pCoinsView,
+        transaction.pTransaction,
+        nSpendHeight,
+        ToAcceptorCallback(transaction, [pPromise](const libmw::TxRef&, bool valid) { pPromise->set_value(valid); })
+    );
+
+    return result;
+}
+
 MWEXPORT bool HasCoin(const libmw::CoinsViewRef& view, const libmw::Commitment& commitment)
 {
     assert(view.pCoinsView != nullptr);
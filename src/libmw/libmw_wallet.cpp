@@ -2,10 +2,13 @@
 
 #include "Transformers.h"
 
+#include <mw/common/Logger.h>
+#include <mw/exceptions/DeserializationException.h>
 #include <mw/models/tx/Transaction.h>
 #include <mw/wallet/Keychain.h>
 #include <mw/wallet/Transact.h>
 #include <mw/wallet/Wallet.h>
+#include <mw/wallet/WalletScanner.h>
 
 LIBMW_NAMESPACE
 
@@ -16,30 +19,45 @@ MWEXPORT libmw::MWEBAddress KeychainRef::GetAddress(const uint32_t index)
     return TransformAddress(pKeychain->GetStealthAddress(index));
 }
 
+MWEXPORT std::vector<uint8_t> KeychainRef::SerializeSpendPubKeys() const
+{
+    assert(pKeychain != nullptr);
+
+    return pKeychain->SerializeSpendPubKeys();
+}
+
 WALLET_NAMESPACE
 
 MWEXPORT libmw::KeychainRef LoadKeychain(
     const libmw::PrivateKey& scan_key,
     const libmw::PrivateKey& spend_key,
-    const uint32_t address_index_counter)
+    const uint32_t address_index_counter,
+    const std::vector<uint8_t>& spend_pubkeys)
 {
     auto pKeychain = std::make_shared<mw::Keychain>(
         scan_key,
         spend_key,
         address_index_counter
     );
+
+    if (!spend_pubkeys.empty()) {
+        try {
+            pKeychain->LoadSpendPubKeys(spend_pubkeys);
+        } catch (const DeserializationException& e) {
+            // They're only a cache, so they'll be derived again instead.
+            LOG_WARNING_F("Failed to load spend pubkeys: {}", e.what());
+        }
+    }
+
     return libmw::KeychainRef{ pKeychain };
 }
 
-MWEXPORT libmw::TxRef CreateTx(
-    const std::vector<libmw::Coin>& input_coins,
+// Splits the recipients into MWEB outputs and pegouts.
+static void SplitRecipients(
     const std::vector<libmw::Recipient>& recipients,
-    const boost::optional<uint64_t>& pegin_amount,
-    const uint64_t fee)
+    std::vector<std::pair<uint64_t, StealthAddress>>& receivers,
+    std::vector<PegOutCoin>& pegouts)
 {
-    std::vector<std::pair<uint64_t, StealthAddress>> receivers;
-    std::vector<PegOutCoin> pegouts;
-
     for (const libmw::Recipient& recipient : recipients) {
         if (recipient.which() == 0) {
             const libmw::MWEBRecipient& mweb_recipient = boost::get<libmw::MWEBRecipient>(recipient);
@@ -52,8 +70,49 @@ MWEXPORT libmw::TxRef CreateTx(
             pegouts.push_back(PegOutCoin(pegout_recipient.amount, pegout_recipient.scriptPubKey));
         }
     }
+}
 
-    mw::Transaction::CPtr pTransaction = Transact::CreateTx(input_coins, receivers, pegouts, pegin_amount, fee);
+MWEXPORT libmw::TxRef CreateTx(
+    const std::vector<libmw::Coin>& input_coins,
+    const std::vector<libmw::Recipient>& recipients,
+    const boost::optional<uint64_t>& pegin_amount,
+    const uint64_t fee,
+    const bool aggregate_proofs)
+{
+    std::vector<std::pair<uint64_t, StealthAddress>> receivers;
+    std::vector<PegOutCoin> pegouts;
+    SplitRecipients(recipients, receivers, pegouts);
+
+    mw::Transaction::CPtr pTransaction = Transact::CreateTx(input_coins, receivers, pegouts, pegin_amount, fee, aggregate_proofs);
+    return libmw::TxRef{ pTransaction };
+}
+
+MWEXPORT libmw::TxRef Send(
+    const libmw::KeychainRef& keychain,
+    const std::vector<libmw::Coin>& available_coins,
+    const std::vector<libmw::Recipient>& recipients,
+    const uint64_t fee_rate,
+    std::vector<libmw::Coin>& spent_coins_out,
+    const bool aggregate_proofs)
+{
+    assert(keychain.pKeychain != nullptr);
+
+    std::vector<std::pair<uint64_t, StealthAddress>> receivers;
+    std::vector<PegOutCoin> pegouts;
+    SplitRecipients(recipients, receivers, pegouts);
+
+    CoinSelection::Result selection;
+    mw::Transaction::CPtr pTransaction = Transact::Send(
+        keychain.pKeychain,
+        available_coins,
+        receivers,
+        pegouts,
+        fee_rate,
+        selection,
+        aggregate_proofs
+    );
+
+    spent_coins_out = std::move(selection.inputs);
     return libmw::TxRef{ pTransaction };
 }
 
@@ -99,5 +158,49 @@ MWEXPORT bool RewindTxOutput(
     return false;
 }
 
+MWEXPORT std::vector<libmw::Coin> ScanBlock(
+    const libmw::KeychainRef& keychain,
+    const libmw::BlockRef& block)
+{
+    assert(keychain.pKeychain != nullptr);
+    assert(block.pBlock != nullptr);
+
+    return Wallet(keychain.pKeychain).ScanOutputs(block.pBlock->GetOutputs());
+}
+
+MWEXPORT std::vector<libmw::Coin> ScanChain(
+    const libmw::KeychainRef& keychain,
+    const libmw::IChain::Ptr& pChain,
+    const libmw::IDBWrapper::Ptr& pWalletDB)
+{
+    assert(keychain.pKeychain != nullptr);
+    assert(pChain != nullptr);
+    assert(pWalletDB != nullptr);
+
+    return WalletScanner(keychain.pKeychain, pWalletDB).ScanChain(pChain);
+}
+
+MWEXPORT void DisconnectBlock(
+    const libmw::KeychainRef& keychain,
+    const libmw::BlockUndoRef& undo,
+    const libmw::IDBWrapper::Ptr& pWalletDB)
+{
+    assert(keychain.pKeychain != nullptr);
+    assert(undo.pUndo != nullptr);
+    assert(pWalletDB != nullptr);
+
+    WalletScanner(keychain.pKeychain, pWalletDB).DisconnectBlock(undo.pUndo);
+}
+
+MWEXPORT std::vector<libmw::Coin> GetCoins(
+    const libmw::KeychainRef& keychain,
+    const libmw::IDBWrapper::Ptr& pWalletDB)
+{
+    assert(keychain.pKeychain != nullptr);
+    assert(pWalletDB != nullptr);
+
+    return WalletScanner(keychain.pKeychain, pWalletDB).GetCoins();
+}
+
 END_NAMESPACE // wallet
 END_NAMESPACE // libmw
\ No newline at end of file
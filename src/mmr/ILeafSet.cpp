@@ -61,17 +61,16 @@ uint8_t ILeafSet::BitToByte(const uint8_t bit) const
 
 BitSet ILeafSet::ToBitSet() const
 {
-	BitSet bitset(GetNextLeafIdx().Get());
+	// Bytes are read whole, since the leafset uses the same bit order as BitSet::From.
+	const uint64_t numBytes = (m_nextLeafIdx.GetLeafIndex() + 7) / 8;
 
-	mmr::LeafIndex idx = mmr::LeafIndex::At(0);
-	while (idx < GetNextLeafIdx()) {
-		if (Contains(idx)) {
-			bitset.set(idx.Get());
-		}
-
-		++idx;
+	std::vector<uint8_t> bytes(numBytes);
+	for (uint64_t byte_idx = 0; byte_idx < numBytes; byte_idx++) {
+		bytes[byte_idx] = GetByte(byte_idx);
 	}
 
+	BitSet bitset = BitSet::From(bytes);
+	bitset.bitset.resize(m_nextLeafIdx.GetLeafIndex());
 	return bitset;
 }
 
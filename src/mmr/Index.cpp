@@ -8,6 +8,13 @@ Index Index::At(const uint64_t position) noexcept
     return Index(position, CalculateHeight(position));
 }
 
+Index Index::AtHeight(const uint64_t height, const uint64_t n) noexcept
+{
+    // Nodes up to and including this one are the (n + 1) subtrees of height 'height', each with (2^(height + 1) - 1) nodes,
+    // plus the (n - CountBitsSet(n)) higher nodes that were completed by the n subtrees to the left.
+    return Index(((n + 1) << (height + 1)) - 2 - BitUtil::CountBitsSet(n), height);
+}
+
 uint64_t Index::GetLeafIndex() const noexcept
 {
     assert(IsLeaf());
@@ -0,0 +1,177 @@
+#include <mw/mmr/MMRBuilder.h>
+#include <mw/mmr/MMRUtil.h>
+#include <mw/mmr/Node.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/exceptions/ValidationException.h>
+#include <array>
+#include <atomic>
+
+using namespace mmr;
+
+// Hashes are buffered and appended to the file once at least this many bytes are waiting.
+static const size_t FLUSH_SIZE = 4 * 1024 * 1024;
+
+// Hashing is cheap, so heights with fewer nodes than this aren't split up.
+static const uint64_t MIN_NODES_PER_TASK = 4096;
+
+MMRBuilder::MMRBuilder(const FilePath& hash_file_path, const BitSet& unspent_leaf_indices)
+    : m_hashFile(hash_file_path),
+    m_leafset(unspent_leaf_indices),
+    m_prunedParents(MMRUtil::CalcPrunedParents(unspent_leaf_indices)),
+    m_nextLeafIdx(LeafIndex::At(0))
+{
+    if (m_hashFile.Exists()) {
+        m_hashFile.GetPath().Remove();
+    }
+
+    m_hashFile.Create();
+}
+
+void MMRBuilder::Add(
+    const LeafIndex& next_leaf_idx,
+    const std::vector<Leaf>& unspent_leaves,
+    const std::vector<mw::Hash>& pruned_parent_hashes)
+{
+    if (next_leaf_idx < m_nextLeafIdx || next_leaf_idx.Get() > m_leafset.size()) {
+        ThrowValidation(EConsensusError::MMR_MISMATCH);
+    }
+
+    const uint64_t first_leaf = m_nextLeafIdx.Get();
+    const uint64_t end_leaf = next_leaf_idx.Get();
+    const uint64_t first_pos = m_nextLeafIdx.GetPosition();
+    const uint64_t end_pos = next_leaf_idx.GetPosition();
+
+    //
+    // The range's positions are the nodes whose last leaf is in the range, which at height h
+    // are nodes [first_leaf >> h, end_leaf >> h). Each hash goes in the slot for its position,
+    // so all nodes of the same height can be calculated concurrently once the height below them is complete.
+    //
+    std::vector<boost::optional<mw::Hash>> hashes(end_pos - first_pos);
+    auto get_slot = [&hashes, first_pos](const Index& index) -> boost::optional<mw::Hash>& {
+        return hashes[index.GetPosition() - first_pos];
+    };
+
+    auto leaf_iter = unspent_leaves.cbegin();
+    for (uint64_t leaf_idx = first_leaf; leaf_idx < end_leaf; leaf_idx++) {
+        if (m_leafset.test(leaf_idx)) {
+            if (leaf_iter == unspent_leaves.cend() || leaf_iter->GetLeafIndex().Get() != leaf_idx) {
+                ThrowValidation(EConsensusError::MMR_MISMATCH);
+            }
+
+            get_slot(Index::AtHeight(0, leaf_idx)) = leaf_iter->GetHash();
+            ++leaf_iter;
+        }
+    }
+
+    auto hash_iter = pruned_parent_hashes.cbegin();
+    for (uint64_t pos = first_pos; pos < end_pos; pos++) {
+        if (m_prunedParents.test(pos)) {
+            if (hash_iter == pruned_parent_hashes.cend()) {
+                ThrowValidation(EConsensusError::MMR_MISMATCH);
+            }
+
+            hashes[pos - first_pos] = *hash_iter;
+            ++hash_iter;
+        }
+    }
+
+    if (leaf_iter != unspent_leaves.cend() || hash_iter != pruned_parent_hashes.cend()) {
+        ThrowValidation(EConsensusError::MMR_MISMATCH);
+    }
+
+    // The peaks left by earlier ranges, one for each bit set in first_leaf, from the highest to the lowest.
+    std::array<const boost::optional<mw::Hash>*, 64> prev_peaks{};
+    size_t peak_idx = 0;
+    for (int height = 63; height >= 0; height--) {
+        if ((first_leaf >> height) & 1) {
+            prev_peaks[height] = &m_peaks[peak_idx++];
+        }
+    }
+    assert(peak_idx == m_peaks.size());
+
+    // A child that's not in the range is the earlier peak at its height.
+    auto get_child = [&](const uint64_t height, const uint64_t n) -> const boost::optional<mw::Hash>& {
+        if (n >= (first_leaf >> height)) {
+            return get_slot(Index::AtHeight(height, n));
+        }
+
+        assert(n + 1 == (first_leaf >> height) && prev_peaks[height] != nullptr);
+        return *prev_peaks[height];
+    };
+
+    std::atomic<bool> mismatch(false);
+    for (uint64_t height = 1; (end_leaf >> height) > 0; height++) {
+        const uint64_t begin_node = first_leaf >> height;
+        const uint64_t end_node = end_leaf >> height;
+        ThreadPool::Get().ParallelFor(begin_node, end_node, MIN_NODES_PER_TASK, [&](const uint64_t begin, const uint64_t end) {
+            for (uint64_t n = begin; n < end; n++) {
+                const Index index = Index::AtHeight(height, n);
+                const boost::optional<mw::Hash>& left_hash = get_child(height - 1, 2 * n);
+                const boost::optional<mw::Hash>& right_hash = get_child(height - 1, (2 * n) + 1);
+                if (!left_hash || !right_hash) {
+                    continue;
+                }
+
+                // A pruned parent's hash is supplied because its children's aren't.
+                if (m_prunedParents.test(index.GetPosition())) {
+                    mismatch = true;
+                } else {
+                    get_slot(index) = Node::CalcParentHash(index, *left_hash, *right_hash);
+                }
+            }
+        });
+    }
+
+    if (mismatch) {
+        ThrowValidation(EConsensusError::MMR_MISMATCH);
+    }
+
+    for (const boost::optional<mw::Hash>& hash : hashes) {
+        if (hash) {
+            m_buffer.insert(m_buffer.end(), hash->vec().cbegin(), hash->vec().cend());
+        }
+    }
+
+    std::vector<boost::optional<mw::Hash>> peaks;
+    for (int height = 63; height >= 0; height--) {
+        if ((end_leaf >> height) & 1) {
+            peaks.push_back(get_child(height, (end_leaf >> height) - 1));
+        }
+    }
+
+    m_peaks = std::move(peaks);
+    m_nextLeafIdx = next_leaf_idx;
+
+    if (m_buffer.size() >= FLUSH_SIZE) {
+        Flush();
+    }
+}
+
+mw::Hash MMRBuilder::Root() const
+{
+    if (m_peaks.empty()) {
+        return ZERO_HASH;
+    }
+
+    // Every range ends at a leaf, so only peaks are left in m_peaks.
+    const Index root_index = Index::At(m_nextLeafIdx.GetPosition());
+
+    boost::optional<mw::Hash> root;
+    for (auto iter = m_peaks.crbegin(); iter != m_peaks.crend(); iter++) {
+        if (!*iter) {
+            ThrowValidation(EConsensusError::MMR_MISMATCH);
+        }
+
+        root = root ? Node::CalcParentHash(root_index, **iter, *root) : **iter;
+    }
+
+    return *root;
+}
+
+void MMRBuilder::Flush()
+{
+    if (!m_buffer.empty()) {
+        m_hashFile.Write(m_buffer);
+        m_buffer.clear();
+    }
+}
@@ -23,9 +23,7 @@ FilePath PruneList::GetPath(const FilePath& dir, const uint32_t file_index)
 
 uint64_t PruneList::GetShift(const Index& index) const noexcept
 {
-    // NOTE: rank() uses an inefficient algorithm.
-    // A shift cache with an efficient "nearest-neighbor" searching algorithm would be better.
-    return m_compacted.rank(index.GetPosition());
+    return m_shifts.rank(index.GetPosition());
 }
 
 uint64_t PruneList::GetShift(const LeafIndex& index) const noexcept
@@ -39,5 +37,6 @@ void PruneList::Commit(const uint32_t file_index, const BitSet& compacted)
         .Write(compacted.bytes());
 
     m_compacted = compacted;
+    m_shifts = BitSetRank(m_compacted);
     m_totalShift = compacted.count();
 }
\ No newline at end of file
@@ -2,13 +2,18 @@
 #include <mw/mmr/Node.h>
 #include <mw/db/LeafDB.h>
 #include <mw/exceptions/NotFoundException.h>
+#include <mw/exceptions/ValidationException.h>
+#include <algorithm>
+
+// Surviving hashes are copied to the compacted hash file in chunks of up to this many bytes.
+static const uint64_t COMPACT_CHUNK_SIZE = 4 * 1024 * 1024;
 
 std::shared_ptr<mmr::FileBackend> mmr::FileBackend::Open(
     const char dbPrefix,
     const FilePath& mmr_dir,
     const uint32_t file_index,
     const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-    const mmr::PruneList::CPtr& pPruneList)
+    const mmr::PruneList::Ptr& pPruneList)
 {
     const FilePath path = GetPath(mmr_dir, dbPrefix, file_index);
     return std::make_shared<FileBackend>(
@@ -25,7 +30,7 @@ mmr::FileBackend::FileBackend(
     const FilePath& mmr_dir,
     const AppendOnlyFile::Ptr& pHashFile,
     const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-    const mmr::PruneList::CPtr& pPruneList)
+    const mmr::PruneList::Ptr& pPruneList)
     : m_dbPrefix(dbPrefix), m_dir(mmr_dir), m_pHashFile(pHashFile), m_pDatabase(pDBWrapper), m_pPruneList(pPruneList)
 {
 }
@@ -60,27 +65,101 @@ void mmr::FileBackend::Rewind(const LeafIndex& nextLeafIndex)
         pos -= m_pPruneList->GetShift(nextLeafIndex);
     }
 
-    m_pHashFile->Rewind(pos * 32);
+    if (m_pStaged) {
+        // The staged hash file is only valid if every hash it removes is kept.
+        if (pos * mw::Hash::size() <= m_pStaged->last_removed) {
+            ThrowFile_F("Can't rewind {} hash file past its staged compaction", m_dbPrefix);
+        }
+
+        m_pStaged->num_kept = std::min(m_pStaged->num_kept, pos * mw::Hash::size());
+    }
+
+    m_pHashFile->Rewind(pos * mw::Hash::size());
 }
 
-void mmr::FileBackend::Compact(const uint32_t file_index, const boost::dynamic_bitset<uint64_t>& hashes_to_remove)
+uint64_t mmr::FileBackend::Compact(const uint32_t compact_index, const BitSet& compacted)
 {
-    uint64_t num_hashes = m_pHashFile->GetSize() / mw::Hash::size();
-    assert(num_hashes = hashes_to_remove.size());
+    if (m_pPruneList == nullptr) {
+        ThrowFile_F("Can't compact {} hash file without a PruneList", m_dbPrefix);
+    }
 
-    const FilePath path = GetPath(filesystem::temp_directory_path(), m_dbPrefix, file_index);
-    AppendOnlyFile::Ptr pFile = AppendOnlyFile::Load(path);
+    if (m_pStaged) {
+        ThrowFile_F("{} hash file already has a staged compaction", m_dbPrefix);
+    }
 
-    for (uint64_t pos = 0; pos < hashes_to_remove.size(); pos++) {
-        if (hashes_to_remove.test(pos)) {
+    // Positions that were already removed from the hash file can't be brought back.
+    const BitSet& prev_compacted = m_pPruneList->GetCompacted();
+    for (size_t pos = prev_compacted.bitset.find_first(); pos != boost::dynamic_bitset<>::npos; pos = prev_compacted.bitset.find_next(pos)) {
+        if (pos >= compacted.size() || !compacted.test(pos)) {
+            ThrowValidation(EConsensusError::MMR_MISMATCH);
+        }
+    }
+
+    if (compacted.count() == prev_compacted.count()) {
+        return 0;
+    }
+
+    File temp_file(m_dir.GetChild(StringUtil::Format("{}{:0>6}.tmp", m_dbPrefix, compact_index)));
+    if (temp_file.Exists()) {
+        temp_file.GetPath().Remove();
+    }
+    temp_file.Create();
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(COMPACT_CHUNK_SIZE);
+
+    // Copies the kept hashes in [run_begin, run_end) of the current hash file.
+    uint64_t run_begin = 0;
+    auto copy_run = [this, &temp_file, &buffer, &run_begin](const uint64_t run_end) {
+        while (run_begin < run_end) {
+            const uint64_t num_hashes = std::min(run_end - run_begin, COMPACT_CHUNK_SIZE / mw::Hash::size());
+            std::vector<uint8_t> bytes = m_pHashFile->Read(run_begin * mw::Hash::size(), num_hashes * mw::Hash::size());
+            buffer.insert(buffer.end(), bytes.cbegin(), bytes.cend());
+            if (buffer.size() >= COMPACT_CHUNK_SIZE) {
+                temp_file.Write(buffer);
+                buffer.clear();
+            }
+
+            run_begin += num_hashes;
+        }
+    };
+
+    const uint64_t num_positions = (m_pHashFile->GetSize() / mw::Hash::size()) + m_pPruneList->GetTotalShift();
+    uint64_t hash_pos = 0;
+    uint64_t num_removed = 0;
+    uint64_t last_removed = 0;
+    for (uint64_t pos = 0; pos < num_positions; pos++) {
+        if (pos < prev_compacted.size() && prev_compacted.test(pos)) {
             continue;
         }
 
-        pFile->Append(m_pHashFile->Read(pos * mw::Hash::size(), mw::Hash::size()));
+        if (pos < compacted.size() && compacted.test(pos)) {
+            copy_run(hash_pos);
+            run_begin = hash_pos + 1;
+            last_removed = hash_pos * mw::Hash::size();
+            ++num_removed;
+        }
+
+        ++hash_pos;
     }
 
-    pFile->Commit(GetPath(m_dir, m_dbPrefix, file_index));
-    m_pHashFile = pFile;
+    copy_run(hash_pos);
+    if (!buffer.empty()) {
+        temp_file.Write(buffer);
+    }
+
+    // The live hash file and PruneList are left alone until the next Commit(),
+    // so the files of the last committed MMRInfo are never modified.
+    m_pStaged = std::make_unique<StagedCompaction>(StagedCompaction{
+        temp_file.GetPath(),
+        compact_index,
+        compacted,
+        num_removed,
+        last_removed,
+        m_pHashFile->GetSize()
+    });
+
+    return num_removed;
 }
 
 uint64_t mmr::FileBackend::GetNumLeaves() const noexcept
@@ -121,7 +200,12 @@ mmr::Leaf mmr::FileBackend::GetLeaf(const LeafIndex& idx) const
 
 void mmr::FileBackend::Commit(const uint32_t file_index, const std::unique_ptr<libmw::IDBBatch>& pBatch)
 {
-    m_pHashFile->Commit(GetPath(m_dir, m_dbPrefix, file_index));
+    const FilePath path = GetPath(m_dir, m_dbPrefix, file_index);
+    if (m_pStaged) {
+        ApplyStaged(path);
+    } else {
+        m_pHashFile->Commit(path);
+    }
 
     // Update database
     LeafDB(m_dbPrefix, m_pDatabase.get(), pBatch.get())
@@ -131,6 +215,26 @@ void mmr::FileBackend::Commit(const uint32_t file_index, const std::unique_ptr<l
     m_leafMap.clear();
 }
 
+void mmr::FileBackend::ApplyStaged(const FilePath& path)
+{
+    // The hashes added since the compaction was staged follow the kept ones.
+    File temp_file(m_pStaged->temp_path);
+    const uint64_t num_kept = m_pStaged->num_kept;
+    temp_file.Write(
+        num_kept - (m_pStaged->num_removed * mw::Hash::size()),
+        m_pHashFile->Read(num_kept, m_pHashFile->GetSize() - num_kept),
+        true
+    );
+
+    // The hash file must be unmapped in case it's the one being replaced.
+    m_pHashFile.reset();
+    temp_file.Rename(path.GetFSPath().filename().u8string());
+
+    m_pHashFile = AppendOnlyFile::Load(path);
+    m_pPruneList->Commit(m_pStaged->compact_index, m_pStaged->compacted);
+    m_pStaged.reset();
+}
+
 FilePath mmr::FileBackend::GetPath(const FilePath& dir, const char prefix, const uint32_t file_index)
 {
     return dir.GetChild(StringUtil::Format("{}{:0>6}.dat", prefix, file_index));;
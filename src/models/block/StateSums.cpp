@@ -0,0 +1,32 @@
+#include <mw/models/block/StateSums.h>
+#include <mw/crypto/Crypto.h>
+
+// Crypto::AddCommitments fails when the result is the point at infinity,
+// which happens whenever everything in a sum is removed (e.g. every UTXO is spent).
+static Commitment UpdateSum(const Commitment& sum, const std::vector<Commitment>& added, const std::vector<Commitment>& removed)
+{
+    std::vector<Commitment> positive = added;
+    positive.push_back(sum);
+
+    const Commitment positive_sum = Crypto::AddCommitments(positive);
+    const Commitment negative_sum = Crypto::AddCommitments(removed);
+    if (positive_sum == negative_sum) {
+        return Commitment{};
+    }
+
+    return Crypto::AddCommitments({ positive_sum }, { negative_sum });
+}
+
+mw::StateSums mw::StateSums::Update(
+    const std::vector<Commitment>& utxos_added,
+    const std::vector<Commitment>& utxos_removed,
+    const std::vector<Commitment>& kernels_added,
+    const std::vector<Commitment>& kernels_removed,
+    const int64_t supply_change) const
+{
+    return StateSums(
+        UpdateSum(utxo_sum, utxos_added, utxos_removed),
+        UpdateSum(kernel_sum, kernels_added, kernels_removed),
+        total_mw_supply + supply_change
+    );
+}
@@ -3,6 +3,7 @@
 #include <mw/crypto/Random.h>
 #include <mw/crypto/Bulletproofs.h>
 #include <mw/crypto/Schnorr.h>
+#include <cassert>
 
 Output::Output(
     Commitment&& commitment,
@@ -14,7 +15,8 @@ Output::Output(
     BigInt<16>&& masked_nonce,
     PublicKey&& sender_pubkey,
     Signature&& signature,
-    const RangeProof::CPtr& pProof
+    const RangeProof::CPtr& pProof,
+    std::vector<Commitment>&& aggregated_commits
 )
     : m_commitment(std::move(commitment)),
     m_features(features),
@@ -25,7 +27,8 @@ Output::Output(
     m_maskedNonce(std::move(masked_nonce)),
     m_senderPubKey(std::move(sender_pubkey)),
     m_signature(std::move(signature)),
-    m_pProof(pProof)
+    m_pProof(pProof),
+    m_aggregatedCommits(std::move(aggregated_commits))
 {
     m_hash = Hashed(*this);
 }
@@ -36,6 +39,68 @@ Output Output::Create(
     const SecretKey& sender_privkey,
     const StealthAddress& receiver_addr,
     const uint64_t value)
+{
+    Output output = CreateUnproven(blind_out, features, sender_privkey, receiver_addr, value);
+
+    // Probably best to store sender_key so sender can identify all outputs they've sent?
+    RangeProof::CPtr pRangeProof = Bulletproofs::Generate(
+        value,
+        SecretKey(blind_out.vec()),
+        Random::CSPRNG<32>(),
+        Random::CSPRNG<32>(),
+        ProofMessage{},
+        output.BuildProofMessage()
+    );
+
+    return output.WithProof(pRangeProof, {});
+}
+
+std::vector<Output> Output::CreateAggregated(
+    std::vector<BlindingFactor>& blinds_out,
+    const Features& features,
+    const std::vector<SecretKey>& sender_privkeys,
+    const std::vector<std::pair<uint64_t, StealthAddress>>& recipients)
+{
+    assert(sender_privkeys.size() == recipients.size());
+
+    const Features aggregated_features(features.Get() | EOutputFeatures::AGGREGATED_PROOF);
+
+    blinds_out.resize(recipients.size());
+    std::vector<Output> outputs;
+    std::vector<uint64_t> values;
+    std::vector<SecretKey> blinds;
+    for (size_t i = 0; i < recipients.size(); i++) {
+        outputs.push_back(CreateUnproven(blinds_out[i], aggregated_features, sender_privkeys[i], recipients[i].second, recipients[i].first));
+        values.push_back(recipients[i].first);
+        blinds.push_back(SecretKey(blinds_out[i].vec()));
+    }
+
+    // The proof commits to the first output's data, and to the other outputs' commitments.
+    // The rest of their data is covered by their own signatures.
+    RangeProof::CPtr pRangeProof = Bulletproofs::GenerateAggregated(
+        values,
+        blinds,
+        Random::CSPRNG<32>(),
+        Random::CSPRNG<32>(),
+        outputs.front().BuildProofMessage()
+    );
+
+    std::vector<Commitment> aggregated_commits;
+    for (size_t i = 1; i < outputs.size(); i++) {
+        aggregated_commits.push_back(outputs[i].GetCommitment());
+        outputs[i] = outputs[i].WithProof(std::make_shared<const RangeProof>(), {});
+    }
+
+    outputs.front() = outputs.front().WithProof(pRangeProof, std::move(aggregated_commits));
+    return outputs;
+}
+
+Output Output::CreateUnproven(
+    BlindingFactor& blind_out,
+    const Features& features,
+    const SecretKey& sender_privkey,
+    const StealthAddress& receiver_addr,
+    const uint64_t value)
 {
     // Generate 128-bit secret nonce 'n' = Hash128(T_nonce, sender_privkey)
     secret_key_t<16> n = Hashed(EHashTag::NONCE, sender_privkey).data();
@@ -83,29 +148,8 @@ Output Output::Create(
     PublicKey sender_pubkey = Keys::From(sender_privkey).PubKey();
     Signature signature = Schnorr::Sign(sender_privkey.data(), sig_message);
 
-    std::vector<uint8_t> proof_data = Serializer()
-        .Append<uint8_t>(features.Get())
-        .Append(Ko)
-        .Append(Ke)
-        .Append(t[0])
-        .Append(mv)
-        .Append(mn)
-        .Append(sender_pubkey)
-        .Append(signature)
-        .vec();
-
-    // Probably best to store sender_key so sender can identify all outputs they've sent?
-    RangeProof::CPtr pRangeProof = Bulletproofs::Generate(
-        value,
-        SecretKey(blind_out.vec()),
-        Random::CSPRNG<32>(),
-        Random::CSPRNG<32>(),
-        ProofMessage{},
-        proof_data
-    );
-
     return Output{
-        Crypto::CommitBlinded(value, blind_out),
+        std::move(output_commit),
         features,
         std::move(Ko),
         std::move(Ke),
@@ -114,10 +158,27 @@ Output Output::Create(
         std::move(mn),
         std::move(sender_pubkey),
         std::move(signature),
-        pRangeProof
+        std::make_shared<const RangeProof>()
     };
 }
 
+Output Output::WithProof(const RangeProof::CPtr& pProof, std::vector<Commitment>&& aggregated_commits) const
+{
+    return Output(
+        Commitment(m_commitment),
+        m_features,
+        PublicKey(m_receiverPubKey),
+        PublicKey(m_keyExchangePubKey),
+        m_viewTag,
+        m_maskedValue,
+        BigInt<16>(m_maskedNonce),
+        PublicKey(m_senderPubKey),
+        Signature(m_signature),
+        pProof,
+        std::move(aggregated_commits)
+    );
+}
+
 SignedMessage Output::BuildSignedMsg() const noexcept
 {
     mw::Hash hashed_msg = Hasher()
@@ -131,9 +192,9 @@ SignedMessage Output::BuildSignedMsg() const noexcept
     return SignedMessage{ std::move(hashed_msg), m_senderPubKey, m_signature };
 }
 
-ProofData Output::BuildProofData() const noexcept
+std::vector<uint8_t> Output::BuildProofMessage() const
 {
-    std::vector<uint8_t> message = Serializer()
+    return Serializer()
         .Append<uint8_t>(m_features.Get())
         .Append(m_receiverPubKey)
         .Append(m_keyExchangePubKey)
@@ -143,13 +204,16 @@ ProofData Output::BuildProofData() const noexcept
         .Append(m_senderPubKey)
         .Append(m_signature)
         .vec();
+}
 
-    return ProofData{ m_commitment, m_pProof, std::move(message) };
+ProofData Output::BuildProofData() const noexcept
+{
+    return ProofData{ m_commitment, m_pProof, BuildProofMessage(), m_aggregatedCommits };
 }
 
 Serializer& Output::Serialize(Serializer& serializer) const noexcept
 {
-    return serializer
+    serializer
         .Append(m_commitment)
         .Append<uint8_t>(m_features.Get())
         .Append(m_receiverPubKey)
@@ -160,6 +224,15 @@ Serializer& Output::Serialize(Serializer& serializer) const noexcept
         .Append(m_senderPubKey)
         .Append(m_signature)
         .Append(m_pProof);
+
+    if (HasAggregatedProof()) {
+        serializer.Append<uint8_t>((uint8_t)m_aggregatedCommits.size());
+        for (const Commitment& commitment : m_aggregatedCommits) {
+            serializer.Append(commitment);
+        }
+    }
+
+    return serializer;
 }
 
 Output Output::Deserialize(Deserializer& deserializer)
@@ -176,6 +249,19 @@ Output Output::Deserialize(Deserializer& deserializer)
     Signature signature = Signature::Deserialize(deserializer);
 
     RangeProof::CPtr pProof = std::make_shared<const RangeProof>(RangeProof::Deserialize(deserializer));
+
+    std::vector<Commitment> aggregated_commits;
+    if (Features(features).IsSet(EOutputFeatures::AGGREGATED_PROOF)) {
+        const uint8_t num_aggregated = deserializer.Read<uint8_t>();
+        if (num_aggregated >= RangeProof::MAX_COMMITS) {
+            ThrowDeserialization_F("Aggregated proof can't be over {} other commitments", num_aggregated);
+        }
+
+        for (uint8_t i = 0; i < num_aggregated; i++) {
+            aggregated_commits.push_back(Commitment::Deserialize(deserializer));
+        }
+    }
+
     return Output(
         std::move(commitment),
         features,
@@ -186,6 +272,7 @@ Output Output::Deserialize(Deserializer& deserializer)
         std::move(masked_nonce),
         std::move(sender_pubkey),
         std::move(signature),
-        pProof
+        pProof,
+        std::move(aggregated_commits)
     );
 }
\ No newline at end of file
@@ -11,6 +11,14 @@ void mw::Transaction::Validate() const
     OwnerSumValidator::Validate(m_ownerOffset, m_body);
 }
 
+void mw::Transaction::ValidateStructureAndSums() const
+{
+    m_body.ValidateStructure();
+
+    KernelSumValidator::ValidateForTx(*this);
+    OwnerSumValidator::Validate(m_ownerOffset, m_body);
+}
+
 std::string mw::Transaction::Print() const noexcept
 {
     auto print_kernel = [](const Kernel& kernel) -> std::string {
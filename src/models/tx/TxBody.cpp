@@ -1,10 +1,36 @@
 #include <mw/models/tx/TxBody.h>
 #include <mw/exceptions/ValidationException.h>
 #include <mw/consensus/Weight.h>
+#include <mw/exceptions/DeserializationException.h>
 
-#include <unordered_set>
 #include <numeric>
 
+enum class EOrder
+{
+    STRICTLY_INCREASING,
+    HAS_DUPLICATES,
+    NOT_SORTED
+};
+
+// Checks the order of the items in a single pass.
+// Items that are neither less than nor greater than their neighbor are duplicates.
+template<typename T, typename Less>
+static EOrder CheckOrder(const std::vector<T>& items, const Less& less)
+{
+    EOrder order = EOrder::STRICTLY_INCREASING;
+    for (size_t i = 1; i < items.size(); i++) {
+        if (less(items[i], items[i - 1])) {
+            return EOrder::NOT_SORTED;
+        }
+
+        if (!less(items[i - 1], items[i])) {
+            order = EOrder::HAS_DUPLICATES;
+        }
+    }
+
+    return order;
+}
+
 std::vector<PegInCoin> TxBody::GetPegIns() const noexcept
 {
     std::vector<PegInCoin> pegins;
@@ -90,7 +116,37 @@ TxBody TxBody::Deserialize(Deserializer& deserializer)
     return TxBody(std::move(inputs), std::move(outputs), std::move(kernels), std::move(owner_sigs));
 }
 
+Serializer& TxBody::SerializeCutThroughs(Serializer& serializer) const noexcept
+{
+    return Serialize(serializer).AppendVec<CutThrough>(m_cutThroughs);
+}
+
+TxBody TxBody::DeserializeWithCutThroughs(Deserializer& deserializer)
+{
+    TxBody body = Deserialize(deserializer);
+    body.m_cutThroughs = deserializer.ReadVec<CutThrough>();
+    return body;
+}
+
+mw::Hash TxBody::GetCutThroughHash() const noexcept
+{
+    return Hashed(Serializer().AppendVec<CutThrough>(m_cutThroughs).vec());
+}
+
 void TxBody::Validate() const
+{
+    ValidateStructure();
+
+    if (!Schnorr::BatchVerify(BuildSignedMessages())) {
+        ThrowValidation(EConsensusError::INVALID_SIG);
+    }
+
+    if (!Bulletproofs::BatchVerify(BuildProofData())) {
+        ThrowValidation(EConsensusError::BULLETPROOF);
+    }
+}
+
+void TxBody::ValidateStructure() const
 {
     // Verify weight
     if (Weight::ExceedsMaximum(*this)) {
@@ -109,69 +165,104 @@ void TxBody::Validate() const
         ThrowValidation(EConsensusError::BLOCK_WEIGHT);
     }
 
-    // Verify inputs, outputs, kernels, and owner signatures are sorted
-    if (!std::is_sorted(m_inputs.cbegin(), m_inputs.cend(), SortByCommitment)
-        || !std::is_sorted(m_outputs.cbegin(), m_outputs.cend(), SortByCommitment)
+    // Verify inputs, outputs, kernels, owner signatures, and cut-throughs are sorted.
+    // Inputs and outputs are sorted by commitment, and cut-throughs by hash,
+    // so duplicates are found by comparing neighbors in the same pass.
+    const EOrder input_order = CheckOrder(m_inputs, SortByCommitment);
+    const EOrder output_order = CheckOrder(m_outputs, SortByCommitment);
+    const EOrder cut_through_order = CheckOrder(m_cutThroughs, SortByHash);
+    if (input_order == EOrder::NOT_SORTED
+        || output_order == EOrder::NOT_SORTED
+        || cut_through_order == EOrder::NOT_SORTED
         || !std::is_sorted(m_kernels.cbegin(), m_kernels.cend(), KernelSort)
         || !std::is_sorted(m_ownerSigs.cbegin(), m_ownerSigs.cend(), SortByHash))
     {
         ThrowValidation(EConsensusError::NOT_SORTED);
     }
 
-    // Verify no duplicate inputs
-    std::unordered_set<Commitment> input_commits;
-    std::transform(
-        m_inputs.cbegin(), m_inputs.cend(),
-        std::inserter(input_commits, input_commits.end()),
-        [](const Input& input) { return input.GetCommitment(); }
-    );
-
-    if (input_commits.size() != m_inputs.size()) {
+    // Verify no duplicate inputs, outputs or cut-throughs
+    if (input_order == EOrder::HAS_DUPLICATES
+        || output_order == EOrder::HAS_DUPLICATES
+        || cut_through_order == EOrder::HAS_DUPLICATES)
+    {
         ThrowValidation(EConsensusError::DUPLICATE_COMMITS);
     }
 
-    // Verify no duplicate outputs
-    std::unordered_set<Commitment> output_commits;
-    std::transform(
-        m_outputs.cbegin(), m_outputs.cend(),
-        std::inserter(output_commits, output_commits.end()),
-        [](const Output& output) { return output.GetCommitment(); }
-    );
+    // Verify every output without a range proof of its own is covered by another output's aggregated proof
+    ValidateAggregatedProofs();
 
-    if (output_commits.size() != m_outputs.size()) {
-        ThrowValidation(EConsensusError::DUPLICATE_COMMITS);
-    }
-
-    // Verify no duplicate kernels
-    std::unordered_set<Commitment> kernel_commits;
+    // Kernels are sorted by supply change first, so they're sorted again by commitment and by hash.
+    // Only pointers are sorted, and nothing is hashed.
+    std::vector<const Kernel*> kernels;
+    kernels.reserve(m_kernels.size());
     std::transform(
         m_kernels.cbegin(), m_kernels.cend(),
-        std::inserter(kernel_commits, kernel_commits.end()),
-        [](const Kernel& kernel) { return kernel.GetCommitment(); }
+        std::back_inserter(kernels),
+        [](const Kernel& kernel) { return &kernel; }
     );
 
-    if (kernel_commits.size() != m_kernels.size()) {
+    // Verify no duplicate kernels
+    std::sort(
+        kernels.begin(), kernels.end(),
+        [](const Kernel* pA, const Kernel* pB) { return pA->GetCommitment() < pB->GetCommitment(); }
+    );
+    auto duplicate_kernel = std::adjacent_find(
+        kernels.cbegin(), kernels.cend(),
+        [](const Kernel* pA, const Kernel* pB) { return pA->GetCommitment() == pB->GetCommitment(); }
+    );
+    if (duplicate_kernel != kernels.cend()) {
         ThrowValidation(EConsensusError::DUPLICATE_COMMITS);
     }
 
     // Verify kernel exists with matching hash for each owner sig
-    std::unordered_set<mw::Hash> kernel_hashes;
-    std::transform(
-        m_kernels.cbegin(), m_kernels.cend(),
-        std::inserter(kernel_hashes, kernel_hashes.end()),
-        [](const Kernel& kernel) { return kernel.GetHash(); }
-    );
+    if (!m_ownerSigs.empty()) {
+        auto by_hash = [](const Kernel* pA, const Kernel* pB) { return pA->GetHash() < pB->GetHash(); };
+        std::sort(kernels.begin(), kernels.end(), by_hash);
 
-    for (const auto& owner_sig : m_ownerSigs) {
-        if (kernel_hashes.find(owner_sig.GetMsgHash()) == kernel_hashes.end()) {
-            ThrowValidation(EConsensusError::KERNEL_MISSING);
+        for (const auto& owner_sig : m_ownerSigs) {
+            auto iter = std::lower_bound(
+                kernels.cbegin(), kernels.cend(), owner_sig.GetMsgHash(),
+                [](const Kernel* pKernel, const mw::Hash& hash) { return pKernel->GetHash() < hash; }
+            );
+            if (iter == kernels.cend() || (*iter)->GetHash() != owner_sig.GetMsgHash()) {
+                ThrowValidation(EConsensusError::KERNEL_MISSING);
+            }
         }
     }
+}
+
+void TxBody::ValidateAggregatedProofs() const
+{
+    std::vector<const Commitment*> covered;
+    for (const Output& output : m_outputs) {
+        if (output.HasAggregatedProof() && output.HasRangeProof()) {
+            for (const Commitment& commitment : output.GetAggregatedCommits()) {
+                covered.push_back(&commitment);
+            }
+        }
+    }
+
+    auto by_value = [](const Commitment* pA, const Commitment* pB) { return *pA < *pB; };
+    std::sort(covered.begin(), covered.end(), by_value);
+
+    for (const Output& output : m_outputs) {
+        if (output.HasRangeProof()) {
+            continue;
+        }
 
-    //
-    // Verify all signatures
-    //
+        if (output.GetRangeProof()->size() != 0
+            || !std::binary_search(covered.cbegin(), covered.cend(), &output.GetCommitment(), by_value))
+        {
+            ThrowValidation(EConsensusError::BULLETPROOF);
+        }
+    }
+}
+
+std::vector<SignedMessage> TxBody::BuildSignedMessages() const
+{
     std::vector<SignedMessage> signatures;
+    signatures.reserve(m_kernels.size() + m_inputs.size() + m_outputs.size() + m_ownerSigs.size() + (2 * m_cutThroughs.size()));
+
     std::transform(
         m_kernels.cbegin(), m_kernels.cend(),
         std::back_inserter(signatures),
@@ -197,20 +288,23 @@ void TxBody::Validate() const
 
     signatures.insert(signatures.end(), m_ownerSigs.begin(), m_ownerSigs.end());
 
-    if (!Schnorr::BatchVerify(signatures)) {
-        ThrowValidation(EConsensusError::INVALID_SIG);
+    for (const CutThrough& cut_through : m_cutThroughs) {
+        signatures.push_back(cut_through.GetInputSig());
+        signatures.push_back(cut_through.GetOutputSig());
     }
 
-    //
-    // Verify RangeProofs
-    //
+    return signatures;
+}
+
+std::vector<ProofData> TxBody::BuildProofData() const
+{
     std::vector<ProofData> rangeProofs;
-    std::transform(
-        m_outputs.cbegin(), m_outputs.cend(),
-        std::back_inserter(rangeProofs),
-        [](const Output& output) { return output.BuildProofData(); }
-    );
-    if (!Bulletproofs::BatchVerify(rangeProofs)) {
-        ThrowValidation(EConsensusError::BULLETPROOF);
+    rangeProofs.reserve(m_outputs.size());
+    for (const Output& output : m_outputs) {
+        if (output.HasRangeProof()) {
+            rangeProofs.push_back(output.BuildProofData());
+        }
     }
-}
\ No newline at end of file
+
+    return rangeProofs;
+}
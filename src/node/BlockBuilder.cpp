@@ -1,6 +1,6 @@
 #include <mw/node/BlockBuilder.h>
-#include <mw/consensus/KernelSumValidator.h>
 #include <mw/consensus/Aggregation.h>
+#include <mw/consensus/ChainParams.h>
 #include <mw/consensus/Weight.h>
 
 #include <unordered_set>
@@ -8,11 +8,66 @@
 
 MW_NAMESPACE
 
+// Merges the sorted items into the sorted vector.
+template<typename T, typename Less>
+static void MergeSorted(std::vector<T>& vec, const std::vector<T>& items, const Less& less)
+{
+    const size_t num_existing = vec.size();
+    vec.insert(vec.end(), items.cbegin(), items.cend());
+    std::inplace_merge(vec.begin(), vec.begin() + num_existing, vec.end(), less);
+}
+
+// Erases one copy of each of the sorted items from the sorted vector in a single pass.
+template<typename T, typename Less>
+static void EraseSorted(std::vector<T>& vec, const std::vector<T>& items, const Less& less)
+{
+    auto item_iter = items.cbegin();
+    auto new_end = std::remove_if(vec.begin(), vec.end(), [&item_iter, &items, &less](const T& elem) {
+        while (item_iter != items.cend() && less(*item_iter, elem)) {
+            ++item_iter;
+        }
+
+        if (item_iter != items.cend() && *item_iter == elem) {
+            ++item_iter;
+            return true;
+        }
+
+        return false;
+    });
+    vec.erase(new_end, vec.end());
+}
+
+bool BlockBuilder::FeeRateOrder::operator()(const Candidate* pLhs, const Candidate* pRhs) const noexcept
+{
+    const double lhs_rate = (double)pLhs->fee / std::max<uint64_t>(pLhs->weight, 1);
+    const double rhs_rate = (double)pRhs->fee / std::max<uint64_t>(pRhs->weight, 1);
+    if (lhs_rate != rhs_rate) {
+        return lhs_rate > rhs_rate;
+    }
+
+    return pLhs->pTransaction->GetHash() < pRhs->pTransaction->GetHash();
+}
+
+BlockBuilder::BlockBuilder(
+    const uint64_t height,
+    const mw::ICoinsView::Ptr& pCoinsView,
+    const uint64_t max_weight,
+    const bool cut_through)
+    : m_height(height), m_maxWeight(max_weight), m_cutThrough(cut_through && mw::ChainParams::IsCutThroughActive(height)), m_weight(0), m_pCoinsView(pCoinsView)
+{
+    // Reserve enough room for a full block, so adding transactions doesn't reallocate.
+    // Inputs don't count towards the weight, so they're only reserved for one per output.
+    m_outputs.reserve(max_weight / libmw::OUTPUT_WEIGHT);
+    m_inputs.reserve(max_weight / libmw::OUTPUT_WEIGHT);
+    m_kernels.reserve(max_weight / libmw::KERNEL_WEIGHT);
+    m_ownerSigs.reserve(max_weight / libmw::OWNER_SIG_WEIGHT);
+}
+
 bool BlockBuilder::AddTransaction(const Transaction::CPtr& pTransaction, const std::vector<PegInCoin>& pegins)
 {
     // Check weight
     uint64_t weight = Weight::Calculate(pTransaction->GetBody());
-    if ((weight + m_weight) > libmw::MAX_BLOCK_WEIGHT) {
+    if ((weight + m_weight) > m_maxWeight) {
         LOG_ERROR("Exceeds max block weight");
         return false;
     }
@@ -52,52 +107,291 @@ bool BlockBuilder::AddTransaction(const Transaction::CPtr& pTransaction, const s
         }
     }
 
+    // Blocks before the cut-through height can't have any cut-throughs.
+    if (!m_cutThrough && !pTransaction->GetBody().GetCutThroughs().empty()) {
+        LOG_ERROR_F("Transaction {} has cut-throughs", pTransaction);
+        return false;
+    }
+
+    // Make sure the transaction hasn't already been added.
+    if (FindTransaction(pTransaction->GetHash()) != m_transactions.end()) {
+        LOG_ERROR_F("Transaction {} already added", pTransaction);
+        return false;
+    }
+
     // Validate transaction
     pTransaction->Validate();
 
-    // Make sure all inputs are available.
+    // Make sure all inputs are available, and aren't spent by another transaction in the block.
     for (const Input& input : pTransaction->GetInputs()) {
-        if (m_pCoinsView->GetUTXOs(input.GetCommitment()).empty()) {
-            LOG_ERROR_F("Input {} not found on chain", input.GetCommitment());
+        if (!IsSpendable(input.GetCommitment())) {
+            return false;
+        }
+
+        if (std::binary_search(m_inputs.cbegin(), m_inputs.cend(), input, SortByCommitment)) {
+            LOG_ERROR_F("Input {} already spent in block", input.GetCommitment());
             return false;
         }
     }
 
-    // Make sure no duplicate outputs already on chain.
+    // Make sure no duplicate outputs already on chain or in the block.
     for (const Output& output : pTransaction->GetOutputs()) {
         if (!m_pCoinsView->GetUTXOs(output.GetCommitment()).empty()) {
             LOG_ERROR_F("Output {} already on chain", output.GetCommitment());
             return false;
         }
+
+        if (std::binary_search(m_outputs.cbegin(), m_outputs.cend(), output, SortByCommitment)) {
+            LOG_ERROR_F("Output {} already in block", output.GetCommitment());
+            return false;
+        }
     }
 
-    // Aggregate transactions
-    auto pAggregated = pTransaction;
-    if (m_pAggregated != nullptr) {
-        pAggregated = Aggregation::Aggregate({ m_pAggregated, pTransaction });
+    BlindingFactor kernel_offset = Crypto::AddBlindingFactors({ m_kernelOffset, pTransaction->GetKernelOffset() });
+    BlindingFactor owner_offset = Crypto::AddBlindingFactors({ m_ownerOffset, pTransaction->GetOwnerOffset() });
+
+    // The transaction's body is already sorted (checked by Validate), so it's merged in linear time.
+    MergeSorted(m_inputs, pTransaction->GetInputs(), SortByCommitment);
+    MergeSorted(m_outputs, pTransaction->GetOutputs(), SortByCommitment);
+    MergeSorted(m_kernels, pTransaction->GetKernels(), KernelSort);
+    MergeSorted(m_ownerSigs, pTransaction->GetOwnerSigs(), SortByHash);
+    MergeSorted(m_cutThroughs, pTransaction->GetBody().GetCutThroughs(), SortByHash);
+
+    m_kernelOffset = std::move(kernel_offset);
+    m_ownerOffset = std::move(owner_offset);
+    m_transactions.push_back(pTransaction);
+    m_weight += weight;
+
+    return true;
+}
+
+bool BlockBuilder::AddCandidate(const Transaction::CPtr& pTransaction, const std::vector<PegInCoin>& pegins)
+{
+    const uint64_t weight = Weight::Calculate(pTransaction->GetBody());
+    if (weight > m_maxWeight) {
+        LOG_ERROR("Exceeds max block weight");
+        return false;
     }
 
-    if (pAggregated == nullptr) {
-        LOG_ERROR("Failed to aggregate transaction");
+    if (m_candidates.find(pTransaction->GetHash()) != m_candidates.end()) {
+        LOG_ERROR_F("Candidate {} already added", pTransaction);
         return false;
     }
 
-    m_pAggregated = pAggregated;
-    m_weight += weight;
+    for (const Input& input : pTransaction->GetInputs()) {
+        if (!IsSpendable(input.GetCommitment())) {
+            return false;
+        }
+    }
+
+    auto inserted = m_candidates.emplace(
+        pTransaction->GetHash(),
+        Candidate{ pTransaction, pegins, pTransaction->GetTotalFee(), weight }
+    );
+    m_queued.insert(&inserted.first->second);
+
+    SelectCandidates();
+    return true;
+}
+
+bool BlockBuilder::RemoveTransaction(const mw::Hash& tx_hash)
+{
+    bool removed = false;
+
+    auto candidate_iter = m_candidates.find(tx_hash);
+    if (candidate_iter != m_candidates.end()) {
+        m_queued.erase(&candidate_iter->second);
+        m_selected.erase(&candidate_iter->second);
+        m_candidates.erase(candidate_iter);
+        removed = true;
+    }
+
+    if (FindTransaction(tx_hash) != m_transactions.end()) {
+        RemoveFromBlock(tx_hash);
+        SelectCandidates();
+        removed = true;
+    }
+
+    return removed;
+}
+
+void BlockBuilder::SelectCandidates()
+{
+    auto iter = m_queued.begin();
+    while (iter != m_queued.end()) {
+        const Candidate* pCandidate = *iter;
+
+        // Find the selected candidates with the lowest fee rates that would have to be removed to make room.
+        std::vector<const Candidate*> evicted;
+        uint64_t freed_weight = 0;
+        uint64_t evicted_fees = 0;
+        for (auto selected_iter = m_selected.rbegin(); selected_iter != m_selected.rend(); selected_iter++) {
+            if (m_weight - freed_weight + pCandidate->weight <= m_maxWeight || !FeeRateOrder()(pCandidate, *selected_iter)) {
+                break;
+            }
+
+            // Evicting a transaction would also evict the ones spending its outputs, so they're left alone.
+            if (HasDependents(*(*selected_iter)->pTransaction)) {
+                continue;
+            }
+
+            evicted.push_back(*selected_iter);
+            freed_weight += (*selected_iter)->weight;
+            evicted_fees += (*selected_iter)->fee;
+        }
+
+        const bool fits = m_weight - freed_weight + pCandidate->weight <= m_maxWeight;
+        if (!fits || (!evicted.empty() && evicted_fees >= pCandidate->fee)) {
+            ++iter;
+            continue;
+        }
+
+        // Evicted candidates have lower fee rates, so they're queued after this one and will be reconsidered.
+        for (const Candidate* pEvicted : evicted) {
+            m_selected.erase(pEvicted);
+            RemoveFromBlock(pEvicted->pTransaction->GetHash());
+            m_queued.insert(pEvicted);
+        }
+
+        iter = m_queued.erase(iter);
+
+        bool added = false;
+        try {
+            added = AddTransaction(pCandidate->pTransaction, pCandidate->pegins);
+        } catch (std::exception& e) {
+            LOG_DEBUG_F("Failed to add candidate {}. Error: {}", pCandidate->pTransaction, e.what());
+        }
+
+        if (added) {
+            m_selected.insert(pCandidate);
+        } else {
+            // The candidate is invalid or conflicts with the block, so it's dropped from the pool.
+            m_candidates.erase(mw::Hash(pCandidate->pTransaction->GetHash()));
+        }
+    }
+}
+
+bool BlockBuilder::IsSpendable(const Commitment& commitment) const
+{
+    if (m_cutThrough) {
+        auto output_iter = std::lower_bound(
+            m_outputs.cbegin(), m_outputs.cend(), commitment,
+            [](const Output& output, const Commitment& commit) { return output.GetCommitment() < commit; }
+        );
+        if (output_iter != m_outputs.cend() && output_iter->GetCommitment() == commitment && !output_iter->IsPeggedIn()) {
+            return true;
+        }
+    }
+
+    std::vector<UTXO::CPtr> utxos = m_pCoinsView->GetUTXOs(commitment);
+    if (utxos.empty()) {
+        LOG_ERROR_F("Input {} not found on chain", commitment);
+        return false;
+    }
+
+    if (utxos.back()->IsPeggedIn() && m_height < utxos.back()->GetBlockHeight() + mw::ChainParams::GetPegInMaturity()) {
+        LOG_ERROR_F("Input {} spends an immature peg-in", commitment);
+        return false;
+    }
 
     return true;
 }
 
+std::vector<Transaction::CPtr>::iterator BlockBuilder::FindTransaction(const mw::Hash& tx_hash)
+{
+    return std::find_if(
+        m_transactions.begin(), m_transactions.end(),
+        [&tx_hash](const Transaction::CPtr& pAdded) { return pAdded->GetHash() == tx_hash; }
+    );
+}
+
+bool BlockBuilder::HasDependents(const Transaction& transaction) const
+{
+    return std::any_of(
+        transaction.GetOutputs().cbegin(), transaction.GetOutputs().cend(),
+        [this](const Output& output) {
+            auto input_iter = std::lower_bound(
+                m_inputs.cbegin(), m_inputs.cend(), output.GetCommitment(),
+                [](const Input& input, const Commitment& commit) { return input.GetCommitment() < commit; }
+            );
+            return input_iter != m_inputs.cend() && input_iter->GetCommitment() == output.GetCommitment();
+        }
+    );
+}
+
+void BlockBuilder::RemoveFromBlock(const mw::Hash& tx_hash)
+{
+    auto iter = FindTransaction(tx_hash);
+    if (iter == m_transactions.end()) {
+        // Already removed as a dependent of another transaction.
+        return;
+    }
+
+    const Transaction::CPtr pTransaction = *iter;
+
+    // Transactions spending the outputs can't stay in the block without them.
+    // Dependent candidates are queued again, and dropped when they can't be added back.
+    if (HasDependents(*pTransaction)) {
+        const std::vector<Commitment> output_commits = pTransaction->GetOutputCommits();
+        std::vector<mw::Hash> dependents;
+        for (const Transaction::CPtr& pAdded : m_transactions) {
+            const bool spends_output = std::any_of(
+                pAdded->GetInputs().cbegin(), pAdded->GetInputs().cend(),
+                [&output_commits](const Input& input) {
+                    return std::binary_search(output_commits.cbegin(), output_commits.cend(), input.GetCommitment());
+                }
+            );
+            if (spends_output) {
+                dependents.push_back(pAdded->GetHash());
+            }
+        }
+
+        for (const mw::Hash& dependent_hash : dependents) {
+            auto candidate_iter = m_candidates.find(dependent_hash);
+            if (candidate_iter != m_candidates.end() && m_selected.erase(&candidate_iter->second) > 0) {
+                m_queued.insert(&candidate_iter->second);
+            }
+
+            RemoveFromBlock(dependent_hash);
+        }
+
+        iter = FindTransaction(tx_hash);
+    }
+
+    BlindingFactor kernel_offset = Crypto::AddBlindingFactors({ m_kernelOffset }, { pTransaction->GetKernelOffset() });
+    BlindingFactor owner_offset = Crypto::AddBlindingFactors({ m_ownerOffset }, { pTransaction->GetOwnerOffset() });
+
+    EraseSorted(m_inputs, pTransaction->GetInputs(), SortByCommitment);
+    EraseSorted(m_outputs, pTransaction->GetOutputs(), SortByCommitment);
+    EraseSorted(m_kernels, pTransaction->GetKernels(), KernelSort);
+    EraseSorted(m_ownerSigs, pTransaction->GetOwnerSigs(), SortByHash);
+    EraseSorted(m_cutThroughs, pTransaction->GetBody().GetCutThroughs(), SortByHash);
+
+    m_kernelOffset = std::move(kernel_offset);
+    m_ownerOffset = std::move(owner_offset);
+    m_transactions.erase(iter);
+    m_weight -= Weight::Calculate(pTransaction->GetBody());
+}
+
 mw::Block::Ptr BlockBuilder::BuildBlock() const
 {
     mw::CoinsViewCache cache(m_pCoinsView);
 
-    std::vector<mw::Transaction::CPtr> txs;
-    if (m_pAggregated != nullptr) {
-        txs.push_back(m_pAggregated);
+    // The contents are already sorted and the offsets summed, so they're used as-is instead of being aggregated again.
+    std::vector<Input> inputs = m_inputs;
+    std::vector<Output> outputs = m_outputs;
+    std::vector<CutThrough> cut_throughs = m_cutThroughs;
+    if (m_cutThrough) {
+        cut_throughs = Aggregation::ApplyCutThrough(inputs, outputs, std::move(cut_throughs));
     }
 
-    return cache.BuildNextBlock(m_height, txs);
+    auto pTransaction = std::make_shared<const mw::Transaction>(
+        m_kernelOffset,
+        m_ownerOffset,
+        TxBody(std::move(inputs), std::move(outputs), std::vector<Kernel>(m_kernels), std::vector<SignedMessage>(m_ownerSigs), std::move(cut_throughs))
+    );
+
+    return cache.BuildNextBlock(m_height, { pTransaction });
 }
 
-END_NAMESPACE
\ No newline at end of file
+END_NAMESPACE
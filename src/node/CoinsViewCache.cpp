@@ -5,13 +5,44 @@
 #include <mw/consensus/KernelSumValidator.h>
 #include <mw/common/Logger.h>
 #include <mw/db/MMRInfoDB.h>
+#include <unordered_set>
 
 MW_NAMESPACE
 
 std::vector<UTXO::CPtr> CoinsViewCache::GetUTXOs(const Commitment& commitment) const noexcept
 {
     std::vector<UTXO::CPtr> utxos = m_pBase->GetUTXOs(commitment);
+    ApplyUpdates(commitment, utxos);
 
+    return utxos;
+}
+
+std::unordered_map<Commitment, std::vector<UTXO::CPtr>> CoinsViewCache::LookupUTXOs(const std::vector<Commitment>& commitments) const
+{
+    std::unordered_map<Commitment, std::vector<UTXO::CPtr>> utxos_by_commitment = m_pBase->LookupUTXOs(commitments);
+
+    std::unordered_set<Commitment> updated;
+    for (const Commitment& commitment : commitments) {
+        if (!updated.insert(commitment).second) {
+            continue;
+        }
+
+        auto iter = utxos_by_commitment.find(commitment);
+        std::vector<UTXO::CPtr> utxos = iter != utxos_by_commitment.end() ? std::move(iter->second) : std::vector<UTXO::CPtr>{};
+        ApplyUpdates(commitment, utxos);
+
+        if (!utxos.empty()) {
+            utxos_by_commitment[commitment] = std::move(utxos);
+        } else if (iter != utxos_by_commitment.end()) {
+            utxos_by_commitment.erase(iter);
+        }
+    }
+
+    return utxos_by_commitment;
+}
+
+void CoinsViewCache::ApplyUpdates(const Commitment& commitment, std::vector<UTXO::CPtr>& utxos) const
+{
     std::vector<CoinAction> actions = m_pUpdates->GetActions(commitment);
     for (const CoinAction& action : actions) {
         if (action.pUTXO != nullptr) {
@@ -21,8 +52,6 @@ std::vector<UTXO::CPtr> CoinsViewCache::GetUTXOs(const Commitment& commitment) c
             utxos.pop_back();
         }
     }
-
-    return utxos;
 }
 
 mw::BlockUndo::CPtr CoinsViewCache::ApplyBlock(const mw::Block::Ptr& pBlock)
@@ -35,6 +64,17 @@ mw::BlockUndo::CPtr CoinsViewCache::ApplyBlock(const mw::Block::Ptr& pBlock)
     BlindingFactor prev_offset = pPreviousHeader != nullptr ? pPreviousHeader->GetKernelOffset() : BlindingFactor();
     KernelSumValidator::ValidateForBlock(pBlock->GetTxBody(), pBlock->GetKernelOffset(), prev_offset);
 
+    if (GetStateSums()) {
+        const TxBody& body = pBlock->GetTxBody();
+        SetStateSums(GetStateSums()->Update(
+            body.GetOutputCommits(),
+            body.GetInputCommits(),
+            body.GetKernelCommits(),
+            {},
+            body.GetSupplyChange()
+        ));
+    }
+
     std::for_each(
         pBlock->GetKernels().cbegin(), pBlock->GetKernels().cend(),
         [this](const Kernel& kernel) { m_pKernelMMR->Add(kernel); }
@@ -49,14 +89,8 @@ mw::BlockUndo::CPtr CoinsViewCache::ApplyBlock(const mw::Block::Ptr& pBlock)
         }
     );
 
-    std::vector<Commitment> coinsAdded;
-    std::for_each(
-        pBlock->GetOutputs().cbegin(), pBlock->GetOutputs().cend(),
-        [this, &pBlock, &coinsAdded](const Output& output) {
-            AddUTXO(pBlock->GetHeight(), output);
-            coinsAdded.push_back(output.GetCommitment());
-        }
-    );
+    AddUTXOs(pBlock->GetHeight(), pBlock->GetOutputs());
+    std::vector<Commitment> coinsAdded = pBlock->GetTxBody().GetOutputCommits();
 
     ValidateMMRs(pBlock->GetHeader());
 
@@ -78,6 +112,34 @@ void CoinsViewCache::UndoBlock(const mw::BlockUndo::CPtr& pUndo)
     }
 
     auto pHeader = pUndo->GetPreviousHeader();
+    if (GetStateSums()) {
+        // The undo data doesn't include kernels, so they're read from the MMR before it's rewound.
+        std::vector<Commitment> kernels_removed;
+        int64_t supply_change = 0;
+        const uint64_t num_kernels = pHeader != nullptr ? pHeader->GetNumKernels() : 0;
+        for (uint64_t i = num_kernels; i < m_pKernelMMR->GetNumLeaves(); i++) {
+            mmr::Leaf leaf = m_pKernelMMR->GetLeaf(mmr::LeafIndex::At(i));
+            Kernel kernel = Deserializer(leaf.vec()).Read<Kernel>();
+            kernels_removed.push_back(kernel.GetCommitment());
+            supply_change -= kernel.GetSupplyChange();
+        }
+
+        std::vector<Commitment> utxos_added;
+        std::transform(
+            pUndo->GetCoinsSpent().cbegin(), pUndo->GetCoinsSpent().cend(),
+            std::back_inserter(utxos_added),
+            [](const UTXO& utxo) { return utxo.GetCommitment(); }
+        );
+
+        SetStateSums(GetStateSums()->Update(
+            utxos_added,
+            pUndo->GetCoinsAdded(),
+            {},
+            kernels_removed,
+            supply_change
+        ));
+    }
+
     if (pHeader == nullptr) {
         m_pLeafSet->Rewind(0, {});
         m_pKernelMMR->Rewind(0);
@@ -106,10 +168,7 @@ mw::Block::Ptr CoinsViewCache::BuildNextBlock(const uint64_t height, const std::
         [this](const Kernel& kernel) { m_pKernelMMR->Add(kernel); }
     );
 
-    std::for_each(
-        pTransaction->GetOutputs().cbegin(), pTransaction->GetOutputs().cend(),
-        [this, height](const Output& output) { AddUTXO(height, output); }
-    );
+    AddUTXOs(height, pTransaction->GetOutputs());
 
     std::for_each(
         pTransaction->GetInputs().cbegin(), pTransaction->GetInputs().cend(),
@@ -133,6 +192,11 @@ mw::Block::Ptr CoinsViewCache::BuildNextBlock(const uint64_t height, const std::
 
     BlindingFactor owner_offset = pTransaction->GetOwnerOffset();
 
+    boost::optional<mw::Hash> cut_through_hash = boost::none;
+    if (mw::ChainParams::IsCutThroughActive(height)) {
+        cut_through_hash = pTransaction->GetBody().GetCutThroughHash();
+    }
+
     auto pHeader = std::make_shared<mw::Header>(
         height,
         std::move(output_root),
@@ -141,7 +205,8 @@ mw::Block::Ptr CoinsViewCache::BuildNextBlock(const uint64_t height, const std::
         std::move(kernel_offset),
         std::move(owner_offset),
         output_mmr_size,
-        kernel_mmr_size
+        kernel_mmr_size,
+        std::move(cut_through_hash)
     );
 
     return std::make_shared<mw::Block>(pHeader, pTransaction->GetBody());
@@ -162,14 +227,37 @@ bool CoinsViewCache::HasCoinInCache(const Commitment& commitment) const noexcept
     return false;
 }
 
-void CoinsViewCache::AddUTXO(const uint64_t header_height, const Output& output)
+void CoinsViewCache::AddUTXOs(const uint64_t header_height, const std::vector<Output>& outputs)
 {
-    mmr::LeafIndex leafIdx = m_pOutputPMMR->Add(output.ToOutputId());
-    m_pLeafSet->Add(leafIdx);
+    // Outputs without their own range proof are stored with the output carrying the aggregated proof that covers them.
+    std::unordered_map<Commitment, std::shared_ptr<const Output>> proof_outputs;
+    for (const Output& output : outputs) {
+        if (output.HasAggregatedProof() && output.HasRangeProof()) {
+            auto pProofOutput = std::make_shared<const Output>(output);
+            for (const Commitment& commitment : output.GetAggregatedCommits()) {
+                proof_outputs[commitment] = pProofOutput;
+            }
+        }
+    }
 
-    auto pUTXO = std::make_shared<UTXO>(header_height, std::move(leafIdx), output);
+    for (const Output& output : outputs) {
+        std::shared_ptr<const Output> pProofOutput = nullptr;
+        if (!output.HasRangeProof()) {
+            auto iter = proof_outputs.find(output.GetCommitment());
+            if (iter == proof_outputs.end()) {
+                ThrowValidation(EConsensusError::BULLETPROOF);
+            }
+
+            pProofOutput = iter->second;
+        }
 
-    m_pUpdates->AddUTXO(pUTXO);
+        mmr::LeafIndex leafIdx = m_pOutputPMMR->Add(output.ToOutputId());
+        m_pLeafSet->Add(leafIdx);
+
+        auto pUTXO = std::make_shared<UTXO>(header_height, std::move(leafIdx), output, std::move(pProofOutput));
+
+        m_pUpdates->AddUTXO(pUTXO);
+    }
 }
 
 UTXO CoinsViewCache::SpendUTXO(const Commitment& commitment)
@@ -208,6 +296,7 @@ void CoinsViewCache::Flush(const std::unique_ptr<libmw::IDBBatch>& pBatch)
     }
     
     m_pBase->WriteBatch(pBatch, *m_pUpdates, GetBestHeader());
+    m_pBase->SetStateSums(GetStateSums());
 
     MMRInfo mmr_info;
     if (!m_pBase->IsCache()) {
@@ -225,6 +314,12 @@ void CoinsViewCache::Flush(const std::unique_ptr<libmw::IDBBatch>& pBatch)
     m_pOutputPMMR->Flush(mmr_info.index, pBatch);
 
     if (!m_pBase->IsCache()) {
+        mmr_info.version = MMRInfo::HEIGHT_VERSION;
+        mmr_info.pruned = GetBestHeader()->GetHash();
+        mmr_info.height = GetBestHeader()->GetHeight();
+        mmr_info.sums = GetStateSums();
+        m_pBase->OnFlushed(mmr_info, pBatch);
+
         MMRInfoDB(GetDatabase().get(), pBatch.get())
             .Save(mmr_info);
     }
@@ -14,6 +14,18 @@ std::vector<UTXO::CPtr> CoinsViewDB::GetUTXOs(const Commitment& commitment) cons
     return GetUTXOs(coinDB, commitment);
 }
 
+std::unordered_map<Commitment, std::vector<UTXO::CPtr>> CoinsViewDB::LookupUTXOs(const std::vector<Commitment>& commitments) const
+{
+    CoinDB coinDB(GetDatabase().get(), nullptr);
+
+    std::unordered_map<Commitment, std::vector<UTXO::CPtr>> utxos_by_commitment;
+    for (auto& utxo : coinDB.GetUTXOs(commitments)) {
+        utxos_by_commitment.insert({ utxo.first, { std::move(utxo.second) } });
+    }
+
+    return utxos_by_commitment;
+}
+
 std::vector<UTXO::CPtr> CoinsViewDB::GetUTXOs(const CoinDB& coinDB, const Commitment& commitment) const
 {
     std::vector<uint8_t> value;
@@ -72,4 +84,15 @@ void CoinsViewDB::WriteBatch(const std::unique_ptr<libmw::IDBBatch>& pBatch, con
     }
 }
 
+void CoinsViewDB::OnFlushed(MMRInfo& mmr_info, const libmw::IDBBatch::UPtr& pBatch)
+{
+    if (m_pCompactionScheduler != nullptr) {
+        m_pCompactionScheduler->OnFlush(GetBestHeader(), *m_pOutputPMMR, mmr_info);
+
+        if (m_pLeafPruner != nullptr) {
+            m_pLeafPruner->Prune(GetDatabase().get(), pBatch.get(), m_pCompactionScheduler->GetHorizonIndex());
+        }
+    }
+}
+
 END_NAMESPACE
\ No newline at end of file
@@ -1,35 +1,127 @@
 #include "CoinsViewFactory.h"
 
+#include <mw/common/ThreadPool.h>
 #include <mw/crypto/Bulletproofs.h>
 #include <mw/crypto/Schnorr.h>
 #include <mw/consensus/KernelSumValidator.h>
 #include <mw/db/CoinDB.h>
 #include <mw/db/LeafDB.h>
+#include <mw/db/LeafPruneDB.h>
 #include <mw/db/MMRInfoDB.h>
+#include <mw/db/StateApplyDB.h>
 #include <mw/exceptions/ValidationException.h>
 #include <mw/mmr/backends/FileBackend.h>
-#include <mw/mmr/MMRFactory.h>
 #include <mw/mmr/MMRUtil.h>
 
 static const size_t KERNEL_BATCH_SIZE = 512;
-static const size_t PROOF_BATCH_SIZE = 512;
+static const size_t PROOF_BATCH_SIZE = 128;
+
+// Leaves are hashed in parallel, in groups of at least this many.
+static const uint64_t MIN_LEAVES_PER_TASK = 256;
+
+// Reading more chunks waits once this many checks per pool thread are outstanding,
+// which bounds how many chunks are held in memory.
+static const size_t MAX_PENDING_PER_THREAD = 4;
 
 mw::CoinsViewDB::Ptr CoinsViewFactory::CreateDBView(
 	const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
 	const libmw::IChain::Ptr& pChain,
-    const FilePath& chainDir,
+	const FilePath& chainDir,
+	const mw::Header::CPtr& pStateHeader,
+	const BitSet& leafset,
+	const mw::StateChunkReader& read_chunk,
+	const mw::CompactionScheduler::Ptr& pCompactionScheduler,
+	const mw::LeafPruner::Ptr& pLeafPruner)
+{
+	// An earlier apply may have been interrupted.
+	RemovePartialState(pDBWrapper);
+
+	try {
+		return ApplyState(pDBWrapper, pChain, chainDir, pStateHeader, leafset, read_chunk, pCompactionScheduler, pLeafPruner);
+	} catch (...) {
+		RemovePartialState(pDBWrapper);
+		throw;
+	}
+}
+
+void CoinsViewFactory::RemovePartialState(const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper)
+{
+	auto pProgress = StateApplyDB(pDBWrapper.get()).Get();
+	if (pProgress == nullptr) {
+		return;
+	}
+
+	LOG_INFO_F(
+		"Removing a partially applied state: {} kernels, {} outputs",
+		pProgress->num_kernels,
+		pProgress->num_outputs
+	);
+
+	// Removed a chunk's worth of leaves at a time, so the batches stay small.
+	for (uint64_t begin = 0; begin < pProgress->num_kernels; begin += mw::StateChunk::MAX_LEAVES) {
+		const uint64_t end = std::min(begin + mw::StateChunk::MAX_LEAVES, pProgress->num_kernels);
+
+		std::vector<mmr::LeafIndex> indices;
+		indices.reserve(end - begin);
+		for (uint64_t i = begin; i < end; i++) {
+			indices.push_back(mmr::LeafIndex::At(i));
+		}
+
+		auto pBatch = pDBWrapper->CreateBatch();
+		LeafDB('K', pDBWrapper.get(), pBatch.get()).Remove(indices);
+		pBatch->Commit();
+	}
+
+	for (uint64_t begin = 0; begin < pProgress->num_outputs; begin += mw::StateChunk::MAX_LEAVES) {
+		const uint64_t end = std::min(begin + mw::StateChunk::MAX_LEAVES, pProgress->num_outputs);
+
+		// Only the unspent outputs were written. Their leaves hold the OutputIds, which give the UTXOs' commitments.
+		std::vector<mmr::LeafIndex> indices;
+		std::vector<Commitment> commitments;
+		for (uint64_t i = begin; i < end; i++) {
+			auto pLeaf = LeafDB('O', pDBWrapper.get()).Get(mmr::LeafIndex::At(i));
+			if (pLeaf != nullptr) {
+				Deserializer deserializer(pLeaf->vec());
+				commitments.push_back(deserializer.Read<OutputId>().GetCommitment());
+				indices.push_back(pLeaf->GetLeafIndex());
+			}
+		}
+
+		if (!indices.empty()) {
+			auto pBatch = pDBWrapper->CreateBatch();
+			LeafDB('O', pDBWrapper.get(), pBatch.get()).Remove(indices);
+			CoinDB(pDBWrapper.get(), pBatch.get()).RemoveUTXOs(commitments);
+			pBatch->Commit();
+		}
+	}
+
+	// Removed last, so an interrupted cleanup starts over.
+	auto pBatch = pDBWrapper->CreateBatch();
+	StateApplyDB(pDBWrapper.get(), pBatch.get()).Remove();
+	pBatch->Commit();
+}
+
+mw::CoinsViewDB::Ptr CoinsViewFactory::ApplyState(
+	const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
+	const libmw::IChain::Ptr& pChain,
+	const FilePath& chainDir,
 	const mw::Header::CPtr& pStateHeader,
-    const std::vector<UTXO::CPtr>& utxos,
-    const std::vector<Kernel>& kernels,
 	const BitSet& leafset,
-	const std::vector<mw::Hash>& pruned_parent_hashes)
+	const mw::StateChunkReader& read_chunk,
+	const mw::CompactionScheduler::Ptr& pCompactionScheduler,
+	const mw::LeafPruner::Ptr& pLeafPruner)
 {
-    if (kernels.size() != pStateHeader->GetNumKernels()) {
-        ThrowValidation(EConsensusError::MMR_MISMATCH);
-    }
+	// The leafset may have been padded to a whole number of bytes.
+	const uint64_t num_txos = pStateHeader->GetNumTXOs();
+	BitSet unspent_leaves = leafset;
+	unspent_leaves.bitset.resize(num_txos);
+	if (leafset.size() < num_txos || unspent_leaves.count() != leafset.count()) {
+		ThrowValidation(EConsensusError::MMR_MISMATCH);
+	}
 
 	/**
-	 * Update MMRInfo
+	 * Determine the new MMRInfo.
+	 * It's only saved once the whole state has been validated.
 	 */
 	auto pMMRInfo = MMRInfoDB(pDBWrapper.get()).GetLatest();
 	MMRInfo mmr_info = pMMRInfo ? *pMMRInfo : MMRInfo{};
@@ -37,14 +129,19 @@ mw::CoinsViewDB::Ptr CoinsViewFactory::CreateDBView(
 	mmr_info.pruned = pStateHeader->GetHash();
 	mmr_info.compact_index++;
 	mmr_info.compacted = pStateHeader->GetHash();
-	MMRInfoDB(pDBWrapper.get()).Save(mmr_info);
-
+	mmr_info.height = pStateHeader->GetHeight();
+	mmr_info.compacted_height = pStateHeader->GetHeight();
 
 	/**
 	 * Build LeafSet
 	 */
-	File(mmr::LeafSet::GetPath(chainDir, mmr_info.index))
-		.Write(leafset.bytes());
+	File leafset_file(mmr::LeafSet::GetPath(chainDir, mmr_info.index));
+	if (leafset_file.Exists()) {
+		leafset_file.GetPath().Remove();
+	}
+
+	// The first 8 bytes of the file are the next leaf index.
+	leafset_file.Write(Serializer().Append<uint64_t>(num_txos).Append(unspent_leaves.bytes()).vec());
 	auto pLeafSet = mmr::LeafSet::Open(chainDir, mmr_info.index);
 	if (pLeafSet->Root() != pStateHeader->GetLeafsetRoot()) {
 		ThrowValidation(EConsensusError::MMR_MISMATCH);
@@ -53,188 +150,295 @@ mw::CoinsViewDB::Ptr CoinsViewFactory::CreateDBView(
 	/**
 	 * Build PruneList
 	 */
-	BitSet compact_bitset = mmr::MMRUtil::BuildCompactBitSet(pStateHeader->GetNumTXOs(), leafset);
-	File(mmr::PruneList::GetPath(chainDir, mmr_info.compact_index))
-		.Write(compact_bitset.bytes());
+	File prune_list_file(mmr::PruneList::GetPath(chainDir, mmr_info.compact_index));
+	if (prune_list_file.Exists()) {
+		prune_list_file.GetPath().Remove();
+	}
+
+	prune_list_file.Write(mmr::MMRUtil::BuildCompactBitSet(num_txos, unspent_leaves).bytes());
 	auto pPruneList = mmr::PruneList::Open(chainDir, mmr_info.compact_index);
 
 	/**
-	 * Build KernelMMR
+	 * Apply each chunk
 	 */
-	auto pBatch = pDBWrapper->CreateBatch();
-    auto pKernelMMR = BuildAndValidateKernelMMR(
-        pDBWrapper,
-		pBatch,
-		mmr_info,
-        pChain,
-        chainDir,
-        pStateHeader,
-        kernels
-    );
-	
-	/**
-	 * Build Output PMMR
-	 */
-	auto pOutputPMMR = BuildAndValidateOutputMMR(
-		pDBWrapper,
-		pBatch,
-		mmr_info,
-		chainDir,
+	BitSet all_kernels(pStateHeader->GetNumKernels());
+	all_kernels.bitset.set();
+
+	ApplyContext context{
 		pStateHeader,
-		utxos,
-		leafset,
-		pPruneList,
-		pruned_parent_hashes
+		pChain->NewIterator(),
+		mmr::MMRBuilder(mmr::FileBackend::GetPath(chainDir, 'K', mmr_info.index), all_kernels),
+		mmr::MMRBuilder(mmr::FileBackend::GetPath(chainDir, 'O', mmr_info.index), unspent_leaves),
+		Commitment{},
+		Commitment{},
+		0,
+		{},
+		0,
+		{},
+		{},
+		{},
+		mw::StateApplyProgress{}
+	};
+	assert(context.pChainIter->Valid());
+
+	const size_t max_pending = MAX_PENDING_PER_THREAD * ThreadPool::Get().GetNumThreads();
+
+	mw::StateChunk chunk;
+	while (read_chunk(chunk)) {
+		// Shared with the checks that are still running after the chunk is applied.
+		auto pChunk = std::make_shared<const mw::StateChunk>(std::move(chunk));
+
+		if (pChunk->type == mw::EStateChunkType::KERNELS) {
+			ApplyKernelChunk(pChunk, context);
+		} else {
+			ApplyOutputChunk(pChunk, context);
+		}
+
+		WaitForChecks(context, max_pending);
+		CommitChunks(pDBWrapper, context);
+	}
+
+	WaitForChecks(context, 0);
+	CommitChunks(pDBWrapper, context);
+
+	if (context.kernel_builder.GetNextLeafIdx().Get() != pStateHeader->GetNumKernels()
+		|| context.output_builder.GetNextLeafIdx().Get() != num_txos) {
+		ThrowValidation(EConsensusError::MMR_MISMATCH);
+	}
+
+	context.kernel_builder.Flush();
+	context.output_builder.Flush();
+
+	auto pKernelMMR = std::make_shared<mmr::MMR>(
+		mmr::FileBackend::Open('K', chainDir, mmr_info.index, pDBWrapper, nullptr)
+	);
+	auto pOutputPMMR = std::make_shared<mmr::MMR>(
+		mmr::FileBackend::Open('O', chainDir, mmr_info.index, pDBWrapper, pPruneList)
 	);
+	if (pKernelMMR->Root() != pStateHeader->GetKernelRoot()
+		|| pOutputPMMR->Root() != pStateHeader->GetOutputRoot()) {
+		ThrowValidation(EConsensusError::MMR_MISMATCH);
+	}
 
 	/**
 	 * Validate block sums
 	 */
-    std::vector<Commitment> utxo_commitments;
-    std::transform(
-        utxos.cbegin(), utxos.cend(),
-        std::back_inserter(utxo_commitments),
-        [](const UTXO::CPtr& pUTXO) { return pUTXO->GetCommitment(); }
-    );
-
-	KernelSumValidator::ValidateState(
-		utxo_commitments,
-		kernels,
-		pStateHeader->GetKernelOffset()
-	);
+	assert(context.pending_checks.empty() && context.pending_chunks.empty());
+	assert(context.kernel_sums.empty() && context.utxo_sums.empty());
+	mw::StateSums sums(context.utxo_sum, context.kernel_sum, context.total_mw_supply);
+	KernelSumValidator::ValidateState(sums, pStateHeader->GetKernelOffset());
 
-	// Add UTXOs to database
-	CoinDB coinDB(pDBWrapper.get(), pBatch.get());
-	coinDB.AddUTXOs(utxos);
+	mmr_info.version = MMRInfo::HEIGHT_VERSION;
+	mmr_info.sums = sums;
+
+	// The chunks' leaves and UTXOs are only used once the MMRInfo that points to this state is saved.
+	auto pBatch = pDBWrapper->CreateBatch();
+	MMRInfoDB(pDBWrapper.get(), pBatch.get()).Save(mmr_info);
+	StateApplyDB(pDBWrapper.get(), pBatch.get()).Remove();
+
+	// Earlier prune passes were for leafsets that were replaced by this state.
+	LeafPruneDB(pDBWrapper.get(), pBatch.get()).Save(LeafPruneState{});
 	pBatch->Commit();
 
-	return std::make_shared<mw::CoinsViewDB>(
+	auto pDBView = std::make_shared<mw::CoinsViewDB>(
 		pStateHeader,
 		pDBWrapper,
 		pLeafSet,
 		pKernelMMR,
-		pOutputPMMR
+		pOutputPMMR,
+		pCompactionScheduler,
+		pLeafPruner
 	);
+	pDBView->SetStateSums(sums);
+	return pDBView;
 }
 
 // TODO: Do we also want to validate peg-in/peg-out transactions beyond the horizon?
 // This will require us to save the hogex txs to disk, and never prune them.
-mmr::MMR::Ptr CoinsViewFactory::BuildAndValidateKernelMMR(
-    const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-	const std::unique_ptr<libmw::IDBBatch>& pBatch,
-	const MMRInfo& mmr_info,
-	const libmw::IChain::Ptr& pChain,
-    const FilePath& chainDir,
-    const mw::Header::CPtr& pStateHeader,
-    const std::vector<Kernel>& kernels)
+void CoinsViewFactory::ApplyKernelChunk(
+	const std::shared_ptr<const mw::StateChunk>& pChunk,
+	ApplyContext& context)
 {
-    mmr::MMR::Ptr pMMR = std::make_shared<mmr::MMR>(
-		mmr::FileBackend::Open('K', chainDir, mmr_info.index, pDBWrapper, nullptr)
-	);
+	const mw::StateChunk& chunk = *pChunk;
+	if (chunk.first_leaf != context.kernel_builder.GetNextLeafIdx().Get()
+		|| chunk.kernels.size() != chunk.num_leaves
+		|| !chunk.utxos.empty()
+		|| !chunk.pruned_parent_hashes.empty()) {
+		ThrowValidation(EConsensusError::MMR_MISMATCH);
+	}
 
-	auto pChainIter = pChain->NewIterator();
-	assert(pChainIter->Valid());
+	// Verify kernel signatures
+	for (size_t begin = 0; begin < chunk.kernels.size(); begin += KERNEL_BATCH_SIZE) {
+		const size_t end = std::min(begin + KERNEL_BATCH_SIZE, chunk.kernels.size());
+		context.pending_checks.push_back(ThreadPool::Get().Enqueue([pChunk, begin, end]() {
+			std::vector<SignedMessage> signatures;
+			signatures.reserve(end - begin);
+			for (size_t i = begin; i < end; i++) {
+				const Kernel& kernel = pChunk->kernels[i];
+				signatures.push_back({ kernel.GetSignatureMessage(), Crypto::ToPublicKey(kernel.GetCommitment()), kernel.GetSignature() });
+			}
 
-	std::vector<mmr::Leaf> leaves;
-	leaves.reserve(kernels.size());
+			if (!Schnorr::BatchVerify(signatures)) {
+				ThrowValidation(EConsensusError::INVALID_SIG);
+			}
+		}));
+	}
 
-	uint64_t kernels_added = 0;
-    for (const Kernel& kernel : kernels)
-    {
+	context.kernel_sums.push_back(ThreadPool::Get().Enqueue([pChunk]() {
+		return Crypto::AddCommitments(Commitments::From(pChunk->kernels));
+	}));
+
+	std::vector<mmr::Leaf> leaves(chunk.kernels.size());
+	ThreadPool::Get().ParallelFor(0, leaves.size(), MIN_LEAVES_PER_TASK, [&chunk, &leaves](const uint64_t begin, const uint64_t end) {
+		for (uint64_t i = begin; i < end; i++) {
+			leaves[i] = mmr::Leaf::Create(mmr::LeafIndex::At(chunk.first_leaf + i), chunk.kernels[i].Serialized());
+		}
+	});
+
+	auto& pChainIter = context.pChainIter;
+	for (size_t i = 0; i < leaves.size(); i++)
+	{
 		if (!pChainIter->Valid()) {
 			ThrowValidation(EConsensusError::MMR_MISMATCH);
 		}
 
-        mmr::LeafIndex leaf_idx = pMMR->Add(kernel);
-		leaves.push_back(mmr::Leaf::Create(leaf_idx, kernel.Serialized()));
-
-		++kernels_added;
+		context.kernel_builder.Add(leaves[i].GetLeafIndex().Next(), { leaves[i] }, {});
 
-        // We have to loop here because some blocks may not have any new kernels.
-        while (pChainIter->Valid() && kernels_added == pChainIter->GetHeader().pHeader->GetNumKernels())
-        {
-            if (pChainIter->GetHeader().pHeader->GetKernelRoot() != pMMR->Root()) {
-                ThrowValidation(EConsensusError::MMR_MISMATCH);
-            }
+		// We have to loop here because some blocks may not have any new kernels.
+		const uint64_t kernels_added = context.kernel_builder.GetNextLeafIdx().Get();
+		while (pChainIter->Valid() && kernels_added == pChainIter->GetHeader().pHeader->GetNumKernels())
+		{
+			if (pChainIter->GetHeader().pHeader->GetKernelRoot() != context.kernel_builder.Root()) {
+				ThrowValidation(EConsensusError::MMR_MISMATCH);
+			}
 
-            if (pChainIter->GetHeader().pHeader == pStateHeader) {
-                break;
-            }
+			if (pChainIter->GetHeader().pHeader == context.pStateHeader) {
+				break;
+			}
 
 			pChainIter->Next();
-        }
-    }
+		}
 
-	LeafDB('K', pDBWrapper.get(), pBatch.get())
-		.Add(leaves);
+		// Total supply can never go below 0
+		context.total_mw_supply += chunk.kernels[i].GetSupplyChange();
+		if (context.total_mw_supply < 0) {
+			ThrowValidation(EConsensusError::BLOCK_SUMS);
+		}
+	}
 
-	// Verify kernel signatures
-	std::vector<SignedMessage> signatures;
-	for (const Kernel& kernel : kernels)
-	{
-		PublicKey pubkey = Crypto::ToPublicKey(kernel.GetCommitment());
-		signatures.push_back({ kernel.GetSignatureMessage(), std::move(pubkey), kernel.GetSignature() });
+	context.pending_chunks.push_back({ pChunk, std::move(leaves), context.checks_passed + context.pending_checks.size() });
+}
 
-		if (signatures.size() >= KERNEL_BATCH_SIZE) {
-			if (!Schnorr::BatchVerify(signatures)) {
-				ThrowValidation(EConsensusError::INVALID_SIG);
+void CoinsViewFactory::ApplyOutputChunk(
+	const std::shared_ptr<const mw::StateChunk>& pChunk,
+	ApplyContext& context)
+{
+	const mw::StateChunk& chunk = *pChunk;
+	if (chunk.first_leaf != context.output_builder.GetNextLeafIdx().Get() || !chunk.kernels.empty()) {
+		ThrowValidation(EConsensusError::MMR_MISMATCH);
+	}
+
+	// Verify range proofs.
+	// UTXOs covered by another output's aggregated proof are stored with that output, so its proof is verified for them,
+	// once per batch, after checking that it covers them.
+	for (size_t begin = 0; begin < chunk.utxos.size(); begin += PROOF_BATCH_SIZE) {
+		const size_t end = std::min(begin + PROOF_BATCH_SIZE, chunk.utxos.size());
+		context.pending_checks.push_back(ThreadPool::Get().Enqueue([pChunk, begin, end]() {
+			std::vector<ProofData> proofs;
+			proofs.reserve(end - begin);
+			for (size_t i = begin; i < end; i++) {
+				const UTXO& utxo = *pChunk->utxos[i];
+				ProofData proof = utxo.BuildProofData();
+				if (utxo.GetProofOutput() != nullptr) {
+					const std::vector<Commitment>& covered = proof.aggregated_commits;
+					if (std::find(covered.cbegin(), covered.cend(), utxo.GetCommitment()) == covered.cend()) {
+						ThrowValidation(EConsensusError::BULLETPROOF);
+					}
+				}
+
+				if (proof.aggregated_commits.empty() || std::find(proofs.cbegin(), proofs.cend(), proof) == proofs.cend()) {
+					proofs.push_back(std::move(proof));
+				}
 			}
 
-			signatures.clear();
-		}
+			if (!Bulletproofs::BatchVerify(proofs)) {
+				ThrowValidation(EConsensusError::BULLETPROOF);
+			}
+		}));
 	}
 
-	if (!signatures.empty()) {
-		if (!Schnorr::BatchVerify(signatures)) {
-			ThrowValidation(EConsensusError::INVALID_SIG);
+	context.utxo_sums.push_back(ThreadPool::Get().Enqueue([pChunk]() {
+		std::vector<Commitment> utxo_commitments;
+		utxo_commitments.reserve(pChunk->utxos.size());
+		std::transform(
+			pChunk->utxos.cbegin(), pChunk->utxos.cend(),
+			std::back_inserter(utxo_commitments),
+			[](const UTXO::CPtr& pUTXO) { return pUTXO->GetCommitment(); }
+		);
+		return Crypto::AddCommitments(utxo_commitments);
+	}));
+
+	std::vector<mmr::Leaf> leaves(chunk.utxos.size());
+	ThreadPool::Get().ParallelFor(0, leaves.size(), MIN_LEAVES_PER_TASK, [&chunk, &leaves](const uint64_t begin, const uint64_t end) {
+		for (uint64_t i = begin; i < end; i++) {
+			const UTXO::CPtr& pUTXO = chunk.utxos[i];
+			leaves[i] = mmr::Leaf::Create(pUTXO->GetLeafIndex(), pUTXO->ToOutputId().Serialized());
 		}
-	}
+	});
 
-    return pMMR;
+	// Fails unless the UTXOs are exactly the unspent leaves in the chunk's range.
+	context.output_builder.Add(chunk.GetNextLeafIdx(), leaves, chunk.pruned_parent_hashes);
+
+	context.pending_chunks.push_back({ pChunk, std::move(leaves), context.checks_passed + context.pending_checks.size() });
 }
 
-mmr::MMR::Ptr CoinsViewFactory::BuildAndValidateOutputMMR(
-    const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-	const std::unique_ptr<libmw::IDBBatch>& pBatch,
-	const MMRInfo& mmr_info,
-    const FilePath& chainDir,
-    const mw::Header::CPtr& pStateHeader,
-    const std::vector<UTXO::CPtr>& utxos,
-	const BitSet& leafset,
-	const mmr::PruneList::Ptr& pPruneList,
-	const std::vector<mw::Hash>& pruned_parent_hashes)
+void CoinsViewFactory::CommitChunks(const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper, ApplyContext& context)
 {
-	if (leafset.count() != utxos.size()) {
-		ThrowValidation(EConsensusError::MMR_MISMATCH);
-	}
+	while (!context.pending_chunks.empty() && context.pending_chunks.front().checks_queued <= context.checks_passed) {
+		const PendingChunk& pending = context.pending_chunks.front();
+		const mw::StateChunk& chunk = *pending.pChunk;
+
+		auto pBatch = pDBWrapper->CreateBatch();
+		if (chunk.type == mw::EStateChunkType::KERNELS) {
+			LeafDB('K', pDBWrapper.get(), pBatch.get())
+				.Add(pending.leaves);
+			context.progress.num_kernels = chunk.GetNextLeafIdx().Get();
+		} else {
+			// Every output in the chunk's range may have been spent.
+			if (!chunk.utxos.empty()) {
+				LeafDB('O', pDBWrapper.get(), pBatch.get())
+					.Add(pending.leaves);
+				CoinDB(pDBWrapper.get(), pBatch.get())
+					.AddUTXOs(chunk.utxos);
+			}
 
-	std::vector<mmr::Leaf> output_leaves;
-	size_t utxo_idx = 0;
-	for (uint64_t i = 0; i < leafset.size(); i++) {
-		if (leafset.test(i)) {
-			const UTXO::CPtr& pUTXO = utxos[utxo_idx++];
-			output_leaves.push_back(
-				mmr::Leaf::Create(mmr::LeafIndex::At(i), pUTXO->ToOutputId().Serialized())
-			);
+			context.progress.num_outputs = chunk.GetNextLeafIdx().Get();
 		}
-	}
 
-	mmr::MMR::Ptr pOutputPMMR = mmr::MMRFactory::Build(
-		'O',
-		pDBWrapper,
-		pBatch,
-		pPruneList,
-		mmr_info,
-		chainDir,
-		leafset,
-		output_leaves,
-		pruned_parent_hashes
-	);
+		StateApplyDB(pDBWrapper.get(), pBatch.get()).Save(context.progress);
+		pBatch->Commit();
 
-	if (pOutputPMMR->Root() != pStateHeader->GetOutputRoot()
-		|| pOutputPMMR->GetNumLeaves() != pStateHeader->GetNumTXOs()) {
-		ThrowValidation(EConsensusError::MMR_MISMATCH);
+		context.pending_chunks.pop_front();
 	}
+}
 
-	return pOutputPMMR;
-}
\ No newline at end of file
+void CoinsViewFactory::WaitForChecks(ApplyContext& context, const size_t max_pending)
+{
+	while (context.pending_checks.size() > max_pending) {
+		context.pending_checks.front().get();
+		context.pending_checks.pop_front();
+		context.checks_passed++;
+	}
+
+	// Sums that have already finished are added too, so the totals keep up with the chunks.
+	auto add_partial_sums = [max_pending](std::deque<std::future<Commitment>>& partial_sums, Commitment& total) {
+		while (!partial_sums.empty()
+			&& (partial_sums.size() > max_pending || partial_sums.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+			total = Crypto::AddCommitments({ total, partial_sums.front().get() });
+			partial_sums.pop_front();
+		}
+	};
+
+	add_partial_sums(context.kernel_sums, context.kernel_sum);
+	add_partial_sums(context.utxo_sums, context.utxo_sum);
+}
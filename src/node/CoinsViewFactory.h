@@ -2,50 +2,114 @@
 
 #include <mw/common/BitSet.h>
 #include <mw/file/FilePath.h>
-#include <mw/mmr/MMR.h>
+#include <mw/mmr/MMRBuilder.h>
 #include <mw/mmr/MMRInfo.h>
-#include <mw/mmr/PruneList.h>
 #include <mw/models/block/Header.h>
-#include <mw/models/tx/UTXO.h>
 #include <mw/node/CoinsView.h>
+#include <mw/node/StateChunk.h>
 #include <libmw/interfaces/chain_interface.h>
 #include <libmw/interfaces/db_interface.h>
-#include <functional>
+
+#include <deque>
+#include <future>
 
 class CoinsViewFactory
 {
 public:
+    //
+    // Validates the state one chunk at a time, building the MMR files as it goes.
+    // Only the chunks that are still being verified, the leafset, and the peaks of the MMRs are held in memory.
+    // Each chunk's leaves and UTXOs are committed in a batch of their own once its checks pass,
+    // but nothing refers to them until the MMRInfo is saved, after the whole state is valid.
+    // If the apply fails, whatever was committed is removed again.
+    //
     static mw::CoinsViewDB::Ptr CreateDBView(
         const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
         const libmw::IChain::Ptr& pChain,
         const FilePath& chainDir,
         const mw::Header::CPtr& pStateHeader,
-        const std::vector<UTXO::CPtr>& utxos,
-        const std::vector<Kernel>& kernels,
         const BitSet& leafset,
-        const std::vector<mw::Hash>& pruned_parent_hashes
+        const mw::StateChunkReader& read_chunk,
+        const mw::CompactionScheduler::Ptr& pCompactionScheduler,
+        const mw::LeafPruner::Ptr& pLeafPruner
     );
 
+    //
+    // Removes the leaves and UTXOs of a state whose apply failed or was interrupted, if there is one.
+    //
+    static void RemovePartialState(const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper);
+
 private:
-    static mmr::MMR::Ptr BuildAndValidateKernelMMR(
+    // A chunk that was applied, but not yet committed.
+    struct PendingChunk
+    {
+        std::shared_ptr<const mw::StateChunk> pChunk;
+        std::vector<mmr::Leaf> leaves;
+
+        // The number of checks queued once the chunk was applied. It's committed once that many have passed.
+        size_t checks_queued;
+    };
+
+    // Everything that's carried over from one chunk to the next.
+    struct ApplyContext
+    {
+        const mw::Header::CPtr& pStateHeader;
+        std::unique_ptr<libmw::IChainIterator> pChainIter;
+        mmr::MMRBuilder kernel_builder;
+        mmr::MMRBuilder output_builder;
+        Commitment kernel_sum;
+        Commitment utxo_sum;
+        int64_t total_mw_supply;
+
+        // Signature and range proof batches that are queued or running on the thread pool.
+        std::deque<std::future<void>> pending_checks;
+        size_t checks_passed;
+
+        // Applied chunks, in order, that are waiting on their checks.
+        std::deque<PendingChunk> pending_chunks;
+
+        // Partial sums of each chunk's commitments, in chunk order, that haven't been added to the totals yet.
+        std::deque<std::future<Commitment>> kernel_sums;
+        std::deque<std::future<Commitment>> utxo_sums;
+
+        // What has been committed so far.
+        mw::StateApplyProgress progress;
+    };
+
+    static mw::CoinsViewDB::Ptr ApplyState(
         const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-        const std::unique_ptr<libmw::IDBBatch>& pBatch,
-        const MMRInfo& mmr_info,
         const libmw::IChain::Ptr& pChain,
         const FilePath& chainDir,
         const mw::Header::CPtr& pStateHeader,
-        const std::vector<Kernel>& kernels
+        const BitSet& leafset,
+        const mw::StateChunkReader& read_chunk,
+        const mw::CompactionScheduler::Ptr& pCompactionScheduler,
+        const mw::LeafPruner::Ptr& pLeafPruner
     );
 
-    static mmr::MMR::Ptr BuildAndValidateOutputMMR(
-        const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
-        const std::unique_ptr<libmw::IDBBatch>& pBatch,
-        const MMRInfo& mmr_info,
-        const FilePath& chainDir,
-        const mw::Header::CPtr& pStateHeader,
-        const std::vector<UTXO::CPtr>& utxos,
-        const BitSet& leafset,
-        const mmr::PruneList::Ptr& pPruneList,
-        const std::vector<mw::Hash>& pruned_parent_hashes
+    //
+    // The MMRs are built on the calling thread, while the chunk's signatures, range proofs and sums
+    // are verified on the thread pool. The chunk is then held until CommitChunks writes it.
+    //
+    static void ApplyKernelChunk(
+        const std::shared_ptr<const mw::StateChunk>& pChunk,
+        ApplyContext& context
     );
-};
\ No newline at end of file
+
+    static void ApplyOutputChunk(
+        const std::shared_ptr<const mw::StateChunk>& pChunk,
+        ApplyContext& context
+    );
+
+    //
+    // Commits each pending chunk whose checks, and those of every chunk before it, have passed.
+    //
+    static void CommitChunks(const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper, ApplyContext& context);
+
+    //
+    // Waits until no more than max_pending checks and partial sums of each type are outstanding,
+    // adding finished partial sums to the totals. Rethrows the first failed check.
+    // Called with 0 once every chunk is read, so all of their checks have passed before the MMRInfo is saved.
+    //
+    static void WaitForChecks(ApplyContext& context, const size_t max_pending);
+};
@@ -0,0 +1,155 @@
+#include <mw/node/CompactionScheduler.h>
+#include <mw/common/Logger.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/db/MMRInfoDB.h>
+#include <mw/mmr/LeafSet.h>
+#include <mw/mmr/MMRUtil.h>
+
+using namespace mw;
+
+void CompactionScheduler::Load(libmw::IDBWrapper* pDBWrapper)
+{
+    MMRInfoDB mmr_info_db(pDBWrapper, nullptr);
+    auto pLatest = mmr_info_db.GetLatest();
+    if (pLatest == nullptr || !pLatest->height || m_horizon == 0) {
+        return;
+    }
+
+    m_lastCompactedHeight = pLatest->compacted_height;
+
+    // Walks back through the saved flushes until one is beyond the horizon.
+    // Flushes at or above a later flush's height were disconnected.
+    std::deque<Checkpoint> checkpoints;
+    for (uint32_t index = pLatest->index; index > 0; index--) {
+        auto pMMRInfo = mmr_info_db.GetByIndex(index);
+        if (pMMRInfo == nullptr || !pMMRInfo->height) {
+            break;
+        }
+
+        const uint64_t height = *pMMRInfo->height;
+        if (!checkpoints.empty() && height >= checkpoints.front().height) {
+            continue;
+        }
+
+        checkpoints.push_front(Checkpoint{ height, pMMRInfo->pruned, index });
+        if (height + m_horizon <= *pLatest->height) {
+            break;
+        }
+    }
+
+    m_checkpoints = std::move(checkpoints);
+    UpdateHorizon(*pLatest->height);
+
+    LOG_DEBUG_F("Restored {} compaction checkpoints", m_checkpoints.size() + (m_horizonCheckpoint ? 1 : 0));
+}
+
+uint64_t CompactionScheduler::OnFlush(const mw::Header::CPtr& pHeader, mmr::MMR& output_pmmr, MMRInfo& mmr_info)
+{
+    if (pHeader == nullptr || m_horizon == 0) {
+        return 0;
+    }
+
+    // The files just written include the compaction staged by the previous flush.
+    const uint64_t bytes_reclaimed = m_staged ? ApplyStaged(mmr_info) : 0;
+
+    // Flushes at or above the new tip were disconnected.
+    while (!m_checkpoints.empty() && m_checkpoints.back().height >= pHeader->GetHeight()) {
+        m_checkpoints.pop_back();
+    }
+
+    if (m_pending && m_pending->checkpoint.height >= pHeader->GetHeight()) {
+        m_pending = boost::none;
+    }
+
+    m_checkpoints.push_back(Checkpoint{ pHeader->GetHeight(), pHeader->GetHash(), mmr_info.index });
+    UpdateHorizon(pHeader->GetHeight());
+
+    if (m_pending && m_pending->compacted.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        StagePending(output_pmmr, mmr_info);
+    }
+
+    if (!m_pending) {
+        SchedulePending();
+    }
+
+    return bytes_reclaimed;
+}
+
+void CompactionScheduler::Wait() const
+{
+    if (m_pending) {
+        m_pending->compacted.wait();
+    }
+}
+
+uint64_t CompactionScheduler::ApplyStaged(MMRInfo& mmr_info)
+{
+    Staged staged = std::move(*m_staged);
+    m_staged = boost::none;
+
+    mmr_info.compact_index = staged.compact_index;
+    mmr_info.compacted = staged.checkpoint.header_hash;
+    mmr_info.compacted_height = staged.checkpoint.height;
+    m_lastCompactedHeight = staged.checkpoint.height;
+
+    const uint64_t bytes_reclaimed = staged.num_removed * mw::Hash::size();
+    LOG_INFO_F(
+        "Compacted output PMMR to height {}: removed {} hashes, reclaiming {} bytes",
+        staged.checkpoint.height,
+        staged.num_removed,
+        bytes_reclaimed
+    );
+    return bytes_reclaimed;
+}
+
+void CompactionScheduler::StagePending(mmr::MMR& output_pmmr, const MMRInfo& mmr_info)
+{
+    Pending pending = std::move(*m_pending);
+    m_pending = boost::none;
+
+    try {
+        const uint32_t compact_index = mmr_info.compact_index + 1;
+        const uint64_t num_removed = output_pmmr.Compact(compact_index, pending.compacted.get());
+        if (num_removed == 0) {
+            LOG_DEBUG_F("Nothing to compact from output PMMR at height {}", pending.checkpoint.height);
+            return;
+        }
+
+        m_staged = Staged{ pending.checkpoint, compact_index, num_removed };
+        LOG_DEBUG_F("Staged output PMMR compaction for height {}", pending.checkpoint.height);
+    } catch (const std::exception& e) {
+        LOG_ERROR_F("Failed to compact output PMMR to height {}: {}", pending.checkpoint.height, e.what());
+    }
+}
+
+void CompactionScheduler::UpdateHorizon(const uint64_t tip_height)
+{
+    // Only the most recent flush that's beyond the horizon is needed. Older ones are discarded.
+    while (!m_checkpoints.empty() && m_checkpoints.front().height + m_horizon <= tip_height) {
+        m_horizonCheckpoint = m_checkpoints.front();
+        m_checkpoints.pop_front();
+    }
+}
+
+void CompactionScheduler::SchedulePending()
+{
+    if (!m_horizonCheckpoint || m_horizonCheckpoint->height == m_lastScheduledHeight) {
+        return;
+    }
+
+    const Checkpoint checkpoint = *m_horizonCheckpoint;
+    if (m_lastCompactedHeight && checkpoint.height < *m_lastCompactedHeight + m_interval) {
+        return;
+    }
+
+    FilePath datadir = m_datadir;
+    const uint32_t file_index = checkpoint.file_index;
+    std::shared_future<BitSet> compacted = ThreadPool::Get().Enqueue([datadir, file_index]() {
+        BitSet unspent_leaves = mmr::LeafSet::Open(datadir, file_index)->ToBitSet();
+        return mmr::MMRUtil::BuildCompactBitSet(unspent_leaves.size(), unspent_leaves);
+    }).share();
+
+    LOG_DEBUG_F("Calculating output PMMR compaction for height {}", checkpoint.height);
+    m_pending = Pending{ checkpoint, std::move(compacted) };
+    m_lastScheduledHeight = checkpoint.height;
+}
@@ -0,0 +1,69 @@
+#include <mw/node/LeafPruner.h>
+#include <mw/common/Logger.h>
+#include <mw/db/LeafDB.h>
+#include <mw/db/LeafPruneDB.h>
+#include <mw/mmr/LeafSet.h>
+#include <algorithm>
+
+using namespace mw;
+
+uint64_t LeafPruner::Prune(
+    libmw::IDBWrapper* pDBWrapper,
+    libmw::IDBBatch* pBatch,
+    const boost::optional<uint32_t>& horizon_index)
+{
+    LeafPruneDB pruneDB(pDBWrapper, pBatch);
+
+    auto pState = pruneDB.Get();
+    LeafPruneState state = pState ? *pState : LeafPruneState{};
+    if (!state.IsPassInProgress()) {
+        if (!horizon_index || *horizon_index == state.base_index) {
+            return 0;
+        }
+
+        state.target_index = *horizon_index;
+        state.next_leaf = 0;
+    }
+
+    const BitSet& base = GetLeafSet(state.base_index);
+    const BitSet& target = GetLeafSet(state.target_index);
+
+    std::vector<mmr::LeafIndex> spent_leaves;
+    uint64_t leaf_idx = state.next_leaf;
+    const uint64_t scan_end = std::min<uint64_t>(target.size(), leaf_idx + m_maxLeavesScannedPerFlush);
+    for (; leaf_idx < scan_end && spent_leaves.size() < m_maxLeavesPerFlush; leaf_idx++) {
+        // Leaves already spent in the base leafset were removed by an earlier pass.
+        const bool spent_in_base = leaf_idx < base.size() && !base.test(leaf_idx);
+        if (!target.test(leaf_idx) && !spent_in_base) {
+            spent_leaves.push_back(mmr::LeafIndex::At(leaf_idx));
+        }
+    }
+
+    LeafDB('O', pDBWrapper, pBatch).Remove(spent_leaves);
+
+    if (leaf_idx >= target.size()) {
+        LOG_DEBUG_F("Finished pruning spent leaves up to leafset {}", state.target_index);
+        state = LeafPruneState{ state.version, state.target_index, 0, 0 };
+
+        for (auto iter = m_leafsets.begin(); iter != m_leafsets.end();) {
+            iter = iter->first == state.base_index ? std::next(iter) : m_leafsets.erase(iter);
+        }
+    } else {
+        state.next_leaf = leaf_idx;
+    }
+
+    pruneDB.Save(state);
+    return spent_leaves.size();
+}
+
+const BitSet& LeafPruner::GetLeafSet(const uint32_t file_index)
+{
+    auto iter = m_leafsets.find(file_index);
+    if (iter == m_leafsets.end()) {
+        // Leafset 0 is never written by a flush, so it's always empty.
+        BitSet leafset = file_index == 0 ? BitSet{} : mmr::LeafSet::Open(m_datadir, file_index)->ToBitSet();
+        iter = m_leafsets.emplace(file_index, std::move(leafset)).first;
+    }
+
+    return iter->second;
+}
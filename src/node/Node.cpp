@@ -4,6 +4,8 @@
 #include <mw/consensus/ChainParams.h>
 #include <mw/db/MMRInfoDB.h>
 #include <mw/node/validation/BlockValidator.h>
+#include <mw/node/validation/StateValidator.h>
+#include <mw/consensus/KernelSumValidator.h>
 #include <mw/consensus/Aggregation.h>
 #include <mw/common/Logger.h>
 #include <mw/mmr/MMR.h>
@@ -14,10 +16,14 @@ mw::INode::Ptr mw::InitializeNode(
     const FilePath& datadir,
     const std::string& hrp,
     const mw::Header::CPtr& pBestHeader,
-    const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper)
+    const std::shared_ptr<libmw::IDBWrapper>& pDBWrapper,
+    const uint32_t prune_horizon)
 {
     mw::ChainParams::Initialize(hrp, libmw::PEGIN_MATURITY);
 
+    // The node may have stopped in the middle of applying a state.
+    CoinsViewFactory::RemovePartialState(pDBWrapper);
+
     auto current_mmr_info = MMRInfoDB(pDBWrapper.get(), nullptr).GetLatest();
     uint32_t file_index = current_mmr_info ? current_mmr_info->index : 0;
     uint32_t compact_index = current_mmr_info ? current_mmr_info->compact_index : 0;
@@ -31,15 +37,33 @@ mw::INode::Ptr mw::InitializeNode(
     auto pOutputBackend = mmr::FileBackend::Open('O', datadir, file_index, pDBWrapper, pPruneList);
     mmr::MMR::Ptr pOutputMMR = std::make_shared<mmr::MMR>(pOutputBackend);
 
+    auto pCompactionScheduler = std::make_shared<mw::CompactionScheduler>(datadir, prune_horizon);
+    pCompactionScheduler->Load(pDBWrapper.get());
+
     mw::CoinsViewDB::Ptr pDBView = std::make_shared<mw::CoinsViewDB>(
         pBestHeader,
         pDBWrapper,
         pLeafSet,
         pKernelsMMR,
-        pOutputMMR
+        pOutputMMR,
+        pCompactionScheduler,
+        std::make_shared<mw::LeafPruner>(datadir)
     );
 
-    return std::shared_ptr<mw::INode>(new Node(datadir, pDBView));
+    if (pBestHeader == nullptr) {
+        pDBView->SetStateSums(mw::StateSums{});
+    } else if (current_mmr_info && current_mmr_info->sums && current_mmr_info->pruned == pBestHeader->GetHash()) {
+        // The saved sums were updated with every block up to the best header, so only the totals need to be checked.
+        KernelSumValidator::ValidateState(*current_mmr_info->sums, pBestHeader->GetKernelOffset());
+        pDBView->SetStateSums(current_mmr_info->sums);
+    } else {
+        // Sums weren't saved before MMRInfo version 1, so they're calculated once and saved on the next flush.
+        // They're also recalculated when the saved sums are for another header, e.g. from another branch.
+        LOG_INFO("Calculating UTXO and kernel sums");
+        pDBView->SetStateSums(StateValidator().Validate(*pDBView));
+    }
+
+    return std::shared_ptr<mw::INode>(new Node(datadir, prune_horizon, pDBView));
 }
 
 Node::~Node()
@@ -60,6 +84,18 @@ void Node::ValidateBlock(
     LOG_TRACE_F("Block {} validated", pBlock);
 }
 
+std::future<void> Node::ValidateBlockAsync(
+    const mw::Block::Ptr& pBlock,
+    const mw::Hash& mweb_hash,
+    const std::vector<PegInCoin>& pegInCoins,
+    const std::vector<PegOutCoin>& pegOutCoins) const
+{
+    assert(pBlock != nullptr);
+
+    LOG_TRACE_F("Queueing validation of block {}", pBlock);
+    return BlockValidator::ValidateAsync(pBlock, mweb_hash, pegInCoins, pegOutCoins);
+}
+
 mw::BlockUndo::CPtr Node::ConnectBlock(const mw::Block::Ptr& pBlock, const mw::ICoinsView::Ptr& pView)
 {
     assert(pBlock != nullptr);
@@ -94,19 +130,17 @@ mw::ICoinsView::Ptr Node::ApplyState(
     const libmw::IDBWrapper::Ptr& pDBWrapper,
     const libmw::IChain::Ptr& pChain,
     const mw::Header::CPtr& pStateHeader,
-    const std::vector<UTXO::CPtr>& utxos,
-    const std::vector<Kernel>& kernels,
     const BitSet& leafset,
-    const std::vector<mw::Hash>& pruned_parent_hashes)
+    const mw::StateChunkReader& read_chunk)
 {
     return CoinsViewFactory::CreateDBView(
         pDBWrapper,
         pChain,
         m_datadir,
         pStateHeader,
-        utxos,
-        kernels,
         leafset,
-        pruned_parent_hashes
+        read_chunk,
+        std::make_shared<mw::CompactionScheduler>(m_datadir, m_pruneHorizon),
+        std::make_shared<mw::LeafPruner>(m_datadir)
     );
 }
\ No newline at end of file
@@ -6,8 +6,8 @@
 class Node : public mw::INode
 {
 public:
-    Node(const FilePath& datadir, const mw::CoinsViewDB::Ptr& pDBView)
-        : m_datadir(datadir), m_pDBView(pDBView) { }
+    Node(const FilePath& datadir, const uint32_t prune_horizon, const mw::CoinsViewDB::Ptr& pDBView)
+        : m_datadir(datadir), m_pruneHorizon(prune_horizon), m_pDBView(pDBView) { }
     ~Node();
 
     mw::CoinsViewDB::Ptr GetDBView() final { return m_pDBView; }
@@ -19,6 +19,13 @@ public:
         const std::vector<PegOutCoin>& pegOutCoins
     ) const final;
 
+    std::future<void> ValidateBlockAsync(
+        const mw::Block::Ptr& pBlock,
+        const mw::Hash& mweb_hash,
+        const std::vector<PegInCoin>& pegInCoins,
+        const std::vector<PegOutCoin>& pegOutCoins
+    ) const final;
+
     mw::BlockUndo::CPtr ConnectBlock(const mw::Block::Ptr& pBlock, const mw::ICoinsView::Ptr& pView) final;
     void DisconnectBlock(const mw::BlockUndo::CPtr& pUndoData, const mw::ICoinsView::Ptr& pView) final;
 
@@ -26,13 +33,12 @@ public:
         const libmw::IDBWrapper::Ptr& pDBWrapper,
         const libmw::IChain::Ptr& pChain,
         const mw::Header::CPtr& pStateHeader,
-        const std::vector<UTXO::CPtr>& utxos,
-        const std::vector<Kernel>& kernels,
         const BitSet& leafset,
-        const std::vector<mw::Hash>& pruned_parent_hashes
+        const mw::StateChunkReader& read_chunk
     ) final;
 
 private:
     FilePath m_datadir;
+    uint32_t m_pruneHorizon;
     mw::CoinsViewDB::Ptr m_pDBView;
 };
\ No newline at end of file
@@ -1,72 +1,245 @@
 #include <mw/node/Snapshot.h>
+#include <mw/exceptions/NotFoundException.h>
+#include <mw/exceptions/ValidationException.h>
 #include <mw/mmr/MMRUtil.h>
+#include <cassert>
 
 using namespace mw;
 
+// Chunks are copied from the temporary file into the snapshot file in pieces of up to this many bytes.
+static const size_t COPY_CHUNK_SIZE = 4 * 1024 * 1024;
+
+// Splits the kernels and outputs into chunks, only loading a chunk's contents when it's read.
+template<typename GetKernel, typename GetUTXO, typename GetHash>
+static StateChunkReader StreamChunks(
+    const uint64_t leaves_per_chunk,
+    const uint64_t num_kernels,
+    const std::shared_ptr<const BitSet>& pLeafset,
+    GetKernel get_kernel,
+    GetUTXO get_utxo,
+    GetHash get_pruned_parent_hash)
+{
+    assert(leaves_per_chunk > 0 && leaves_per_chunk <= StateChunk::MAX_LEAVES);
+
+    struct Cursor
+    {
+        uint64_t next_kernel;
+        uint64_t next_output;
+    };
+
+    auto pCursor = std::make_shared<Cursor>(Cursor{ 0, 0 });
+    auto pPrunedParents = std::make_shared<const BitSet>(mmr::MMRUtil::CalcPrunedParents(*pLeafset));
+
+    return [=](StateChunk& chunk) -> bool {
+        if (pCursor->next_kernel < num_kernels) {
+            const uint64_t first_leaf = pCursor->next_kernel;
+            const uint64_t num_leaves = std::min(leaves_per_chunk, num_kernels - first_leaf);
+
+            chunk = StateChunk(EStateChunkType::KERNELS, first_leaf, num_leaves, {}, {}, {});
+            chunk.kernels.reserve(num_leaves);
+            for (uint64_t i = first_leaf; i < first_leaf + num_leaves; i++) {
+                chunk.kernels.push_back(get_kernel(i));
+            }
+
+            pCursor->next_kernel += num_leaves;
+            return true;
+        }
+
+        if (pCursor->next_output < pLeafset->size()) {
+            const uint64_t first_leaf = pCursor->next_output;
+            const uint64_t num_leaves = std::min(leaves_per_chunk, pLeafset->size() - first_leaf);
+
+            chunk = StateChunk(EStateChunkType::OUTPUTS, first_leaf, num_leaves, {}, {}, {});
+            for (uint64_t i = first_leaf; i < first_leaf + num_leaves; i++) {
+                if (pLeafset->test(i)) {
+                    chunk.utxos.push_back(get_utxo(i));
+                }
+            }
+
+            const uint64_t end_pos = chunk.GetNextLeafIdx().GetPosition();
+            for (uint64_t pos = mmr::LeafIndex::At(first_leaf).GetPosition(); pos < end_pos; pos++) {
+                if (pPrunedParents->test(pos)) {
+                    chunk.pruned_parent_hashes.push_back(get_pruned_parent_hash(pos));
+                }
+            }
+
+            pCursor->next_output += num_leaves;
+            return true;
+        }
+
+        return false;
+    };
+}
+
 State Snapshot::Build(const ICoinsView::CPtr& pView)
 {
     // TODO: We will start using this in a future release when we finish
     // the more-efficient state sync (i.e. download pruned state instead of block by block).
     // When we do use this, we have to decide whether it's better to rewind from Litecoin code or from here.
+    State state{
+        pView->GetBestHeader()->GetHash(),
+        {},
+        pView->GetLeafSet()->ToBitSet(),
+        {},
+        {}
+    };
 
-    //
-    // Load kernels
-    //
-    std::vector<Kernel> kernels;
-
-    auto pKernelMMR = pView->GetKernelMMR();
-    kernels.reserve(pKernelMMR->GetNumLeaves());
+    state.kernels.reserve(pView->GetKernelMMR()->GetNumLeaves());
+    state.utxos.reserve(state.leafset.count());
 
-    mmr::LeafIndex kernel_idx = mmr::LeafIndex::At(0);
-    while (kernel_idx < pKernelMMR->GetNextLeafIdx()) {
-        mmr::Leaf leaf = pKernelMMR->GetLeaf(kernel_idx);
-        kernels.push_back(Deserializer(leaf.vec()).Read<Kernel>());
-        ++kernel_idx;
+    StateChunkReader read_chunk = Stream(pView);
+    StateChunk chunk;
+    while (read_chunk(chunk)) {
+        std::move(chunk.kernels.begin(), chunk.kernels.end(), std::back_inserter(state.kernels));
+        std::move(chunk.utxos.begin(), chunk.utxos.end(), std::back_inserter(state.utxos));
+        std::move(chunk.pruned_parent_hashes.begin(), chunk.pruned_parent_hashes.end(), std::back_inserter(state.pruned_parent_hashes));
     }
 
-    //
-    // Build unspent leaves bitset
-    //
-    BitSet leafset = pView->GetLeafSet()->ToBitSet();
-    
-    //
-    // Load UTXOs
-    //
-    std::vector<UTXO::CPtr> utxos;
-    utxos.reserve(leafset.count());
-
-    auto pOutputPMMR = pView->GetOutputPMMR();
-
-    mmr::LeafIndex output_idx = mmr::LeafIndex::At(0);
-    while (output_idx < pOutputPMMR->GetNextLeafIdx()) {
-        if (leafset.test(output_idx.Get())) {
-            mmr::Leaf leaf = pOutputPMMR->GetLeaf(kernel_idx);
+    return state;
+}
+
+StateChunkReader Snapshot::Stream(const ICoinsView::CPtr& pView, const uint64_t leaves_per_chunk)
+{
+    mmr::IMMR::Ptr pKernelMMR = pView->GetKernelMMR();
+    mmr::IMMR::Ptr pOutputPMMR = pView->GetOutputPMMR();
+
+    return StreamChunks(
+        leaves_per_chunk,
+        pKernelMMR->GetNumLeaves(),
+        std::make_shared<const BitSet>(pView->GetLeafSet()->ToBitSet()),
+        [pKernelMMR](const uint64_t leaf_idx) {
+            mmr::Leaf leaf = pKernelMMR->GetLeaf(mmr::LeafIndex::At(leaf_idx));
+            return Deserializer(leaf.vec()).Read<Kernel>();
+        },
+        [pView, pOutputPMMR](const uint64_t leaf_idx) {
+            mmr::Leaf leaf = pOutputPMMR->GetLeaf(mmr::LeafIndex::At(leaf_idx));
             OutputId output_id = Deserializer(leaf.vec()).Read<OutputId>();
-            std::vector<UTXO::CPtr> utxo = pView->GetUTXOs(output_id.GetCommitment());
-            assert(utxo.size() == 1);
-            utxos.push_back(utxo.front());
+            std::vector<UTXO::CPtr> utxos = pView->GetUTXOs(output_id.GetCommitment());
+            if (utxos.empty()) {
+                ThrowNotFound_F("UTXO not found for leaf {}", leaf_idx);
+            }
+
+            return utxos.front();
+        },
+        [pOutputPMMR](const uint64_t pos) {
+            return pOutputPMMR->GetHash(mmr::Index::At(pos));
         }
-        
-        ++output_idx;
+    );
+}
+
+StateChunkReader Snapshot::Stream(const std::shared_ptr<const State>& pState, const uint64_t leaves_per_chunk)
+{
+    // The UTXOs and pruned parent hashes are in leaf and position order, so they're found by rank.
+    auto pLeafset = std::make_shared<const BitSet>(pState->leafset);
+    const BitSet pruned_parents = mmr::MMRUtil::CalcPrunedParents(*pLeafset);
+    if (pLeafset->count() != pState->utxos.size() || pruned_parents.count() != pState->pruned_parent_hashes.size()) {
+        ThrowValidation(EConsensusError::MMR_MISMATCH);
     }
-    
-    //
-    // Lookup parent hashes
-    //
-    std::vector<mw::Hash> pruned_parent_hashes;
-    BitSet pruned_parent_bitset = mmr::MMRUtil::CalcPrunedParents(leafset);
-    for (uint64_t i = 0; i < pruned_parent_bitset.size(); i++) {
-        if (pruned_parent_bitset.test(i)) {
-            mw::Hash hash = pOutputPMMR->GetHash(mmr::Index::At(i));
-            pruned_parent_hashes.push_back(std::move(hash));
+
+    auto pLeafRanks = std::make_shared<const BitSetRank>(*pLeafset);
+    auto pPrunedParentRanks = std::make_shared<const BitSetRank>(pruned_parents);
+
+    return StreamChunks(
+        leaves_per_chunk,
+        pState->kernels.size(),
+        pLeafset,
+        [pState](const uint64_t leaf_idx) { return pState->kernels[leaf_idx]; },
+        [pState, pLeafRanks](const uint64_t leaf_idx) { return pState->utxos[pLeafRanks->rank(leaf_idx)]; },
+        [pState, pPrunedParentRanks](const uint64_t pos) { return pState->pruned_parent_hashes[pPrunedParentRanks->rank(pos)]; }
+    );
+}
+
+StateManifest Snapshot::Write(const ICoinsView::CPtr& pView, const FilePath& path, const uint64_t leaves_per_chunk)
+{
+    // Chunks are written to a temporary file first, since their hashes and offsets go in the manifest.
+    File chunks_file(FilePath(path.ToString() + ".chunks"));
+    File snapshot_file(path);
+    for (File* pFile : { &chunks_file, &snapshot_file }) {
+        if (pFile->Exists()) {
+            pFile->GetPath().Remove();
         }
+
+        pFile->Create();
     }
 
-    return State{
-        pView->GetBestHeader()->GetHash(),
-        std::move(kernels),
-        std::move(leafset),
-        std::move(utxos),
-        std::move(pruned_parent_hashes)
+    StateManifest manifest(0, pView->GetBestHeader()->GetHash(), pView->GetLeafSet()->ToBitSet(), {});
+
+    uint64_t offset = 0;
+    StateChunkReader read_chunk = Stream(pView, leaves_per_chunk);
+    StateChunk chunk;
+    while (read_chunk(chunk)) {
+        std::vector<uint8_t> serialized = chunk.Serialized();
+        manifest.chunks.push_back(StateChunkInfo(chunk.type, chunk.first_leaf, chunk.num_leaves, offset, serialized.size(), Hashed(serialized)));
+        offset += serialized.size();
+        chunks_file.Write(serialized);
+    }
+
+    std::vector<uint8_t> serialized_manifest = manifest.Serialized();
+    snapshot_file.Write(Serializer().Append<uint64_t>(serialized_manifest.size()).vec());
+    snapshot_file.Write(serialized_manifest);
+    for (uint64_t pos = 0; pos < offset; pos += COPY_CHUNK_SIZE) {
+        snapshot_file.Write(chunks_file.ReadBytes(pos, std::min<uint64_t>(COPY_CHUNK_SIZE, offset - pos)));
+    }
+
+    chunks_file.GetPath().Remove();
+    return manifest;
+}
+
+SnapshotFile SnapshotFile::Open(const FilePath& path)
+{
+    File file(path);
+    const uint64_t file_size = file.GetSize();
+    if (file_size < sizeof(uint64_t)) {
+        ThrowDeserialization_F("{} is too small to be a snapshot", file);
+    }
+
+    const uint64_t manifest_size = Deserializer(file.ReadBytes(0, sizeof(uint64_t))).Read<uint64_t>();
+    if (manifest_size > file_size - sizeof(uint64_t)) {
+        ThrowDeserialization_F("The manifest of {} is larger than the file", file);
+    }
+
+    Deserializer deserializer(file.ReadBytes(sizeof(uint64_t), manifest_size));
+    StateManifest manifest = deserializer.Read<StateManifest>();
+    return SnapshotFile(file, std::move(manifest), sizeof(uint64_t) + manifest_size);
+}
+
+StateChunk SnapshotFile::ReadChunk(const size_t chunk_idx) const
+{
+    const StateChunkInfo& info = m_manifest.chunks.at(chunk_idx);
+
+    // The manifest is untrusted too, so the chunk's location is checked before anything is allocated for it.
+    const uint64_t file_size = m_file.GetSize();
+    if (info.size > StateChunk::MAX_SERIALIZED_SIZE
+        || m_chunksPos > file_size
+        || info.offset > file_size - m_chunksPos
+        || info.size > file_size - m_chunksPos - info.offset) {
+        ThrowDeserialization_F("Chunk {} of {} is out of bounds", chunk_idx, m_file);
+    }
+
+    std::vector<uint8_t> serialized = m_file.ReadBytes(m_chunksPos + info.offset, info.size);
+    if (Hashed(serialized) != info.hash) {
+        ThrowDeserialization_F("Chunk {} of {} does not match its hash", chunk_idx, m_file);
+    }
+
+    Deserializer deserializer(std::move(serialized));
+    StateChunk chunk = deserializer.Read<StateChunk>();
+    if (chunk.type != info.type || chunk.first_leaf != info.first_leaf || chunk.num_leaves != info.num_leaves) {
+        ThrowDeserialization_F("Chunk {} of {} does not match the manifest", chunk_idx, m_file);
+    }
+
+    return chunk;
+}
+
+StateChunkReader SnapshotFile::Stream() const
+{
+    auto pNextChunk = std::make_shared<size_t>(0);
+    SnapshotFile snapshot = *this;
+    return [snapshot, pNextChunk](StateChunk& chunk) -> bool {
+        if (*pNextChunk >= snapshot.GetManifest().chunks.size()) {
+            return false;
+        }
+
+        chunk = snapshot.ReadChunk((*pNextChunk)++);
+        return true;
     };
-}
\ No newline at end of file
+}
@@ -1,7 +1,15 @@
 #include <mw/node/validation/BlockValidator.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/consensus/ChainParams.h>
+#include <mw/consensus/OwnerSumValidator.h>
+#include <mw/crypto/Schnorr.h>
 #include <mw/exceptions/ValidationException.h>
 #include <unordered_map>
 
+// Signatures and range proofs are verified in batches of up to this many, each of which is a separate task.
+static const size_t SIGNATURE_BATCH_SIZE = 256;
+static const size_t PROOF_BATCH_SIZE = 32;
+
 void BlockValidator::Validate(
     const mw::Block::Ptr& pBlock,
     const mw::Hash& mweb_hash,
@@ -18,14 +26,76 @@ void BlockValidator::Validate(
         ThrowValidation(EConsensusError::HASH_MISMATCH);
     }
 
-    pBlock->Validate();
+    // Past the cut-through height, the header commits to the cut-throughs, so they can't be added or swapped
+    // without changing the block's hash. Blocks before it have no cut-through field.
+    const boost::optional<mw::Hash>& cut_through_hash = pBlock->GetHeader()->GetCutThroughHash();
+    if (mw::ChainParams::IsCutThroughActive(pBlock->GetHeight())) {
+        if (!cut_through_hash || *cut_through_hash != pBlock->GetTxBody().GetCutThroughHash()) {
+            ThrowValidation(EConsensusError::HASH_MISMATCH);
+        }
+    } else if (cut_through_hash || !pBlock->GetTxBody().GetCutThroughs().empty()) {
+        ThrowValidation(EConsensusError::HASH_MISMATCH);
+    }
+
+    pBlock->GetTxBody().ValidateStructure();
 
     ValidatePegInCoins(pBlock, pegInCoins);
     ValidatePegOutCoins(pBlock, pegOutCoins);
 
+    VerifyInParallel(pBlock);
+
     pBlock->MarkAsValidated();
 }
 
+std::future<void> BlockValidator::ValidateAsync(
+    const mw::Block::Ptr& pBlock,
+    const mw::Hash& mweb_hash,
+    const std::vector<PegInCoin>& pegInCoins,
+    const std::vector<PegOutCoin>& pegOutCoins)
+{
+    return ThreadPool::Get().Enqueue([pBlock, mweb_hash, pegInCoins, pegOutCoins]() {
+        BlockValidator().Validate(pBlock, mweb_hash, pegInCoins, pegOutCoins);
+    });
+}
+
+void BlockValidator::VerifyInParallel(const mw::Block::CPtr& pBlock)
+{
+    const TxBody& body = pBlock->GetTxBody();
+    std::vector<SignedMessage> signatures = body.BuildSignedMessages();
+    std::vector<ProofData> proofs = body.BuildProofData();
+
+    // Each task is one signature batch, one range proof batch, or the owner sum.
+    std::vector<std::function<void()>> tasks;
+    for (size_t begin = 0; begin < signatures.size(); begin += SIGNATURE_BATCH_SIZE) {
+        tasks.push_back([&signatures, begin]() {
+            const size_t end = std::min(begin + SIGNATURE_BATCH_SIZE, signatures.size());
+            if (!Schnorr::BatchVerify(std::vector<SignedMessage>(signatures.begin() + begin, signatures.begin() + end))) {
+                ThrowValidation(EConsensusError::INVALID_SIG);
+            }
+        });
+    }
+
+    for (size_t begin = 0; begin < proofs.size(); begin += PROOF_BATCH_SIZE) {
+        tasks.push_back([&proofs, begin]() {
+            const size_t end = std::min(begin + PROOF_BATCH_SIZE, proofs.size());
+            if (!Bulletproofs::BatchVerify(std::vector<ProofData>(proofs.begin() + begin, proofs.begin() + end))) {
+                ThrowValidation(EConsensusError::BULLETPROOF);
+            }
+        });
+    }
+
+    tasks.push_back([&pBlock, &body]() {
+        OwnerSumValidator::Validate(pBlock->GetHeader()->GetOwnerOffset(), body);
+    });
+
+    // ParallelFor also runs tasks on the calling thread, so this is safe when called from ValidateAsync.
+    ThreadPool::Get().ParallelFor(0, tasks.size(), 1, [&tasks](const uint64_t begin, const uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            tasks[i]();
+        }
+    });
+}
+
 void BlockValidator::ValidatePegInCoins(
     const mw::Block::CPtr& pBlock,
     const std::vector<PegInCoin>& pegInCoins)
@@ -1,14 +1,20 @@
 #include <mw/node/validation/StateValidator.h>
 #include <mw/consensus/KernelSumValidator.h>
+#include <mw/crypto/CommitmentSum.h>
 
-void StateValidator::Validate(const mw::ICoinsView& coins_view)
-{
-    std::vector<Commitment> utxos;
+// Commitments are read from the DB and added to the sums in batches of this many.
+static const size_t SUM_BATCH_SIZE = 16 * 1024;
 
+mw::StateSums StateValidator::Validate(const mw::ICoinsView& coins_view)
+{
     auto pKernelMMR = coins_view.GetKernelMMR();
     auto pOutputPMMR = coins_view.GetOutputPMMR();
     auto pLeafSet = coins_view.GetLeafSet();
 
+    CommitmentSum utxo_sum;
+    std::vector<Commitment> utxos;
+    utxos.reserve(SUM_BATCH_SIZE);
+
     const uint64_t num_outputs = pOutputPMMR->GetNumLeaves();
     for (size_t i = 0; i < num_outputs; i++) {
         mmr::LeafIndex index = mmr::LeafIndex::At(i);
@@ -16,15 +22,42 @@ void StateValidator::Validate(const mw::ICoinsView& coins_view)
             mmr::Leaf leaf = pOutputPMMR->GetLeaf(index);
             OutputId output_id = Deserializer(leaf.vec()).Read<OutputId>();
             utxos.push_back(output_id.GetCommitment());
+
+            if (utxos.size() >= SUM_BATCH_SIZE) {
+                utxo_sum.AddPartial(utxos);
+                utxos.clear();
+            }
         }
     }
 
-    std::vector<Kernel> kernels;
+    utxo_sum.AddPartial(utxos);
+
+    CommitmentSum kernel_sum;
+    std::vector<Commitment> kernels;
+    kernels.reserve(SUM_BATCH_SIZE);
+
+    int64_t total_mw_supply = 0;
     const uint64_t num_kernels = pKernelMMR->GetNumLeaves();
     for (size_t i = 0; i < num_kernels; i++) {
         mmr::Leaf leaf = pKernelMMR->GetLeaf(mmr::LeafIndex::At(i));
-        kernels.push_back(Deserializer(leaf.vec()).Read<Kernel>());
+        Kernel kernel = Deserializer(leaf.vec()).Read<Kernel>();
+        kernels.push_back(kernel.GetCommitment());
+
+        // Total supply can never go below 0
+        total_mw_supply += kernel.GetSupplyChange();
+        if (total_mw_supply < 0) {
+            ThrowValidation(EConsensusError::BLOCK_SUMS);
+        }
+
+        if (kernels.size() >= SUM_BATCH_SIZE) {
+            kernel_sum.AddPartial(kernels);
+            kernels.clear();
+        }
     }
 
-    KernelSumValidator::ValidateState(utxos, kernels, coins_view.GetBestHeader()->GetKernelOffset());
-}
\ No newline at end of file
+    kernel_sum.AddPartial(kernels);
+
+    mw::StateSums sums(utxo_sum.Total(), kernel_sum.Total(), total_mw_supply);
+    KernelSumValidator::ValidateState(sums, coins_view.GetBestHeader()->GetKernelOffset());
+    return sums;
+}
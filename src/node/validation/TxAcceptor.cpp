@@ -0,0 +1,204 @@
+#include <mw/node/validation/TxAcceptor.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/consensus/ChainParams.h>
+#include <mw/exceptions/ValidationException.h>
+#include <algorithm>
+
+// The checks of a batch are split into tasks of this many transactions.
+static const size_t CHECK_CHUNK_SIZE = 16;
+
+TxAcceptor::TxAcceptor()
+    : TxAcceptor(Options{}, VerificationService::Get()) { }
+
+TxAcceptor::TxAcceptor(const Options& options, VerificationService& verifier)
+    : m_options(options), m_verifier(verifier), m_stopping(false)
+{
+    m_dispatcher = std::thread([this]() { Run(); });
+}
+
+TxAcceptor::~TxAcceptor()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_pendingAdded.notify_all();
+    m_spaceFreed.notify_all();
+    m_dispatcher.join();
+}
+
+TxAcceptor& TxAcceptor::Get()
+{
+    static TxAcceptor acceptor;
+    return acceptor;
+}
+
+std::future<void> TxAcceptor::Submit(const mw::ICoinsView::CPtr& pView, const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height)
+{
+    auto pPromise = std::make_shared<std::promise<void>>();
+    std::future<void> result = pPromise->get_future();
+    Submit(pView, pTransaction, spend_height, [pPromise](const std::exception_ptr& error) {
+        if (error) {
+            pPromise->set_exception(error);
+        } else {
+            pPromise->set_value();
+        }
+    });
+
+    return result;
+}
+
+void TxAcceptor::Submit(const mw::ICoinsView::CPtr& pView, const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height, const Callback& callback)
+{
+    Enqueue(pView, pTransaction, spend_height, callback, true);
+}
+
+bool TxAcceptor::TrySubmit(const mw::ICoinsView::CPtr& pView, const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height, const Callback& callback)
+{
+    return Enqueue(pView, pTransaction, spend_height, callback, false);
+}
+
+size_t TxAcceptor::GetNumQueued() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
+
+void TxAcceptor::CheckInputs(
+    const mw::Transaction& transaction,
+    const std::unordered_map<Commitment, std::vector<UTXO::CPtr>>& utxos,
+    const uint64_t spend_height)
+{
+    for (const Input& input : transaction.GetInputs()) {
+        auto iter = utxos.find(input.GetCommitment());
+        if (iter == utxos.end() || iter->second.empty()) {
+            ThrowValidation(EConsensusError::UTXO_MISSING);
+        }
+
+        const UTXO::CPtr& pUTXO = iter->second.back();
+        if (pUTXO->IsPeggedIn() && spend_height < pUTXO->GetBlockHeight() + mw::ChainParams::GetPegInMaturity()) {
+            ThrowValidation(EConsensusError::PEGIN_MATURITY);
+        }
+    }
+}
+
+bool TxAcceptor::Enqueue(
+    const mw::ICoinsView::CPtr& pView,
+    const mw::Transaction::CPtr& pTransaction,
+    const uint64_t spend_height,
+    const Callback& callback,
+    const bool block)
+{
+    assert(pView != nullptr);
+    assert(pTransaction != nullptr);
+
+    // Saves a lookup when the transaction would be turned away anyway. The queue is checked again below.
+    if (!block && GetNumQueued() >= m_options.max_queued_txs) {
+        return false;
+    }
+
+    // The inputs are looked up on the submitter's thread, while it still holds whatever guards the view,
+    // so the dispatcher and workers only ever see this snapshot of them.
+    Pending pending{ pTransaction, {}, spend_height, callback };
+    try {
+        pending.utxos = pView->LookupUTXOs(pTransaction->GetInputCommits());
+    } catch (const std::exception&) {
+        callback(std::current_exception());
+        return true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto has_space = [this]() { return m_stopping || m_pending.size() < m_options.max_queued_txs; };
+
+        if (!has_space()) {
+            if (!block) {
+                return false;
+            }
+
+            m_spaceFreed.wait(lock, has_space);
+        }
+
+        if (!m_stopping) {
+            m_pending.push_back(std::move(pending));
+            lock.unlock();
+
+            m_pendingAdded.notify_one();
+            return true;
+        }
+    }
+
+    // The acceptor is being destroyed, so the transaction is processed on the caller's thread.
+    std::vector<Pending> batch;
+    batch.push_back(std::move(pending));
+    Process(batch);
+    return true;
+}
+
+void TxAcceptor::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_pendingAdded.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            return;
+        }
+
+        // No window here. Transactions pile up while the previous batch is processed,
+        // and the VerificationService holds back their signatures and proofs for the ones that follow.
+        const size_t batch_size = std::min(m_pending.size(), m_options.max_batch_txs);
+        std::vector<Pending> batch(
+            std::make_move_iterator(m_pending.begin()),
+            std::make_move_iterator(m_pending.begin() + batch_size)
+        );
+        m_pending.erase(m_pending.begin(), m_pending.begin() + batch_size);
+        lock.unlock();
+        m_spaceFreed.notify_all();
+
+        Process(batch);
+        lock.lock();
+    }
+}
+
+void TxAcceptor::Process(std::vector<Pending>& batch) const
+{
+    std::vector<std::exception_ptr> errors(batch.size());
+    std::vector<std::vector<SignedMessage>> signatures(batch.size());
+    std::vector<std::vector<ProofData>> proofs(batch.size());
+
+    // Each task runs the structure, sum and input checks of a chunk of transactions.
+    // The inputs are checked last, so CheckTransaction's error takes precedence over CheckTxInputs'.
+    std::vector<std::function<void()>> tasks;
+    for (size_t begin = 0; begin < batch.size(); begin += CHECK_CHUNK_SIZE) {
+        tasks.push_back([&batch, &errors, &signatures, &proofs, begin]() {
+            const size_t end = std::min(begin + CHECK_CHUNK_SIZE, batch.size());
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    const mw::Transaction& transaction = *batch[i].pTransaction;
+                    transaction.ValidateStructureAndSums();
+                    CheckInputs(transaction, batch[i].utxos, batch[i].spend_height);
+                    signatures[i] = transaction.GetBody().BuildSignedMessages();
+                    proofs[i] = transaction.GetBody().BuildProofData();
+                } catch (const std::exception&) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        });
+    }
+
+    ThreadPool::Get().ParallelFor(0, tasks.size(), 1, [&tasks](const uint64_t begin, const uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            tasks[i]();
+        }
+    });
+
+    // Blocks while the VerificationService is full, which holds back the next batch too.
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (errors[i]) {
+            batch[i].callback(errors[i]);
+        } else {
+            m_verifier.Submit(std::move(signatures[i]), std::move(proofs[i]), batch[i].callback);
+        }
+    }
+}
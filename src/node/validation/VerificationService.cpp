@@ -0,0 +1,285 @@
+#include <mw/node/validation/VerificationService.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/crypto/Bulletproofs.h>
+#include <mw/crypto/Schnorr.h>
+#include <mw/exceptions/ValidationException.h>
+#include <algorithm>
+
+// A dispatched batch is split into tasks of up to this many signatures or range proofs, like a block's.
+static const size_t SIGNATURE_CHUNK_SIZE = 256;
+static const size_t PROOF_CHUNK_SIZE = 32;
+
+// Whether any of the chunks covering [begin, begin + count) failed.
+static bool AnyFailed(const std::vector<uint8_t>& failed, const size_t first_chunk, const size_t chunk_size, const size_t begin, const size_t count)
+{
+    if (count == 0) {
+        return false;
+    }
+
+    for (size_t chunk = begin / chunk_size; chunk <= (begin + count - 1) / chunk_size; chunk++) {
+        if (failed[first_chunk + chunk] != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+VerificationService::VerificationService()
+    : VerificationService(Options{}) { }
+
+VerificationService::VerificationService(const Options& options)
+    : m_options(options), m_queuedSignatures(0), m_queuedProofs(0), m_queuedUrgent(0), m_stopping(false)
+{
+    // The dispatcher uses the shared pool, so it has to be created first to be destroyed last.
+    ThreadPool::Get();
+    m_dispatcher = std::thread([this]() { Run(); });
+}
+
+VerificationService::~VerificationService()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_jobAdded.notify_all();
+    m_spaceFreed.notify_all();
+    m_dispatcher.join();
+}
+
+VerificationService& VerificationService::Get()
+{
+    static VerificationService service;
+    return service;
+}
+
+std::future<void> VerificationService::Submit(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs)
+{
+    auto pPromise = std::make_shared<std::promise<void>>();
+    std::future<void> result = pPromise->get_future();
+    Submit(std::move(signatures), std::move(proofs), [pPromise](const std::exception_ptr& error) {
+        if (error) {
+            pPromise->set_exception(error);
+        } else {
+            pPromise->set_value();
+        }
+    });
+
+    return result;
+}
+
+void VerificationService::Submit(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs, const Callback& callback)
+{
+    Enqueue(Job{ std::move(signatures), std::move(proofs), callback, {} }, true);
+}
+
+bool VerificationService::TrySubmit(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs, const Callback& callback)
+{
+    return Enqueue(Job{ std::move(signatures), std::move(proofs), callback, {} }, false);
+}
+
+void VerificationService::Verify(std::vector<SignedMessage>&& signatures, std::vector<ProofData>&& proofs)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_jobs.empty()) {
+            lock.unlock();
+            VerifyJob(Job{ std::move(signatures), std::move(proofs), nullptr, {} });
+            return;
+        }
+    }
+
+    // Other jobs are already waiting, so this one shares their batch, which is dispatched right away.
+    auto pPromise = std::make_shared<std::promise<void>>();
+    std::future<void> result = pPromise->get_future();
+    Job job{ std::move(signatures), std::move(proofs), [pPromise](const std::exception_ptr& error) {
+        if (error) {
+            pPromise->set_exception(error);
+        } else {
+            pPromise->set_value();
+        }
+    }, {} };
+    job.urgent = true;
+
+    Enqueue(std::move(job), true);
+    result.get();
+}
+
+size_t VerificationService::GetNumQueued() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_queuedSignatures + m_queuedProofs;
+}
+
+bool VerificationService::Enqueue(Job&& job, const bool block)
+{
+    const size_t num_items = job.signatures.size() + job.proofs.size();
+    if (num_items == 0) {
+        job.callback(nullptr);
+        return true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto has_space = [this, num_items]() {
+            return m_stopping || m_jobs.empty() || m_queuedSignatures + m_queuedProofs + num_items <= m_options.max_queued_items;
+        };
+
+        if (!has_space()) {
+            if (!block) {
+                return false;
+            }
+
+            m_spaceFreed.wait(lock, has_space);
+        }
+
+        if (!m_stopping) {
+            m_queuedSignatures += job.signatures.size();
+            m_queuedProofs += job.proofs.size();
+            m_queuedUrgent += job.urgent ? 1 : 0;
+            job.queued_at = std::chrono::steady_clock::now();
+            m_jobs.push_back(std::move(job));
+            lock.unlock();
+
+            m_jobAdded.notify_one();
+            return true;
+        }
+    }
+
+    // The service is being destroyed, so the job is verified on the caller's thread.
+    std::exception_ptr error;
+    try {
+        VerifyJob(job);
+    } catch (const std::exception&) {
+        error = std::current_exception();
+    }
+
+    job.callback(error);
+    return true;
+}
+
+void VerificationService::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_jobAdded.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+        if (m_jobs.empty()) {
+            return;
+        }
+
+        // The oldest job waits out its window for others to join it, unless the batch is already full
+        // or a caller of Verify is waiting on it.
+        // Under load, jobs pile up while the previous batch is verified, so their window has already passed.
+        const auto deadline = m_jobs.front().queued_at + m_options.batch_window;
+        m_jobAdded.wait_until(lock, deadline, [this]() { return m_stopping || m_queuedUrgent > 0 || IsBatchFull(); });
+
+        std::vector<Job> batch;
+        size_t num_signatures = 0;
+        size_t num_proofs = 0;
+        while (!m_jobs.empty()) {
+            const Job& job = m_jobs.front();
+            if (!batch.empty()
+                && (num_signatures + job.signatures.size() > m_options.max_batch_signatures
+                    || num_proofs + job.proofs.size() > m_options.max_batch_proofs)) {
+                break;
+            }
+
+            num_signatures += job.signatures.size();
+            num_proofs += job.proofs.size();
+            m_queuedUrgent -= job.urgent ? 1 : 0;
+            batch.push_back(std::move(m_jobs.front()));
+            m_jobs.pop_front();
+        }
+
+        m_queuedSignatures -= num_signatures;
+        m_queuedProofs -= num_proofs;
+        lock.unlock();
+        m_spaceFreed.notify_all();
+
+        VerifyBatch(batch);
+        lock.lock();
+    }
+}
+
+bool VerificationService::IsBatchFull() const noexcept
+{
+    return m_queuedSignatures >= m_options.max_batch_signatures || m_queuedProofs >= m_options.max_batch_proofs;
+}
+
+void VerificationService::VerifyBatch(const std::vector<Job>& jobs) const
+{
+    std::vector<SignedMessage> signatures;
+    std::vector<ProofData> proofs;
+    for (const Job& job : jobs) {
+        signatures.insert(signatures.end(), job.signatures.begin(), job.signatures.end());
+        proofs.insert(proofs.end(), job.proofs.begin(), job.proofs.end());
+    }
+
+    // Each task verifies one chunk, and records whether it failed rather than throwing,
+    // so the jobs in the chunks that passed can still be completed.
+    const size_t num_signature_chunks = (signatures.size() + SIGNATURE_CHUNK_SIZE - 1) / SIGNATURE_CHUNK_SIZE;
+    const size_t num_proof_chunks = (proofs.size() + PROOF_CHUNK_SIZE - 1) / PROOF_CHUNK_SIZE;
+    std::vector<uint8_t> failed(num_signature_chunks + num_proof_chunks, 0);
+    ThreadPool::Get().ParallelFor(0, failed.size(), 1, [&](const uint64_t begin, const uint64_t end) {
+        for (uint64_t chunk = begin; chunk < end; chunk++) {
+            bool valid = false;
+            try {
+                if (chunk < num_signature_chunks) {
+                    const size_t first = chunk * SIGNATURE_CHUNK_SIZE;
+                    const size_t last = std::min(first + SIGNATURE_CHUNK_SIZE, signatures.size());
+                    valid = Schnorr::BatchVerify(std::vector<SignedMessage>(signatures.begin() + first, signatures.begin() + last));
+                } else {
+                    const size_t first = (chunk - num_signature_chunks) * PROOF_CHUNK_SIZE;
+                    const size_t last = std::min(first + PROOF_CHUNK_SIZE, proofs.size());
+                    valid = Bulletproofs::BatchVerify(std::vector<ProofData>(proofs.begin() + first, proofs.begin() + last));
+                }
+            } catch (const std::exception&) {
+                valid = false;
+            }
+
+            failed[chunk] = valid ? 0 : 1;
+        }
+    });
+
+    // Jobs covered only by chunks that passed are valid. The rest are verified on their own,
+    // which only rechecks what isn't already in the signature and range proof caches.
+    std::vector<const Job*> suspects;
+    size_t signature_begin = 0;
+    size_t proof_begin = 0;
+    for (const Job& job : jobs) {
+        if (AnyFailed(failed, 0, SIGNATURE_CHUNK_SIZE, signature_begin, job.signatures.size())
+            || AnyFailed(failed, num_signature_chunks, PROOF_CHUNK_SIZE, proof_begin, job.proofs.size())) {
+            suspects.push_back(&job);
+        } else {
+            job.callback(nullptr);
+        }
+
+        signature_begin += job.signatures.size();
+        proof_begin += job.proofs.size();
+    }
+
+    ThreadPool::Get().ParallelFor(0, suspects.size(), 1, [&suspects](const uint64_t begin, const uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            std::exception_ptr error;
+            try {
+                VerifyJob(*suspects[i]);
+            } catch (const std::exception&) {
+                error = std::current_exception();
+            }
+
+            suspects[i]->callback(error);
+        }
+    });
+}
+
+void VerificationService::VerifyJob(const Job& job)
+{
+    if (!job.signatures.empty() && !Schnorr::BatchVerify(job.signatures)) {
+        ThrowValidation(EConsensusError::INVALID_SIG);
+    }
+
+    if (!job.proofs.empty() && !Bulletproofs::BatchVerify(job.proofs)) {
+        ThrowValidation(EConsensusError::BULLETPROOF);
+    }
+}
@@ -0,0 +1,270 @@
+#include <mw/wallet/CoinSelection.h>
+#include "WalletUtil.h"
+
+#include <mw/consensus/Weight.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/InsufficientFundsException.h>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <random>
+
+// Branch-and-bound gives up after trying this many branches.
+static const size_t BNB_TOTAL_TRIES = 100'000;
+
+// The knapsack search makes up to KNAPSACK_MAX_ITERATIONS random passes over the coins smaller than the target,
+// but no more than fit in KNAPSACK_MAX_STEPS coin visits, so it stays fast over very large wallets.
+static const size_t KNAPSACK_MAX_ITERATIONS = 1000;
+static const size_t KNAPSACK_MAX_STEPS = 100'000;
+
+static std::vector<libmw::Coin> ToCoins(const std::vector<libmw::Coin>& coins, const std::vector<size_t>& selected)
+{
+    std::vector<libmw::Coin> selected_coins;
+    selected_coins.reserve(selected.size());
+    for (size_t idx : selected) {
+        selected_coins.push_back(coins[idx]);
+    }
+
+    return selected_coins;
+}
+
+CoinSelection::Result CoinSelection::Select(
+    const std::vector<libmw::Coin>& coins,
+    const uint64_t amount,
+    const size_t num_outputs,
+    const uint64_t fee_rate,
+    const size_t num_pegouts,
+    const bool aggregate_proofs)
+{
+    // The spendable coins, largest first. Amounts are copied next to the indices
+    // so the searches below don't have to chase through the much larger libmw::Coin.
+    std::vector<Candidate> sorted;
+    sorted.reserve(coins.size());
+    uint64_t total_available = 0;
+    for (size_t i = 0; i < coins.size(); i++) {
+        if (coins[i].amount > 0 && coins[i].key.has_value() && coins[i].blind.has_value()) {
+            sorted.push_back({ coins[i].amount, i });
+            total_available += coins[i].amount;
+        }
+    }
+
+    const uint64_t fee = CalcFee(num_outputs, fee_rate, num_pegouts, aggregate_proofs);
+    const uint64_t fee_with_change = CalcFee(num_outputs + 1, fee_rate, num_pegouts, aggregate_proofs);
+    if (total_available < amount + fee) {
+        ThrowInsufficientFunds_F("{} available, but {} needed", total_available, amount + fee);
+    }
+
+    // Neither search looks past the smallest coin worth more than amount + fee_with_change,
+    // so the rest are dropped before sorting. In large wallets, that's usually most of them.
+    const auto larger_begin = std::partition(
+        sorted.begin(), sorted.end(),
+        [amount, fee_with_change](const Candidate& candidate) { return candidate.first <= amount + fee_with_change; }
+    );
+    if (larger_begin != sorted.end()) {
+        std::iter_swap(larger_begin, std::min_element(larger_begin, sorted.end()));
+        sorted.erase(larger_begin + 1, sorted.end());
+    }
+
+    std::sort(sorted.begin(), sorted.end(), std::greater<Candidate>());
+
+    // Without change, whatever the inputs add up to beyond the amount goes to the fee.
+    // That's only worth it when the excess is no more than the cost of the change output.
+    boost::optional<std::vector<size_t>> changeless = SelectBnB(sorted, amount + fee, fee_with_change - fee);
+    if (!changeless && total_available < amount + fee_with_change) {
+        std::vector<size_t> all;
+        all.reserve(sorted.size());
+        for (const Candidate& candidate : sorted) {
+            all.push_back(candidate.second);
+        }
+
+        changeless = std::move(all);
+    }
+
+    if (changeless) {
+        std::vector<libmw::Coin> inputs = ToCoins(coins, changeless.value());
+        const uint64_t input_total = WalletUtil::TotalAmount(inputs);
+        return Result{ std::move(inputs), input_total - amount, 0 };
+    }
+
+    std::vector<libmw::Coin> inputs = ToCoins(coins, SelectKnapsack(sorted, amount + fee_with_change));
+    const uint64_t input_total = WalletUtil::TotalAmount(inputs);
+    return Result{ std::move(inputs), fee_with_change, input_total - amount - fee_with_change };
+}
+
+uint64_t CoinSelection::CalcFee(
+    const size_t num_outputs,
+    const uint64_t fee_rate,
+    const size_t num_pegouts,
+    const bool aggregate_proofs)
+{
+    const size_t weight = Weight::Calculate(std::max<size_t>(1, num_pegouts), 1, 0)
+        + Weight::CalculateOutputs(num_outputs, aggregate_proofs);
+    return fee_rate * weight;
+}
+
+//
+// Depth-first search over including or excluding each coin, largest first, for a set of coins
+// worth between target and target + max_excess. Returns the set with the smallest excess found.
+//
+boost::optional<std::vector<size_t>> CoinSelection::SelectBnB(
+    const std::vector<Candidate>& sorted,
+    const uint64_t target,
+    const uint64_t max_excess)
+{
+    // Any coin worth more than target + max_excess overshoots on its own, so the search starts after them.
+    const size_t offset = std::lower_bound(
+        sorted.begin(), sorted.end(), target + max_excess,
+        [](const Candidate& candidate, const uint64_t value) { return candidate.first > value; }
+    ) - sorted.begin();
+
+    // Value of the coins that haven't been included or excluded yet.
+    uint64_t available = 0;
+    for (size_t i = offset; i < sorted.size(); i++) {
+        available += sorted[i].first;
+    }
+
+    // Whether each coin, in sorted order, is included on the current branch.
+    std::vector<bool> selection;
+    selection.reserve(sorted.size() - offset);
+    uint64_t value = 0;
+
+    std::vector<bool> best;
+    uint64_t best_excess = max_excess + 1;
+
+    for (size_t tries = 0; tries < BNB_TOTAL_TRIES; tries++) {
+        bool backtrack = false;
+        if (value + available < target || value > target + max_excess) {
+            backtrack = true;
+        } else if (value >= target) {
+            if (value - target < best_excess) {
+                best_excess = value - target;
+                best = selection;
+                if (best_excess == 0) {
+                    break;
+                }
+            }
+
+            backtrack = true;
+        }
+
+        if (backtrack) {
+            // Walk back to the last included coin, and try the branch that excludes it.
+            while (!selection.empty() && !selection.back()) {
+                selection.pop_back();
+                available += sorted[offset + selection.size()].first;
+            }
+
+            if (selection.empty()) {
+                break;
+            }
+
+            selection.back() = false;
+            value -= sorted[offset + selection.size() - 1].first;
+        } else {
+            const uint64_t coin_amount = sorted[offset + selection.size()].first;
+            available -= coin_amount;
+
+            // Including this coin after excluding one of the same amount would just repeat that branch.
+            if (!selection.empty() && !selection.back() && coin_amount == sorted[offset + selection.size() - 1].first) {
+                selection.push_back(false);
+            } else {
+                selection.push_back(true);
+                value += coin_amount;
+            }
+        }
+    }
+
+    if (best_excess > max_excess) {
+        return boost::none;
+    }
+
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < best.size(); i++) {
+        if (best[i]) {
+            selected.push_back(sorted[offset + i].second);
+        }
+    }
+
+    return boost::make_optional(std::move(selected));
+}
+
+//
+// Looks for the set of coins closest to, but not below, the target.
+// The smallest coin larger than the target is used if no combination of smaller coins comes closer.
+// The total of the coins must be at least the target.
+//
+std::vector<size_t> CoinSelection::SelectKnapsack(const std::vector<Candidate>& sorted, const uint64_t target)
+{
+    // Coins are sorted largest first, so the smaller coins are a suffix of sorted.
+    const auto first_smaller = std::lower_bound(
+        sorted.begin(), sorted.end(), target,
+        [](const Candidate& candidate, const uint64_t value) { return candidate.first > value; }
+    );
+    if (first_smaller != sorted.end() && first_smaller->first == target) {
+        return { first_smaller->second };
+    }
+
+    boost::optional<size_t> lowest_larger;
+    if (first_smaller != sorted.begin()) {
+        lowest_larger = (first_smaller - 1)->second;
+    }
+
+    const size_t offset = first_smaller - sorted.begin();
+    const size_t num_smaller = sorted.size() - offset;
+    uint64_t total_smaller = 0;
+    for (auto iter = first_smaller; iter != sorted.end(); iter++) {
+        total_smaller += iter->first;
+    }
+
+    if (total_smaller < target) {
+        assert(lowest_larger.has_value());
+        return { lowest_larger.value() };
+    }
+
+    // Each iteration makes a random first pass over the smaller coins, largest first,
+    // then a second pass over the coins it skipped, until the target is reached.
+    // Whenever the target is reached, the last coin is taken back out to look for a closer total.
+    const size_t num_iterations = std::min(KNAPSACK_MAX_ITERATIONS, std::max<size_t>(1, KNAPSACK_MAX_STEPS / num_smaller));
+    std::mt19937_64 rng(Random::FastRandom());
+
+    std::vector<bool> best(num_smaller, true);
+    uint64_t best_total = total_smaller;
+    std::vector<bool> included(num_smaller);
+    for (size_t iteration = 0; iteration < num_iterations && best_total != target; iteration++) {
+        std::fill(included.begin(), included.end(), false);
+        uint64_t total = 0;
+        bool reached_target = false;
+        for (int pass = 0; pass < 2 && !reached_target; pass++) {
+            for (size_t i = 0; i < num_smaller; i++) {
+                if (pass == 0 ? (rng() & 1) == 1 : !included[i]) {
+                    const uint64_t coin_amount = sorted[offset + i].first;
+                    total += coin_amount;
+                    included[i] = true;
+                    if (total >= target) {
+                        reached_target = true;
+                        if (total < best_total) {
+                            best_total = total;
+                            best = included;
+                        }
+
+                        total -= coin_amount;
+                        included[i] = false;
+                    }
+                }
+            }
+        }
+    }
+
+    if (lowest_larger.has_value() && best_total != target && (first_smaller - 1)->first <= best_total) {
+        return { lowest_larger.value() };
+    }
+
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < num_smaller; i++) {
+        if (best[i]) {
+            selected.push_back(sorted[offset + i].second);
+        }
+    }
+
+    return selected;
+}
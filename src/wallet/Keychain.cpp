@@ -1,15 +1,22 @@
 #include <mw/wallet/Keychain.h>
 #include <mw/crypto/Hasher.h>
 #include <mw/common/Logger.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/exceptions/DeserializationException.h>
 
 #define RESTORE_WINDOW 100
 
+// Minimum number of spend pubkeys each thread pool task derives.
+static const uint64_t MIN_PUBKEYS_PER_TASK = 16;
+
 MW_NAMESPACE
 
 StealthAddress Keychain::GetStealthAddress(const uint32_t index) const
 {
     assert(index < ULONG_MAX);
-    m_addressIndexCounter = std::max(m_addressIndexCounter, index);
+
+    uint32_t counter = m_addressIndexCounter.load();
+    while (counter < index && !m_addressIndexCounter.compare_exchange_weak(counter, index)) { }
 
     PublicKey Bi = PublicKey::From(GetSpendKey(index));
     PublicKey Ai = Bi.Mul(m_scanSecret);
@@ -31,22 +38,121 @@ SecretKey Keychain::GetSpendKey(const uint32_t index) const
 
 bool Keychain::IsSpendPubKey(const PublicKey& spend_pubkey, uint32_t& index_out) const
 {
-    // Ensure pubkey cache is fully populated
-    while (m_pubkeys.size() <= ((size_t)m_addressIndexCounter + RESTORE_WINDOW)) {
-        LOG_INFO_F("Size: {}, Counter: {}", m_pubkeys.size(), m_addressIndexCounter);
-        uint32_t pubkey_index = (uint32_t)m_pubkeys.size();
-        PublicKey pubkey = PublicKey::From(GetSpendKey(pubkey_index));
+    const size_t num_required = (size_t)m_addressIndexCounter.load() + RESTORE_WINDOW + 1;
+    const SpendPubKey key{ spend_pubkey.array(), 0 };
+
+    auto find = [this, &key, &index_out]() {
+        auto iter = std::lower_bound(m_pubkeys.cbegin(), m_pubkeys.cend(), key);
+        if (iter != m_pubkeys.cend() && iter->pubkey == key.pubkey) {
+            index_out = iter->index;
+            return true;
+        }
+
+        return false;
+    };
+
+    {
+        std::shared_lock<std::shared_mutex> read_lock(m_mutex);
+        if (m_pubkeys.size() >= num_required) {
+            return find();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> write_lock(m_mutex);
+    if (m_pubkeys.size() < num_required) {
+        // Derive a whole window at a time, so the pubkeys aren't re-sorted every time the counter goes up.
+        DeriveSpendPubKeys(((num_required + RESTORE_WINDOW - 1) / RESTORE_WINDOW) * RESTORE_WINDOW);
+    }
+
+    return find();
+}
+
+std::vector<uint8_t> Keychain::SerializeSpendPubKeys() const
+{
+    std::shared_lock<std::shared_mutex> read_lock(m_mutex);
+
+    Serializer serializer;
+    serializer.Append<uint32_t>((uint32_t)m_pubkeys.size());
+    for (const SpendPubKey& pubkey : m_pubkeys) {
+        serializer
+            .Append(pubkey.pubkey)
+            .Append<uint32_t>(pubkey.index);
+    }
+
+    return serializer
+        .Append(HashSpendPubKeys(serializer.vec()))
+        .vec();
+}
+
+void Keychain::LoadSpendPubKeys(const std::vector<uint8_t>& serialized)
+{
+    Deserializer deserializer(serialized);
+    const uint32_t num_pubkeys = deserializer.Read<uint32_t>();
+    if (num_pubkeys == 0) {
+        return;
+    }
 
-        m_pubkeys.insert({ std::move(pubkey), pubkey_index });
+    // Checking the hash is as good as deriving every pubkey again, without the cost.
+    if (serialized.size() < sizeof(uint32_t) + mw::Hash::size()) {
+        ThrowDeserialization("Spend pubkeys hash missing");
     }
 
-    auto iter = m_pubkeys.find(spend_pubkey);
-    if (iter != m_pubkeys.end()) {
-        index_out = iter->second;
-        return true;
+    const size_t hash_offset = serialized.size() - mw::Hash::size();
+    const mw::Hash hash(serialized.data() + hash_offset);
+    if (hash != HashSpendPubKeys(std::vector<uint8_t>(serialized.begin(), serialized.begin() + hash_offset))) {
+        ThrowDeserialization("Spend pubkeys belong to a different keychain");
     }
 
-    return false;
+    std::vector<SpendPubKey> pubkeys;
+    pubkeys.reserve(num_pubkeys);
+    std::vector<bool> indices(num_pubkeys, false);
+    for (uint32_t i = 0; i < num_pubkeys; i++) {
+        SpendPubKey pubkey{ deserializer.ReadArray<33>(), deserializer.Read<uint32_t>() };
+        if (!pubkeys.empty() && !(pubkeys.back() < pubkey)) {
+            ThrowDeserialization("Spend pubkeys not sorted");
+        }
+
+        if (pubkey.index >= num_pubkeys || indices[pubkey.index]) {
+            ThrowDeserialization("Spend pubkey indices not contiguous");
+        }
+
+        indices[pubkey.index] = true;
+        pubkeys.push_back(std::move(pubkey));
+    }
+
+    std::unique_lock<std::shared_mutex> write_lock(m_mutex);
+    if (pubkeys.size() > m_pubkeys.size()) {
+        m_pubkeys = std::move(pubkeys);
+    }
+}
+
+mw::Hash Keychain::HashSpendPubKeys(const std::vector<uint8_t>& serialized) const
+{
+    // The serialized pubkeys are hashed first, so the secrets are followed by a fixed-length message.
+    return Hasher(EHashTag::ADDRESS)
+        .Append(m_scanSecret)
+        .Append(m_spendSecret)
+        .Append(Hashed(serialized))
+        .hash();
+}
+
+void Keychain::DeriveSpendPubKeys(const size_t num_indices) const
+{
+    const size_t first_index = m_pubkeys.size();
+    std::vector<SpendPubKey> derived(num_indices - first_index);
+    ThreadPool::Get().ParallelFor(first_index, num_indices, MIN_PUBKEYS_PER_TASK,
+        [this, first_index, &derived](const uint64_t begin, const uint64_t end) {
+            for (uint64_t index = begin; index < end; index++) {
+                derived[index - first_index] = SpendPubKey{ PublicKey::From(GetSpendKey((uint32_t)index)).array(), (uint32_t)index };
+            }
+        }
+    );
+
+    std::sort(derived.begin(), derived.end());
+    m_pubkeys.insert(m_pubkeys.end(), derived.cbegin(), derived.cend());
+    std::inplace_merge(m_pubkeys.begin(), m_pubkeys.begin() + first_index, m_pubkeys.end());
+
+    LOG_DEBUG_F("Derived spend pubkeys up to index {}", num_indices - 1);
 }
 
 END_NAMESPACE
\ No newline at end of file
@@ -1,18 +1,23 @@
 #include <mw/wallet/Transact.h>
 #include "WalletUtil.h"
 
+#include <mw/common/ThreadPool.h>
 #include <mw/consensus/Weight.h>
 #include <mw/crypto/Blinds.h>
 #include <mw/exceptions/InsufficientFundsException.h>
 #include <mw/wallet/Wallet.h>
 #include <numeric>
 
+// Minimum number of output groups each thread pool task creates. Outputs with their own proof are a group of 1.
+static const uint64_t MIN_GROUPS_PER_TASK = 1;
+
 mw::Transaction::CPtr Transact::CreateTx(
     const std::vector<libmw::Coin>& input_coins,
     const std::vector<std::pair<uint64_t, StealthAddress>>& recipients,
     const std::vector<PegOutCoin>& pegouts,
     const boost::optional<uint64_t>& pegin_amount,
-    const uint64_t fee)
+    const uint64_t fee,
+    const bool aggregate_proofs)
 {
     if (pegouts.size() > 1) {
         throw std::runtime_error("Only supporting one pegout at this time.");
@@ -45,7 +50,7 @@ mw::Transaction::CPtr Transact::CreateTx(
     std::vector<Input> inputs = WalletUtil::SignInputs(input_coins);
 
     // Create outputs
-    Transact::Outputs outputs = CreateOutputs(recipients);
+    Transact::Outputs outputs = CreateOutputs(recipients, aggregate_proofs);
 
     // Total kernel offset is split between raw kernel_offset and the kernel's blinding factor.
     // sum(output.blind) - sum(input.blind) = kernel_offset + sum(kernel.blind)
@@ -90,34 +95,100 @@ mw::Transaction::CPtr Transact::CreateTx(
     );
 }
 
-Transact::Outputs Transact::CreateOutputs(const std::vector<std::pair<uint64_t, StealthAddress>>& recipients)
+mw::Transaction::CPtr Transact::Send(
+    const mw::Keychain::Ptr& pKeychain,
+    const std::vector<libmw::Coin>& available_coins,
+    const std::vector<std::pair<uint64_t, StealthAddress>>& recipients,
+    const std::vector<PegOutCoin>& pegouts,
+    const uint64_t fee_rate,
+    CoinSelection::Result& selection_out,
+    const bool aggregate_proofs)
 {
-    Blinds output_blinds;
-    Blinds output_keys;
-    std::vector<Output> outputs;
-    std::transform(
-        recipients.cbegin(), recipients.cend(),
-        std::back_inserter(outputs),
-        [&output_blinds, &output_keys](const std::pair<uint64_t, StealthAddress>& recipient) {
-            BlindingFactor blind;
-            SecretKey ephemeral_key = Random::CSPRNG<32>();
-            Output output = Output::Create(
-                blind,
-                EOutputFeatures::DEFAULT_OUTPUT,
-                ephemeral_key,
-                recipient.second,
-                recipient.first
-            );
-
-            output_blinds.Add(blind);
-            output_keys.Add(ephemeral_key);
-            return output;
+    uint64_t amount = std::accumulate(
+        pegouts.cbegin(), pegouts.cend(), (uint64_t)0,
+        [](uint64_t sum, const PegOutCoin& pegout) { return sum + pegout.GetAmount(); }
+    );
+    amount = std::accumulate(
+        recipients.cbegin(), recipients.cend(), amount,
+        [](uint64_t sum, const std::pair<uint64_t, StealthAddress>& recipient) { return sum + recipient.first; }
+    );
+
+    selection_out = CoinSelection::Select(available_coins, amount, recipients.size(), fee_rate, pegouts.size(), aggregate_proofs);
+
+    std::vector<std::pair<uint64_t, StealthAddress>> receivers = recipients;
+    if (selection_out.change > 0) {
+        receivers.push_back({ selection_out.change, pKeychain->GetStealthAddress(libmw::CHANGE_INDEX) });
+    }
+
+    return CreateTx(selection_out.inputs, receivers, pegouts, boost::none, selection_out.fee, aggregate_proofs);
+}
+
+Transact::Outputs Transact::CreateOutputs(
+    const std::vector<std::pair<uint64_t, StealthAddress>>& recipients,
+    const bool aggregate_proofs)
+{
+    // Each output needs its own range proof, which dominates the cost of building a transaction,
+    // so the outputs are created on the thread pool. The ephemeral keys are drawn up front on this thread.
+    std::vector<SecretKey> ephemeral_keys;
+    ephemeral_keys.reserve(recipients.size());
+    for (size_t i = 0; i < recipients.size(); i++) {
+        ephemeral_keys.push_back(Random::CSPRNG<32>());
+    }
+
+    // With aggregate_proofs, the recipients are split into groups that share a proof, largest first.
+    // Aggregated proofs must be over a power of 2 outputs, so a group of 1 is just an output with its own proof.
+    std::vector<std::pair<size_t, size_t>> groups;
+    for (size_t next = 0; next < recipients.size();) {
+        size_t group_size = aggregate_proofs ? RangeProof::MAX_COMMITS : 1;
+        while (group_size > recipients.size() - next) {
+            group_size /= 2;
+        }
+
+        groups.push_back({ next, group_size });
+        next += group_size;
+    }
+
+    std::vector<BlindingFactor> blinds(recipients.size());
+    std::vector<Output> outputs(recipients.size());
+    ThreadPool::Get().ParallelFor(0, groups.size(), MIN_GROUPS_PER_TASK,
+        [&recipients, &ephemeral_keys, &groups, &blinds, &outputs](const uint64_t begin, const uint64_t end) {
+            for (uint64_t g = begin; g < end; g++) {
+                const size_t first = groups[g].first;
+                const size_t group_size = groups[g].second;
+                if (group_size == 1) {
+                    outputs[first] = Output::Create(
+                        blinds[first],
+                        EOutputFeatures::DEFAULT_OUTPUT,
+                        ephemeral_keys[first],
+                        recipients[first].second,
+                        recipients[first].first
+                    );
+                    continue;
+                }
+
+                std::vector<BlindingFactor> group_blinds;
+                std::vector<Output> group_outputs = Output::CreateAggregated(
+                    group_blinds,
+                    EOutputFeatures::DEFAULT_OUTPUT,
+                    std::vector<SecretKey>(ephemeral_keys.begin() + first, ephemeral_keys.begin() + first + group_size),
+                    std::vector<std::pair<uint64_t, StealthAddress>>(recipients.begin() + first, recipients.begin() + first + group_size)
+                );
+                std::move(group_blinds.begin(), group_blinds.end(), blinds.begin() + first);
+                std::move(group_outputs.begin(), group_outputs.end(), outputs.begin() + first);
+            }
         }
     );
 
+    Blinds output_blinds;
+    Blinds output_keys;
+    for (size_t i = 0; i < recipients.size(); i++) {
+        output_blinds.Add(blinds[i]);
+        output_keys.Add(ephemeral_keys[i]);
+    }
+
     return Transact::Outputs{
         output_blinds.Total(),
         output_keys.Total(),
         std::move(outputs)
     };
-}
\ No newline at end of file
+}
@@ -1,9 +1,68 @@
 #include <mw/wallet/Wallet.h>
+#include <mw/common/ThreadPool.h>
+#include <mw/crypto/Crypto.h>
 #include <mw/crypto/Keys.h>
+#include <mw/exceptions/CryptoException.h>
+
+// Minimum number of outputs each thread pool task checks.
+static const uint64_t MIN_OUTPUTS_PER_TASK = 16;
 
 bool Wallet::RewindOutput(const Output& output, libmw::Coin& coin) const
 {
-    SecretKey t = Hashed(EHashTag::DERIVE, output.Ke().Mul(m_pKeychain->GetScanSecret()));
+    // Outputs with keys that aren't valid points can't belong to the wallet.
+    try {
+        return RewindOutput(output, output.Ke().Mul(m_pKeychain->GetScanSecret()), coin);
+    } catch (const CryptoException&) {
+        return false;
+    }
+}
+
+std::vector<libmw::Coin> Wallet::ScanOutputs(const std::vector<Output>& outputs) const
+{
+    // The shared secret is needed before the view tag can be checked, so it's calculated for every output.
+    std::vector<PublicKey> sending_keys;
+    sending_keys.reserve(outputs.size());
+    std::transform(
+        outputs.cbegin(), outputs.cend(),
+        std::back_inserter(sending_keys),
+        [](const Output& output) { return output.Ke(); }
+    );
+
+    // Outputs whose keys aren't valid points have no shared secret, and are skipped.
+    const std::vector<boost::optional<PublicKey>> shared_secrets = Crypto::MultiplyKeys(sending_keys, m_pKeychain->GetScanSecret());
+
+    std::vector<boost::optional<libmw::Coin>> found(outputs.size());
+    ThreadPool::Get().ParallelFor(0, outputs.size(), MIN_OUTPUTS_PER_TASK,
+        [this, &outputs, &shared_secrets, &found](const uint64_t begin, const uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) {
+                if (!shared_secrets[i]) {
+                    continue;
+                }
+
+                // Any other key that isn't a valid point also means the output isn't the wallet's.
+                libmw::Coin coin;
+                try {
+                    if (RewindOutput(outputs[i], *shared_secrets[i], coin)) {
+                        found[i] = std::move(coin);
+                    }
+                } catch (const CryptoException&) { }
+            }
+        }
+    );
+
+    std::vector<libmw::Coin> coins;
+    for (const boost::optional<libmw::Coin>& coin : found) {
+        if (coin) {
+            coins.push_back(*coin);
+        }
+    }
+
+    return coins;
+}
+
+bool Wallet::RewindOutput(const Output& output, const PublicKey& shared_secret, libmw::Coin& coin) const
+{
+    SecretKey t = Hashed(EHashTag::DERIVE, shared_secret);
     if (t[0] != output.GetViewTag()) {
         return false;
     }
@@ -50,4 +109,4 @@ bool Wallet::RewindOutput(const Output& output, libmw::Coin& coin) const
         output.GetCommitment().array()
     };
     return true;
-}
\ No newline at end of file
+}
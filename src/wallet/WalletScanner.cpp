@@ -0,0 +1,123 @@
+#include <mw/wallet/WalletScanner.h>
+#include <mw/common/Logger.h>
+#include <mw/db/WalletDB.h>
+#include <mw/exceptions/DatabaseException.h>
+
+std::vector<libmw::Coin> WalletScanner::ScanChain(const libmw::IChain::Ptr& pChain)
+{
+    std::unique_ptr<libmw::IChainIterator> pChainIter = pChain->NewIterator();
+
+    std::unique_ptr<mw::ScanCursor> pCursor = GetCursor();
+    if (pCursor != nullptr) {
+        while (pChainIter->Valid() && pChainIter->GetHeight() < pCursor->height) {
+            pChainIter->Next();
+        }
+
+        if (pChainIter->Valid()
+            && pChainIter->GetHeight() == pCursor->height
+            && pChainIter->GetHeader().pHeader->GetHash() == pCursor->block_hash) {
+            pChainIter->Next();
+        } else {
+            LOG_WARNING_F("Block {} at height {} is no longer in the chain. Rescanning.", pCursor->block_hash, pCursor->height);
+
+            WalletDB walletDB(m_pDBWrapper.get());
+            walletDB.RemoveAllCoins();
+            walletDB.RemoveCursor();
+            pChainIter = pChain->NewIterator();
+        }
+    }
+
+    std::vector<libmw::Coin> coins;
+    while (pChainIter->Valid()) {
+        std::vector<libmw::Coin> block_coins = ConnectBlock(pChainIter->GetBlock().pBlock);
+        std::move(block_coins.begin(), block_coins.end(), std::back_inserter(coins));
+        pChainIter->Next();
+    }
+
+    return coins;
+}
+
+std::vector<libmw::Coin> WalletScanner::ConnectBlock(const mw::Block::CPtr& pBlock)
+{
+    assert(pBlock != nullptr);
+
+    std::unique_ptr<mw::ScanCursor> pCursor = GetCursor();
+    if (pCursor != nullptr && pBlock->GetHeight() != pCursor->height + 1) {
+        ThrowDatabase_F("Block at height {} doesn't follow the scan cursor at height {}", pBlock->GetHeight(), pCursor->height);
+    }
+
+    std::vector<libmw::Coin> coins = m_wallet.ScanOutputs(pBlock->GetOutputs());
+
+    // Inputs are spent before outputs are added, so a block can't spend coins it creates.
+    auto pBatch = m_pDBWrapper->CreateBatch();
+    WalletDB walletDB(m_pDBWrapper.get(), pBatch.get());
+    for (const Input& input : pBlock->GetInputs()) {
+        walletDB.RemoveCoin(input.GetCommitment());
+    }
+
+    std::vector<mw::WalletCoin> wallet_coins;
+    std::transform(
+        coins.cbegin(), coins.cend(),
+        std::back_inserter(wallet_coins),
+        [&pBlock](const libmw::Coin& coin) { return mw::WalletCoin(coin, pBlock->GetHeight()); }
+    );
+    walletDB.AddCoins(wallet_coins);
+    walletDB.SaveCursor(mw::ScanCursor(pBlock->GetHeight(), pBlock->GetHash()));
+    pBatch->Commit();
+
+    return coins;
+}
+
+void WalletScanner::DisconnectBlock(const mw::BlockUndo::CPtr& pUndo)
+{
+    assert(pUndo != nullptr);
+
+    std::unique_ptr<mw::ScanCursor> pCursor = GetCursor();
+    const mw::Header::CPtr& pPrevHeader = pUndo->GetPreviousHeader();
+    if (pCursor == nullptr || (pPrevHeader != nullptr && pPrevHeader->GetHeight() + 1 != pCursor->height)) {
+        ThrowDatabase("Undo data doesn't match the block at the scan cursor");
+    }
+
+    auto pBatch = m_pDBWrapper->CreateBatch();
+    WalletDB walletDB(m_pDBWrapper.get(), pBatch.get());
+    for (const Commitment& commitment : pUndo->GetCoinsAdded()) {
+        walletDB.RemoveCoin(commitment);
+    }
+
+    // The spent coins aren't stored once they're spent, so the ones that belong to the wallet are rewound again.
+    std::vector<mw::WalletCoin> restored;
+    for (const UTXO& utxo : pUndo->GetCoinsSpent()) {
+        libmw::Coin coin;
+        if (m_wallet.RewindOutput(utxo.GetOutput(), coin)) {
+            restored.push_back(mw::WalletCoin(std::move(coin), utxo.GetBlockHeight()));
+        }
+    }
+    walletDB.AddCoins(restored);
+
+    if (pPrevHeader != nullptr) {
+        walletDB.SaveCursor(mw::ScanCursor(pPrevHeader->GetHeight(), pPrevHeader->GetHash()));
+    } else {
+        walletDB.RemoveCursor();
+    }
+
+    pBatch->Commit();
+}
+
+std::unique_ptr<mw::ScanCursor> WalletScanner::GetCursor() const
+{
+    return WalletDB(m_pDBWrapper.get()).GetCursor();
+}
+
+std::vector<libmw::Coin> WalletScanner::GetCoins() const
+{
+    std::vector<mw::WalletCoin> wallet_coins = WalletDB(m_pDBWrapper.get()).GetCoins();
+
+    std::vector<libmw::Coin> coins;
+    std::transform(
+        wallet_coins.cbegin(), wallet_coins.cend(),
+        std::back_inserter(coins),
+        [](const mw::WalletCoin& wallet_coin) { return wallet_coin.coin; }
+    );
+
+    return coins;
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <mw/models/crypto/BlindingFactor.h>
 #include <mw/crypto/Crypto.h>
 #include <mw/crypto/Hasher.h>
+#include <mw/crypto/Schnorr.h>
+#include <mw/models/tx/Input.h>
 #include <numeric>
 
 class WalletUtil
@@ -12,17 +14,16 @@ public:
     static std::vector<BlindingFactor> GetBlindingFactors(const std::vector<libmw::Coin>& coins)
     {
         std::vector<BlindingFactor> blinds;
+        std::vector<uint64_t> amounts;
+        blinds.reserve(coins.size());
+        amounts.reserve(coins.size());
+        for (const libmw::Coin& coin : coins) {
+            assert(coin.blind.has_value());
+            blinds.push_back(BlindingFactor{ coin.blind.value() });
+            amounts.push_back(coin.amount);
+        }
 
-        std::transform(
-            coins.cbegin(), coins.cend(),
-            std::back_inserter(blinds),
-            [](const libmw::Coin& coin) {
-                assert(coin.blind.has_value());
-                return BlindingFactor{ Crypto::BlindSwitch(coin.blind.value(), coin.amount) };
-            }
-        );
-
-        return blinds;
+        return Crypto::BlindSwitch(blinds, amounts);
     }
 
     static std::vector<BlindingFactor> GetKeys(const std::vector<libmw::Coin>& coins)
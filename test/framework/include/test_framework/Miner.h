@@ -43,6 +43,11 @@ public:
         auto outputMMR = GetOutputMMR(pTransaction->GetOutputs());
         auto pLeafSet = GetLeafSet(pTransaction->GetInputs(), pTransaction->GetOutputs());
 
+        boost::optional<mw::Hash> cut_through_hash = boost::none;
+        if (mw::ChainParams::IsCutThroughActive(height)) {
+            cut_through_hash = pTransaction->GetBody().GetCutThroughHash();
+        }
+
         auto pHeader = std::make_shared<mw::Header>(
             height,
             outputMMR.Root(),
@@ -51,7 +56,8 @@ public:
             std::move(kernel_offset),
             std::move(owner_offset),
             outputMMR.GetNumLeaves(),
-            kernelMMR.GetNumLeaves()
+            kernelMMR.GetNumLeaves(),
+            std::move(cut_through_hash)
         );
 
         std::cout << "Mined Block: " << pHeader->GetHeight() << " - " << pHeader->Format() << std::endl;
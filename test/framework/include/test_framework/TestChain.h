@@ -0,0 +1,40 @@
+#pragma once
+
+#include <libmw/interfaces/chain_interface.h>
+#include <test_framework/models/MinedBlock.h>
+
+//
+// Serves the blocks, in order, through the libmw::IChain interface.
+//
+class TestChain : public libmw::IChain
+{
+public:
+    TestChain(const std::vector<test::MinedBlock>& blocks)
+        : m_blocks(blocks) { }
+
+    std::unique_ptr<libmw::IChainIterator> NewIterator() final
+    {
+        return std::make_unique<Iterator>(m_blocks);
+    }
+
+private:
+    class Iterator : public libmw::IChainIterator
+    {
+    public:
+        Iterator(const std::vector<test::MinedBlock>& blocks)
+            : m_blocks(blocks), m_index(0) { }
+
+        void Next() noexcept final { m_index++; }
+        bool Valid() const noexcept final { return m_index < m_blocks.size(); }
+
+        uint64_t GetHeight() const final { return m_blocks[m_index].GetHeader()->GetHeight(); }
+        libmw::HeaderRef GetHeader() const final { return libmw::HeaderRef{ m_blocks[m_index].GetHeader() }; }
+        libmw::BlockRef GetBlock() const final { return libmw::BlockRef{ m_blocks[m_index].GetBlock() }; }
+
+    private:
+        const std::vector<test::MinedBlock>& m_blocks;
+        size_t m_index;
+    };
+
+    std::vector<test::MinedBlock> m_blocks;
+};
\ No newline at end of file
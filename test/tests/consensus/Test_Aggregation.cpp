@@ -1,9 +1,14 @@
 #include <catch.hpp>
 
 #include <mw/consensus/Aggregation.h>
+#include <mw/consensus/Weight.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/DeserializationException.h>
 
 #include <test_framework/TxBuilder.h>
 
+#include <chrono>
+
 TEST_CASE("Aggregation")
 {
     mw::Transaction::CPtr tx1 = test::TxBuilder()
@@ -56,4 +61,136 @@ TEST_CASE("Aggregation")
         .Add(tx2->GetOwnerOffset())
         .Total();
     REQUIRE(pAggregated->GetOwnerOffset() == owner_offset);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Aggregation - Duplicates")
+{
+    test::Tx tx1 = test::TxBuilder().AddInput(10).AddOutput(5).AddPlainKernel(5).Build();
+    test::Tx tx2 = test::TxBuilder().AddInput(20).AddOutput(15).AddPlainKernel(5).Build();
+
+    // Same input as tx1
+    mw::Transaction::CPtr pDuplicateInput = mw::Transaction::Create(
+        BlindingFactor(), BlindingFactor(), tx1.GetTransaction()->GetInputs(), tx2.GetTransaction()->GetOutputs(), tx2.GetKernels(), {}
+    );
+    REQUIRE_THROWS_AS(Aggregation::Aggregate({ tx1.GetTransaction(), pDuplicateInput }), ValidationException);
+
+    // Same output as tx1
+    mw::Transaction::CPtr pDuplicateOutput = mw::Transaction::Create(
+        BlindingFactor(), BlindingFactor(), tx2.GetTransaction()->GetInputs(), tx1.GetTransaction()->GetOutputs(), tx2.GetKernels(), {}
+    );
+    REQUIRE_THROWS_AS(Aggregation::Aggregate({ tx1.GetTransaction(), pDuplicateOutput }), ValidationException);
+
+    // Same kernel as tx1
+    mw::Transaction::CPtr pDuplicateKernel = mw::Transaction::Create(
+        BlindingFactor(), BlindingFactor(), tx2.GetTransaction()->GetInputs(), tx2.GetTransaction()->GetOutputs(), tx1.GetKernels(), {}
+    );
+    REQUIRE_THROWS_AS(Aggregation::Aggregate({ tx1.GetTransaction(), pDuplicateKernel }), ValidationException);
+
+    REQUIRE_NOTHROW(Aggregation::Aggregate({ tx1.GetTransaction(), tx2.GetTransaction() }));
+}
+
+TEST_CASE("Aggregation - Cut-through")
+{
+    test::Tx tx1 = test::TxBuilder()
+        .AddInput(50).AddOutput(20).AddOutput(25)
+        .AddPlainKernel(5, true)
+        .Build();
+    test::Tx tx2 = test::TxBuilder()
+        .AddInput(tx1.GetOutputs()[0]).AddOutput(15)
+        .AddPlainKernel(5, true)
+        .Build();
+
+    //
+    // Without cut-through, the output and the input spending it are both kept.
+    //
+    mw::Transaction::CPtr pUncut = Aggregation::Aggregate({ tx1.GetTransaction(), tx2.GetTransaction() });
+    pUncut->Validate();
+    REQUIRE(pUncut->GetInputs().size() == 2);
+    REQUIRE(pUncut->GetOutputs().size() == 3);
+    REQUIRE(pUncut->GetBody().GetCutThroughs().empty());
+
+    // A body without cut-throughs is serialized the same way it was before they were supported.
+    std::vector<uint8_t> legacy_serialized = Serializer()
+        .AppendVec<Input>(pUncut->GetInputs())
+        .AppendVec<Output>(pUncut->GetOutputs())
+        .AppendVec<Kernel>(pUncut->GetKernels())
+        .AppendVec<SignedMessage>(pUncut->GetOwnerSigs())
+        .vec();
+    REQUIRE(pUncut->GetBody().Serialized() == legacy_serialized);
+
+    // The owner sig count isn't trusted, so a count that can't fit in the data is rejected before anything is allocated.
+    std::vector<uint8_t> oversized_serialized = Serializer()
+        .AppendVec<Input>(pUncut->GetInputs())
+        .AppendVec<Output>(pUncut->GetOutputs())
+        .AppendVec<Kernel>(pUncut->GetKernels())
+        .Append<uint32_t>(0x7FFFFFFF)
+        .vec();
+    Deserializer oversized_deserializer(oversized_serialized);
+    REQUIRE_THROWS_AS(TxBody::Deserialize(oversized_deserializer), DeserializationException);
+
+    //
+    // With cut-through, only their signatures are left.
+    //
+    mw::Transaction::CPtr pAggregated = Aggregation::Aggregate({ tx1.GetTransaction(), tx2.GetTransaction() }, true);
+    pAggregated->Validate();
+    REQUIRE(pAggregated->GetInputs() == tx1.GetTransaction()->GetInputs());
+    REQUIRE(pAggregated->GetOutputs().size() == 2);
+    REQUIRE(pAggregated->GetKernels() == pUncut->GetKernels());
+    REQUIRE(pAggregated->GetOwnerSigs() == pUncut->GetOwnerSigs());
+    REQUIRE(pAggregated->GetBody().GetCutThroughs().size() == 1);
+    REQUIRE(pAggregated->GetBody().GetCutThroughs().front().GetSenderPubKey() == tx1.GetOutputs()[0].GetOutput().GetSenderPubKey());
+    REQUIRE(Weight::Calculate(pAggregated->GetBody()) < Weight::Calculate(pUncut->GetBody()));
+
+    // Cut-throughs are only serialized as the explicit field of a block past the cut-through height.
+    Serializer serializer;
+    pAggregated->GetBody().SerializeCutThroughs(serializer);
+    Deserializer deserializer(serializer.vec());
+    REQUIRE(TxBody::DeserializeWithCutThroughs(deserializer).GetCutThroughs() == pAggregated->GetBody().GetCutThroughs());
+
+    Deserializer tx_deserializer(pAggregated->Serialized());
+    REQUIRE(tx_deserializer.Read<mw::Transaction>().GetBody().GetCutThroughs().empty());
+
+    //
+    // Cut-throughs are kept when aggregating again.
+    //
+    test::Tx tx3 = test::TxBuilder().AddInput(30).AddOutput(25).AddPlainKernel(5).Build();
+    mw::Transaction::CPtr pReaggregated = Aggregation::Aggregate({ pAggregated, tx3.GetTransaction() }, true);
+    pReaggregated->Validate();
+    REQUIRE(pReaggregated->GetBody().GetCutThroughs() == pAggregated->GetBody().GetCutThroughs());
+
+    //
+    // The owner sum can't be balanced without the cut-through's signatures.
+    //
+    mw::Transaction invalid(
+        pAggregated->GetKernelOffset(),
+        pAggregated->GetOwnerOffset(),
+        TxBody(pAggregated->GetInputs(), pAggregated->GetOutputs(), pAggregated->GetKernels(), pAggregated->GetOwnerSigs())
+    );
+    REQUIRE_THROWS_AS(invalid.Validate(), ValidationException);
+}
+
+TEST_CASE("Aggregation - 1000 transactions", "[.benchmark]")
+{
+    // Random commitments are enough to measure the merge, since the signatures and proofs aren't checked.
+    const RangeProof::CPtr pProof = std::make_shared<const RangeProof>();
+    std::vector<mw::Transaction::CPtr> transactions;
+    for (size_t i = 0; i < 1000; i++) {
+        std::vector<Input> inputs;
+        std::vector<Output> outputs;
+        for (size_t j = 0; j < 2; j++) {
+            inputs.push_back(Input(Commitment(Random::CSPRNG<33>().GetBigInt()), PublicKey(), Signature()));
+            outputs.push_back(Output(Commitment(Random::CSPRNG<33>().GetBigInt()), Features(), PublicKey(), PublicKey(), 0, 0, BigInt<16>(), PublicKey(), Signature(), pProof));
+        }
+
+        std::vector<Kernel> kernels{ Kernel(i, boost::none, boost::none, boost::none, {}, Commitment(Random::CSPRNG<33>().GetBigInt()), Signature()) };
+        transactions.push_back(mw::Transaction::Create(Random::CSPRNG<32>(), Random::CSPRNG<32>(), inputs, outputs, kernels, {}));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    mw::Transaction::CPtr pAggregated = Aggregation::Aggregate(transactions);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    REQUIRE(pAggregated->GetInputs().size() == 2000);
+    REQUIRE(std::is_sorted(pAggregated->GetOutputs().cbegin(), pAggregated->GetOutputs().cend(), SortByCommitment));
+    WARN("Aggregated 1000 transactions in " << elapsed << "us");
+}
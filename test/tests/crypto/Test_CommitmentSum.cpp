@@ -0,0 +1,41 @@
+#include <catch.hpp>
+
+#include <mw/crypto/CommitmentSum.h>
+#include <mw/crypto/Crypto.h>
+#include <mw/crypto/Random.h>
+
+TEST_CASE("CommitmentSum")
+{
+    // Enough commitments that they're split into several partitions, the last of which is only partly full.
+    // There are few enough partial sums that they're added directly, rather than partitioned again.
+    std::vector<Commitment> positive;
+    for (uint64_t i = 0; i < 3000; i++) {
+        positive.push_back(Crypto::CommitBlinded(i, Random::CSPRNG<32>().GetBigInt()));
+    }
+
+    std::vector<Commitment> negative;
+    for (uint64_t i = 0; i < 1500; i++) {
+        negative.push_back(Crypto::CommitBlinded(i, Random::CSPRNG<32>().GetBigInt()));
+    }
+
+    REQUIRE(positive.size() > 2 * CommitmentSum::PARTITION_SIZE);
+    REQUIRE(positive.size() % CommitmentSum::PARTITION_SIZE != 0);
+    REQUIRE(negative.size() > CommitmentSum::PARTITION_SIZE);
+
+    const Commitment expected = Crypto::AddCommitments(positive, negative);
+    REQUIRE(CommitmentSum::Sum(positive, negative) == expected);
+    REQUIRE(CommitmentSum::Sum(positive) == Crypto::AddCommitments(positive));
+    REQUIRE(CommitmentSum::Sum({}, negative) == Crypto::AddCommitments({}, negative));
+
+    // Summing one batch at a time gives the same result.
+    CommitmentSum sum;
+    REQUIRE(sum.Total() == Commitment{});
+
+    for (size_t i = 0; i < positive.size(); i += 700) {
+        const size_t end = std::min(i + 700, positive.size());
+        sum.AddPartial(std::vector<Commitment>(positive.begin() + i, positive.begin() + end));
+    }
+
+    sum.AddPartial({}, negative);
+    REQUIRE(sum.Total() == expected);
+}
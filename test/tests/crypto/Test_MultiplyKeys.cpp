@@ -0,0 +1,72 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Crypto.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/CryptoException.h>
+
+#include <chrono>
+
+static std::vector<PublicKey> RandomKeys(const size_t num_keys)
+{
+    std::vector<PublicKey> keys;
+    for (size_t i = 0; i < num_keys; i++) {
+        keys.push_back(PublicKey::From(Random::CSPRNG<32>()));
+    }
+
+    return keys;
+}
+
+TEST_CASE("Crypto::MultiplyKeys")
+{
+    // Enough keys that they're split into several batches, with a partial batch at the end.
+    const std::vector<PublicKey> keys = RandomKeys(600);
+    const SecretKey mul = Random::CSPRNG<32>();
+
+    const std::vector<boost::optional<PublicKey>> products = Crypto::MultiplyKeys(keys, mul);
+    REQUIRE(products.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        REQUIRE(products[i].has_value());
+        REQUIRE(*products[i] == keys[i].Mul(mul));
+    }
+
+    REQUIRE(Crypto::MultiplyKeys({}, mul).empty());
+    REQUIRE_THROWS_AS(Crypto::MultiplyKeys(keys, SecretKey()), CryptoException);
+
+    // Keys that aren't valid points fail on their own, without failing the rest of their batch.
+    std::vector<PublicKey> with_invalid = keys;
+    with_invalid[1] = PublicKey();
+    with_invalid[300] = PublicKey();
+    const std::vector<boost::optional<PublicKey>> products_with_invalid = Crypto::MultiplyKeys(with_invalid, mul);
+    REQUIRE(products_with_invalid.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i == 1 || i == 300) {
+            REQUIRE_FALSE(products_with_invalid[i].has_value());
+        } else {
+            REQUIRE(products_with_invalid[i].has_value());
+            REQUIRE(*products_with_invalid[i] == *products[i]);
+        }
+    }
+
+    const std::vector<boost::optional<PublicKey>> all_invalid = Crypto::MultiplyKeys({ PublicKey(), PublicKey() }, mul);
+    REQUIRE(all_invalid.size() == 2);
+    REQUIRE_FALSE(all_invalid[0].has_value());
+    REQUIRE_FALSE(all_invalid[1].has_value());
+}
+
+TEST_CASE("Crypto::MultiplyKeys - 20000 keys", "[.benchmark]")
+{
+    const std::vector<PublicKey> keys = RandomKeys(20000);
+    const SecretKey mul = Random::CSPRNG<32>();
+
+    auto start = std::chrono::steady_clock::now();
+    for (const PublicKey& key : keys) {
+        key.Mul(mul);
+    }
+    const double single_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Crypto::MultiplyKeys(keys, mul);
+    const double batch_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WARN("One at a time: " << (uint64_t)(keys.size() / single_secs) << " outputs/s, batched: " << (uint64_t)(keys.size() / batch_secs) << " outputs/s");
+}
@@ -0,0 +1,130 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Crypto.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/CryptoException.h>
+
+#include <chrono>
+
+// Blinding factors 1, n - 1 and an arbitrary one, with values that cover the first, middle and last windows of the value table.
+// The expected results were calculated with secp256k1_pedersen_commit and secp256k1_blind_switch, without the precomputed tables.
+struct PedersenVector
+{
+    std::string blind;
+    uint64_t value;
+    std::string commitment;
+    std::string blind_switch;
+};
+
+static const std::vector<PedersenVector> PEDERSEN_VECTORS = {
+    {
+        "0000000000000000000000000000000000000000000000000000000000000001", 0,
+        "0879be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798",
+        "da4ae30c2e534b4307c4813a5cb2bc39c3134e9ec3b4d89f0a54972c17fdabd1"
+    },
+    {
+        "0000000000000000000000000000000000000000000000000000000000000001", 1,
+        "09337b7285fc31a330c3e05d10c1cbbc009bf37c9c5dcf192adfd221bc8450d79a",
+        "a5a81902b9259bcdff123e81621e24a710ebe3d112bee6997de71470dc2d8bf6"
+    },
+    {
+        "1d3a0f4ad1d1e6c1b72d0f0b9d1ec6c1f1a3b0e1c4d5e6f708192a3b4c5d6e7f", 1234567890123,
+        "08cce5387d21bb38d6e798a5511777f9a79650a10020b8b158b32af828e4046d9a",
+        "26de6061f4e7e6ee22ce1977d385ab352719146e3413e5dc4debf608be39eec1"
+    },
+    {
+        "1d3a0f4ad1d1e6c1b72d0f0b9d1ec6c1f1a3b0e1c4d5e6f708192a3b4c5d6e7f", 0xffffffffffffffff,
+        "098cdd4a2601c0739bd4a7b4a3431fc3d22eeb5f94f34646130ce6d86892a95361",
+        "f0d37f81676583431e7466373fdad074e86d2504dd86fa0c65ffcd20e4ad1d89"
+    },
+    {
+        "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140", 1,
+        "081d325d840aeb50fe036fc4a3dc5d3d75e24d4e534de2d2d07b3ea30bcea2bf71",
+        "31c303c2dc2853b8028a85f3074f760ecb571afaec52348f3e8279b98c8e8113"
+    },
+    {
+        "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140", 0xffffffffffffffff,
+        "0867ec6c8782c9c5f41bb0c960ec23316ffae70c0ddb8d3dcde3dbe13bdcf3f799",
+        "f6753e584eb45fbe078698b43536636302494a5fe080690a66862c14bb89fee6"
+    }
+};
+
+TEST_CASE("Crypto::CommitBlinded")
+{
+    std::vector<uint64_t> values;
+    std::vector<BlindingFactor> blinds;
+    for (const PedersenVector& vector : PEDERSEN_VECTORS) {
+        const BlindingFactor blind = BlindingFactor::FromHex(vector.blind);
+        REQUIRE(Crypto::CommitBlinded(vector.value, blind).ToHex() == vector.commitment);
+        REQUIRE(Crypto::BlindSwitch(blind, vector.value).ToHex() == vector.blind_switch);
+
+        values.push_back(vector.value);
+        blinds.push_back(blind);
+    }
+
+    // Zero blinding factors are allowed, as long as the value isn't also zero.
+    REQUIRE(Crypto::CommitTransparent(1).ToHex() == "0950929b74c1a04954b78b4b6035e97a5e078a5a0f28ec96d547bfee9ace803ac0");
+    REQUIRE_THROWS_AS(Crypto::CommitTransparent(0), CryptoException);
+
+    // Batches match the known vectors, in order.
+    const std::vector<Commitment> commitments = Crypto::CommitBlinded(values, blinds);
+    const std::vector<BlindingFactor> blind_switches = Crypto::BlindSwitch(blinds, values);
+    REQUIRE(commitments.size() == PEDERSEN_VECTORS.size());
+    REQUIRE(blind_switches.size() == PEDERSEN_VECTORS.size());
+    for (size_t i = 0; i < PEDERSEN_VECTORS.size(); i++) {
+        REQUIRE(commitments[i].ToHex() == PEDERSEN_VECTORS[i].commitment);
+        REQUIRE(blind_switches[i].ToHex() == PEDERSEN_VECTORS[i].blind_switch);
+    }
+
+    // Enough commitments that they're split into several batches, with a partial batch at the end.
+    values.clear();
+    blinds.clear();
+    for (size_t i = 0; i < 600; i++) {
+        values.push_back(Random::FastRandom());
+        blinds.push_back(Random::CSPRNG<32>().GetBigInt());
+    }
+
+    const std::vector<Commitment> batch_commitments = Crypto::CommitBlinded(values, blinds);
+    const std::vector<BlindingFactor> batch_switches = Crypto::BlindSwitch(blinds, values);
+    for (size_t i = 0; i < values.size(); i++) {
+        REQUIRE(batch_commitments[i] == Crypto::CommitBlinded(values[i], blinds[i]));
+        REQUIRE(batch_switches[i] == Crypto::BlindSwitch(blinds[i], values[i]));
+    }
+
+    // The homomorphism holds when the sum carries across every window of the tables.
+    REQUIRE(Crypto::AddCommitments({ Crypto::CommitBlinded(0x0fffffffffffffff, blinds[0]), Crypto::CommitBlinded(1, blinds[1]) }) == Crypto::CommitBlinded(
+        0x1000000000000000,
+        Crypto::AddBlindingFactors({ blinds[0], blinds[1] })
+    ));
+
+    REQUIRE(Crypto::CommitBlinded(std::vector<uint64_t>{}, std::vector<BlindingFactor>{}).empty());
+    REQUIRE_THROWS_AS(Crypto::CommitBlinded(std::vector<uint64_t>{ 1 }, std::vector<BlindingFactor>{}), CryptoException);
+
+    // A blinding factor that overflows fails the whole batch. Switch blinds can't be zero either.
+    blinds[values.size() / 2] = BlindingFactor::FromHex("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141");
+    REQUIRE_THROWS_AS(Crypto::CommitBlinded(values, blinds), CryptoException);
+    REQUIRE_THROWS_AS(Crypto::BlindSwitch(blinds, values), CryptoException);
+    REQUIRE_THROWS_AS(Crypto::BlindSwitch(BlindingFactor(), 1), CryptoException);
+}
+
+TEST_CASE("Crypto::CommitBlinded - 20000 commitments", "[.benchmark]")
+{
+    std::vector<uint64_t> values;
+    std::vector<BlindingFactor> blinds;
+    for (size_t i = 0; i < 20000; i++) {
+        values.push_back(Random::FastRandom());
+        blinds.push_back(Random::CSPRNG<32>().GetBigInt());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < values.size(); i++) {
+        Crypto::CommitBlinded(values[i], Crypto::BlindSwitch(blinds[i], values[i]));
+    }
+    const double single_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Crypto::CommitBlinded(values, Crypto::BlindSwitch(blinds, values));
+    const double batch_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WARN("One at a time: " << (uint64_t)(values.size() / single_secs) << " switch commitments/s, batched: " << (uint64_t)(values.size() / batch_secs) << " switch commitments/s");
+}
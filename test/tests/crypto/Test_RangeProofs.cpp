@@ -3,6 +3,9 @@
 #include <mw/crypto/Bulletproofs.h>
 #include <mw/crypto/Crypto.h>
 #include <mw/crypto/Random.h>
+#include <mw/exceptions/CryptoException.h>
+
+#include <chrono>
 
 TEST_CASE("Range Proofs")
 {
@@ -42,4 +45,75 @@ TEST_CASE("Range Proofs")
     std::vector<ProofData> rangeProofs;
     rangeProofs.push_back(ProofData{ commit, pRangeProof, extraData });
     REQUIRE(Bulletproofs::BatchVerify(rangeProofs));
-}
\ No newline at end of file
+}
+TEST_CASE("Aggregated Range Proofs")
+{
+    auto create = [](const size_t num_commits, std::vector<Commitment>& commits) {
+        std::vector<uint64_t> values;
+        std::vector<SecretKey> keys;
+        commits.clear();
+        for (size_t i = 0; i < num_commits; i++) {
+            values.push_back(1000 + i);
+            keys.push_back(Random::CSPRNG<32>());
+            commits.push_back(Crypto::CommitBlinded(values.back(), BlindingFactor(keys.back().vec())));
+        }
+
+        return Bulletproofs::GenerateAggregated(values, keys, Random::CSPRNG<32>(), Random::CSPRNG<32>(), { 1, 2, 3 });
+    };
+
+    std::vector<ProofData> proofs;
+    for (size_t num_commits : { 1, 2, 4, 8 }) {
+        std::vector<Commitment> commits;
+        RangeProof::CPtr pProof = create(num_commits, commits);
+        REQUIRE(pProof->size() == RangeProof::SizeFor(num_commits));
+
+        ProofData proof{ commits.front(), pProof, { 1, 2, 3 }, std::vector<Commitment>(commits.begin() + 1, commits.end()) };
+        REQUIRE(Bulletproofs::BatchVerify({ proof }));
+        proofs.push_back(proof);
+
+        if (num_commits > 1) {
+            // Proven commitments must be given in the order they were proven.
+            std::swap(proof.aggregated_commits.front(), proof.commitment);
+            REQUIRE_FALSE(Bulletproofs::BatchVerify({ proof }));
+        }
+    }
+
+    // Single and aggregated proofs are verified together.
+    REQUIRE(Bulletproofs::BatchVerify(proofs));
+
+    // Proofs must be over a power of 2 commitments.
+    std::vector<Commitment> commits;
+    REQUIRE_THROWS_AS(create(3, commits), CryptoException);
+    REQUIRE_THROWS_AS(create(RangeProof::MAX_COMMITS * 2, commits), CryptoException);
+}
+
+TEST_CASE("Aggregated Range Proofs - 64 outputs", "[.benchmark]")
+{
+    const size_t num_outputs = 64;
+
+    for (size_t num_commits : { 1, 2, 4, 8 }) {
+        std::vector<ProofData> proofs;
+        size_t total_size = 0;
+        for (size_t first = 0; first < num_outputs; first += num_commits) {
+            std::vector<uint64_t> values;
+            std::vector<SecretKey> keys;
+            std::vector<Commitment> commits;
+            for (size_t i = 0; i < num_commits; i++) {
+                values.push_back(first + i);
+                keys.push_back(Random::CSPRNG<32>());
+                commits.push_back(Crypto::CommitBlinded(values.back(), BlindingFactor(keys.back().vec())));
+            }
+
+            RangeProof::CPtr pProof = Bulletproofs::GenerateAggregated(values, keys, Random::CSPRNG<32>(), Random::CSPRNG<32>(), {});
+            total_size += pProof->size();
+            proofs.push_back(ProofData{ commits.front(), pProof, {}, std::vector<Commitment>(commits.begin() + 1, commits.end()) });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(Bulletproofs::BatchVerify(proofs));
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        WARN(num_outputs << " outputs in proofs over " << num_commits << " commitments: "
+            << total_size << " bytes, verified in " << elapsed.count() << "us");
+    }
+}
@@ -0,0 +1,93 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Random.h>
+#include <mw/db/CoinDB.h>
+#include <mw/wallet/Transact.h>
+#include <mw/wallet/Wallet.h>
+
+#include <test_framework/DBWrapper.h>
+
+TEST_CASE("CoinDB - Shared proofs")
+{
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+
+    //
+    // 4 outputs that share one aggregated proof.
+    //
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+    std::vector<std::pair<uint64_t, StealthAddress>> recipients;
+    for (uint32_t i = 0; i < 4; i++) {
+        recipients.push_back({ 10 + i, pKeychain->GetStealthAddress(i) });
+    }
+
+    mw::Transaction::CPtr pTx = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(50), 4, true);
+    const std::vector<Output>& outputs = pTx->GetOutputs();
+    auto carrier_iter = std::find_if(outputs.cbegin(), outputs.cend(), [](const Output& output) { return output.HasRangeProof(); });
+    REQUIRE(carrier_iter != outputs.cend());
+    auto pCarrier = std::make_shared<const Output>(*carrier_iter);
+    const std::vector<Commitment>& members = pCarrier->GetAggregatedCommits();
+    REQUIRE(members.size() == 3);
+
+    std::vector<UTXO::CPtr> utxos;
+    for (size_t i = 0; i < outputs.size(); i++) {
+        const Output& output = outputs[i];
+        utxos.push_back(std::make_shared<UTXO>(10, mmr::LeafIndex::At(i), output, output.HasRangeProof() ? nullptr : pCarrier));
+    }
+
+    CoinDB(pDatabase.get()).AddUTXOs(utxos);
+
+    // The carrier is stored once, rather than in each member's record.
+    std::vector<uint8_t> data;
+    REQUIRE(pDatabase->Read("R" + pCarrier->GetCommitment().ToHex(), data));
+    for (const Commitment& member : members) {
+        REQUIRE(pDatabase->Read("U" + member.ToHex(), data));
+        REQUIRE(data.front() == 1);
+        REQUIRE(data.size() < pCarrier->Serialized().size());
+    }
+
+    auto utxos_by_commitment = CoinDB(pDatabase.get()).GetUTXOs(members);
+    REQUIRE(utxos_by_commitment.size() == 3);
+    REQUIRE(utxos_by_commitment[members[0]]->GetProofOutput() == utxos_by_commitment[members[1]]->GetProofOutput());
+    REQUIRE(utxos_by_commitment[members[0]]->BuildProofData() == pCarrier->BuildProofData());
+
+    //
+    // The proof is kept until the last of the members is spent, even after the carrier is.
+    //
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        CoinDB(pDatabase.get(), pBatch.get()).RemoveUTXOs({ pCarrier->GetCommitment(), members[0], members[1] });
+        pBatch->Commit();
+    }
+
+    REQUIRE(CoinDB(pDatabase.get()).GetUTXOs({ pCarrier->GetCommitment() }).empty());
+    utxos_by_commitment = CoinDB(pDatabase.get()).GetUTXOs({ members[2] });
+    REQUIRE(utxos_by_commitment[members[2]]->GetProofOutput()->GetCommitment() == pCarrier->GetCommitment());
+
+    // Removed and added back in the same batch, as when a block is disconnected and another connected.
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        CoinDB coinDB(pDatabase.get(), pBatch.get());
+        coinDB.RemoveUTXOs({ members[2] });
+        coinDB.AddUTXOs({ utxos_by_commitment[members[2]] });
+        pBatch->Commit();
+    }
+
+    REQUIRE(pDatabase->Read("R" + pCarrier->GetCommitment().ToHex(), data));
+    CoinDB(pDatabase.get()).RemoveUTXOs({ members[2] });
+    REQUIRE_FALSE(pDatabase->Read("R" + pCarrier->GetCommitment().ToHex(), data));
+
+    //
+    // Records from before the format was versioned can still be read.
+    //
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        pBatch->Write("U" + pCarrier->GetCommitment().ToHex(), Serializer().Append<uint64_t>(5).Append<uint64_t>(7).Append(*pCarrier).vec());
+        pBatch->Commit();
+    }
+
+    utxos_by_commitment = CoinDB(pDatabase.get()).GetUTXOs({ pCarrier->GetCommitment() });
+    const UTXO::CPtr& pLegacy = utxos_by_commitment[pCarrier->GetCommitment()];
+    REQUIRE(pLegacy->GetBlockHeight() == 5);
+    REQUIRE(pLegacy->GetLeafIndex().Get() == 7);
+    REQUIRE(pLegacy->GetOutput() == *pCarrier);
+}
@@ -0,0 +1,164 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/file/ScopedFileRemover.h>
+#include <mw/mmr/Leaf.h>
+#include <mw/mmr/MMR.h>
+#include <mw/mmr/MMRBuilder.h>
+#include <mw/mmr/MMRUtil.h>
+#include <mw/mmr/backends/VectorBackend.h>
+
+#include <test_framework/TestUtil.h>
+
+using namespace mmr;
+
+static std::vector<Leaf> RandomLeaves(const BitSet& leafset)
+{
+    std::vector<Leaf> leaves;
+    for (uint64_t leaf_idx = 0; leaf_idx < leafset.size(); leaf_idx++) {
+        if (leafset.test(leaf_idx)) {
+            leaves.push_back(Leaf::Create(LeafIndex::At(leaf_idx), Random::CSPRNG<20>().vec()));
+        }
+    }
+    return leaves;
+}
+
+static std::vector<mw::Hash> RandomHashes(const uint64_t num_hashes)
+{
+    std::vector<mw::Hash> hashes(num_hashes);
+    for (uint64_t i = 0; i < num_hashes; i++) {
+        hashes[i] = Random::CSPRNG<32>().GetBigInt();
+    }
+    return hashes;
+}
+
+// Builds the MMR in ranges of leaves_per_range leaves, and returns the hashes written to the file.
+static std::vector<mw::Hash> BuildHashes(
+    const BitSet& unspent_leaf_indices,
+    const std::vector<Leaf>& leaves,
+    const std::vector<mw::Hash>& pruned_parent_hashes,
+    const uint64_t leaves_per_range,
+    mw::Hash* pRoot = nullptr)
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir);
+    datadir.CreateDir();
+
+    const BitSet pruned_parent_indices = MMRUtil::CalcPrunedParents(unspent_leaf_indices);
+    MMRBuilder builder(datadir.GetChild("hashes.bin"), unspent_leaf_indices);
+
+    auto leaf_iter = leaves.cbegin();
+    auto hash_iter = pruned_parent_hashes.cbegin();
+    uint64_t pos = 0;
+    for (uint64_t first_leaf = 0; first_leaf < unspent_leaf_indices.size(); first_leaf += leaves_per_range) {
+        const LeafIndex next_leaf_idx = LeafIndex::At(std::min<uint64_t>(first_leaf + leaves_per_range, unspent_leaf_indices.size()));
+
+        std::vector<Leaf> range_leaves;
+        while (leaf_iter != leaves.cend() && leaf_iter->GetLeafIndex() < next_leaf_idx) {
+            range_leaves.push_back(*leaf_iter++);
+        }
+
+        std::vector<mw::Hash> range_hashes;
+        for (; pos < next_leaf_idx.GetPosition(); pos++) {
+            if (pruned_parent_indices.test(pos)) {
+                range_hashes.push_back(*hash_iter++);
+            }
+        }
+
+        builder.Add(next_leaf_idx, range_leaves, range_hashes);
+    }
+
+    builder.Flush();
+    if (pRoot != nullptr) {
+        *pRoot = builder.Root();
+    }
+
+    const std::vector<uint8_t> bytes = File(datadir.GetChild("hashes.bin")).ReadBytes();
+    std::vector<mw::Hash> hashes;
+    for (size_t i = 0; i < bytes.size(); i += mw::Hash::size()) {
+        hashes.push_back(mw::Hash(std::vector<uint8_t>(bytes.begin() + i, bytes.begin() + i + mw::Hash::size())));
+    }
+
+    return hashes;
+}
+
+TEST_CASE("mmr::MMRBuilder")
+{
+    size_t num_leaves = 50;
+    BitSet unspent_leaf_indices(num_leaves);
+    unspent_leaf_indices.set(2);
+    unspent_leaf_indices.set(9);
+    unspent_leaf_indices.set(26);
+    unspent_leaf_indices.set(27);
+    for (size_t i = 30; i < num_leaves; i++) {
+        unspent_leaf_indices.set(i);
+    }
+
+    std::vector<Leaf> leaves = RandomLeaves(unspent_leaf_indices);
+
+    BitSet pruned_parent_indices = MMRUtil::CalcPrunedParents(unspent_leaf_indices);
+    REQUIRE(pruned_parent_indices.str() == "0010100000000101000010000000100000000000000001001000000100000000000000000000000000000000000000000000");
+    std::vector<mw::Hash> pruned_parent_hashes = RandomHashes(pruned_parent_indices.count());
+
+    for (const uint64_t leaves_per_range : { 1, 7, 16, 50 }) {
+        std::vector<mw::Hash> hashes = BuildHashes(unspent_leaf_indices, leaves, pruned_parent_hashes, leaves_per_range);
+        REQUIRE(hashes.size() == 63);
+        REQUIRE(hashes[0] == pruned_parent_hashes[0]);
+        REQUIRE(hashes[61] == leaves[23].GetHash());
+    }
+
+    // Finish these assertions
+}
+
+TEST_CASE("mmr::MMRBuilder - Matches full MMR")
+{
+    for (size_t num_leaves : { 1, 2, 7, 64, 1000, 5000 }) {
+        mmr::MMR mmr(std::make_shared<VectorBackend>());
+        BitSet unspent_leaf_indices(num_leaves);
+        for (size_t i = 0; i < num_leaves; i++) {
+            mmr.Add(Random::CSPRNG<20>().vec());
+            if (Random::CSPRNG<1>()[0] % 3 == 0) {
+                unspent_leaf_indices.set(i);
+            }
+        }
+
+        std::vector<Leaf> leaves;
+        for (size_t i = 0; i < num_leaves; i++) {
+            if (unspent_leaf_indices.test(i)) {
+                leaves.push_back(mmr.GetLeaf(LeafIndex::At(i)));
+            }
+        }
+
+        std::vector<mw::Hash> pruned_parent_hashes;
+        BitSet pruned_parent_indices = MMRUtil::CalcPrunedParents(unspent_leaf_indices);
+        for (size_t pos = 0; pos < pruned_parent_indices.size(); pos++) {
+            if (pruned_parent_indices.test(pos)) {
+                pruned_parent_hashes.push_back(mmr.GetHash(Index::At(pos)));
+            }
+        }
+
+        // The whole MMR at once, and in ranges that don't line up with its subtrees.
+        for (const uint64_t leaves_per_range : { (uint64_t)num_leaves, (uint64_t)3, (uint64_t)1000 }) {
+            mw::Hash root;
+            std::vector<mw::Hash> hashes = BuildHashes(unspent_leaf_indices, leaves, pruned_parent_hashes, leaves_per_range, &root);
+            REQUIRE(root == mmr.Root());
+
+            // Calculated hashes should appear in the full MMR in the same order.
+            size_t hash_idx = 0;
+            for (uint64_t pos = 0; pos < mmr.GetNextLeafIdx().GetPosition() && hash_idx < hashes.size(); pos++) {
+                if (mmr.GetHash(Index::At(pos)) == hashes[hash_idx]) {
+                    ++hash_idx;
+                }
+            }
+
+            REQUIRE(hash_idx == hashes.size());
+        }
+
+        // A missing unspent leaf is caught.
+        if (!leaves.empty()) {
+            std::vector<Leaf> missing_leaf(leaves.begin(), leaves.end() - 1);
+            REQUIRE_THROWS_AS(BuildHashes(unspent_leaf_indices, missing_leaf, pruned_parent_hashes, num_leaves), ValidationException);
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #include <catch.hpp>
 
+#include <mw/crypto/Random.h>
 #include <mw/mmr/MMRUtil.h>
+#include <chrono>
 #include <unordered_set>
 
 using namespace mmr;
@@ -9,6 +11,76 @@ using namespace mmr;
     REQUIRE(iter.Next()); \
     REQUIRE(iter.GetPosition() == expected_pos);
 
+//
+// The original leaf-by-leaf and sibling-by-sibling implementations, used as a reference.
+//
+static BitSet ReferenceCompactBitSet(const uint64_t num_leaves, const BitSet& unspent_leaf_indices)
+{
+    BitSet compactable_node_indices(num_leaves * 2);
+    BitSet prunable_nodes(num_leaves * 2);
+
+    for (uint64_t i = 0; i < num_leaves; i++) {
+        if (unspent_leaf_indices.size() > i && !unspent_leaf_indices.test(i)) {
+            prunable_nodes.set(mmr::LeafIndex::At(i).GetPosition());
+        }
+    }
+
+    mmr::LeafIndex next_leaf = mmr::LeafIndex::At(num_leaves);
+    mmr::Index last_node = mmr::Index::At(next_leaf.GetPosition() - 1);
+    for (uint64_t height = 1; ((2ULL << height) - 2) <= next_leaf.GetPosition(); height++) {
+        SiblingIter iter(height, last_node);
+        while (iter.Next()) {
+            mmr::Index right_child = iter.Get().GetRightChild();
+            mmr::Index left_child = iter.Get().GetLeftChild();
+            if (prunable_nodes.test(right_child.GetPosition()) && prunable_nodes.test(left_child.GetPosition())) {
+                compactable_node_indices.set(right_child.GetPosition());
+                compactable_node_indices.set(left_child.GetPosition());
+                prunable_nodes.set(iter.Get().GetPosition());
+            }
+        }
+    }
+
+    return compactable_node_indices;
+}
+
+static BitSet ReferencePrunedParents(const BitSet& unspent_leaf_indices)
+{
+    BitSet ret(unspent_leaf_indices.size() * 2);
+    for (uint64_t i = 0; i < unspent_leaf_indices.size(); i++) {
+        if (!unspent_leaf_indices.test(i)) {
+            ret.set(mmr::LeafIndex::At(i).GetPosition());
+        }
+    }
+
+    mmr::Index last_node = mmr::LeafIndex::At(unspent_leaf_indices.size()).GetNodeIndex();
+    for (uint64_t height = 1; ((2ULL << height) - 2) <= last_node.GetPosition(); height++) {
+        SiblingIter iter(height, last_node);
+        while (iter.Next()) {
+            mmr::Index right_child = iter.Get().GetRightChild();
+            mmr::Index left_child = iter.Get().GetLeftChild();
+            if (ret.test(right_child.GetPosition()) && ret.test(left_child.GetPosition())) {
+                ret.set(right_child.GetPosition(), false);
+                ret.set(left_child.GetPosition(), false);
+                ret.set(iter.Get().GetPosition());
+            }
+        }
+    }
+
+    return ret;
+}
+
+static BitSet RandomLeafset(const uint64_t num_leaves, const uint8_t percent_unspent)
+{
+    BitSet leafset(num_leaves);
+    for (uint64_t i = 0; i < num_leaves; i++) {
+        if (Random::FastRandom() % 100 < percent_unspent) {
+            leafset.set(i);
+        }
+    }
+
+    return leafset;
+}
+
 TEST_CASE("mmr::SiblingIter")
 {
     // Height 0
@@ -143,4 +215,37 @@ TEST_CASE("mmr::MMRUtil::CalcPrunedParents")
 
     BitSet pruned_parent_hashes = mmr::MMRUtil::CalcPrunedParents(unspent_leaf_indices);
     REQUIRE(pruned_parent_hashes.str() == "0010100000000101000010000000100000000000000001001000000100000000000000000000000000000000000000000000");
+}
+
+TEST_CASE("mmr::MMRUtil - Matches reference implementation")
+{
+    for (size_t i = 0; i < 500; i++) {
+        const uint64_t num_leaves = Random::FastRandom() % 1000;
+        const uint8_t percent_unspent = (uint8_t)(Random::FastRandom() % 101);
+        BitSet unspent_leaf_indices = RandomLeafset(num_leaves, percent_unspent);
+
+        REQUIRE(mmr::MMRUtil::CalcPrunedParents(unspent_leaf_indices).bitset == ReferencePrunedParents(unspent_leaf_indices).bitset);
+
+        // The MMR may have more leaves than the leafset covers.
+        const uint64_t mmr_leaves = num_leaves + (i % 2 == 0 ? 0 : Random::FastRandom() % 100);
+        REQUIRE(mmr::MMRUtil::BuildCompactBitSet(mmr_leaves, unspent_leaf_indices).bitset == ReferenceCompactBitSet(mmr_leaves, unspent_leaf_indices).bitset);
+    }
+}
+
+TEST_CASE("mmr::MMRUtil - 50M leaves", "[.benchmark]")
+{
+    const uint64_t num_leaves = 50'000'000;
+    BitSet unspent_leaf_indices = RandomLeafset(num_leaves, 25);
+
+    auto start = std::chrono::steady_clock::now();
+    BitSet compact_bitset = mmr::MMRUtil::BuildCompactBitSet(num_leaves, unspent_leaf_indices);
+    auto compact_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    BitSet pruned_parents = mmr::MMRUtil::CalcPrunedParents(unspent_leaf_indices);
+    auto pruned_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    WARN("BuildCompactBitSet: " << compact_ms << "ms, CalcPrunedParents: " << pruned_ms << "ms");
+    REQUIRE(compact_bitset.size() == num_leaves * 2);
+    REQUIRE(pruned_parents.size() == num_leaves * 2);
 }
\ No newline at end of file
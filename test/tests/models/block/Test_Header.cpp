@@ -1,5 +1,6 @@
 #include <catch.hpp>
 
+#include <mw/consensus/ChainParams.h>
 #include <mw/models/block/Header.h>
 
 TEST_CASE("Header")
@@ -48,4 +49,38 @@ TEST_CASE("Header")
 
     Deserializer deserializer = header.Serialized();
     REQUIRE(header == mw::Header::Deserialize(deserializer));
+
+    //
+    // Headers at or above the cut-through height have an explicit cut-through hash after the kernel MMR size.
+    //
+    mw::ChainParams::Initialize(mw::ChainParams::GetHRP(), mw::ChainParams::GetPegInMaturity(), height + 1);
+
+    mw::Hash cutThroughHash = mw::Hash::FromHex("006102030405060708090A0B0C0D0E0F1112131415161718191A1B1C1D1E1F20");
+    mw::Header header3(
+        height + 1,
+        mw::Hash(outputRoot),
+        mw::Hash(kernelRoot),
+        mw::Hash(leafsetRoot),
+        BlindingFactor(kernelOffset),
+        BlindingFactor(ownerOffset),
+        outputMMRSize,
+        kernelMMRSize,
+        cutThroughHash
+    );
+    REQUIRE_FALSE(header2 == header3);
+    REQUIRE(*header3.GetCutThroughHash() == cutThroughHash);
+    REQUIRE(header3.Serialized().size() == header2.Serialized().size() + mw::Hash::size());
+
+    Deserializer deserializer3 = header3.Serialized();
+    mw::Header deserialized3 = mw::Header::Deserialize(deserializer3);
+    REQUIRE(header3 == deserialized3);
+    REQUIRE(deserialized3.GetNumKernels() == kernelMMRSize);
+    REQUIRE(*deserialized3.GetCutThroughHash() == cutThroughHash);
+
+    // Headers below it are unchanged.
+    Deserializer deserializer4 = header.Serialized();
+    REQUIRE_FALSE(mw::Header::Deserialize(deserializer4).GetCutThroughHash().has_value());
+    REQUIRE(header.Format() == "56f10c78905687658dff9aadf812498a68d5704932cb59efe95f13552eac73b5");
+
+    mw::ChainParams::Initialize(mw::ChainParams::GetHRP(), mw::ChainParams::GetPegInMaturity());
 }
\ No newline at end of file
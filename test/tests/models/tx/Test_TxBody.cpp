@@ -1,7 +1,12 @@
 #include <catch.hpp>
 
+#include <mw/consensus/Weight.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/ValidationException.h>
 #include <test_framework/TxBuilder.h>
 
+#include <chrono>
+
 TEST_CASE("Tx Body")
 {
     const uint64_t pegInAmount = 123;
@@ -26,4 +31,106 @@ TEST_CASE("Tx Body")
     // Getters
     //
     REQUIRE(txBody.GetTotalFee() == fee);
-}
\ No newline at end of file
+}
+
+// Builds a body with random commitments. Signatures and range proofs are empty, so only the structure is valid.
+static TxBody RandomBody(const size_t num_inputs, const size_t num_outputs, const size_t num_kernels)
+{
+    std::vector<Input> inputs;
+    for (size_t i = 0; i < num_inputs; i++) {
+        inputs.push_back(Input(Commitment(Random::CSPRNG<33>().GetBigInt()), PublicKey(), Signature()));
+    }
+
+    const RangeProof::CPtr pProof = std::make_shared<const RangeProof>();
+    std::vector<Output> outputs;
+    for (size_t i = 0; i < num_outputs; i++) {
+        outputs.push_back(Output(Commitment(Random::CSPRNG<33>().GetBigInt()), Features(), PublicKey(), PublicKey(), 0, 0, BigInt<16>(), PublicKey(), Signature(), pProof));
+    }
+
+    std::vector<Kernel> kernels;
+    for (size_t i = 0; i < num_kernels; i++) {
+        kernels.push_back(Kernel(i, boost::none, boost::none, boost::none, {}, Commitment(Random::CSPRNG<33>().GetBigInt()), Signature()));
+    }
+
+    std::sort(inputs.begin(), inputs.end(), SortByCommitment);
+    std::sort(outputs.begin(), outputs.end(), SortByCommitment);
+    std::sort(kernels.begin(), kernels.end(), KernelSort);
+    return TxBody(std::move(inputs), std::move(outputs), std::move(kernels), {});
+}
+
+TEST_CASE("TxBody::ValidateStructure")
+{
+    TxBody body = RandomBody(10, 10, 10);
+    body.ValidateStructure();
+
+    auto require_error = [](const TxBody& invalid, const std::string& expected) {
+        try {
+            invalid.ValidateStructure();
+            FAIL("Expected ValidationException");
+        } catch (const ValidationException& e) {
+            REQUIRE(e.GetMsg() == "Consensus Error: " + expected);
+        }
+    };
+
+    // Duplicate input
+    {
+        std::vector<Input> inputs = body.GetInputs();
+        inputs[4] = inputs[3];
+        require_error(TxBody(inputs, body.GetOutputs(), body.GetKernels(), {}), "DUPLICATE_COMMITS");
+    }
+
+    // Duplicate output
+    {
+        std::vector<Output> outputs = body.GetOutputs();
+        outputs[9] = outputs[8];
+        require_error(TxBody(body.GetInputs(), outputs, body.GetKernels(), {}), "DUPLICATE_COMMITS");
+    }
+
+    // Unsorted outputs take precedence over duplicate inputs
+    {
+        std::vector<Input> inputs = body.GetInputs();
+        inputs[1] = inputs[0];
+        std::vector<Output> outputs = body.GetOutputs();
+        std::swap(outputs[0], outputs[1]);
+        require_error(TxBody(inputs, outputs, body.GetKernels(), {}), "NOT_SORTED");
+    }
+
+    // Kernels with the same commitment but different fees aren't neighbors in kernel order
+    {
+        std::vector<Kernel> kernels = body.GetKernels();
+        kernels.push_back(Kernel(100, boost::none, boost::none, boost::none, {}, Commitment(kernels[2].GetCommitment()), Signature()));
+        std::sort(kernels.begin(), kernels.end(), KernelSort);
+        require_error(TxBody(body.GetInputs(), body.GetOutputs(), kernels, {}), "DUPLICATE_COMMITS");
+    }
+
+    // Owner sigs must sign the hash of a kernel
+    {
+        std::vector<SignedMessage> owner_sigs{
+            SignedMessage(body.GetKernels()[7].GetHash(), PublicKey(), Signature()),
+            SignedMessage(body.GetKernels()[2].GetHash(), PublicKey(), Signature())
+        };
+        std::sort(owner_sigs.begin(), owner_sigs.end(), SortByHash);
+        TxBody(body.GetInputs(), body.GetOutputs(), body.GetKernels(), owner_sigs).ValidateStructure();
+
+        owner_sigs.push_back(SignedMessage(mw::Hash(Random::CSPRNG<32>().GetBigInt()), PublicKey(), Signature()));
+        std::sort(owner_sigs.begin(), owner_sigs.end(), SortByHash);
+        require_error(TxBody(body.GetInputs(), body.GetOutputs(), body.GetKernels(), owner_sigs), "KERNEL_MISSING");
+    }
+}
+
+TEST_CASE("TxBody::ValidateStructure - max weight", "[.benchmark]")
+{
+    // 1,000 outputs and 1,500 kernels is the maximum block weight. Inputs don't add weight.
+    const size_t num_outputs = libmw::MAX_BLOCK_WEIGHT * 6 / (7 * libmw::OUTPUT_WEIGHT);
+    const size_t num_kernels = (libmw::MAX_BLOCK_WEIGHT - (num_outputs * libmw::OUTPUT_WEIGHT)) / libmw::KERNEL_WEIGHT;
+    TxBody body = RandomBody(5'000, num_outputs, num_kernels);
+
+    const size_t iterations = 100;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        body.ValidateStructure();
+    }
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    WARN("ValidateStructure: " << (total_us / iterations) << "us per body");
+}
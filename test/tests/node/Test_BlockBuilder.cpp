@@ -1,12 +1,21 @@
 #include <catch.hpp>
 
 #include <libmw/libmw.h>
+#include <mw/consensus/Aggregation.h>
+#include <mw/consensus/ChainParams.h>
+#include <mw/consensus/Weight.h>
+#include <mw/exceptions/ValidationException.h>
 #include <mw/file/ScopedFileRemover.h>
+#include <mw/node/BlockBuilder.h>
+#include <mw/node/INode.h>
 #include <mw/node/validation/BlockValidator.h>
 
 #include <test_framework/DBWrapper.h>
 #include <test_framework/Miner.h>
 #include <test_framework/TestUtil.h>
+#include <test_framework/TxBuilder.h>
+
+#include <chrono>
 
 TEST_CASE("BlockBuilder")
 {
@@ -62,4 +71,256 @@ TEST_CASE("BlockBuilder")
 
         libmw::node::Shutdown();
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("BlockBuilder - Remove transactions")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, std::make_shared<TestDBWrapper>());
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+
+    test::Miner miner;
+    test::Tx pegin_tx = test::TxBuilder()
+        .AddPeginKernel(100)
+        .AddOutput(40, EOutputFeatures::PEGGED_IN)
+        .AddOutput(60, EOutputFeatures::PEGGED_IN)
+        .Build();
+    pNode->ConnectBlock(miner.MineBlock(10, { pegin_tx }).GetBlock(), pCachedView);
+
+    test::Tx tx1 = test::TxBuilder().AddInput(pegin_tx.GetOutputs()[0]).AddPlainKernel(5).AddOutput(35).Build();
+    test::Tx tx2 = test::Tx::CreatePegIn(50);
+    test::Tx tx3 = test::TxBuilder().AddInput(pegin_tx.GetOutputs()[1]).AddPlainKernel(10).AddOutput(50).Build();
+    test::Tx double_spend = test::TxBuilder().AddInput(pegin_tx.GetOutputs()[0]).AddPlainKernel(7).AddOutput(33).Build();
+
+    // The spent outputs are peg-ins, so they have to mature first.
+    mw::BlockBuilder builder(10 + mw::ChainParams::GetPegInMaturity(), pCachedView);
+    REQUIRE(builder.AddTransaction(tx1.GetTransaction(), {}));
+    REQUIRE(builder.AddTransaction(tx2.GetTransaction(), { tx2.GetPegInCoin() }));
+    REQUIRE(builder.AddTransaction(tx3.GetTransaction(), {}));
+    REQUIRE_FALSE(builder.AddTransaction(tx1.GetTransaction(), {}));
+    REQUIRE_FALSE(builder.AddTransaction(double_spend.GetTransaction(), {}));
+
+    //
+    // Removing a transaction leaves the same block as if it was never added.
+    //
+    REQUIRE(builder.RemoveTransaction(tx1.GetTransaction()->GetHash()));
+    REQUIRE_FALSE(builder.RemoveTransaction(tx1.GetTransaction()->GetHash()));
+    REQUIRE(builder.GetWeight() == Weight::Calculate(tx2.GetTransaction()->GetBody()) + Weight::Calculate(tx3.GetTransaction()->GetBody()));
+
+    mw::Block::Ptr pBlock = builder.BuildBlock();
+    mw::Transaction::CPtr pExpected = Aggregation::Aggregate({ tx2.GetTransaction(), tx3.GetTransaction() });
+    REQUIRE(pBlock->GetTxBody() == pExpected->GetBody());
+    REQUIRE(pBlock->GetHeader()->GetOwnerOffset() == pExpected->GetOwnerOffset());
+    BlockValidator().Validate(pBlock, pBlock->GetHash(), { tx2.GetPegInCoin() }, {});
+
+    //
+    // The input spent by the removed transaction is available again.
+    //
+    REQUIRE(builder.AddTransaction(double_spend.GetTransaction(), {}));
+    pBlock = builder.BuildBlock();
+    pExpected = Aggregation::Aggregate({ tx2.GetTransaction(), tx3.GetTransaction(), double_spend.GetTransaction() });
+    REQUIRE(pBlock->GetTxBody() == pExpected->GetBody());
+    BlockValidator().Validate(pBlock, pBlock->GetHash(), { tx2.GetPegInCoin() }, {});
+
+    auto pConnectView = std::make_shared<mw::CoinsViewCache>(pCachedView);
+    pNode->ConnectBlock(pBlock, pConnectView);
+}
+
+TEST_CASE("BlockBuilder - Full block template", "[.benchmark]")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, std::make_shared<TestDBWrapper>());
+
+    // Each peg-in has 1 kernel and 1 output, so this fills the block.
+    const size_t num_txs = libmw::MAX_BLOCK_WEIGHT / (libmw::KERNEL_WEIGHT + libmw::OUTPUT_WEIGHT);
+    std::vector<test::Tx> txs;
+    for (size_t i = 0; i < num_txs; i++) {
+        txs.push_back(test::Tx::CreatePegIn(1000 + i));
+    }
+
+    using namespace std::chrono;
+    mw::BlockBuilder builder(1, pNode->GetDBView());
+    auto start = steady_clock::now();
+    for (const test::Tx& tx : txs) {
+        REQUIRE(builder.AddTransaction(tx.GetTransaction(), { tx.GetPegInCoin() }));
+    }
+    const auto add_time = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    // Replace every tenth transaction, as when the mempool changes between templates.
+    start = steady_clock::now();
+    for (size_t i = 0; i < num_txs; i += 10) {
+        REQUIRE(builder.RemoveTransaction(txs[i].GetTransaction()->GetHash()));
+    }
+    for (size_t i = 0; i < num_txs; i += 10) {
+        REQUIRE(builder.AddTransaction(txs[i].GetTransaction(), { txs[i].GetPegInCoin() }));
+    }
+    const auto update_time = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    mw::Block::Ptr pBlock = builder.BuildBlock();
+    const auto build_time = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    REQUIRE(pBlock->GetKernels().size() == num_txs);
+    WARN("Added " << num_txs << " txs in " << add_time << "ms, replaced 10% in " << update_time << "ms, built in " << build_time << "ms");
+}
+
+TEST_CASE("BlockBuilder - Select candidates by fee rate")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, std::make_shared<TestDBWrapper>());
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+
+    test::Miner miner;
+    test::Tx pegin_tx = test::TxBuilder()
+        .AddPeginKernel(400)
+        .AddOutput(100, EOutputFeatures::PEGGED_IN)
+        .AddOutput(100, EOutputFeatures::PEGGED_IN)
+        .AddOutput(100, EOutputFeatures::PEGGED_IN)
+        .AddOutput(100, EOutputFeatures::PEGGED_IN)
+        .Build();
+    pNode->ConnectBlock(miner.MineBlock(10, { pegin_tx }).GetBlock(), pCachedView);
+
+    auto spend = [&pegin_tx](const size_t output_idx, const uint64_t fee) {
+        return test::TxBuilder().AddInput(pegin_tx.GetOutputs()[output_idx]).AddPlainKernel(fee).AddOutput(100 - fee).Build();
+    };
+    test::Tx low_fee = spend(0, 10);
+    test::Tx mid_fee = spend(1, 30);
+    test::Tx high_fee = spend(2, 50);
+
+    // Room for 2 of the transactions.
+    const uint64_t tx_weight = Weight::Calculate(low_fee.GetTransaction()->GetBody());
+    const uint64_t height = 10 + mw::ChainParams::GetPegInMaturity();
+
+    //
+    // Peg-ins can't be spent until they mature.
+    //
+    {
+        mw::BlockBuilder builder(height - 1, pCachedView, 2 * tx_weight);
+        REQUIRE_FALSE(builder.AddCandidate(low_fee.GetTransaction(), {}));
+        REQUIRE_FALSE(builder.AddTransaction(low_fee.GetTransaction(), {}));
+    }
+
+    mw::BlockBuilder builder(height, pCachedView, 2 * tx_weight);
+    REQUIRE(builder.AddCandidate(low_fee.GetTransaction(), {}));
+    REQUIRE(builder.AddCandidate(mid_fee.GetTransaction(), {}));
+    REQUIRE(builder.GetTransactions().size() == 2);
+
+    //
+    // A higher fee rate candidate replaces the lowest one once the block is full.
+    //
+    REQUIRE(builder.AddCandidate(high_fee.GetTransaction(), {}));
+    REQUIRE(builder.GetWeight() == 2 * tx_weight);
+    mw::Block::Ptr pBlock = builder.BuildBlock();
+    REQUIRE(pBlock->GetTxBody() == Aggregation::Aggregate({ mid_fee.GetTransaction(), high_fee.GetTransaction() })->GetBody());
+
+    //
+    // Outputs of other candidates can't be spent in the same block.
+    //
+    test::Tx child = test::TxBuilder().AddInput(high_fee.GetOutputs()[0]).AddPlainKernel(40).AddOutput(10).Build();
+    REQUIRE_FALSE(builder.AddCandidate(child.GetTransaction(), {}));
+
+    //
+    // Removing a selected candidate makes room for the best queued one.
+    //
+    REQUIRE(builder.RemoveTransaction(high_fee.GetTransaction()->GetHash()));
+    pBlock = builder.BuildBlock();
+    REQUIRE(pBlock->GetTxBody() == Aggregation::Aggregate({ low_fee.GetTransaction(), mid_fee.GetTransaction() })->GetBody());
+    BlockValidator().Validate(pBlock, pBlock->GetHash(), {}, {});
+
+    auto pConnectView = std::make_shared<mw::CoinsViewCache>(pCachedView);
+    pNode->ConnectBlock(pBlock, pConnectView);
+}
+
+TEST_CASE("BlockBuilder - Cut-through")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, std::make_shared<TestDBWrapper>());
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+
+    test::Miner miner;
+    test::Tx pegin_tx = test::TxBuilder()
+        .AddPeginKernel(100)
+        .AddOutput(100, EOutputFeatures::PEGGED_IN)
+        .Build();
+    pNode->ConnectBlock(miner.MineBlock(10, { pegin_tx }).GetBlock(), pCachedView);
+
+    test::Tx parent = test::TxBuilder().AddInput(pegin_tx.GetOutputs()[0]).AddPlainKernel(5).AddOutput(95).Build();
+    test::Tx child = test::TxBuilder().AddInput(parent.GetOutputs()[0]).AddPlainKernel(5, true).AddOutput(90).Build();
+    const Commitment& cut_commitment = parent.GetOutputs()[0].GetCommitment();
+    const uint64_t height = 10 + mw::ChainParams::GetPegInMaturity();
+
+    //
+    // Below the cut-through height, blocks can't spend their own outputs.
+    //
+    {
+        mw::BlockBuilder builder(height, pCachedView, libmw::MAX_BLOCK_WEIGHT, true);
+        REQUIRE(builder.AddTransaction(parent.GetTransaction(), {}));
+        REQUIRE_FALSE(builder.AddTransaction(child.GetTransaction(), {}));
+        REQUIRE_FALSE(builder.BuildBlock()->GetHeader()->GetCutThroughHash().has_value());
+    }
+
+    mw::ChainParams::Initialize(mw::ChainParams::GetHRP(), mw::ChainParams::GetPegInMaturity(), height);
+
+    mw::BlockBuilder builder(height, pCachedView, libmw::MAX_BLOCK_WEIGHT, true);
+    REQUIRE_FALSE(builder.AddTransaction(child.GetTransaction(), {}));
+    REQUIRE(builder.AddTransaction(parent.GetTransaction(), {}));
+    REQUIRE(builder.AddTransaction(child.GetTransaction(), {}));
+
+    //
+    // The parent's output and the child's input are cut through.
+    //
+    mw::Block::Ptr pBlock = builder.BuildBlock();
+    REQUIRE(pBlock->GetInputs().size() == 1);
+    REQUIRE(pBlock->GetOutputs().size() == 1);
+    REQUIRE(pBlock->GetTxBody().GetCutThroughs().size() == 1);
+    REQUIRE(*pBlock->GetHeader()->GetCutThroughHash() == pBlock->GetTxBody().GetCutThroughHash());
+
+    Deserializer deserializer = pBlock->Serialized();
+    REQUIRE(mw::Block::Deserialize(deserializer).GetTxBody() == pBlock->GetTxBody());
+
+    // The header commits to the cut-throughs, so a block whose header doesn't is rejected.
+    const mw::Header& header = *pBlock->GetHeader();
+    auto pUncommitted = std::make_shared<mw::Block>(
+        std::make_shared<mw::Header>(
+            header.GetHeight(),
+            mw::Hash(header.GetOutputRoot()),
+            mw::Hash(header.GetKernelRoot()),
+            mw::Hash(header.GetLeafsetRoot()),
+            BlindingFactor(header.GetKernelOffset()),
+            BlindingFactor(header.GetOwnerOffset()),
+            header.GetNumTXOs(),
+            header.GetNumKernels()
+        ),
+        pBlock->GetTxBody()
+    );
+    try {
+        BlockValidator().Validate(pUncommitted, pUncommitted->GetHash(), {}, {});
+        FAIL("Expected ValidationException");
+    } catch (const ValidationException& e) {
+        REQUIRE(e.GetMsg() == "Consensus Error: HASH_MISMATCH");
+    }
+
+    BlockValidator().Validate(pBlock, pBlock->GetHash(), {}, {});
+
+    auto pConnectView = std::make_shared<mw::CoinsViewCache>(pCachedView);
+    pNode->ConnectBlock(pBlock, pConnectView);
+    REQUIRE(pConnectView->GetUTXOs(cut_commitment).empty());
+    REQUIRE(pConnectView->GetUTXOs(child.GetOutputs()[0].GetCommitment()).size() == 1);
+
+    //
+    // Removing the parent removes the child too.
+    //
+    REQUIRE(builder.RemoveTransaction(parent.GetTransaction()->GetHash()));
+    REQUIRE(builder.GetTransactions().empty());
+    REQUIRE(builder.GetWeight() == 0);
+
+    mw::ChainParams::Initialize(mw::ChainParams::GetHRP(), mw::ChainParams::GetPegInMaturity());
+}
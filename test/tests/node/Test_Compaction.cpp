@@ -0,0 +1,118 @@
+#include <catch.hpp>
+
+#include <mw/db/LeafDB.h>
+#include <mw/db/MMRInfoDB.h>
+#include <mw/file/ScopedFileRemover.h>
+#include <mw/mmr/backends/FileBackend.h>
+#include <mw/node/CoinsView.h>
+#include <mw/node/INode.h>
+
+#include <test_framework/models/Tx.h>
+#include <test_framework/DBWrapper.h>
+#include <test_framework/Miner.h>
+#include <test_framework/TestUtil.h>
+#include <test_framework/TxBuilder.h>
+
+TEST_CASE("Compact output PMMR beyond horizon")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, pDatabase, 2);
+    REQUIRE(pNode != nullptr);
+
+    auto get_scheduler = [&pNode]() {
+        return std::dynamic_pointer_cast<mw::CoinsViewDB>(pNode->GetDBView())->GetCompactionScheduler();
+    };
+    mw::CompactionScheduler::Ptr pScheduler = get_scheduler();
+    REQUIRE(pScheduler != nullptr);
+
+    test::Miner miner;
+    auto connect_and_flush = [&](const uint64_t height, const std::vector<test::Tx>& txs) {
+        auto block = miner.MineBlock(height, txs);
+
+        auto pDBView = pNode->GetDBView();
+        auto pCachedView = std::make_shared<mw::CoinsViewCache>(pDBView);
+        pNode->ConnectBlock(block.GetBlock(), pCachedView);
+
+        auto pBatch = pDatabase->CreateBatch();
+        pCachedView->Flush(pBatch);
+        pBatch->Commit();
+
+        REQUIRE(pDBView->GetOutputPMMR()->Root() == block.GetBlock()->GetHeader()->GetOutputRoot());
+
+        // Compactions are calculated in the background, then staged and committed by the next two flushes.
+        pScheduler->Wait();
+        return block;
+    };
+
+    // Block 150: 4 peg-in outputs
+    test::Tx tx1 = test::TxBuilder()
+        .AddPeginKernel(100)
+        .AddOutput(10, EOutputFeatures::PEGGED_IN)
+        .AddOutput(20, EOutputFeatures::PEGGED_IN)
+        .AddOutput(30, EOutputFeatures::PEGGED_IN)
+        .AddOutput(40, EOutputFeatures::PEGGED_IN)
+        .Build();
+    connect_and_flush(150, { tx1 });
+
+    // Block 151: Spend all 4 outputs, leaving their parents prunable.
+    test::TxBuilder tx2_builder;
+    for (const auto& output : tx1.GetOutputs()) {
+        tx2_builder.AddInput(output);
+    }
+    test::Tx tx2 = tx2_builder
+        .AddPlainKernel(10)
+        .AddOutput(90)
+        .Build();
+    auto block151 = connect_and_flush(151, { tx2 });
+
+    // The recorded flushes survive a restart.
+    pNode.reset();
+    pNode = mw::InitializeNode(datadir, "test", block151.GetBlock()->GetHeader(), pDatabase, 2);
+    pScheduler = get_scheduler();
+
+    // Blocks 152 & 153: Block 151 is now beyond the horizon.
+    connect_and_flush(152, { test::Tx::CreatePegIn(5) });
+    connect_and_flush(153, { test::Tx::CreatePegIn(5) });
+
+    // Block 154: The calculated compaction is staged, but the committed files aren't compacted yet.
+    connect_and_flush(154, { test::Tx::CreatePegIn(5) });
+
+    auto pMMRInfo = MMRInfoDB(pDatabase.get(), nullptr).GetLatest();
+    REQUIRE(pMMRInfo);
+    REQUIRE(pMMRInfo->compact_index == 0);
+    REQUIRE(File(mmr::FileBackend::GetPath(datadir, 'O', pMMRInfo->index)).GetSize() == mmr::LeafIndex::At(8).GetPosition() * mw::Hash::size());
+
+    // Block 155: The staged compaction is committed along with the new block.
+    auto block155 = connect_and_flush(155, { test::Tx::CreatePegIn(5) });
+
+    pMMRInfo = MMRInfoDB(pDatabase.get(), nullptr).GetLatest();
+    REQUIRE(pMMRInfo);
+    REQUIRE(pMMRInfo->compact_index == 1);
+    REQUIRE(pMMRInfo->compacted.value() == block151.GetHash());
+    REQUIRE(pMMRInfo->compacted_height.value() == 151);
+
+    // Leaves 0-3 and parents 2 & 5 are removed. Peak 6 must be kept.
+    const uint64_t num_positions = mmr::LeafIndex::At(9).GetPosition();
+    REQUIRE(File(mmr::FileBackend::GetPath(datadir, 'O', pMMRInfo->index)).GetSize() == (num_positions - 6) * mw::Hash::size());
+
+    // The files of the previous flush are untouched.
+    REQUIRE(File(mmr::FileBackend::GetPath(datadir, 'O', pMMRInfo->index - 1)).GetSize() == mmr::LeafIndex::At(8).GetPosition() * mw::Hash::size());
+
+    // The spent leaves were also removed from the database.
+    REQUIRE(LeafDB('O', pDatabase.get()).Get(mmr::LeafIndex::At(0)) == nullptr);
+    REQUIRE(LeafDB('O', pDatabase.get()).Get(mmr::LeafIndex::At(3)) == nullptr);
+    REQUIRE(LeafDB('O', pDatabase.get()).Get(mmr::LeafIndex::At(4)) != nullptr);
+
+    // The compacted PMMR can still be appended to.
+    auto block156 = connect_and_flush(156, { test::Tx::CreatePegIn(5) });
+
+    // The compacted PMMR can be reloaded.
+    pNode.reset();
+    pNode = mw::InitializeNode(datadir, "test", block156.GetBlock()->GetHeader(), pDatabase, 2);
+    REQUIRE(pNode->GetDBView()->GetOutputPMMR()->Root() == block156.GetBlock()->GetHeader()->GetOutputRoot());
+
+    pNode.reset();
+}
@@ -0,0 +1,117 @@
+#include <catch.hpp>
+
+#include <mw/db/LeafDB.h>
+#include <mw/db/LeafPruneDB.h>
+#include <mw/file/ScopedFileRemover.h>
+#include <mw/mmr/LeafSet.h>
+#include <mw/node/LeafPruner.h>
+
+#include <test_framework/DBWrapper.h>
+#include <test_framework/TestUtil.h>
+
+TEST_CASE("mw::LeafPruner")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+
+    std::vector<mmr::Leaf> leaves;
+    for (uint8_t i = 0; i < 10; i++) {
+        leaves.push_back(mmr::Leaf::Create(mmr::LeafIndex::At(i), { i }));
+    }
+    LeafDB('O', pDatabase.get()).Add(leaves);
+
+    // Leafset 1: Leaves 1, 2, and 5 are spent.
+    auto pLeafSet = mmr::LeafSet::Open(datadir, 0);
+    for (const mmr::Leaf& leaf : leaves) {
+        pLeafSet->Add(leaf.GetLeafIndex());
+    }
+    pLeafSet->Remove(mmr::LeafIndex::At(1));
+    pLeafSet->Remove(mmr::LeafIndex::At(2));
+    pLeafSet->Remove(mmr::LeafIndex::At(5));
+    pLeafSet->Flush(1);
+
+    // Leafset 2: Leaves 0 and 7 are also spent.
+    pLeafSet->Remove(mmr::LeafIndex::At(0));
+    pLeafSet->Remove(mmr::LeafIndex::At(7));
+    pLeafSet->Flush(2);
+
+    auto prune = [&pDatabase, &datadir](const boost::optional<uint32_t>& horizon_index) {
+        auto pBatch = pDatabase->CreateBatch();
+        const uint64_t num_pruned = mw::LeafPruner(datadir, 2).Prune(pDatabase.get(), pBatch.get(), horizon_index);
+        pBatch->Commit();
+        return num_pruned;
+    };
+
+    auto get_remaining = [&pDatabase]() {
+        std::vector<uint64_t> remaining;
+        for (uint64_t i = 0; i < 10; i++) {
+            if (LeafDB('O', pDatabase.get()).Get(mmr::LeafIndex::At(i)) != nullptr) {
+                remaining.push_back(i);
+            }
+        }
+
+        return remaining;
+    };
+
+    REQUIRE(prune(boost::none) == 0);
+
+    // A new pruner is used each time, so every pass must resume from the saved watermark.
+    REQUIRE(prune(1) == 2);
+    REQUIRE(get_remaining() == std::vector<uint64_t>{ 0, 3, 4, 5, 6, 7, 8, 9 });
+    REQUIRE(prune(1) == 1);
+    REQUIRE(get_remaining() == std::vector<uint64_t>{ 0, 3, 4, 6, 7, 8, 9 });
+
+    // The pass for leafset 1 is complete.
+    REQUIRE(LeafPruneDB(pDatabase.get()).Get()->base_index == 1);
+    REQUIRE(prune(1) == 0);
+
+    // Only the leaves spent since leafset 1 are pruned for leafset 2.
+    REQUIRE(prune(2) == 2);
+    REQUIRE(prune(2) == 0);
+    REQUIRE(get_remaining() == std::vector<uint64_t>{ 3, 4, 6, 8, 9 });
+    REQUIRE(!LeafPruneDB(pDatabase.get()).Get()->IsPassInProgress());
+
+    // The watermark isn't stored with the leaves, so clearing them keeps it.
+    LeafDB('O', pDatabase.get()).RemoveAll();
+    REQUIRE(LeafPruneDB(pDatabase.get()).Get()->base_index == 2);
+}
+
+TEST_CASE("mw::LeafPruner - Scan limit")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+
+    std::vector<mmr::Leaf> leaves;
+    for (uint8_t i = 0; i < 10; i++) {
+        leaves.push_back(mmr::Leaf::Create(mmr::LeafIndex::At(i), { i }));
+    }
+    LeafDB('O', pDatabase.get()).Add(leaves);
+
+    // Leafset 1: Only leaf 9 is spent.
+    auto pLeafSet = mmr::LeafSet::Open(datadir, 0);
+    for (const mmr::Leaf& leaf : leaves) {
+        pLeafSet->Add(leaf.GetLeafIndex());
+    }
+    pLeafSet->Remove(mmr::LeafIndex::At(9));
+    pLeafSet->Flush(1);
+
+    auto prune = [&pDatabase, &datadir]() {
+        auto pBatch = pDatabase->CreateBatch();
+        const uint64_t num_pruned = mw::LeafPruner(datadir, 100, 4).Prune(pDatabase.get(), pBatch.get(), 1);
+        pBatch->Commit();
+        return num_pruned;
+    };
+
+    // Each flush scans at most 4 leaves, even when none of them are spent.
+    REQUIRE(prune() == 0);
+    REQUIRE(LeafPruneDB(pDatabase.get()).Get()->next_leaf == 4);
+    REQUIRE(prune() == 0);
+    REQUIRE(LeafPruneDB(pDatabase.get()).Get()->next_leaf == 8);
+    REQUIRE(prune() == 1);
+    REQUIRE(!LeafPruneDB(pDatabase.get()).Get()->IsPassInProgress());
+    REQUIRE(LeafDB('O', pDatabase.get()).Get(mmr::LeafIndex::At(9)) == nullptr);
+}
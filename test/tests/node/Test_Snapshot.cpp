@@ -0,0 +1,381 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Random.h>
+#include <mw/db/CoinDB.h>
+#include <mw/db/LeafDB.h>
+#include <mw/db/MMRInfoDB.h>
+#include <mw/db/StateApplyDB.h>
+#include <mw/exceptions/DeserializationException.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/file/ScopedFileRemover.h>
+#include <mw/node/CoinsView.h>
+#include <mw/node/INode.h>
+#include <mw/node/Snapshot.h>
+#include <mw/wallet/Transact.h>
+#include <mw/wallet/Wallet.h>
+
+#include <test_framework/models/Tx.h>
+#include <test_framework/DBWrapper.h>
+#include <test_framework/Miner.h>
+#include <test_framework/TestChain.h>
+#include <test_framework/TestUtil.h>
+#include <test_framework/TxBuilder.h>
+
+TEST_CASE("Apply chunked state snapshot")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    //
+    // Mine a chain that spends some outputs, so the output PMMR has pruned parents.
+    //
+    auto pSourceNode = mw::InitializeNode(datadir.GetChild("source"), "test", nullptr, std::make_shared<TestDBWrapper>());
+    auto pSourceView = pSourceNode->GetDBView();
+
+    test::Miner miner;
+    std::vector<test::MinedBlock> blocks;
+    auto connect_and_flush = [&](const uint64_t height, const std::vector<test::Tx>& txs) {
+        blocks.push_back(miner.MineBlock(height, txs));
+
+        auto pCachedView = std::make_shared<mw::CoinsViewCache>(pSourceView);
+        pSourceNode->ConnectBlock(blocks.back().GetBlock(), pCachedView);
+        auto pBatch = pSourceView->GetDatabase()->CreateBatch();
+        pCachedView->Flush(pBatch);
+        pBatch->Commit();
+    };
+
+    test::Tx tx1 = test::TxBuilder()
+        .AddPeginKernel(100)
+        .AddOutput(10, EOutputFeatures::PEGGED_IN)
+        .AddOutput(20, EOutputFeatures::PEGGED_IN)
+        .AddOutput(30, EOutputFeatures::PEGGED_IN)
+        .AddOutput(40, EOutputFeatures::PEGGED_IN)
+        .Build();
+    connect_and_flush(10, { tx1 });
+
+    test::Tx tx2 = test::TxBuilder()
+        .AddInput(tx1.GetOutputs()[0])
+        .AddInput(tx1.GetOutputs()[1])
+        .AddInput(tx1.GetOutputs()[3])
+        .AddPlainKernel(5)
+        .AddOutput(65)
+        .Build();
+    connect_and_flush(11, { tx2, test::Tx::CreatePegIn(7) });
+    connect_and_flush(12, { test::Tx::CreatePegIn(8) });
+
+    const mw::Header::CPtr& pStateHeader = blocks.back().GetHeader();
+    auto pChain = std::make_shared<TestChain>(blocks);
+
+    auto require_state = [&](const mw::ICoinsView::Ptr& pView) {
+        REQUIRE(pView->GetBestHeader() == pStateHeader);
+        REQUIRE(pView->GetKernelMMR()->Root() == pStateHeader->GetKernelRoot());
+        REQUIRE(pView->GetOutputPMMR()->Root() == pStateHeader->GetOutputRoot());
+        REQUIRE(pView->GetLeafSet()->Root() == pStateHeader->GetLeafsetRoot());
+        REQUIRE(pView->GetUTXOs(tx1.GetOutputs()[2].GetCommitment()).size() == 1);
+        REQUIRE(pView->GetUTXOs(tx1.GetOutputs()[0].GetCommitment()).empty());
+    };
+
+    //
+    // Two leaves per chunk, so block boundaries and pruned parents fall in the middle of chunks.
+    //
+    const FilePath snapshot_path = datadir.GetChild("snapshot.dat");
+    mw::StateManifest manifest = mw::Snapshot::Write(pSourceView, snapshot_path, 2);
+    REQUIRE(manifest.header_hash == pStateHeader->GetHash());
+    REQUIRE(manifest.leafset.size() == pStateHeader->GetNumTXOs());
+    REQUIRE(manifest.chunks.size() == 6);
+    REQUIRE(manifest.chunks[0].type == mw::EStateChunkType::KERNELS);
+    REQUIRE(manifest.chunks[5].type == mw::EStateChunkType::OUTPUTS);
+
+    mw::SnapshotFile snapshot = mw::SnapshotFile::Open(snapshot_path);
+    REQUIRE(snapshot.GetManifest().Serialized() == manifest.Serialized());
+
+    {
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+        auto pNode = mw::InitializeNode(datadir.GetChild("from_file"), "test", nullptr, pDatabase);
+        require_state(pNode->ApplyState(pDatabase, pChain, pStateHeader, manifest.leafset, snapshot.Stream()));
+    }
+
+    //
+    // The in-memory state is split into chunks the same way.
+    //
+    auto pState = std::make_shared<const mw::State>(mw::Snapshot::Build(pSourceView));
+    REQUIRE(pState->utxos.size() == pState->leafset.count());
+
+    {
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+        auto pNode = mw::InitializeNode(datadir.GetChild("from_state"), "test", nullptr, pDatabase);
+        require_state(pNode->ApplyState(pDatabase, pChain, pStateHeader, pState->leafset, mw::Snapshot::Stream(pState, 3)));
+    }
+
+    //
+    // A range proof that's only checked on the thread pool fails the state, and nothing is written.
+    //
+    {
+        mw::State bad_state = mw::Snapshot::Build(pSourceView);
+        REQUIRE(bad_state.utxos.size() >= 2);
+
+        // The leaves only commit to the output IDs, so swapping in another output's proof keeps the roots valid.
+        const UTXO::CPtr pUTXO = bad_state.utxos.front();
+        const Output& output = pUTXO->GetOutput();
+        Output bad_output(
+            Commitment(output.GetCommitment()),
+            output.GetFeatures(),
+            PublicKey(output.GetReceiverPubKey()),
+            PublicKey(output.GetKeyExchangePubKey()),
+            output.GetViewTag(),
+            output.GetMaskedValue(),
+            BigInt<16>(output.GetMaskedNonce()),
+            PublicKey(output.GetSenderPubKey()),
+            Signature(output.GetSignature()),
+            bad_state.utxos.back()->GetOutput().GetRangeProof()
+        );
+        bad_state.utxos.front() = std::make_shared<UTXO>(pUTXO->GetBlockHeight(), mmr::LeafIndex(pUTXO->GetLeafIndex()), bad_output);
+
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+        auto pNode = mw::InitializeNode(datadir.GetChild("bad_proof"), "test", nullptr, pDatabase);
+        auto pBadState = std::make_shared<const mw::State>(std::move(bad_state));
+        try {
+            pNode->ApplyState(pDatabase, pChain, pStateHeader, pBadState->leafset, mw::Snapshot::Stream(pBadState, 3));
+            FAIL("Expected ValidationException");
+        } catch (const ValidationException& e) {
+            REQUIRE(e.GetMsg() == "Consensus Error: BULLETPROOF");
+        }
+
+        REQUIRE(MMRInfoDB(pDatabase.get()).GetLatest() == nullptr);
+        REQUIRE(LeafDB('O', pDatabase.get()).Get(pUTXO->GetLeafIndex()) == nullptr);
+        REQUIRE(CoinDB(pDatabase.get()).GetUTXOs({ output.GetCommitment() }).empty());
+    }
+
+    //
+    // A missing chunk is caught once the reader runs out.
+    //
+    {
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+        auto pNode = mw::InitializeNode(datadir.GetChild("missing_chunk"), "test", nullptr, pDatabase);
+
+        mw::StateChunkReader read_chunk = snapshot.Stream();
+        auto pNumRead = std::make_shared<size_t>(0);
+        const size_t num_chunks = manifest.chunks.size();
+        mw::StateChunkReader skip_last = [read_chunk, pNumRead, num_chunks](mw::StateChunk& chunk) {
+            return ++(*pNumRead) < num_chunks && read_chunk(chunk);
+        };
+        REQUIRE_THROWS_AS(pNode->ApplyState(pDatabase, pChain, pStateHeader, manifest.leafset, skip_last), ValidationException);
+
+        // The chunks that were committed before the failure were removed again.
+        REQUIRE(MMRInfoDB(pDatabase.get()).GetLatest() == nullptr);
+        REQUIRE(StateApplyDB(pDatabase.get()).Get() == nullptr);
+        REQUIRE(LeafDB('K', pDatabase.get()).Get(mmr::LeafIndex::At(0)) == nullptr);
+        REQUIRE(LeafDB('O', pDatabase.get()).Get(mmr::LeafIndex::At(2)) == nullptr);
+        REQUIRE(CoinDB(pDatabase.get()).GetUTXOs({ tx1.GetOutputs()[2].GetCommitment() }).empty());
+    }
+
+    //
+    // Chunks left behind by an apply that was interrupted are removed when the node starts.
+    //
+    {
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+
+        auto pUTXO = std::make_shared<UTXO>(10, mmr::LeafIndex::At(2), tx1.GetOutputs()[2].GetOutput());
+        auto pBatch = pDatabase->CreateBatch();
+        LeafDB('K', pDatabase.get(), pBatch.get())
+            .Add({ mmr::Leaf::Create(mmr::LeafIndex::At(0), tx1.GetKernels()[0].Serialized()) });
+        LeafDB('O', pDatabase.get(), pBatch.get())
+            .Add({ mmr::Leaf::Create(pUTXO->GetLeafIndex(), pUTXO->ToOutputId().Serialized()) });
+        CoinDB(pDatabase.get(), pBatch.get()).AddUTXOs({ pUTXO });
+        StateApplyDB(pDatabase.get(), pBatch.get()).Save(mw::StateApplyProgress{ 0, 1, 4 });
+        pBatch->Commit();
+
+        auto pNode = mw::InitializeNode(datadir.GetChild("interrupted"), "test", nullptr, pDatabase);
+
+        REQUIRE(StateApplyDB(pDatabase.get()).Get() == nullptr);
+        REQUIRE(LeafDB('K', pDatabase.get()).Get(mmr::LeafIndex::At(0)) == nullptr);
+        REQUIRE(LeafDB('O', pDatabase.get()).Get(pUTXO->GetLeafIndex()) == nullptr);
+        REQUIRE(CoinDB(pDatabase.get()).GetUTXOs({ pUTXO->GetCommitment() }).empty());
+
+        // The state applies normally afterwards.
+        require_state(pNode->ApplyState(pDatabase, pChain, pStateHeader, manifest.leafset, snapshot.Stream()));
+        REQUIRE(StateApplyDB(pDatabase.get()).Get() == nullptr);
+    }
+
+    //
+    // A corrupted chunk doesn't match the hash in the manifest.
+    //
+    {
+        File snapshot_file(snapshot_path);
+        const size_t last_byte = snapshot_file.GetSize() - 1;
+        std::vector<uint8_t> last = snapshot_file.ReadBytes(last_byte, 1);
+        snapshot_file.WriteBytes({ { last_byte, (uint8_t)(last[0] ^ 0xFF) } });
+    }
+
+    REQUIRE_THROWS_AS(mw::SnapshotFile::Open(snapshot_path).ReadChunk(manifest.chunks.size() - 1), DeserializationException);
+}
+
+TEST_CASE("Apply state snapshot with aggregated proofs")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pSourceNode = mw::InitializeNode(datadir.GetChild("source"), "test", nullptr, std::make_shared<TestDBWrapper>());
+    auto pSourceView = pSourceNode->GetDBView();
+
+    test::Miner miner;
+    std::vector<test::MinedBlock> blocks;
+    auto connect_and_flush = [&](const uint64_t height, const mw::Transaction::CPtr& pTransaction) {
+        blocks.push_back(miner.MineBlock(height, { test::Tx(pTransaction, {}) }));
+
+        auto pCachedView = std::make_shared<mw::CoinsViewCache>(pSourceView);
+        pSourceNode->ConnectBlock(blocks.back().GetBlock(), pCachedView);
+        auto pBatch = pSourceView->GetDatabase()->CreateBatch();
+        pCachedView->Flush(pBatch);
+        pBatch->Commit();
+    };
+
+    //
+    // Pegs in to 4 outputs that share one aggregated proof, then spends the output that carries it.
+    //
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+    std::vector<std::pair<uint64_t, StealthAddress>> recipients;
+    for (uint32_t i = 0; i < 4; i++) {
+        recipients.push_back({ 10 + i, pKeychain->GetStealthAddress(i) });
+    }
+
+    mw::Transaction::CPtr pPegIn = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(50), 4, true);
+    connect_and_flush(10, pPegIn);
+
+    const std::vector<Output>& outputs = pPegIn->GetOutputs();
+    auto carrier_iter = std::find_if(outputs.cbegin(), outputs.cend(), [](const Output& output) { return output.HasRangeProof(); });
+    REQUIRE(carrier_iter != outputs.cend());
+    const Output& carrier = *carrier_iter;
+    REQUIRE(carrier.GetAggregatedCommits().size() == 3);
+
+    std::vector<libmw::Coin> coins = Wallet(pKeychain).ScanOutputs(outputs);
+    auto coin_iter = std::find_if(coins.cbegin(), coins.cend(), [&carrier](const libmw::Coin& coin) {
+        return coin.commitment == carrier.GetCommitment().array();
+    });
+    REQUIRE(coin_iter != coins.cend());
+
+    mw::Transaction::CPtr pSpend = Transact::CreateTx({ *coin_iter }, { { coin_iter->amount - 1, pKeychain->GetStealthAddress(4) } }, {}, boost::none, 1);
+    connect_and_flush(11, pSpend);
+
+    // The members keep the spent carrier's proof.
+    REQUIRE(pSourceView->GetUTXOs(carrier.GetCommitment()).empty());
+    for (const Commitment& member : carrier.GetAggregatedCommits()) {
+        std::vector<UTXO::CPtr> utxos = pSourceView->GetUTXOs(member);
+        REQUIRE(utxos.size() == 1);
+        REQUIRE(utxos.front()->GetProofOutput() != nullptr);
+        REQUIRE(utxos.front()->GetProofOutput()->GetCommitment() == carrier.GetCommitment());
+    }
+
+    const mw::Header::CPtr& pStateHeader = blocks.back().GetHeader();
+    auto pChain = std::make_shared<TestChain>(blocks);
+
+    //
+    // The members' proofs are verified with the stored carrier, and the carrier is kept with them.
+    //
+    {
+        auto pState = std::make_shared<const mw::State>(mw::Snapshot::Build(pSourceView));
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+        auto pNode = mw::InitializeNode(datadir.GetChild("applied"), "test", nullptr, pDatabase);
+        auto pView = pNode->ApplyState(pDatabase, pChain, pStateHeader, pState->leafset, mw::Snapshot::Stream(pState, 2));
+        REQUIRE(pView->GetOutputPMMR()->Root() == pStateHeader->GetOutputRoot());
+        for (const Commitment& member : carrier.GetAggregatedCommits()) {
+            std::vector<UTXO::CPtr> utxos = pView->GetUTXOs(member);
+            REQUIRE(utxos.size() == 1);
+            REQUIRE(utxos.front()->GetProofOutput() != nullptr);
+            REQUIRE(utxos.front()->GetProofOutput()->GetCommitment() == carrier.GetCommitment());
+        }
+    }
+
+    //
+    // A member stored with a valid aggregated proof that doesn't cover it fails the state.
+    //
+    {
+        mw::Transaction::CPtr pOther = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(50), 4, true);
+        auto other_iter = std::find_if(
+            pOther->GetOutputs().cbegin(), pOther->GetOutputs().cend(),
+            [](const Output& output) { return output.HasRangeProof(); }
+        );
+        REQUIRE(other_iter != pOther->GetOutputs().cend());
+
+        mw::State bad_state = mw::Snapshot::Build(pSourceView);
+        auto member_iter = std::find_if(
+            bad_state.utxos.begin(), bad_state.utxos.end(),
+            [](const UTXO::CPtr& pUTXO) { return pUTXO->GetProofOutput() != nullptr; }
+        );
+        REQUIRE(member_iter != bad_state.utxos.end());
+        const UTXO::CPtr pMember = *member_iter;
+        *member_iter = std::make_shared<UTXO>(
+            pMember->GetBlockHeight(),
+            mmr::LeafIndex(pMember->GetLeafIndex()),
+            pMember->GetOutput(),
+            std::make_shared<const Output>(*other_iter)
+        );
+
+        auto pDatabase = std::make_shared<TestDBWrapper>();
+        auto pNode = mw::InitializeNode(datadir.GetChild("uncovered"), "test", nullptr, pDatabase);
+        auto pBadState = std::make_shared<const mw::State>(std::move(bad_state));
+        try {
+            pNode->ApplyState(pDatabase, pChain, pStateHeader, pBadState->leafset, mw::Snapshot::Stream(pBadState, 2));
+            FAIL("Expected ValidationException");
+        } catch (const ValidationException& e) {
+            REQUIRE(e.GetMsg() == "Consensus Error: BULLETPROOF");
+        }
+
+        REQUIRE(MMRInfoDB(pDatabase.get()).GetLatest() == nullptr);
+    }
+}
+
+TEST_CASE("Snapshot sizes are checked before reading")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+    datadir.CreateDir();
+
+    //
+    // A chunk can't claim more entries than it has leaves, or more leaves than a chunk may have.
+    //
+    auto serialize_chunk = [](const uint64_t num_leaves, const uint32_t num_utxos) {
+        return Serializer()
+            .Append<uint8_t>((uint8_t)mw::EStateChunkType::OUTPUTS)
+            .Append<uint64_t>(0)
+            .Append<uint64_t>(num_leaves)
+            .Append<uint32_t>(0)
+            .Append<uint32_t>(num_utxos)
+            .vec();
+    };
+
+    REQUIRE_THROWS_AS(Deserializer(serialize_chunk(2, 3)).Read<mw::StateChunk>(), DeserializationException);
+    REQUIRE_THROWS_AS(Deserializer(serialize_chunk(2, 0xFFFFFFFF)).Read<mw::StateChunk>(), DeserializationException);
+    REQUIRE_THROWS_AS(Deserializer(serialize_chunk(mw::StateChunk::MAX_LEAVES + 1, 0)).Read<mw::StateChunk>(), DeserializationException);
+
+    //
+    // A manifest can't point past the end of the file, or at a chunk larger than the maximum.
+    //
+    mw::StateChunk chunk(mw::EStateChunkType::OUTPUTS, 0, 0, {}, {}, {});
+    const std::vector<uint8_t> serialized_chunk = chunk.Serialized();
+
+    auto write_snapshot = [&datadir, &serialized_chunk](const std::string& name, const uint64_t offset, const uint64_t size) {
+        mw::StateManifest manifest(0, mw::Hash(), BitSet(), {
+            mw::StateChunkInfo(mw::EStateChunkType::OUTPUTS, 0, 0, offset, size, Hashed(serialized_chunk))
+        });
+        const std::vector<uint8_t> serialized_manifest = manifest.Serialized();
+
+        File file(datadir.GetChild(name));
+        file.Create();
+        file.Write(Serializer().Append<uint64_t>(serialized_manifest.size()).vec());
+        file.Write(serialized_manifest);
+        file.Write(serialized_chunk);
+        return mw::SnapshotFile::Open(file.GetPath());
+    };
+
+    REQUIRE(write_snapshot("valid.dat", 0, serialized_chunk.size()).ReadChunk(0).utxos.empty());
+    REQUIRE_THROWS_AS(write_snapshot("past_end.dat", 0, serialized_chunk.size() + 1).ReadChunk(0), DeserializationException);
+    REQUIRE_THROWS_AS(write_snapshot("bad_offset.dat", 0xFFFFFFFFFFFFFFFF, serialized_chunk.size()).ReadChunk(0), DeserializationException);
+    REQUIRE_THROWS_AS(write_snapshot("too_large.dat", 0, mw::StateChunk::MAX_SERIALIZED_SIZE + 1).ReadChunk(0), DeserializationException);
+
+    // The size of the manifest is checked against the file too.
+    File truncated(datadir.GetChild("truncated.dat"));
+    truncated.Create();
+    truncated.Write(Serializer().Append<uint64_t>(0xFFFFFFFFFFFFFFFF).vec());
+    REQUIRE_THROWS_AS(mw::SnapshotFile::Open(truncated.GetPath()), DeserializationException);
+}
@@ -1,9 +1,11 @@
 #include <catch.hpp>
 
+#include <mw/exceptions/ValidationException.h>
 #include <mw/node/INode.h>
 #include <mw/file/ScopedFileRemover.h>
 #include <test_framework/Miner.h>
 #include <test_framework/TestNode.h>
+#include <test_framework/TxBuilder.h>
 
 TEST_CASE("BlockValidator")
 {
@@ -29,5 +31,29 @@ TEST_CASE("BlockValidator")
         REQUIRE_FALSE(block_10.GetBlock()->WasValidated());
         pNode->ValidateBlock(block_10.GetBlock(), block_10.GetHash(), pegInCoins, pegOutCoins);
         REQUIRE(block_10.GetBlock()->WasValidated());
+
+        // Validate in the background while block 10 is connected.
+        std::vector<test::Tx> block_11_txs{
+            test::Tx::CreatePegIn(1'000'000),
+            test::TxBuilder()
+                .AddInput(block_10_txs[0].GetOutputs()[0])
+                .AddPlainKernel(1'000)
+                .AddOutput(2'000'000)
+                .AddOutput(2'999'000)
+                .Build()
+        };
+        test::MinedBlock block_11 = miner.MineBlock(11, block_11_txs);
+        std::vector<PegInCoin> block_11_pegins = block_11.GetBlock()->GetPegIns();
+
+        std::future<void> validated = pNode->ValidateBlockAsync(block_11.GetBlock(), block_11.GetHash(), block_11_pegins, {});
+        pNode->ConnectBlock(block_10.GetBlock(), std::make_shared<mw::CoinsViewCache>(pNode->GetDBView()));
+        validated.get();
+        REQUIRE(block_11.GetBlock()->WasValidated());
+
+        // A mismatched hash or peg-in fails before the signatures are checked.
+        test::MinedBlock block_12 = miner.MineBlock(12, { test::Tx::CreatePegIn(500) });
+        REQUIRE_THROWS_AS(pNode->ValidateBlockAsync(block_12.GetBlock(), block_11.GetHash(), {}, {}).get(), ValidationException);
+        REQUIRE_THROWS_AS(pNode->ValidateBlockAsync(block_12.GetBlock(), block_12.GetHash(), {}, {}).get(), ValidationException);
+        REQUIRE_FALSE(block_12.GetBlock()->WasValidated());
     }
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include <catch.hpp>
 
+#include <mw/db/MMRInfoDB.h>
+#include <mw/exceptions/ValidationException.h>
 #include <mw/file/ScopedFileRemover.h>
 #include <mw/node/CoinsView.h>
 #include <mw/node/INode.h>
+#include <mw/node/validation/StateValidator.h>
 
 #include <test_framework/models/Tx.h>
 #include <test_framework/DBWrapper.h>
@@ -57,4 +60,71 @@ TEST_CASE("ValidateState")
 
         pNode.reset();
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("State sums are updated as blocks are connected and disconnected")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, pDatabase);
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+
+    auto require_sums = [](const mw::ICoinsView::Ptr& pView) {
+        REQUIRE(pView->GetStateSums().has_value());
+        REQUIRE(pView->GetStateSums()->Serialized() == StateValidator().Validate(*pView).Serialized());
+    };
+
+    test::Miner miner;
+    test::Tx tx1 = test::TxBuilder()
+        .AddPeginKernel(50)
+        .AddOutput(50, EOutputFeatures::PEGGED_IN)
+        .Build();
+    auto block1 = miner.MineBlock(150, { tx1 });
+    pNode->ConnectBlock(block1.GetBlock(), pCachedView);
+    require_sums(pCachedView);
+
+    // Spends every UTXO, so the UTXO sum is zero.
+    test::Tx tx2 = test::TxBuilder()
+        .AddInput(50, EOutputFeatures::PEGGED_IN, tx1.GetOutputs().front().GetBlind())
+        .AddPegoutKernel(50, 0)
+        .Build();
+    auto block2 = miner.MineBlock(151, { tx2 });
+    mw::BlockUndo::CPtr undoBlock2 = pNode->ConnectBlock(block2.GetBlock(), pCachedView);
+    REQUIRE(pCachedView->GetStateSums()->utxo_sum == Commitment{});
+    REQUIRE(pCachedView->GetStateSums()->total_mw_supply == 0);
+
+    pNode->DisconnectBlock(undoBlock2, pCachedView);
+    require_sums(pCachedView);
+
+    test::Tx tx3 = test::Tx::CreatePegIn(30);
+    miner.Rewind(1);
+    auto block3 = miner.MineBlock(151, { tx3 });
+    pNode->ConnectBlock(block3.GetBlock(), pCachedView);
+    require_sums(pCachedView);
+
+    auto pBatch = pDatabase->CreateBatch();
+    pCachedView->Flush(pBatch);
+    pBatch->Commit();
+    require_sums(pNode->GetDBView());
+    pNode.reset();
+    pCachedView.reset();
+
+    // The saved sums are checked against the header when the node is loaded.
+    pNode = mw::InitializeNode(datadir, "test", block3.GetHeader(), pDatabase);
+    REQUIRE(pNode->GetDBView()->GetStateSums()->Serialized() == StateValidator().Validate(*pNode->GetDBView()).Serialized());
+    pNode.reset();
+
+    REQUIRE_THROWS_AS(mw::InitializeNode(datadir, "test", block1.GetHeader(), pDatabase), ValidationException);
+
+    // The saved sums are only trusted for the header they were saved with. Sums saved for another header
+    // are recalculated, so these ones, which would fail the check, aren't used.
+    MMRInfo mmr_info = *MMRInfoDB(pDatabase.get()).GetLatest();
+    mmr_info.pruned = block1.GetHeader()->GetHash();
+    mmr_info.sums = mw::StateSums{};
+    MMRInfoDB(pDatabase.get()).Save(mmr_info);
+
+    pNode = mw::InitializeNode(datadir, "test", block3.GetHeader(), pDatabase);
+    REQUIRE(pNode->GetDBView()->GetStateSums()->Serialized() == StateValidator().Validate(*pNode->GetDBView()).Serialized());
+}
@@ -0,0 +1,192 @@
+#include <catch.hpp>
+
+#include <libmw/libmw.h>
+#include <mw/consensus/ChainParams.h>
+#include <mw/crypto/Hasher.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/file/ScopedFileRemover.h>
+#include <mw/node/CoinsView.h>
+#include <mw/node/INode.h>
+#include <mw/node/validation/TxAcceptor.h>
+
+#include <test_framework/DBWrapper.h>
+#include <test_framework/Miner.h>
+#include <test_framework/TestUtil.h>
+#include <test_framework/TxBuilder.h>
+
+#include <chrono>
+
+TEST_CASE("TxAcceptor")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir);
+
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, pDatabase);
+    REQUIRE(pNode != nullptr);
+
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+    auto view = libmw::CoinsViewRef{ pCachedView };
+
+    test::Miner miner;
+    uint64_t height = 100;
+
+    // Mine a pegin tx with two outputs
+    test::Tx tx1 = test::TxBuilder()
+        .AddPeginKernel(3000)
+        .AddOutput(1000, EOutputFeatures::PEGGED_IN)
+        .AddOutput(2000, EOutputFeatures::PEGGED_IN)
+        .Build();
+    auto block = miner.MineBlock(height, { tx1 });
+    pNode->ValidateBlock(block.GetBlock(), block.GetHash(), block.GetBlock()->GetPegIns(), {});
+    pNode->ConnectBlock(block.GetBlock(), pCachedView);
+    height += mw::ChainParams::GetPegInMaturity();
+
+    const test::TxOutput& output1 = tx1.GetOutputs()[0];
+    const test::TxOutput& output2 = tx1.GetOutputs()[1];
+
+    //
+    // Many inputs are looked up at once, including ones that are repeated or missing.
+    //
+    test::Tx unknown = test::Tx::CreatePegIn(1000);
+    auto utxos = pCachedView->LookupUTXOs({ output1.GetCommitment(), unknown.GetOutputs().front().GetCommitment(), output1.GetCommitment() });
+    REQUIRE(utxos.size() == 1);
+    REQUIRE(utxos[output1.GetCommitment()].size() == 1);
+    REQUIRE(utxos[output1.GetCommitment()].front()->GetOutput() == output1.GetOutput());
+
+    //
+    // Valid, immature, missing and badly signed transactions are validated together.
+    //
+    test::Tx spend1 = test::TxBuilder().AddInput(output1).AddPlainKernel(0).AddOutput(1000).Build();
+    test::Tx spend2 = test::TxBuilder().AddInput(output2).AddPlainKernel(0).AddOutput(2000).Build();
+    test::Tx spend_unknown = test::TxBuilder().AddInput(unknown.GetOutputs().front()).AddPlainKernel(0).AddOutput(1000).Build();
+
+    // Replaces the owner offset, so the owner sum no longer matches.
+    test::Tx bad_offset_tx = test::TxBuilder().AddInput(output2).AddPlainKernel(0).AddOutput(2000).Build();
+    auto pBadOffset = std::make_shared<mw::Transaction>(
+        bad_offset_tx.GetTransaction()->GetKernelOffset(),
+        BlindingFactor(Hashed({ 0x01 })),
+        bad_offset_tx.GetTransaction()->GetBody()
+    );
+
+    // Replaces an output's sender signature, so only the batched signature verification catches it.
+    test::Tx bad_sig_tx = test::TxBuilder().AddInput(output1).AddPlainKernel(0).AddOutput(1000).Build();
+    const TxBody& bad_sig_body = bad_sig_tx.GetTransaction()->GetBody();
+    const Output& output = bad_sig_body.GetOutputs().front();
+    std::vector<Output> bad_outputs{ Output(
+        Commitment(output.GetCommitment()),
+        output.GetFeatures(),
+        PublicKey(output.GetReceiverPubKey()),
+        PublicKey(output.GetKeyExchangePubKey()),
+        output.GetViewTag(),
+        output.GetMaskedValue(),
+        BigInt<16>(output.GetMaskedNonce()),
+        PublicKey(output.GetSenderPubKey()),
+        Signature(spend2.GetOutputs().front().GetOutput().GetSignature()),
+        output.GetRangeProof()
+    ) };
+    auto pBadSig = std::make_shared<mw::Transaction>(
+        bad_sig_tx.GetTransaction()->GetKernelOffset(),
+        bad_sig_tx.GetTransaction()->GetOwnerOffset(),
+        TxBody(bad_sig_body.GetInputs(), bad_outputs, bad_sig_body.GetKernels(), bad_sig_body.GetOwnerSigs())
+    );
+
+    std::future<bool> spend1_valid = libmw::node::SubmitTransaction(view, libmw::TxRef{ spend1.GetTransaction() }, height);
+    std::future<bool> spend2_immature = libmw::node::SubmitTransaction(view, libmw::TxRef{ spend2.GetTransaction() }, height - 1);
+    std::future<bool> spend_unknown_invalid = libmw::node::SubmitTransaction(view, libmw::TxRef{ spend_unknown.GetTransaction() }, height);
+    std::future<bool> bad_offset_invalid = libmw::node::SubmitTransaction(view, libmw::TxRef{ pBadOffset }, height);
+    std::future<bool> bad_sig_invalid = libmw::node::SubmitTransaction(view, libmw::TxRef{ pBadSig }, height);
+
+    std::promise<bool> spend2_promise;
+    REQUIRE(libmw::node::SubmitTransaction(view, libmw::TxRef{ spend2.GetTransaction() }, height, [&spend2_promise](const libmw::TxRef&, bool valid) {
+        spend2_promise.set_value(valid);
+    }));
+
+    REQUIRE(spend1_valid.get());
+    REQUIRE_FALSE(spend2_immature.get());
+    REQUIRE_FALSE(spend_unknown_invalid.get());
+    REQUIRE_FALSE(bad_offset_invalid.get());
+    REQUIRE_FALSE(bad_sig_invalid.get());
+    REQUIRE(spend2_promise.get_future().get());
+
+    // The synchronous checks agree.
+    REQUIRE(libmw::node::CheckTransaction(libmw::TxRef{ spend1.GetTransaction() }));
+    REQUIRE_FALSE(libmw::node::CheckTransaction(libmw::TxRef{ pBadOffset }));
+    REQUIRE_FALSE(libmw::node::CheckTransaction(libmw::TxRef{ pBadSig }));
+    REQUIRE_FALSE(libmw::node::CheckTxInputs(view, libmw::TxRef{ spend2.GetTransaction() }, height - 1));
+
+    //
+    // The errors match the checks that failed.
+    //
+    {
+        TxAcceptor acceptor(TxAcceptor::Options{}, VerificationService::Get());
+        auto require_error = [&](const mw::Transaction::CPtr& pTransaction, const uint64_t spend_height, const std::string& expected) {
+            try {
+                acceptor.Submit(pCachedView, pTransaction, spend_height).get();
+                FAIL("Expected ValidationException");
+            } catch (const ValidationException& e) {
+                REQUIRE(e.GetMsg() == "Consensus Error: " + expected);
+            }
+        };
+
+        require_error(spend2.GetTransaction(), height - 1, "PEGIN_MATURITY");
+        require_error(spend_unknown.GetTransaction(), height, "UTXO_MISSING");
+        require_error(pBadSig, height, "INVALID_SIG");
+        REQUIRE_NOTHROW(acceptor.Submit(pCachedView, spend2.GetTransaction(), height).get());
+    }
+
+    //
+    // The inputs are looked up when the transaction is submitted, so the view can change before it's validated.
+    //
+    {
+        TxAcceptor acceptor(TxAcceptor::Options{}, VerificationService::Get());
+        std::future<void> spend1_result = acceptor.Submit(pCachedView, spend1.GetTransaction(), height);
+
+        auto spend_block = miner.MineBlock(height, { spend1 });
+        pNode->ConnectBlock(spend_block.GetBlock(), pCachedView);
+        REQUIRE(pCachedView->GetUTXOs(output1.GetCommitment()).empty());
+
+        REQUIRE_NOTHROW(spend1_result.get());
+    }
+
+    pNode.reset();
+}
+
+TEST_CASE("TxAcceptor - 500 transactions", "[.benchmark]")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir);
+
+    auto pDatabase = std::make_shared<TestDBWrapper>();
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, pDatabase);
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+
+    // Transactions without inputs, so every one is independent of the view.
+    // Each is built twice, since the signature and range proof caches would otherwise skip the second run.
+    std::vector<mw::Transaction::CPtr> sync_txs;
+    std::vector<mw::Transaction::CPtr> async_txs;
+    for (size_t i = 0; i < 500; i++) {
+        sync_txs.push_back(test::Tx::CreatePegIn(1000 + i).GetTransaction());
+        async_txs.push_back(test::Tx::CreatePegIn(1000 + i).GetTransaction());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& pTransaction : sync_txs) {
+        REQUIRE(libmw::node::CheckTransaction(libmw::TxRef{ pTransaction }));
+        REQUIRE(libmw::node::CheckTxInputs(libmw::CoinsViewRef{ pCachedView }, libmw::TxRef{ pTransaction }, 100));
+    }
+    const double sync_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::future<void>> futures;
+    for (const auto& pTransaction : async_txs) {
+        futures.push_back(TxAcceptor::Get().Submit(pCachedView, pTransaction, 100));
+    }
+
+    for (std::future<void>& future : futures) {
+        future.get();
+    }
+    const double async_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WARN("One at a time: " << (uint64_t)(sync_txs.size() / sync_secs) << " txs/s, submitted: " << (uint64_t)(async_txs.size() / async_secs) << " txs/s");
+}
@@ -0,0 +1,174 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Hasher.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/node/validation/VerificationService.h>
+#include <test_framework/TxBuilder.h>
+
+#include <atomic>
+#include <thread>
+
+static std::vector<test::Tx> BuildTxs(const size_t num_txs)
+{
+    std::vector<test::Tx> txs;
+    for (size_t i = 0; i < num_txs; i++) {
+        txs.push_back(test::Tx::CreatePegIn(1'000 + i));
+    }
+
+    return txs;
+}
+
+static std::string GetError(std::future<void>& future)
+{
+    try {
+        future.get();
+    } catch (const ValidationException& e) {
+        return e.GetMsg();
+    }
+
+    return "";
+}
+
+TEST_CASE("VerificationService")
+{
+    // A long window, so every job submitted below lands in the same batch.
+    VerificationService::Options options;
+    options.batch_window = std::chrono::milliseconds(50);
+    VerificationService service(options);
+
+    std::vector<test::Tx> txs = BuildTxs(8);
+
+    //
+    // Jobs from several threads complete their own futures.
+    //
+    {
+        std::vector<std::future<void>> futures(txs.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < txs.size(); i++) {
+            threads.emplace_back([&, i]() {
+                const TxBody& body = txs[i].GetTransaction()->GetBody();
+                futures[i] = service.Submit(body.BuildSignedMessages(), body.BuildProofData());
+            });
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (std::future<void>& future : futures) {
+            REQUIRE_NOTHROW(future.get());
+        }
+    }
+
+    //
+    // Invalid jobs only fail their own futures, with the error that matches what's wrong with them.
+    //
+    {
+        test::Tx tx1 = test::Tx::CreatePegIn(10);
+        std::vector<SignedMessage> bad_sigs = tx1.GetTransaction()->GetBody().BuildSignedMessages();
+        bad_sigs.back() = SignedMessage(Hashed({ 0x01 }), bad_sigs.back().GetPublicKey(), bad_sigs.back().GetSignature());
+
+        test::Tx tx2 = test::TxBuilder().AddPeginKernel(30).AddOutput(10, EOutputFeatures::PEGGED_IN).AddOutput(20, EOutputFeatures::PEGGED_IN).Build();
+        std::vector<ProofData> bad_proofs = tx2.GetTransaction()->GetBody().BuildProofData();
+        REQUIRE(bad_proofs.size() == 2);
+        std::swap(bad_proofs[0].commitment, bad_proofs[1].commitment);
+
+        std::vector<test::Tx> good_txs = BuildTxs(4);
+        std::vector<std::future<void>> good_futures;
+        for (size_t i = 0; i < 2; i++) {
+            const TxBody& body = good_txs[i].GetTransaction()->GetBody();
+            good_futures.push_back(service.Submit(body.BuildSignedMessages(), body.BuildProofData()));
+        }
+
+        std::future<void> bad_sig_future = service.Submit(std::move(bad_sigs), tx1.GetTransaction()->GetBody().BuildProofData());
+        std::future<void> bad_proof_future = service.Submit(tx2.GetTransaction()->GetBody().BuildSignedMessages(), std::move(bad_proofs));
+
+        for (size_t i = 2; i < good_txs.size(); i++) {
+            const TxBody& body = good_txs[i].GetTransaction()->GetBody();
+            good_futures.push_back(service.Submit(body.BuildSignedMessages(), body.BuildProofData()));
+        }
+
+        REQUIRE(GetError(bad_sig_future) == "Consensus Error: INVALID_SIG");
+        REQUIRE(GetError(bad_proof_future) == "Consensus Error: BULLETPROOF");
+        for (std::future<void>& future : good_futures) {
+            REQUIRE_NOTHROW(future.get());
+        }
+    }
+
+    //
+    // Empty jobs complete right away.
+    //
+    REQUIRE_NOTHROW(service.Submit({}, {}).get());
+}
+
+TEST_CASE("VerificationService - Verify")
+{
+    // A window far longer than the test, so anything that waits it out is caught.
+    VerificationService::Options options;
+    options.batch_window = std::chrono::seconds(10);
+    VerificationService service(options);
+
+    std::vector<test::Tx> txs = BuildTxs(2);
+    const auto start = std::chrono::steady_clock::now();
+
+    //
+    // With nothing queued, the job is verified on the calling thread.
+    //
+    {
+        const TxBody& body = txs[0].GetTransaction()->GetBody();
+        REQUIRE_NOTHROW(service.Verify(body.BuildSignedMessages(), body.BuildProofData()));
+
+        std::vector<SignedMessage> bad_sigs = body.BuildSignedMessages();
+        bad_sigs.back() = SignedMessage(Hashed({ 0x01 }), bad_sigs.back().GetPublicKey(), bad_sigs.back().GetSignature());
+        REQUIRE_THROWS_AS(service.Verify(std::move(bad_sigs), body.BuildProofData()), ValidationException);
+    }
+
+    //
+    // Otherwise it joins the waiting jobs, which are dispatched without waiting out their window.
+    //
+    {
+        std::future<void> waiting = service.Submit(txs[0].GetTransaction()->GetBody().BuildSignedMessages(), txs[0].GetTransaction()->GetBody().BuildProofData());
+
+        const TxBody& body = txs[1].GetTransaction()->GetBody();
+        REQUIRE_NOTHROW(service.Verify(body.BuildSignedMessages(), body.BuildProofData()));
+        REQUIRE(waiting.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        REQUIRE_NOTHROW(waiting.get());
+    }
+
+    REQUIRE(std::chrono::steady_clock::now() - start < options.batch_window);
+}
+
+TEST_CASE("VerificationService - Backpressure")
+{
+    std::vector<test::Tx> txs = BuildTxs(3);
+    const size_t items_per_tx = txs[0].GetTransaction()->GetBody().BuildSignedMessages().size()
+        + txs[0].GetTransaction()->GetBody().BuildProofData().size();
+
+    // Room for two of the transactions. The window is long enough that nothing is dispatched during the test.
+    VerificationService::Options options;
+    options.max_queued_items = 2 * items_per_tx;
+    options.batch_window = std::chrono::seconds(10);
+    auto pService = std::make_unique<VerificationService>(options);
+
+    std::atomic<size_t> num_valid(0);
+    auto callback = [&num_valid](const std::exception_ptr& error) {
+        if (!error) {
+            num_valid++;
+        }
+    };
+
+    for (size_t i = 0; i < 2; i++) {
+        const TxBody& body = txs[i].GetTransaction()->GetBody();
+        REQUIRE(pService->TrySubmit(body.BuildSignedMessages(), body.BuildProofData(), callback));
+    }
+
+    REQUIRE(pService->GetNumQueued() == 2 * items_per_tx);
+
+    const TxBody& body = txs[2].GetTransaction()->GetBody();
+    REQUIRE_FALSE(pService->TrySubmit(body.BuildSignedMessages(), body.BuildProofData(), callback));
+    REQUIRE(pService->GetNumQueued() == 2 * items_per_tx);
+
+    // Queued jobs are still verified when the service is destroyed.
+    pService.reset();
+    REQUIRE(num_valid == 2);
+}
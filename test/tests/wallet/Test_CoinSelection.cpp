@@ -0,0 +1,164 @@
+#include <catch.hpp>
+
+#include <mw/consensus/Weight.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/InsufficientFundsException.h>
+#include <mw/wallet/CoinSelection.h>
+#include <mw/wallet/Transact.h>
+#include <mw/wallet/Wallet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+static libmw::Coin MakeCoin(const uint64_t amount)
+{
+    libmw::Coin coin{};
+    coin.amount = amount;
+    coin.key = Random::CSPRNG<32>().array();
+    coin.blind = Random::CSPRNG<32>().array();
+    coin.commitment = Random::CSPRNG<33>().GetBigInt().ToArray();
+    return coin;
+}
+
+static uint64_t Total(const std::vector<libmw::Coin>& coins)
+{
+    return std::accumulate(
+        coins.cbegin(), coins.cend(), (uint64_t)0,
+        [](uint64_t total, const libmw::Coin& coin) { return total + coin.amount; }
+    );
+}
+
+TEST_CASE("CoinSelection::Select")
+{
+    const uint64_t fee_rate = 10;
+    const uint64_t fee = CoinSelection::CalcFee(1, fee_rate);
+    const uint64_t fee_with_change = CoinSelection::CalcFee(2, fee_rate);
+    REQUIRE(fee == fee_rate * Weight::Calculate(1, 1, 1));
+    REQUIRE(fee_with_change - fee == fee_rate * libmw::OUTPUT_WEIGHT);
+
+    std::vector<libmw::Coin> coins{ MakeCoin(1'000), MakeCoin(2'000), MakeCoin(5'000), MakeCoin(100'000) };
+
+    // Branch-and-bound finds the 2 coins that pay the amount and fee without change.
+    {
+        CoinSelection::Result result = CoinSelection::Select(coins, 3'000 - fee, 1, fee_rate);
+        REQUIRE(result.change == 0);
+        REQUIRE(result.fee == fee);
+        REQUIRE(result.inputs.size() == 2);
+        REQUIRE(Total(result.inputs) == 3'000);
+    }
+
+    // Excess that costs less than a change output goes to the fee.
+    {
+        CoinSelection::Result result = CoinSelection::Select(coins, 3'000 - fee - 5, 1, fee_rate);
+        REQUIRE(result.change == 0);
+        REQUIRE(result.fee == fee + 5);
+        REQUIRE(Total(result.inputs) == 3'000);
+    }
+
+    // Otherwise the knapsack search picks coins, and the rest is returned as change.
+    {
+        CoinSelection::Result result = CoinSelection::Select(coins, 4'000, 1, fee_rate);
+        REQUIRE(result.fee == fee_with_change);
+        REQUIRE(result.change > 0);
+        REQUIRE(Total(result.inputs) == 4'000 + result.fee + result.change);
+    }
+
+    // Watch-only coins can't be spent.
+    {
+        libmw::Coin watch_only = MakeCoin(1'000'000);
+        watch_only.key = boost::none;
+        std::vector<libmw::Coin> with_watch_only = coins;
+        with_watch_only.push_back(watch_only);
+
+        REQUIRE_THROWS_AS(CoinSelection::Select(with_watch_only, 200'000, 1, fee_rate), InsufficientFundsException);
+    }
+
+    // When the coins cover the fee without change, but not with it, they're all spent.
+    {
+        CoinSelection::Result result = CoinSelection::Select(coins, Total(coins) - fee - 1, 1, fee_rate);
+        REQUIRE(result.change == 0);
+        REQUIRE(result.inputs.size() == coins.size());
+        REQUIRE(result.fee == fee + 1);
+    }
+}
+
+TEST_CASE("CoinSelection::CalcFee")
+{
+    const uint64_t fee_rate = 10;
+
+    // The fee matches the weight of the outputs Transact creates, whether or not their proofs are aggregated.
+    for (const size_t num_outputs : { 1, 3, 11 }) {
+        std::vector<std::pair<uint64_t, StealthAddress>> recipients;
+        for (size_t i = 0; i < num_outputs; i++) {
+            recipients.push_back({ 10, StealthAddress::Random() });
+        }
+
+        for (const bool aggregate_proofs : { false, true }) {
+            mw::Transaction::CPtr pTx = Transact::CreateTx(
+                {}, recipients, {}, boost::make_optional<uint64_t>(num_outputs * 10), 0, aggregate_proofs
+            );
+            REQUIRE(CoinSelection::CalcFee(num_outputs, fee_rate, 0, aggregate_proofs) == fee_rate * Weight::Calculate(pTx->GetBody()));
+        }
+    }
+
+    REQUIRE(CoinSelection::CalcFee(11, fee_rate, 0, true) < CoinSelection::CalcFee(11, fee_rate));
+
+    // A pegout is carried by the transaction's kernel.
+    PegOutCoin pegout(100, std::vector<uint8_t>(22, 0x51));
+    mw::Transaction::CPtr pPegOut = Transact::CreateTx(
+        {}, { { 10, StealthAddress::Random() } }, { pegout }, boost::make_optional<uint64_t>(110), 0
+    );
+    REQUIRE(CoinSelection::CalcFee(1, fee_rate, 1) == fee_rate * Weight::Calculate(pPegOut->GetBody()));
+}
+
+TEST_CASE("Transact::Send")
+{
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+    Wallet wallet(pKeychain);
+
+    // Fund the wallet with a few coins.
+    std::vector<std::pair<uint64_t, StealthAddress>> funding;
+    for (uint32_t i = 1; i <= 4; i++) {
+        funding.push_back({ i * 10'000, pKeychain->GetStealthAddress(i) });
+    }
+    mw::Transaction::CPtr pFundingTx = Transact::CreateTx({}, funding, {}, boost::make_optional<uint64_t>(100'000 + 500), 500);
+    std::vector<libmw::Coin> coins = wallet.ScanOutputs(pFundingTx->GetOutputs());
+    REQUIRE(coins.size() == 4);
+
+    StealthAddress recipient = StealthAddress::Random();
+    CoinSelection::Result selection;
+    mw::Transaction::CPtr pTx = Transact::Send(pKeychain, coins, { { 45'000, recipient } }, {}, 1, selection);
+    REQUIRE_NOTHROW(pTx->Validate());
+    REQUIRE(pTx->GetInputs().size() == selection.inputs.size());
+    REQUIRE(pTx->GetKernels().front().GetFee() == selection.fee);
+
+    // The change comes back to the wallet's change address.
+    std::vector<libmw::Coin> received = wallet.ScanOutputs(pTx->GetOutputs());
+    if (selection.change > 0) {
+        REQUIRE(received.size() == 1);
+        REQUIRE(received.front().IsChange());
+        REQUIRE(received.front().amount == selection.change);
+    } else {
+        REQUIRE(received.empty());
+    }
+}
+
+TEST_CASE("CoinSelection::Select - 100k coins", "[.benchmark]")
+{
+    std::vector<libmw::Coin> coins;
+    coins.reserve(100'000);
+    for (size_t i = 0; i < 100'000; i++) {
+        coins.push_back(MakeCoin(1'000 + Random::FastRandom(0, 1'000'000)));
+    }
+
+    for (const uint64_t amount : { (uint64_t)50'000, (uint64_t)5'000'000, (uint64_t)500'000'000 }) {
+        const auto start = std::chrono::steady_clock::now();
+        CoinSelection::Result result = CoinSelection::Select(coins, amount, 1, 10);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        REQUIRE(Total(result.inputs) == amount + result.fee + result.change);
+        WARN("Selected " << result.inputs.size() << " of " << coins.size() << " coins for " << amount
+            << " (change " << result.change << ") in " << elapsed.count() << "us");
+    }
+}
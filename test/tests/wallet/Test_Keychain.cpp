@@ -0,0 +1,61 @@
+#include <catch.hpp>
+
+#include <mw/common/ThreadPool.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/DeserializationException.h>
+#include <mw/wallet/Keychain.h>
+
+#include <atomic>
+
+TEST_CASE("Keychain::IsSpendPubKey")
+{
+    const SecretKey scan_secret = Random::CSPRNG<32>();
+    const SecretKey spend_secret = Random::CSPRNG<32>();
+    mw::Keychain keychain(scan_secret, spend_secret, 10);
+
+    // Pubkeys are derived up to 100 past the counter.
+    uint32_t index = 0;
+    REQUIRE(keychain.IsSpendPubKey(keychain.GetStealthAddress(110).B(), index));
+    REQUIRE(index == 110);
+    REQUIRE_FALSE(keychain.IsSpendPubKey(mw::Keychain(scan_secret, spend_secret, 0).GetStealthAddress(300).B(), index));
+
+    // Raising the counter derives more, and lookups from many threads see the same pubkeys.
+    keychain.GetStealthAddress(250);
+    std::atomic<size_t> num_found(0);
+    ThreadPool::Get().ParallelFor(0, 351, 1, [&keychain, &num_found](const uint64_t begin, const uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            uint32_t found_index = 0;
+            if (keychain.IsSpendPubKey(PublicKey::From(keychain.GetSpendKey((uint32_t)i)), found_index) && found_index == i) {
+                num_found++;
+            }
+        }
+    });
+    REQUIRE(num_found == 351);
+
+    // Serialized pubkeys can be loaded into a new keychain with the same secrets.
+    const std::vector<uint8_t> serialized = keychain.SerializeSpendPubKeys();
+    mw::Keychain loaded(scan_secret, spend_secret, 250);
+    loaded.LoadSpendPubKeys(serialized);
+    REQUIRE(loaded.SerializeSpendPubKeys() == serialized);
+    REQUIRE(loaded.IsSpendPubKey(keychain.GetStealthAddress(350).B(), index));
+    REQUIRE(index == 350);
+
+    // They're rejected by a keychain with different secrets.
+    mw::Keychain other(Random::CSPRNG<32>(), spend_secret, 250);
+    REQUIRE_THROWS_AS(other.LoadSpendPubKeys(serialized), DeserializationException);
+
+    std::vector<uint8_t> truncated(serialized.begin(), serialized.end() - 1);
+    REQUIRE_THROWS_AS(loaded.LoadSpendPubKeys(truncated), DeserializationException);
+
+    // Swapping the indices of two pubkeys keeps them sorted and contiguous, but the hash no longer matches.
+    const size_t entry_size = 33 + sizeof(uint32_t);
+    std::vector<uint8_t> swapped = serialized;
+    std::swap_ranges(
+        swapped.begin() + sizeof(uint32_t) + 33,
+        swapped.begin() + sizeof(uint32_t) + entry_size,
+        swapped.begin() + sizeof(uint32_t) + entry_size + 33
+    );
+    REQUIRE(swapped != serialized);
+    mw::Keychain fresh(scan_secret, spend_secret, 250);
+    REQUIRE_THROWS_AS(fresh.LoadSpendPubKeys(swapped), DeserializationException);
+}
@@ -0,0 +1,101 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Random.h>
+#include <mw/wallet/Wallet.h>
+
+#include <test_framework/TxBuilder.h>
+
+#include <algorithm>
+#include <chrono>
+
+TEST_CASE("Wallet::ScanOutputs")
+{
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+    Wallet wallet(pKeychain);
+
+    test::Tx tx = test::TxBuilder()
+        .AddPeginKernel(100)
+        .AddOutput(10, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(0), EOutputFeatures::PEGGED_IN)
+        .AddOutput(20, EOutputFeatures::PEGGED_IN)
+        .AddOutput(30, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(5), EOutputFeatures::PEGGED_IN)
+        .AddOutput(40, EOutputFeatures::PEGGED_IN)
+        .Build();
+    const std::vector<Output>& outputs = tx.GetTransaction()->GetOutputs();
+
+    std::vector<libmw::Coin> coins = wallet.ScanOutputs(outputs);
+    REQUIRE(coins.size() == 2);
+
+    // Coins are returned in output order, and match what RewindOutput finds.
+    size_t next_coin = 0;
+    for (const Output& output : outputs) {
+        libmw::Coin coin;
+        if (wallet.RewindOutput(output, coin)) {
+            REQUIRE(next_coin < coins.size());
+            REQUIRE(coins[next_coin].commitment == output.GetCommitment().array());
+            REQUIRE(coins[next_coin].address_index == coin.address_index);
+            REQUIRE(coins[next_coin].amount == coin.amount);
+            REQUIRE((coins[next_coin].key == coin.key));
+            REQUIRE((coins[next_coin].blind == coin.blind));
+            next_coin++;
+        }
+    }
+    REQUIRE(next_coin == coins.size());
+
+    std::vector<uint64_t> amounts;
+    std::transform(coins.cbegin(), coins.cend(), std::back_inserter(amounts), [](const libmw::Coin& coin) { return coin.amount; });
+    std::sort(amounts.begin(), amounts.end());
+    REQUIRE(amounts == std::vector<uint64_t>{ 10, 30 });
+
+    REQUIRE(Wallet(std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0)).ScanOutputs(outputs).empty());
+
+    //
+    // An output whose key exchange pubkey isn't a valid point is skipped, without failing the scan.
+    //
+    const Output& theirs = outputs[1];
+    Output invalid_ke(
+        Commitment(theirs.GetCommitment()),
+        theirs.GetFeatures(),
+        PublicKey(theirs.GetReceiverPubKey()),
+        PublicKey(),
+        theirs.GetViewTag(),
+        theirs.GetMaskedValue(),
+        BigInt<16>(theirs.GetMaskedNonce()),
+        PublicKey(theirs.GetSenderPubKey()),
+        Signature(theirs.GetSignature()),
+        theirs.GetRangeProof()
+    );
+
+    std::vector<Output> with_invalid = outputs;
+    with_invalid.insert(with_invalid.begin() + 1, invalid_ke);
+    std::vector<libmw::Coin> coins_with_invalid = wallet.ScanOutputs(with_invalid);
+    REQUIRE(coins_with_invalid.size() == 2);
+    REQUIRE(coins_with_invalid[0].commitment == coins[0].commitment);
+    REQUIRE(coins_with_invalid[1].commitment == coins[1].commitment);
+
+    libmw::Coin invalid_coin;
+    REQUIRE_FALSE(wallet.RewindOutput(invalid_ke, invalid_coin));
+}
+
+TEST_CASE("Wallet::ScanOutputs - 200 outputs", "[.benchmark]")
+{
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+
+    test::TxBuilder builder;
+    builder.AddPeginKernel(200);
+    for (uint64_t i = 0; i < 200; i++) {
+        if (i % 20 == 0) {
+            builder.AddOutput(1, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(1), EOutputFeatures::PEGGED_IN);
+        } else {
+            builder.AddOutput(1, EOutputFeatures::PEGGED_IN);
+        }
+    }
+    test::Tx tx = builder.Build();
+    const std::vector<Output>& outputs = tx.GetTransaction()->GetOutputs();
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<libmw::Coin> coins = Wallet(pKeychain).ScanOutputs(outputs);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    REQUIRE(coins.size() == 10);
+    WARN("Scanned " << outputs.size() << " outputs in " << elapsed.count() << "us");
+}
@@ -0,0 +1,89 @@
+#include <catch.hpp>
+
+#include <mw/consensus/Weight.h>
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/wallet/Transact.h>
+#include <mw/wallet/Wallet.h>
+
+#include <algorithm>
+#include <chrono>
+
+TEST_CASE("Transact::CreateTx")
+{
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+
+    std::vector<std::pair<uint64_t, StealthAddress>> recipients;
+    for (uint32_t i = 0; i < 8; i++) {
+        recipients.push_back({ 10 + i, pKeychain->GetStealthAddress(i) });
+    }
+
+    mw::Transaction::CPtr pTx = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(200), 92);
+    REQUIRE_NOTHROW(pTx->Validate());
+    REQUIRE(pTx->GetOutputs().size() == recipients.size());
+
+    // Every output can be rewound by the recipient, whichever thread created it.
+    std::vector<libmw::Coin> coins = Wallet(pKeychain).ScanOutputs(pTx->GetOutputs());
+    REQUIRE(coins.size() == recipients.size());
+    for (const libmw::Coin& coin : coins) {
+        REQUIRE(coin.amount == 10 + coin.address_index);
+    }
+}
+
+TEST_CASE("Transact::CreateTx - aggregated proofs")
+{
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+
+    // 11 recipients are split into proofs over 8, 2 and 1 outputs.
+    std::vector<std::pair<uint64_t, StealthAddress>> recipients;
+    for (uint32_t i = 0; i < 11; i++) {
+        recipients.push_back({ 10 + i, pKeychain->GetStealthAddress(i) });
+    }
+
+    mw::Transaction::CPtr pTx = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(200), 35, true);
+    REQUIRE_NOTHROW(pTx->Validate());
+
+    const std::vector<Output>& outputs = pTx->GetOutputs();
+    REQUIRE(outputs.size() == recipients.size());
+    REQUIRE(std::count_if(outputs.cbegin(), outputs.cend(), [](const Output& output) { return output.HasRangeProof(); }) == 3);
+    REQUIRE(pTx->GetBody().BuildProofData().size() == 3);
+
+    mw::Transaction::CPtr pUnaggregated = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(200), 35);
+    REQUIRE(Weight::Calculate(pTx->GetBody()) < Weight::Calculate(pUnaggregated->GetBody()));
+    REQUIRE(pTx->Serialized().size() < pUnaggregated->Serialized().size());
+
+    // The outputs survive serialization, and can still be rewound by the recipient.
+    Deserializer deserializer(pTx->Serialized());
+    mw::Transaction deserialized = mw::Transaction::Deserialize(deserializer);
+    REQUIRE(deserialized.GetHash() == pTx->GetHash());
+    REQUIRE_NOTHROW(deserialized.Validate());
+    REQUIRE(Wallet(pKeychain).ScanOutputs(deserialized.GetOutputs()).size() == recipients.size());
+
+    // Every output without a proof must be covered by one of the body's aggregated proofs,
+    // so removing the output that carries the proof over 8 outputs leaves 7 uncovered.
+    std::vector<Output> uncovered;
+    std::copy_if(
+        outputs.cbegin(), outputs.cend(),
+        std::back_inserter(uncovered),
+        [](const Output& output) { return output.GetAggregatedCommits().size() != 7; }
+    );
+    REQUIRE(uncovered.size() == outputs.size() - 1);
+    REQUIRE_THROWS_AS(TxBody(std::vector<Input>{}, uncovered, pTx->GetKernels(), pTx->GetOwnerSigs()).ValidateStructure(), ValidationException);
+}
+
+TEST_CASE("Transact::CreateTx - 200 recipients", "[.benchmark]")
+{
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+
+    std::vector<std::pair<uint64_t, StealthAddress>> recipients;
+    for (uint32_t i = 0; i < 200; i++) {
+        recipients.push_back({ 1000, pKeychain->GetStealthAddress(i) });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    mw::Transaction::CPtr pTx = Transact::CreateTx({}, recipients, {}, boost::make_optional<uint64_t>(200'000 + 500), 500);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    REQUIRE(pTx->GetOutputs().size() == 200);
+    WARN("Created a transaction with " << recipients.size() << " recipients in " << elapsed.count() << "ms");
+}
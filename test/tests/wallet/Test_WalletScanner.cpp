@@ -0,0 +1,114 @@
+#include <catch.hpp>
+
+#include <mw/crypto/Random.h>
+#include <mw/exceptions/DatabaseException.h>
+#include <mw/file/ScopedFileRemover.h>
+#include <mw/node/CoinsView.h>
+#include <mw/node/INode.h>
+#include <mw/wallet/WalletScanner.h>
+
+#include <test_framework/DBWrapper.h>
+#include <test_framework/Miner.h>
+#include <test_framework/TestChain.h>
+#include <test_framework/TestUtil.h>
+#include <test_framework/TxBuilder.h>
+
+static std::vector<uint64_t> Amounts(const std::vector<libmw::Coin>& coins)
+{
+    std::vector<uint64_t> amounts;
+    std::transform(coins.cbegin(), coins.cend(), std::back_inserter(amounts), [](const libmw::Coin& coin) { return coin.amount; });
+    std::sort(amounts.begin(), amounts.end());
+    return amounts;
+}
+
+TEST_CASE("WalletScanner")
+{
+    FilePath datadir = test::TestUtil::GetTempDir();
+    ScopedFileRemover remover(datadir); // Removes the directory when this goes out of scope.
+
+    auto pNode = mw::InitializeNode(datadir, "test", nullptr, std::make_shared<TestDBWrapper>());
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pNode->GetDBView());
+
+    auto pKeychain = std::make_shared<mw::Keychain>(Random::CSPRNG<32>(), Random::CSPRNG<32>(), 0);
+    auto pWalletDB = std::make_shared<TestDBWrapper>();
+
+    //
+    // Mine blocks that send coins to the wallet, and spend one of them.
+    //
+    test::Miner miner;
+    std::vector<test::MinedBlock> blocks;
+    std::vector<mw::BlockUndo::CPtr> undos;
+    auto mine = [&](const uint64_t height, const std::vector<test::Tx>& txs) {
+        blocks.push_back(miner.MineBlock(height, txs));
+        undos.push_back(pNode->ConnectBlock(blocks.back().GetBlock(), pCachedView));
+    };
+
+    test::Tx tx1 = test::TxBuilder()
+        .AddPeginKernel(100)
+        .AddOutput(10, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(0), EOutputFeatures::PEGGED_IN)
+        .AddOutput(20, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(1), EOutputFeatures::PEGGED_IN)
+        .AddOutput(70, EOutputFeatures::PEGGED_IN)
+        .Build();
+    mine(10, { tx1 });
+
+    test::Tx tx2 = test::TxBuilder()
+        .AddInput(tx1.GetOutputs()[0])
+        .AddPlainKernel(2)
+        .AddOutput(3, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(2), EOutputFeatures::DEFAULT_OUTPUT)
+        .AddOutput(5)
+        .Build();
+    mine(11, { tx2 });
+
+    {
+        WalletScanner scanner(pKeychain, pWalletDB);
+        REQUIRE(Amounts(scanner.ScanChain(std::make_shared<TestChain>(blocks))) == std::vector<uint64_t>{ 3, 10, 20 });
+        REQUIRE(Amounts(scanner.GetCoins()) == std::vector<uint64_t>{ 3, 20 });
+        REQUIRE(scanner.GetCursor()->height == 11);
+        REQUIRE(scanner.GetCursor()->block_hash == blocks.back().GetBlock()->GetHash());
+    }
+
+    //
+    // After a restart, only the new blocks are scanned.
+    //
+    mine(12, { test::TxBuilder()
+        .AddPeginKernel(7)
+        .AddOutput(7, Random::CSPRNG<32>(), pKeychain->GetStealthAddress(3), EOutputFeatures::PEGGED_IN)
+        .Build()
+    });
+
+    WalletScanner scanner(pKeychain, pWalletDB);
+    REQUIRE(Amounts(scanner.ScanChain(std::make_shared<TestChain>(blocks))) == std::vector<uint64_t>{ 7 });
+    REQUIRE(Amounts(scanner.GetCoins()) == std::vector<uint64_t>{ 3, 7, 20 });
+    REQUIRE(scanner.ScanChain(std::make_shared<TestChain>(blocks)).empty());
+
+    //
+    // Disconnecting blocks removes the coins they added and restores the coins they spent.
+    //
+    REQUIRE_THROWS_AS(scanner.DisconnectBlock(undos[1]), DatabaseException);
+
+    scanner.DisconnectBlock(undos[2]);
+    REQUIRE(Amounts(scanner.GetCoins()) == std::vector<uint64_t>{ 3, 20 });
+    REQUIRE(scanner.GetCursor()->block_hash == blocks[1].GetBlock()->GetHash());
+
+    scanner.DisconnectBlock(undos[1]);
+    REQUIRE(Amounts(scanner.GetCoins()) == std::vector<uint64_t>{ 10, 20 });
+    REQUIRE(scanner.GetCursor()->block_hash == blocks[0].GetBlock()->GetHash());
+
+    REQUIRE_THROWS_AS(scanner.ConnectBlock(blocks[2].GetBlock()), DatabaseException);
+    REQUIRE(Amounts(scanner.ConnectBlock(blocks[1].GetBlock())) == std::vector<uint64_t>{ 3 });
+    REQUIRE(Amounts(scanner.GetCoins()) == std::vector<uint64_t>{ 3, 20 });
+
+    //
+    // If the block at the cursor was disconnected without the scanner knowing, the whole chain is scanned again.
+    //
+    test::Miner fork_miner;
+    std::vector<test::MinedBlock> fork{
+        fork_miner.MineBlock(10, { tx1 }),
+        fork_miner.MineBlock(11, {})
+    };
+    REQUIRE(fork[1].GetBlock()->GetHash() != blocks[1].GetBlock()->GetHash());
+
+    REQUIRE(Amounts(scanner.ScanChain(std::make_shared<TestChain>(fork))) == std::vector<uint64_t>{ 10, 20 });
+    REQUIRE(Amounts(scanner.GetCoins()) == std::vector<uint64_t>{ 10, 20 });
+    REQUIRE(scanner.GetCursor()->block_hash == fork[1].GetBlock()->GetHash());
+}